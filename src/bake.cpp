@@ -0,0 +1,104 @@
+#include "pch.h"
+//
+#include <map>
+
+#include "utils/io.h"
+#include "utils/path.h"
+#include "utils/thread_pool.h"
+#include "utils/timer.h"
+#include "vlux/model/gltf.h"
+#include "vlux/model/vlx_scene.h"
+
+namespace {
+/**
+ * @brief Bake one glTF model with its transform into a .vlxscene file
+ */
+void BakeModel(const nlohmann::json& model_config, const std::filesystem::path& output_path,
+               const vlux::MeshOptimizationOptions& mesh_optimization,
+               const vlux::LodOptions& lod, vlux::ThreadPool& thread_pool) {
+    const auto path = model_config.at("path").get<std::filesystem::path>();
+    const auto scale = model_config.at("scale").get<float>();
+    const auto translation_array = model_config.at("translation").get<std::array<float, 3>>();
+    const auto rotation_array = model_config.at("rotation").get<std::array<float, 3>>();
+    const auto translation =
+        glm::vec3(translation_array[0], translation_array[1], translation_array[2]);
+    const auto rotation = glm::vec3(rotation_array[0], rotation_array[1], rotation_array[2]);
+
+    // shared with the decode tasks, which may outlive this call if one of them throws
+    const auto gltf_model =
+        std::make_shared<const tinygltf::Model>(vlux::LoadTinyGltfModel(path));
+    auto primitive_futures = std::vector<std::future<vlux::GltfPrimitive>>();
+    for (const auto& mesh : gltf_model->meshes) {
+        for (const auto& primitive : mesh.primitives) {
+            primitive_futures.emplace_back(
+                thread_pool.Submit([gltf_model, &primitive, scale, translation, rotation,
+                                    mesh_optimization, lod]() {
+                    return vlux::DecodeGltfPrimitive(primitive, *gltf_model, scale, translation,
+                                                     rotation, mesh_optimization, lod);
+                }));
+        }
+    }
+
+    // keep the referenced images only and renumber them in order of first use
+    auto primitives = std::vector<vlux::GltfPrimitive>();
+    auto images = std::vector<vlux::Image<uint8_t>>();
+    auto image_remap = std::map<int, int>();
+    const auto remap_image = [&](int& image_idx) {
+        if (image_idx == -1) {
+            return;
+        }
+        const auto [it, inserted] =
+            image_remap.emplace(image_idx, static_cast<int>(image_remap.size()));
+        if (inserted) {
+            const auto& gltf_image = gltf_model->images[image_idx];
+            images.emplace_back(gltf_image.image, gltf_image.width, gltf_image.height,
+                                gltf_image.component);
+        }
+        image_idx = it->second;
+    };
+    for (auto& primitive_future : primitive_futures) {
+        auto primitive = primitive_future.get();
+        remap_image(primitive.base_color_image);
+        remap_image(primitive.normal_image);
+        remap_image(primitive.emissive_image);
+        remap_image(primitive.occlusion_roughness_metallic_image);
+        primitives.emplace_back(std::move(primitive));
+    }
+
+    vlux::WriteVlxScene(output_path, primitives, images);
+    spdlog::info("{} -> {}: {} primitives, {} textures", path.string(), output_path.string(),
+                 primitives.size(), images.size());
+}
+}  // namespace
+
+int main() {
+    const auto config = vlux::ReadJsonFile(vlux::GetCurrentDir() / "config.json");
+    const auto app_config = vlux::ReadJsonFile(vlux::GetCurrentDir() / "vlux" / "config.json");
+
+    // unpack config
+    const auto scene_name = config.at("scene").get<std::string>();
+    const auto output_dir = config.at("bake").at("output_dir").get<std::filesystem::path>();
+    const auto mesh_optimization = vlux::ParseMeshOptimizationOptions(
+        app_config.value("mesh_optimization", nlohmann::json::object()));
+    const auto lod = vlux::ParseLodOptions(app_config.value("lod", nlohmann::json::object()));
+
+    try {
+        std::filesystem::create_directories(output_dir);
+        auto thread_pool = vlux::ThreadPool(std::thread::hardware_concurrency());
+        auto timer = vlux::Timer();
+        for (const auto& model_config : app_config.at("scenes").at(scene_name).at("models")) {
+            const auto path = model_config.at("path").get<std::filesystem::path>();
+            if (path.extension() == ".vlxscene") {
+                continue;
+            }
+            const auto name = model_config.at("name").get<std::string>();
+            BakeModel(model_config, output_dir / (name + ".vlxscene"), mesh_optimization, lod,
+                      thread_pool);
+        }
+        spdlog::info("bake time: {} ms", timer.GetElapsedMilliseconds());
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
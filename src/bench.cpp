@@ -0,0 +1,85 @@
+#include "pch.h"
+//
+#include "utils/io.h"
+#include "utils/path.h"
+#include "vlux/app.h"
+#include "vlux/bench/bench_stats.h"
+#include "vlux/bench/camera_path.h"
+#include "vlux/device_resource/device_resource.h"
+
+int main() {
+    const auto config_path = vlux::GetCurrentDir() / "config.json";
+    const auto config = vlux::ReadJsonFile(config_path);
+
+    // unpack config
+    const auto spdlog_level = config.at("spdlog_level").get<std::string>();
+    const auto width = config.at("width").get<uint32_t>();
+    const auto height = config.at("height").get<uint32_t>();
+    const auto scene_name = config.at("scene").get<std::string>();
+    const auto& bench_config = config.at("bench");
+    const auto draw_modes = bench_config.at("draw_modes").get<std::vector<std::string>>();
+    const auto warmup_frames = bench_config.at("warmup_frames").get<uint32_t>();
+    const auto measured_frames = bench_config.at("measured_frames").get<uint32_t>();
+    const auto frame_delta = bench_config.at("frame_delta").get<float>();
+    const auto output_dir = bench_config.at("output_dir").get<std::filesystem::path>();
+    const auto camera_path = vlux::bench::LoadCameraPath(bench_config.at("camera_path"));
+
+    // setup logger lovel
+    if (spdlog_level == "info") {
+        spdlog::set_level(spdlog::level::info);
+    } else if (spdlog_level == "debug") {
+        spdlog::set_level(spdlog::level::debug);
+    }
+
+    try {
+        auto device_resource = vlux::DeviceResource(width, height);
+        auto app = vlux::App(device_resource, scene_name);
+
+        const auto device_name = [&]() {
+            auto properties = VkPhysicalDeviceProperties{};
+            vkGetPhysicalDeviceProperties(device_resource.GetVkPhysicalDevice(), &properties);
+            return std::string(properties.deviceName);
+        }();
+        std::filesystem::create_directories(output_dir);
+
+        for (const auto& draw_mode : draw_modes) {
+            spdlog::info("bench: {} / {} on {}", scene_name, draw_mode, device_name);
+            app.SetDrawMode(draw_mode);
+
+            // the camera is driven by the frame number only, so every run sees the same frames
+            const auto render_frames = [&](const uint32_t num_frames) {
+                for (auto frame_i = 0u; frame_i < num_frames; frame_i++) {
+                    const auto keyframe =
+                        camera_path.Sample(static_cast<float>(frame_i) * frame_delta);
+                    app.SetCameraPose(keyframe.pos, keyframe.rot);
+                    app.RenderHeadlessFrame();
+                }
+                return app.FlushFrameTimes();
+            };
+            render_frames(warmup_frames);
+            auto frames = render_frames(measured_frames);
+
+            const auto run = vlux::bench::BenchRun{
+                .scene = scene_name,
+                .draw_mode = draw_mode,
+                .device_name = device_name,
+                .width = width,
+                .height = height,
+                .warmup_frames = warmup_frames,
+                .frames = std::move(frames),
+            };
+            const auto stem = fmt::format("{}_{}", scene_name, draw_mode);
+            vlux::bench::WriteBenchJson(output_dir / (stem + ".json"), run);
+            vlux::bench::WriteBenchCsv(output_dir / (stem + ".csv"), run);
+            app.WriteGpuTrace(output_dir / (stem + "_trace.json"));
+
+            const auto summary = vlux::bench::ToJson(run);
+            spdlog::info("cpu_ms: {}", summary.at("cpu_ms").dump());
+            spdlog::info("gpu_ms: {}", summary.at("gpu_ms").dump());
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -23,6 +23,24 @@ int main() {
         spdlog::set_level(spdlog::level::debug);
     }
 
+    const auto& headless_config = config.at("headless");
+    if (headless_config.at("enable").get<bool>()) {
+        const auto num_frames = headless_config.at("num_frames").get<uint32_t>();
+        const auto readback_dir = headless_config.at("readback_dir").get<std::string>();
+
+        auto device_resource = vlux::DeviceResource(width, height);
+        auto app = vlux::App(device_resource, scene_name);
+        try {
+            app.RunHeadless(num_frames, readback_dir.empty()
+                                            ? std::nullopt
+                                            : std::optional<std::filesystem::path>(readback_dir));
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
     auto window = vlux::Window(width, height, "vlux");
     auto device_resource = vlux::DeviceResource(window, vsync);
     auto app = vlux::App(device_resource, scene_name);
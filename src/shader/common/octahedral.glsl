@@ -0,0 +1,16 @@
+// Octahedral unit vector encoding; model/vertex.cpp has the CPU side
+
+vec2 SignNotZero(in vec2 v) { return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0); }
+
+vec2 EncodeOctahedralNormal(in vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    return n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * SignNotZero(n.xy);
+}
+
+vec3 DecodeOctahedralNormal(in vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * SignNotZero(n.xy);
+    }
+    return normalize(n);
+}
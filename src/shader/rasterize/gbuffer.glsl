@@ -0,0 +1,16 @@
+// Compact G-buffer layout shared by gbuffer_output.glsl (write) and deferred.comp (read)
+//
+//   0: albedo    R8G8B8A8_SRGB            base color * base color factor
+//   1: normal    R16G16_SNORM             octahedral world-space normal
+//   2: emissive  B10G11R11_UFLOAT_PACK32
+//   3: orm       R8G8B8A8_UNORM           occlusion, roughness, metallic (factors applied), flags
+//
+// World position is reconstructed from depth.
+
+#include "../common/octahedral.glsl"
+
+const uint kGBufferFlagGeometry = 1u;
+
+float EncodeGBufferFlags(in uint flags) { return float(flags) / 255.0; }
+
+uint DecodeGBufferFlags(in float flags) { return uint(flags * 255.0 + 0.5); }
@@ -0,0 +1,40 @@
+// G-buffer write of shader.frag; the layout is in gbuffer.glsl
+
+#include "frag_input.glsl"
+#include "gbuffer.glsl"
+
+// see MaterialParams in model/model.h
+struct MaterialParams {
+    vec4 base_color;
+    vec4 metallic_roughness;
+    uvec4 texture_indices;  // base color, normal, emissive, occlusion roughness metallic
+};
+
+layout(location = 0) out vec4 out_albedo;
+layout(location = 1) out vec2 out_normal;
+layout(location = 2) out vec4 out_emissive;
+layout(location = 3) out vec4 out_occlusion_roughness_metallic;
+
+void WriteGBuffer(in FragInput frag_input, in MaterialParams material, in vec4 base_color,
+                  in vec3 normal_ts, in vec4 emissive, in vec4 occlusion_roughness_metallic) {
+    // invert y
+    normal_ts = normalize(normal_ts * 2.0f - 1.0f);
+
+    // TBN matrix
+    mat3x3 tangent_frame_ws =
+        mat3x3(normalize(frag_input.tangent_ws), normalize(frag_input.bitangent_ws),
+               normalize(frag_input.normal_ws));
+    vec3 normal_ws = tangent_frame_ws * normal_ts;
+
+    // the material factors are applied here so that the deferred pass does not need them
+    const float metallic_factor = material.metallic_roughness.x;
+    const float roughness_factor = material.metallic_roughness.y;
+
+    out_albedo = base_color * material.base_color;
+    out_normal = EncodeOctahedralNormal(normalize(normal_ws));
+    out_emissive = emissive;
+    out_occlusion_roughness_metallic =
+        vec4(occlusion_roughness_metallic.x, occlusion_roughness_metallic.y * roughness_factor,
+             occlusion_roughness_metallic.z * metallic_factor,
+             EncodeGBufferFlags(kGBufferFlagGeometry));
+}
@@ -0,0 +1,25 @@
+// Hi-Z pyramid of draw/rasterize/hiz_pyramid.h, shared by hiz_build.comp and draw_cull.comp.
+// Level 0 halves the depth target (rounded up), every further level halves the previous one down
+// to a single texel; the levels are packed back to back in one float buffer.
+
+struct HiZLevel {
+    uint offset;  // first texel in the pyramid buffer
+    uvec2 size;
+};
+
+HiZLevel GetHiZLevel(in uvec2 depth_size, in uint level) {
+    HiZLevel result = HiZLevel(0, max((depth_size + 1) / 2, uvec2(1)));
+    for (uint i = 0; i < level; i++) {
+        result.offset += result.size.x * result.size.y;
+        result.size = (result.size + 1) / 2;
+    }
+    return result;
+}
+
+// Texels of a source of `src_size` covered by texel `coords` of a destination of `dst_size`;
+// rounded outwards, so odd sizes stay conservative
+void GetHiZFootprint(in uvec2 coords, in uvec2 src_size, in uvec2 dst_size, out uvec2 first,
+                     out uvec2 last) {
+    first = (coords * src_size) / dst_size;
+    last = min(((coords + 1) * src_size + dst_size - 1) / dst_size, src_size) - 1;
+}
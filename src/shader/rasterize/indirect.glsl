@@ -0,0 +1,29 @@
+// GPU-driven draws of draw/rasterize/indirect_draw.h, shared by draw_cull.comp and
+// shader_indirect.vert
+
+struct DrawRecord {
+    vec4 aabb_min;  // xyz: object-space bounds
+    vec4 aabb_max;
+    vec4 dequantize_scale;
+    vec4 dequantize_offset;
+    uint lod_offset;  // first DrawLod, full detail first
+    uint lod_count;
+    int vertex_offset;
+    uint material_id;
+};
+
+struct DrawLod {
+    uint first_index;
+    uint index_count;
+    float error;
+    uint padding;
+};
+
+// VkDrawIndexedIndirectCommand
+struct DrawIndexedIndirectCommand {
+    uint index_count;
+    uint instance_count;
+    uint first_index;
+    int vertex_offset;
+    uint first_instance;
+};
@@ -0,0 +1,46 @@
+// Point lights and the screen tile grid built by light_cull.comp
+//
+// The grid stores, per 16x16 pixel tile, the number of lights followed by up to
+// kMaxLightsPerTile indices into `lights`. Keep in sync with rasterize.cpp.
+
+struct LightParams {
+    vec4 pos;
+    float range;
+    vec4 color;
+};
+
+const uint kLightTileSize = 16;
+const uint kMaxLightsPerTile = 255;
+const uint kLightGridStride = kMaxLightsPerTile + 1;
+
+//! contributions below this are cut off, so that every light has a finite radius
+const float kLightCutoff = 1.0f / 256.0f;
+
+uint GetNumLightTilesX(in uint width) { return (width + kLightTileSize - 1) / kLightTileSize; }
+
+uint GetLightGridOffset(in uvec2 tile, in uint num_tiles_x) {
+    return (tile.y * num_tiles_x + tile.x) * kLightGridStride;
+}
+
+//! distance at which the unwindowed attenuation of the brightest channel drops to kLightCutoff
+float GetLightRadius(in LightParams light) {
+    const float intensity = light.range * max(light.color.r, max(light.color.g, light.color.b));
+    // solve 0.017 d^2 + 0.07 d + 1 = intensity / kLightCutoff
+    const float c = 1.0f - intensity / kLightCutoff;
+    if (c >= 0.0f) {
+        return 0.0f;
+    }
+    return (-0.07f + sqrt(0.07f * 0.07f - 4.0f * 0.017f * c)) / (2.0f * 0.017f);
+}
+
+float GetLightAttenuation(in LightParams light, in float distance) {
+    const float radius = GetLightRadius(light);
+    if (radius <= 0.0f) {
+        return 0.0f;
+    }
+    // fade to zero at the radius so that tile borders do not show up
+    const float ratio = distance / radius;
+    const float window = clamp(1.0f - ratio * ratio * ratio * ratio, 0.0f, 1.0f);
+    return light.range / (1.0f + 0.07f * distance + 0.017f * distance * distance) * window *
+           window;
+}
@@ -0,0 +1,36 @@
+// Meshlets of model/meshlet.h, shared by shader.task and shader.mesh
+
+// meshlets culled by one task workgroup, see kMeshletsPerTask in draw/rasterize/rasterize.cpp
+#define MESHLETS_PER_TASK 32
+
+struct Meshlet {
+    uint vertex_offset;
+    uint triangle_offset;
+    uint vertex_count;
+    uint triangle_count;
+    vec4 sphere;  // xyz: center, w: radius
+    vec4 cone;    // xyz: axis, w: cutoff; 1 disables the test
+};
+
+layout(set = 2, binding = 0, std430) readonly buffer Meshlets { Meshlet meshlets[]; };
+// indices into the vertex buffer, Meshlet::vertex_count per meshlet
+layout(set = 2, binding = 1, std430) readonly buffer MeshletVertices { uint meshlet_vertices[]; };
+// three 8-bit indices into the vertices of the meshlet
+layout(set = 2, binding = 2, std430) readonly buffer MeshletTriangles { uint meshlet_triangles[]; };
+// Vertex as 12 words or CompactVertex as 5 words
+layout(set = 2, binding = 3, std430) readonly buffer VertexBuffer { uint vertex_words[]; };
+
+layout(push_constant) uniform MeshletPushConstants {
+    vec4 dequantize_scale;
+    vec4 dequantize_offset;
+    vec4 camera_position;  // world space
+    uint vertex_format;
+    uint meshlet_count;
+    uint material_id;  // see shader.frag
+}
+meshlet_push_constants;
+
+// meshlets that survived culling
+struct TaskPayload {
+    uint meshlet_indices[MESHLETS_PER_TASK];
+};
@@ -0,0 +1,4 @@
+// Instance transforms (Model::GetTransform) of the G-buffer pass, indexed by material id, i.e.
+// model index; applied on top of the placement baked into the vertices
+
+layout(set = 1, binding = 1, std430) readonly buffer ModelTransforms { mat4 model_transforms[]; };
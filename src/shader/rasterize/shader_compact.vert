@@ -0,0 +1,27 @@
+#version 460
+#extension GL_ARB_shading_language_include : require
+
+#include "../common/octahedral.glsl"
+#include "vertex_output.glsl"
+
+// CompactVertex, see model/vertex.h
+layout(location = 0) in vec4 in_position;  // xyz: quantized position, w: tangent sign
+layout(location = 1) in vec2 in_normal;    // octahedral
+layout(location = 2) in vec2 in_uv;
+layout(location = 3) in vec2 in_tangent;  // octahedral
+
+layout(push_constant) uniform VertexPushConstants {
+    vec4 dequantize_scale;
+    vec4 dequantize_offset;
+    uint material_id;
+}
+vertex_push_constants;
+
+void main() {
+    const vec3 position = vertex_push_constants.dequantize_offset.xyz +
+                          vertex_push_constants.dequantize_scale.xyz * in_position.xyz;
+    const vec4 tangent =
+        vec4(DecodeOctahedralNormal(in_tangent), in_position.w < 0.0 ? -1.0 : 1.0);
+    WriteVertexOutput(position, DecodeOctahedralNormal(in_normal), in_uv, tangent,
+                      vertex_push_constants.material_id);
+}
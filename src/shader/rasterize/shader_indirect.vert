@@ -0,0 +1,29 @@
+#version 460
+#extension GL_ARB_shading_language_include : require
+
+#include "indirect.glsl"
+
+layout(set = 1, binding = 2, std430) readonly buffer DrawRecords { DrawRecord draw_records[]; };
+// record of each indirect command, indexed by draw_id_offset + gl_DrawID
+layout(set = 1, binding = 3, std430) readonly buffer VisibleDrawIds { uint visible_draw_ids[]; };
+// vertices of every model (the geometry pool); gl_VertexIndex already includes the vertex offset
+layout(set = 1, binding = 4, std430) readonly buffer VertexBuffer { uint vertex_words[]; };
+
+#include "vertex_fetch.glsl"
+#include "vertex_output.glsl"
+
+layout(push_constant) uniform IndirectPushConstants {
+    uint vertex_format;
+    uint draw_id_offset;  // commands of the late culling phase follow those of the early one
+}
+indirect_push_constants;
+
+void main() {
+    const uint draw_id = indirect_push_constants.draw_id_offset + gl_DrawID;
+    const DrawRecord record = draw_records[visible_draw_ids[draw_id]];
+    const FetchedVertex vertex =
+        FetchVertex(gl_VertexIndex, indirect_push_constants.vertex_format,
+                    record.dequantize_scale.xyz, record.dequantize_offset.xyz);
+    WriteVertexOutput(vertex.position, vertex.normal, vertex.uv, vertex.tangent,
+                      record.material_id);
+}
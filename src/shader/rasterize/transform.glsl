@@ -0,0 +1,35 @@
+// Transform of the G-buffer pass, shared by the vertex and the task/mesh shaders
+
+#include "frag_input.glsl"
+
+struct TransformParams {
+    mat4x4 world;
+    mat4x4 view_proj;
+    mat4x4 world_view_proj;
+    mat4x4 proj_to_world;
+};
+
+layout(set = 0, binding = 0) uniform ubo { TransformParams transform; };
+
+// model: instance transform of the model, see model_transform.glsl
+FragInput TransformVertex(in mat4 model, in vec3 position, in vec3 normal, in vec2 uv,
+                          in vec4 tangent) {
+    FragInput frag_input;
+    const mat4 world = transform.world * model;
+    // Convert normal
+    frag_input.normal_ws = normalize(mat3x3(world) * normal);
+
+    // Reconstruct the rest of the tangent frame
+    frag_input.tangent_ws = normalize(mat3x3(world) * tangent.xyz);
+    frag_input.bitangent_ws =
+        normalize(cross(frag_input.normal_ws, frag_input.tangent_ws)) * tangent.w;
+
+    // Calculate the clip-space position
+    const vec4 position_model = model * vec4(position, 1.0);
+    frag_input.position_cs = transform.world_view_proj * position_model;
+    frag_input.position_ws = transform.world * position_model;
+
+    // Pass through the rest of the data
+    frag_input.texcoord = uv;
+    return frag_input;
+}
@@ -0,0 +1,43 @@
+// Vertex pulling of both vertex formats (model/vertex.h), shared by the mesh shader and the
+// indirect vertex shader. The including shader declares the `vertex_words` storage buffer.
+
+#include "../common/octahedral.glsl"
+
+// see VertexFormat in model/vertex.h
+const uint kVertexFormatFloat = 0;
+const uint kVertexFormatCompact = 1;
+
+struct FetchedVertex {
+    vec3 position;
+    vec3 normal;
+    vec2 uv;
+    vec4 tangent;
+};
+
+FetchedVertex FetchVertex(in uint index, in uint vertex_format, in vec3 dequantize_scale,
+                          in vec3 dequantize_offset) {
+    FetchedVertex vertex;
+    if (vertex_format == kVertexFormatCompact) {
+        // 20 bytes = 5 uint per CompactVertex
+        const uint offset = index * 5;
+        const vec2 pos_xy = unpackSnorm2x16(vertex_words[offset + 0]);
+        const vec2 pos_zw = unpackSnorm2x16(vertex_words[offset + 1]);  // pos.z, tangent sign
+        vertex.position = dequantize_offset + dequantize_scale * vec3(pos_xy, pos_zw.x);
+        vertex.normal = DecodeOctahedralNormal(unpackSnorm2x16(vertex_words[offset + 2]));
+        vertex.tangent = vec4(DecodeOctahedralNormal(unpackSnorm2x16(vertex_words[offset + 3])),
+                              pos_zw.y < 0.0 ? -1.0 : 1.0);
+        vertex.uv = unpackHalf2x16(vertex_words[offset + 4]);
+        return vertex;
+    }
+    // 48 bytes = 12 floats per Vertex: pos.xyz, normal.xyz, uv.xy, tangent.xyzw
+    const uint offset = index * 12;
+    float v[12];
+    for (uint i = 0; i < 12; i++) {
+        v[i] = uintBitsToFloat(vertex_words[offset + i]);
+    }
+    vertex.position = vec3(v[0], v[1], v[2]);
+    vertex.normal = vec3(v[3], v[4], v[5]);
+    vertex.uv = vec2(v[6], v[7]);
+    vertex.tangent = vec4(v[8], v[9], v[10], v[11]);
+    return vertex;
+}
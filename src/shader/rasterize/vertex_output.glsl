@@ -0,0 +1,18 @@
+// Shared by the vertex shaders of each vertex format (model/vertex.h); they decode their inputs
+// and call WriteVertexOutput
+
+#include "model_transform.glsl"
+#include "transform.glsl"
+
+layout(location = 0) out FragInput frag_input;
+// index into the materials and texture arrays of shader.frag
+layout(location = 6) flat out uint out_material_id;
+
+void WriteVertexOutput(in vec3 position, in vec3 normal, in vec2 uv, in vec4 tangent,
+                       in uint material_id) {
+    frag_input = TransformVertex(model_transforms[material_id], position, normal, uv, tangent);
+    out_material_id = material_id;
+
+    // Output the clip-space position
+    gl_Position = frag_input.position_cs;
+}
@@ -2,5 +2,7 @@
 #extension GL_EXT_shader_explicit_arithmetic_types_int64 : require
 
 layout(buffer_reference, scalar) buffer Vertices { vec4 v[]; };
+layout(buffer_reference, scalar) buffer CompactVertices { uint w[]; };
 layout(buffer_reference, scalar) buffer Indices { uint16_t i[]; };
+layout(buffer_reference, scalar) buffer Indices32 { uint i[]; };
 layout(buffer_reference, scalar) buffer Data { vec4 f[]; };
\ No newline at end of file
@@ -5,6 +5,10 @@ struct GeometryNode {
     int texture_index_normal;
     int texture_index_emissive;
     int texture_index_occlusion_roughness_metallic;
+    uint index_size;     // bytes per index, 2 or 4
+    uint vertex_format;  // kVertexFormat*
+    vec4 dequantize_scale;
+    vec4 dequantize_offset;
 };
 layout(set = 2, binding = 0) buffer GeometryNodes { GeometryNode nodes[]; }
 geometry_nodes;
\ No newline at end of file
@@ -1,3 +1,5 @@
+#include "../common/octahedral.glsl"
+
 struct Vertex {
     vec3 pos;
     vec3 normal;
@@ -13,27 +15,53 @@ struct Triangle {
     vec4 tangent;
 };
 
+// model/vertex.h
+const uint kVertexFormatFloat = 0;
+const uint kVertexFormatCompact = 1;
+
+Vertex UnpackVertex(in GeometryNode geometry_node, in uint index) {
+    Vertex vertex;
+    if (geometry_node.vertex_format == kVertexFormatCompact) {
+        // 20 bytes = 5 uint per CompactVertex
+        CompactVertices vertices = CompactVertices(geometry_node.vertex_buffer_device_address);
+        const uint vertex_offset = index * 5;
+        const vec2 pos_xy = unpackSnorm2x16(vertices.w[vertex_offset + 0]);
+        const vec2 pos_zw = unpackSnorm2x16(vertices.w[vertex_offset + 1]);  // pos.z, tangent sign
+        vertex.pos = geometry_node.dequantize_offset.xyz +
+                     geometry_node.dequantize_scale.xyz * vec3(pos_xy, pos_zw.x);
+        vertex.normal = DecodeOctahedralNormal(unpackSnorm2x16(vertices.w[vertex_offset + 2]));
+        const vec2 tangent = unpackSnorm2x16(vertices.w[vertex_offset + 3]);
+        vertex.tangent = vec4(DecodeOctahedralNormal(tangent), pos_zw.y < 0.0 ? -1.0 : 1.0);
+        vertex.uv = unpackHalf2x16(vertices.w[vertex_offset + 4]);
+        return vertex;
+    }
+    // Data is packed as vec4 so we can map to the glTF vertex structure from the host side
+    Vertices vertices = Vertices(geometry_node.vertex_buffer_device_address);
+    const uint vertex_offset = index * 3;           // 12 bytes = 3 vec4 per Vertex
+    const vec4 d0 = vertices.v[vertex_offset + 0];  // pos.xyz, normal.x
+    const vec4 d1 = vertices.v[vertex_offset + 1];  // normal.yz, uv.xy
+    const vec4 d2 = vertices.v[vertex_offset + 2];  // tangent.xyzw
+    vertex.pos = d0.xyz;
+    vertex.normal = vec3(d0.w, d1.xy);
+    vertex.uv = d1.zw;
+    vertex.tangent = d2;
+    return vertex;
+}
+
 // This function will unpack our vertex buffer data into a single triangle and calculates uv
 // coordinates
 Triangle UnpackTriangle(const uint primitive_index) {
     Triangle tri;
     GeometryNode geometry_node = geometry_nodes.nodes[gl_InstanceID];
     Indices indices = Indices(geometry_node.index_buffer_device_address);
-    Vertices vertices = Vertices(geometry_node.vertex_buffer_device_address);
+    Indices32 indices32 = Indices32(geometry_node.index_buffer_device_address);
 
     // Unpack vertices
-    // Data is packed as vec4 so we can map to the glTF vertex structure from the host side
     const uint tri_index = primitive_index * 3;
     for (uint i = 0; i < 3; i++) {
-        const uint vertex_offset =
-            uint(indices.i[tri_index + i]) * 3;         // 12 bytes = 3 vec4 per Vertex
-        const vec4 d0 = vertices.v[vertex_offset + 0];  // pos.xyz, normal.x
-        const vec4 d1 = vertices.v[vertex_offset + 1];  // normal.yz, uv.xy
-        const vec4 d2 = vertices.v[vertex_offset + 2];  // tangent.xyzw
-        tri.vertices[i].pos = d0.xyz;
-        tri.vertices[i].normal = vec3(d0.w, d1.xy);
-        tri.vertices[i].uv = d1.zw;
-        tri.vertices[i].tangent = d2;
+        const uint index = geometry_node.index_size == 4 ? indices32.i[tri_index + i]
+                                                         : uint(indices.i[tri_index + i]);
+        tri.vertices[i] = UnpackVertex(geometry_node, index);
     }
     // Calculate values at barycentric coordinates
     vec3 barycentric_coords = vec3(1.0f - attribs.x - attribs.y, attribs.x, attribs.y);
@@ -8,6 +8,7 @@
 #include "camera.h"
 #include "common/command_buffer.h"
 #include "common/queue.h"
+#include "common/uploader.h"
 #include "control.h"
 #include "cubemap/cubemap.h"
 #include "device_resource/device.h"
@@ -16,13 +17,37 @@
 #include "gui.h"
 #include "imgui.h"
 #include "light.h"
+#include "model/geometry_pool.h"
 #include "model/gltf.h"
 #include "model/model.h"
+#include "model/vlx_scene.h"
 #include "uniform_buffer.h"
 #include "utils/io.h"
 #include "utils/path.h"
+#include "utils/thread_pool.h"
 
 namespace vlux {
+namespace {
+constexpr auto kUploaderStagingSize = VkDeviceSize{64} * 1024 * 1024;
+
+//! a glTF model with its primitives being decoded, or a memory-mapped baked model
+struct ParsedModel {
+    std::filesystem::path path;
+    std::shared_ptr<const tinygltf::Model> gltf;
+    std::vector<std::future<GltfPrimitive>> primitives;
+    std::shared_ptr<const VlxSceneFile> baked;
+};
+
+//! an object waiting for the geometry pool to be sized
+struct PendingObject {
+    //! material, and the geometry unless the object is baked
+    GltfObject object;
+    //! keeps the mapping, and so the geometry of `baked_primitive`, alive until it is staged
+    std::shared_ptr<const VlxSceneFile> baked;
+    const VlxScenePrimitive* baked_primitive = nullptr;
+};
+}  // namespace
+
 App::App(DeviceResource& device_resource, const std::string_view scene_name)
     : device_resource_(device_resource),
       transform_ubo_(device_resource_.GetDevice().GetVkDevice(),
@@ -33,21 +58,28 @@ App::App(DeviceResource& device_resource, const std::string_view scene_name)
                          device_resource_.GetVkPhysicalDevice()),
       light_ubo_(device_resource_.GetDevice().GetVkDevice(),
                  device_resource_.GetVkPhysicalDevice()),
+      light_buffer_(device_resource_.GetDevice().GetVkDevice(),
+                    device_resource_.GetVkPhysicalDevice()),
       config_(ReadJsonFile(GetCurrentDir() / "config.json")),
       scene_name_(scene_name) {
     const auto device = device_resource_.GetDevice().GetVkDevice();
     const auto physical_device = device_resource_.GetVkPhysicalDevice();
 
     // Resource Creation
-    command_pool_.emplace(device, physical_device, device_resource_.GetSurface().GetVkSurface());
-    command_buffer_.emplace(command_pool_->GetVkCommandPool(), device);
+    command_pool_.emplace(device, physical_device, device_resource_.GetVkSurface());
+    command_buffers_.reserve(kMaxFramesInFlight);
+    for (auto frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
+        command_buffers_.emplace_back(command_pool_->GetVkCommandPool(), device);
+    }
 
     // Create Scene
     CreateScene();
 
     // setup control
-    control_.emplace(device_resource_.GetGLFWwindow());
-    const auto [width, height] = device_resource.GetWindow().GetWindowSize();
+    if (!device_resource_.IsHeadless()) {
+        control_.emplace(device_resource_.GetGLFWwindow());
+    }
+    const auto [width, height] = device_resource.GetRenderSize();
     camera_.emplace(glm::vec3{80.0f, 20.0f, -12.0f}, glm::vec3{0.0f, 0.0f, 0.0f}, width, height);
 
     // setup obejets
@@ -55,7 +87,7 @@ App::App(DeviceResource& device_resource, const std::string_view scene_name)
         const auto pos = config_light.at("pos").get<std::array<float, 3>>();
         const auto range = config_light.at("range").get<float>();
         const auto color = config_light.at("color").get<std::array<float, 4>>();
-        lights_.emplace_back(LightParams{
+        AddLight(LightParams{
             .pos = glm::vec4(pos[0], pos[1], pos[2], 0.0f),
             .range = range,
             .color = glm::vec4(color[0], color[1], color[2], color[3]),
@@ -65,23 +97,18 @@ App::App(DeviceResource& device_resource, const std::string_view scene_name)
     // setup draw
     spdlog::debug("setup draw");
     draw_mode_ = config_.at("draw_mode").get<std::string>();
-    if (draw_mode_ == "rasterize") {
-        draw_ = std::make_unique<draw::rasterize::DrawRasterize>(
-            transform_ubo_, camera_ubo_, light_ubo_, scene_.value(), device_resource_);
-    } else if (draw_mode_ == "raytracing") {
-        const auto queue = device_resource_.GetGraphicsComputeQueue();
+    CreateDrawStrategy();
 
-        draw_ = std::make_unique<draw::raytracing::DrawRaytracing>(
-            transform_ubo_, camera_ubo_, camera_matrix_ubo_, light_ubo_, scene_.value(), queue,
-            command_pool_->GetVkCommandPool(), device_resource_);
-    } else {
-        throw std::runtime_error("invalid draw mode");
+    const auto queue_family = FindQueueFamilies(device_resource_.GetVkPhysicalDevice(),
+                                                device_resource_.GetVkSurface());
+    gpu_profiler_.emplace(device, physical_device, queue_family.graphics_compute_family.value());
+
+    if (device_resource_.IsHeadless()) {
+        return;
     }
 
     // Setup GUI
     spdlog::debug("setup gui");
-    const auto queue_family = FindQueueFamilies(device_resource_.GetVkPhysicalDevice(),
-                                                device_resource_.GetSurface().GetVkSurface());
     const auto gui_input = GuiInput{
         .instance = device_resource_.GetInstance().GetVkInstance(),
         .device = device,
@@ -98,64 +125,333 @@ App::App(DeviceResource& device_resource, const std::string_view scene_name)
 
 App::~App() {}
 
+void App::CreateDrawStrategy() {
+    if (draw_mode_ == "rasterize" || draw_mode_ == "mesh_shader" || draw_mode_ == "indirect") {
+        const auto geometry_path = [&]() {
+            if (draw_mode_ == "mesh_shader") {
+                return draw::rasterize::GeometryPath::kMeshShader;
+            }
+            if (draw_mode_ == "indirect") {
+                return draw::rasterize::GeometryPath::kIndirect;
+            }
+            return draw::rasterize::GeometryPath::kVertex;
+        }();
+        draw_ = std::make_unique<draw::rasterize::DrawRasterize>(
+            transform_ubo_, camera_ubo_, light_buffer_, camera_.value(), scene_.value(),
+            device_resource_, geometry_path);
+    } else if (draw_mode_ == "raytracing") {
+        const auto queue = device_resource_.GetGraphicsComputeQueue();
+
+        const auto options = draw::raytracing::ParseRaytracingOptions(
+            config_.value("raytracing", nlohmann::json::object()));
+        draw_ = std::make_unique<draw::raytracing::DrawRaytracing>(
+            transform_ubo_, camera_ubo_, camera_matrix_ubo_, light_ubo_, scene_.value(), queue,
+            command_pool_->GetVkCommandPool(), device_resource_, options);
+    } else {
+        throw std::runtime_error("invalid draw mode");
+    }
+
+    if (!device_resource_.IsHeadless()) {
+        return;
+    }
+    const auto device = device_resource_.GetDevice().GetVkDevice();
+
+    // the output render target stays in `VK_IMAGE_LAYOUT_GENERAL` between headless frames
+    [&]() {
+        const auto command_buffer =
+            BeginSingleTimeCommands(command_pool_->GetVkCommandPool(), device);
+        const auto barrier = VkImageMemoryBarrier2{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .srcStageMask = VK_PIPELINE_STAGE_2_NONE,
+            .srcAccessMask = VK_ACCESS_2_NONE,
+            .dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .dstAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_GENERAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = draw_->GetOutputRenderTarget().GetVkImage(),
+            .subresourceRange =
+                {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .baseMipLevel = 0,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+        };
+        const auto dependency_info = VkDependencyInfo{
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .imageMemoryBarrierCount = 1,
+            .pImageMemoryBarriers = &barrier,
+        };
+        vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+        EndSingleTimeCommands(command_buffer, device_resource_.GetGraphicsComputeQueue(),
+                              command_pool_->GetVkCommandPool(), device);
+    }();
+}
+
+void App::SetDrawMode(const std::string_view draw_mode) {
+    if (draw_mode == draw_mode_) {
+        return;
+    }
+    spdlog::debug("switch draw mode: {} -> {}", draw_mode_, draw_mode);
+    device_resource_.DeviceWaitIdle();
+    draw_.reset();
+    draw_mode_ = draw_mode;
+    CreateDrawStrategy();
+}
+
 void App::CreateScene() {
     spdlog::debug("create scene");
     const auto device = device_resource_.GetDevice().GetVkDevice();
     const auto physical_device = device_resource_.GetVkPhysicalDevice();
-    const auto command_pool = command_pool_->GetVkCommandPool();
-    const auto graphics_queue = device_resource_.GetGraphicsComputeQueue();
+    const auto queue_family_indices =
+        FindQueueFamilies(physical_device, device_resource_.GetVkSurface());
+    auto uploader = Uploader({
+        .device = device,
+        .physical_device = physical_device,
+        .graphics_queue = device_resource_.GetGraphicsComputeQueue(),
+        .graphics_family = queue_family_indices.graphics_compute_family.value(),
+        .transfer_queue = device_resource_.GetTransferQueue(),
+        .transfer_family = queue_family_indices.transfer_family.value_or(
+            queue_family_indices.graphics_compute_family.value()),
+        .staging_size = kUploaderStagingSize,
+    });
 
-    auto models = std::vector<Model>();
     const auto scene_config = config_.at("scenes").at(scene_name_);
     spdlog::debug("load scene: {}", scene_name_);
     timer_.Reset();
+
+    // parsing, image decoding and attribute decoding run on the workers; Vulkan objects are
+    // created on this thread only, so the uploads go through one queue in a fixed order
+    const auto num_load_threads = [&]() {
+        const auto num_threads = config_.value("load_threads", 0u);
+        return num_threads == 0 ? std::thread::hardware_concurrency() : num_threads;
+    }();
+    auto thread_pool = ThreadPool(num_load_threads);
+    spdlog::debug("load with {} threads", thread_pool.GetNumThreads());
+
+    const auto vertex_format =
+        ParseVertexFormat(scene_config.value("vertex_format", std::string("float")));
+    const auto mesh_optimization = ParseMeshOptimizationOptions(
+        config_.value("mesh_optimization", nlohmann::json::object()));
+    const auto lod = ParseLodOptions(config_.value("lod", nlohmann::json::object()));
+    const auto cubemap_path = scene_config.value("cubemap", std::filesystem::path{});
+    auto cubemap_future = thread_pool.Submit([cubemap_path]() -> std::optional<CubeMap> {
+        if (cubemap_path.empty()) {
+            return std::nullopt;
+        }
+        spdlog::debug("load cubemap: {}", cubemap_path.string());
+        return CubeMap(cubemap_path);
+    });
+
+    // (num models,) each resolves to the futures of its primitives once the file is parsed
+    auto model_futures = std::vector<std::future<ParsedModel>>();
+    // (num models,) degrees per frame of the entries with `spin`
+    auto spins = std::vector<std::optional<glm::vec3>>();
     for (const auto& model_config : scene_config.at("models")) {
         // unpack config
         const auto name = model_config.at("name").get<std::string>();
         const auto path = model_config.at("path").get<std::filesystem::path>();
         const auto scale = model_config.at("scale").get<float>();
-        const auto translation = model_config.at("translation").get<std::array<float, 3>>();
-        const auto rotation = model_config.at("rotation").get<std::array<float, 3>>();
-
-        spdlog::debug("load {}", name);
-        const auto gltf_model = LoadTinyGltfModel(path);
-        for (const auto& mesh : gltf_model.meshes) {
-            for (const auto& primitive : mesh.primitives) {
-                // gltf objects
-                auto gltf_objects = LoadGltfObjects(
-                    primitive, gltf_model, graphics_queue, command_pool, physical_device, device,
-                    scale, glm::vec3(translation[0], translation[1], translation[2]),
-                    glm::vec3(rotation[0], rotation[1], rotation[2]));
-                auto vertex_buffers = std::vector<VertexBuffer>();
-                vertex_buffers.emplace_back(device, physical_device, graphics_queue, command_pool,
-                                            std::move(gltf_objects.vertices));
-                // index
-                auto index_buffers = std::vector<IndexBuffer>();
-                index_buffers.emplace_back(device, physical_device, graphics_queue, command_pool,
-                                           std::move(gltf_objects.indices));
-
-                // create model
-                auto model = Model(
-                    device, physical_device, std::move(vertex_buffers), std::move(index_buffers),
-                    std::move(gltf_objects.base_color_factor), gltf_objects.metallic_factor,
-                    gltf_objects.roughness_factor, std::move(gltf_objects.base_color_texture),
-                    std::move(gltf_objects.normal_texture),
-                    std::move(gltf_objects.emissive_texture),
-                    std::move(gltf_objects.occlusion_roughness_metallic_texture));
-                models.emplace_back(std::move(model));
+        const auto translation_array = model_config.at("translation").get<std::array<float, 3>>();
+        const auto rotation_array = model_config.at("rotation").get<std::array<float, 3>>();
+        const auto translation =
+            glm::vec3(translation_array[0], translation_array[1], translation_array[2]);
+        const auto rotation = glm::vec3(rotation_array[0], rotation_array[1], rotation_array[2]);
+        // a runtime instance transform rather than a baked one, so it also applies to .vlxscene
+        spins.emplace_back([&]() -> std::optional<glm::vec3> {
+            if (!model_config.contains("spin")) {
+                return std::nullopt;
             }
+            const auto spin_array = model_config.at("spin").get<std::array<float, 3>>();
+            return glm::vec3(spin_array[0], spin_array[1], spin_array[2]);
+        }());
+
+        if (path.extension() == ".vlxscene") {
+            // vertices were transformed when baking
+            if (scale != 1.0f || translation != glm::vec3(0.0f) || rotation != glm::vec3(0.0f)) {
+                spdlog::warn("{}: the transform is baked into {}; ignored", name, path.string());
+            }
+            model_futures.emplace_back(thread_pool.Submit([=]() {
+                spdlog::debug("map {}", name);
+                return ParsedModel{
+                    .path = path,
+                    .baked = std::make_shared<const VlxSceneFile>(path),
+                };
+            }));
+            continue;
         }
+        model_futures.emplace_back(thread_pool.Submit([=, &thread_pool]() {
+            spdlog::debug("load {}", name);
+            // shared by the primitive tasks, which may outlive this one
+            auto parsed = ParsedModel{
+                .path = path,
+                .gltf = std::make_shared<const tinygltf::Model>(LoadTinyGltfModel(path)),
+            };
+            for (const auto& mesh : parsed.gltf->meshes) {
+                for (const auto& primitive : mesh.primitives) {
+                    parsed.primitives.emplace_back(
+                        thread_pool.Submit([gltf_model = parsed.gltf, &primitive, scale,
+                                            translation, rotation, mesh_optimization, lod]() {
+                            return DecodeGltfPrimitive(primitive, *gltf_model, scale,
+                                                       translation, rotation, mesh_optimization,
+                                                       lod);
+                        }));
+                }
+            }
+            return parsed;
+        }));
     }
-    const auto cubemap_path = scene_config.value("cubemap", std::filesystem::path{});
-    auto cubemap = [&]() -> std::optional<CubeMap> {
-        if (cubemap_path.empty()) {
-            return std::nullopt;
+
+    // the geometry pool is sized from every object, so the geometry is uploaded once all of it
+    // is decoded; textures are uploaded as the objects come in
+    auto texture_cache = TextureCache();
+    auto objects = std::vector<PendingObject>();
+    // (num models,) first object of each config entry, then the end of the last one
+    auto first_objects = std::vector<size_t>();
+    for (auto& model_future : model_futures) {
+        first_objects.emplace_back(objects.size());
+        auto parsed = model_future.get();
+        if (parsed.baked != nullptr) {
+            for (const auto& primitive : parsed.baked->GetPrimitives()) {
+                objects.emplace_back(PendingObject{
+                    .object = CreateVlxSceneObject(*parsed.baked, primitive, parsed.path,
+                                                   texture_cache, uploader, physical_device,
+                                                   device),
+                    .baked = parsed.baked,
+                    .baked_primitive = &primitive,
+                });
+            }
+            continue;
         }
-        spdlog::debug("load cubemap: {}", cubemap_path.string());
-        return CubeMap(cubemap_path);
+        for (auto& primitive_future : parsed.primitives) {
+            objects.emplace_back(PendingObject{
+                .object = CreateGltfObject(primitive_future.get(), *parsed.gltf, parsed.path,
+                                           texture_cache, uploader, physical_device, device),
+            });
+        }
+    }
+    first_objects.emplace_back(objects.size());
+
+    auto geometry_pool = [&]() {
+        auto capacity = GeometryPoolCapacity{};
+        auto max_vertex_count = size_t{0};
+        const auto add = [&](const size_t num_vertices, const size_t num_indices,
+                             const size_t num_lods) {
+            capacity.num_vertex_buffers++;
+            capacity.num_vertices += num_vertices;
+            capacity.num_index_buffers += 1 + num_lods;
+            capacity.num_indices += num_indices;
+            max_vertex_count = std::max(max_vertex_count, num_vertices);
+        };
+        for (const auto& [object, baked, primitive] : objects) {
+            if (baked != nullptr) {
+                auto num_indices = size_t{primitive->num_indices};
+                for (const auto& level : baked->GetLods(*primitive)) {
+                    num_indices += level.num_indices;
+                }
+                add(primitive->num_vertices, num_indices, primitive->num_lods);
+                continue;
+            }
+            auto num_indices = object.indices.size();
+            for (const auto& level : object.lods) {
+                num_indices += level.indices.size();
+            }
+            add(object.vertices.size(), num_indices, object.lods.size());
+        }
+        // one index type for the whole scene, so the indirect path binds the pool once; 16-bit
+        // as long as every model fits, since each draw adds its vertex offset
+        const auto index_type =
+            SelectIndexType(static_cast<Index>(std::max(max_vertex_count, size_t{1}) - 1));
+        return GeometryPool(device, physical_device, vertex_format, index_type, capacity);
     }();
+
+    auto models = std::vector<Model>();
+    models.reserve(objects.size());
+    for (auto& [gltf_objects, baked, primitive] : objects) {
+        auto vertex_buffers = std::vector<VertexBuffer>();
+        auto index_buffers = std::vector<IndexBuffer>();
+        auto meshlet_buffer = std::optional<MeshletBuffer>();
+        if (baked != nullptr) {
+            // staged straight from the mapping
+            const auto vertices = baked->GetVertices(*primitive);
+            const auto index_type = static_cast<VkIndexType>(primitive->index_type);
+            vertex_buffers.emplace_back(geometry_pool, uploader, vertices);
+            index_buffers.emplace_back(geometry_pool, uploader,
+                                       baked->GetPackedIndices(*primitive), index_type);
+            for (const auto& level : baked->GetLods(*primitive)) {
+                index_buffers.emplace_back(geometry_pool, uploader,
+                                           baked->GetPackedIndices(*primitive, level), index_type,
+                                           level.error);
+            }
+            if (device_resource_.GetDevice().IsMeshShaderEnabled()) {
+                const auto indices = UnpackIndices(baked->GetPackedIndices(*primitive), index_type);
+                meshlet_buffer.emplace(device, physical_device, uploader,
+                                       BuildMeshlets(vertices, indices));
+            }
+        } else {
+            vertex_buffers.emplace_back(geometry_pool, uploader, gltf_objects.vertices);
+            index_buffers.emplace_back(geometry_pool, uploader, gltf_objects.indices);
+            for (const auto& level : gltf_objects.lods) {
+                index_buffers.emplace_back(geometry_pool, uploader, level.indices, level.error);
+            }
+            if (device_resource_.GetDevice().IsMeshShaderEnabled()) {
+                meshlet_buffer.emplace(device, physical_device, uploader,
+                                       BuildMeshlets(gltf_objects.vertices, gltf_objects.indices));
+            }
+        }
+
+        // create model
+        auto model = Model(
+            std::move(vertex_buffers), std::move(index_buffers), std::move(meshlet_buffer),
+            std::move(gltf_objects.base_color_factor), gltf_objects.metallic_factor,
+            gltf_objects.roughness_factor, std::move(gltf_objects.base_color_texture),
+            std::move(gltf_objects.normal_texture), std::move(gltf_objects.emissive_texture),
+            std::move(gltf_objects.occlusion_roughness_metallic_texture));
+        models.emplace_back(std::move(model));
+        // the CPU copies are not needed once staged
+        gltf_objects = GltfObject{};
+    }
+    auto cubemap = cubemap_future.get();
+    // the copies overlap with decoding the remaining primitives; wait for the tail only
+    uploader.Wait();
     spdlog::debug("scene load time: {} ms", timer_.GetElapsedMilliseconds());
-    scene_.emplace(std::move(models), std::move(cubemap));
+    spdlog::debug("textures: {} unique, {} shared", texture_cache.GetNumTextures(),
+                  texture_cache.GetNumHits());
+    const auto heap_stats_list = GetMemoryAllocator(device, physical_device).GetHeapStats();
+    for (auto heap_i = 0; const auto& heap_stats : heap_stats_list) {
+        spdlog::debug("heap {}: {} / {} bytes used in {} blocks", heap_i, heap_stats.used,
+                      heap_stats.reserved, heap_stats.block_count);
+        heap_i++;
+    }
+    scene_.emplace(std::move(geometry_pool), std::move(models), std::move(cubemap));
+
+    // every object is one model, so the entries map to consecutive model ranges
+    for (size_t entry_i = 0; entry_i < spins.size(); entry_i++) {
+        const auto first_model = first_objects[entry_i];
+        const auto num_models = first_objects[entry_i + 1] - first_model;
+        if (!spins[entry_i].has_value() || num_models == 0) {
+            continue;
+        }
+        // center of the box around the bounding spheres of the entry
+        auto box_min = glm::vec3(std::numeric_limits<float>::max());
+        auto box_max = glm::vec3(std::numeric_limits<float>::lowest());
+        for (auto model_i = first_model; model_i < first_model + num_models; model_i++) {
+            const auto& model = scene_->GetModels()[model_i];
+            const auto& bounds = model.GetVertexBuffers()[0].GetBoundingSphere();
+            box_min = glm::min(box_min, bounds.center - bounds.radius);
+            box_max = glm::max(box_max, bounds.center + bounds.radius);
+        }
+        spinning_models_.emplace_back(SpinningModels{
+            .first_model = first_model,
+            .num_models = num_models,
+            .pivot = 0.5f * (box_min + box_max),
+            .degrees_per_frame = spins[entry_i].value(),
+        });
+    }
+    spdlog::debug("{} spinning model groups", spinning_models_.size());
 }
 
 void App::MainLoop() {
@@ -167,6 +463,56 @@ void App::MainLoop() {
     device_resource_.DeviceWaitIdle();
 }
 
+void App::UpdateUniformBuffers(const uint32_t frame_idx) {
+    [&]() {
+        const auto transform_params = camera_->CreateTransformParams();
+        transform_ubo_.UpdateUniformBuffer(transform_params, frame_idx);
+    }();
+    [&]() {
+        const auto camera_params = CameraParams{
+            .position = glm::vec4(camera_->GetPosition(), 1.0f),
+        };
+        camera_ubo_.UpdateUniformBuffer(camera_params, frame_idx);
+    }();
+    [&]() {
+        const auto camera_matrix_params = camera_->CreateCameraMatrixParams();
+        camera_matrix_ubo_.UpdateUniformBuffer(camera_matrix_params, frame_idx);
+    }();
+    [&]() {
+        light_buffer_.UpdateLightBuffer(lights_, frame_idx);
+        if (!lights_.empty()) {
+            light_ubo_.UpdateUniformBuffer(lights_.front(), frame_idx);
+        }
+    }();
+}
+
+void App::AnimateModels() {
+    if (spinning_models_.empty()) {
+        return;
+    }
+    animation_frame_++;
+    for (const auto& [first_model, num_models, pivot, degrees_per_frame] : spinning_models_) {
+        const auto angles =
+            glm::radians(degrees_per_frame * static_cast<float>(animation_frame_));
+        auto transform = glm::translate(glm::mat4(1.0f), pivot);
+        transform = glm::rotate(transform, angles.x, glm::vec3(1.0f, 0.0f, 0.0f));
+        transform = glm::rotate(transform, angles.y, glm::vec3(0.0f, 1.0f, 0.0f));
+        transform = glm::rotate(transform, angles.z, glm::vec3(0.0f, 0.0f, 1.0f));
+        transform = glm::translate(transform, -pivot);
+        for (auto model_i = first_model; model_i < first_model + num_models; model_i++) {
+            scene_->SetModelTransform(model_i, transform);
+        }
+    }
+}
+
+size_t App::AddLight(const LightParams& light) {
+    if (lights_.size() >= kMaxLights) {
+        throw std::runtime_error(fmt::format("failed to add light: at most {} lights", kMaxLights));
+    }
+    lights_.emplace_back(light);
+    return lights_.size() - 1;
+}
+
 void App::DrawFrame() {
     spdlog::debug("draw frame");
 
@@ -176,12 +522,19 @@ void App::DrawFrame() {
     const auto device = device_resource_.GetDevice().GetVkDevice();
     const auto& sync_object = device_resource_.GetSyncObject();
     const auto& swapchain = device_resource_.GetSwapchain();
-    const auto command_buffer = command_buffer_->GetVkCommandBuffer();
+    const auto frame_idx = frame_idx_;
+    const auto command_buffer = command_buffers_.at(frame_idx).GetVkCommandBuffer();
+
+    // wait until the GPU is done with the previous submission of this frame slot, so that its
+    // command buffer and per-frame UBOs can be reused while the other slot is still in flight
+    spdlog::debug("fence: wait");
+    sync_object.WaitForFence(frame_idx);
+    gpu_profiler_->Resolve(frame_idx);
 
     uint32_t image_idx;
     {
         auto result = vkAcquireNextImageKHR(device, swapchain.GetVkSwapchain(), UINT64_MAX,
-                                            sync_object.GetVkImageAvailableSemaphore(),
+                                            sync_object.GetVkImageAvailableSemaphore(frame_idx),
                                             VK_NULL_HANDLE, &image_idx);
         if (result == VK_ERROR_OUT_OF_DATE_KHR) {
             device_resource_.RecreateSwapChain();
@@ -191,6 +544,8 @@ void App::DrawFrame() {
             throw std::runtime_error("failed to acquire swap chain image!");
         }
     }
+    // reset only once work is guaranteed to be submitted with this fence
+    sync_object.ResetFence(frame_idx);
 
     spdlog::debug("input");
     [&]() {
@@ -232,21 +587,8 @@ void App::DrawFrame() {
     }();
 
     spdlog::debug("update ubo");
-    [&]() {
-        const auto transform_params = camera_->CreateTransformParams();
-        transform_ubo_.UpdateUniformBuffer(transform_params, image_idx);
-    }();
-    [&]() {
-        const auto camera_params = CameraParams{
-            .position = glm::vec4(camera_->GetPosition(), 1.0f),
-        };
-        camera_ubo_.UpdateUniformBuffer(camera_params, image_idx);
-    }();
-    [&]() {
-        const auto camera_matrix_params = camera_->CreateCameraMatrixParams();
-        camera_matrix_ubo_.UpdateUniformBuffer(camera_matrix_params, image_idx);
-    }();
-    [&]() { light_ubo_.UpdateUniformBuffer(lights_.at(0), image_idx); }();
+    UpdateUniformBuffers(frame_idx);
+    AnimateModels();
 
     spdlog::debug("reset and begin command buffer");
     [&]() {
@@ -261,13 +603,18 @@ void App::DrawFrame() {
         }
     }();
 
+    gpu_profiler_->BeginFrame(frame_idx, command_buffer);
+    gpu_profiler_->BeginScope(frame_idx, command_buffer, "frame");
+
     spdlog::debug("record command buffer");
-    draw_->RecordCommandBuffer(image_idx, swapchain.GetVkExtent(), command_buffer);
+    draw_->RecordCommandBuffer(frame_idx, swapchain.GetVkExtent(), command_buffer,
+                               gpu_profiler_.value());
 
     const auto& output_render_target = draw_->GetOutputRenderTarget();
 
     // Write Swapchain
     spdlog::debug("write swapchain");
+    gpu_profiler_->BeginScope(frame_idx, command_buffer, "swapchain_copy");
     [&]() {
         [&]() {
             const auto barrier = std::to_array({
@@ -355,7 +702,9 @@ void App::DrawFrame() {
                     .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
                     .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
                     .srcAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT,
-                    .dstStageMask = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT_KHR,
+                    // the next frame may already be queued behind this one and writes the same
+                    // render target from compute or ray tracing stages
+                    .dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
                     .dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT,
                     .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
                     .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
@@ -405,6 +754,7 @@ void App::DrawFrame() {
             vkCmdPipelineBarrier2(command_buffer, &dependency_info);
         }();
     }();
+    gpu_profiler_->EndScope(frame_idx, command_buffer);
 
     // ImGui
     spdlog::debug("imgui pass");
@@ -418,6 +768,38 @@ void App::DrawFrame() {
         ImGui::Text("Mouse cursor: %s",
                     mouse_right_button_state_ == MouseRightButtonState::kTriggered ? "enabled"
                                                                                    : "disabled");
+        if (gpu_profiler_->IsSupported()) {
+            ImGui::Separator();
+            ImGui::Text("GPU (ms, average of 64 frames)");
+            for (const auto& average : gpu_profiler_->GetAverages()) {
+                ImGui::Text("%*s%s: %.3f", static_cast<int>(average.depth * 2), "",
+                            average.name.c_str(), average.elapsed_ms.Get());
+            }
+            if (ImGui::Button("Export GPU trace")) {
+                WriteGpuTrace(config_.at("gpu_trace_path").get<std::filesystem::path>());
+            }
+        }
+        if (const auto culling_stats = draw_->GetCullingStats()) {
+            ImGui::Separator();
+            ImGui::Text("Culling (draws)");
+            ImGui::Text("visible: %u / %u (early %u, late %u)",
+                        culling_stats->early_drawn + culling_stats->late_drawn,
+                        culling_stats->draw_count, culling_stats->early_drawn,
+                        culling_stats->late_drawn);
+            ImGui::Text("culled: frustum %u, occlusion %u", culling_stats->frustum_culled,
+                        culling_stats->occluded);
+        }
+        ImGui::Separator();
+        ImGui::Text("Memory (MiB, used / reserved)");
+        const auto& allocator = GetMemoryAllocator(device, device_resource_.GetVkPhysicalDevice());
+        for (auto heap_i = 0u; const auto& heap_stats : allocator.GetHeapStats()) {
+            constexpr auto kMiB = 1024.0f * 1024.0f;
+            ImGui::Text("heap %u: %.1f / %.1f (%u blocks, %u allocations)", heap_i,
+                        static_cast<float>(heap_stats.used) / kMiB,
+                        static_cast<float>(heap_stats.reserved) / kMiB, heap_stats.block_count,
+                        heap_stats.allocation_count);
+            heap_i++;
+        }
         ImGui::End();
 
         ImGui::Begin("Control");
@@ -434,12 +816,20 @@ void App::DrawFrame() {
         ImGui::End();
 
         ImGui::Begin("Light");
-        ImGui::SliderFloat3("pos", glm::value_ptr(lights_.at(0).pos), -100.0f, 100.0f);
-        ImGui::SliderFloat("range", &lights_.at(0).range, 0.0f, 1000.0f);
-        ImGui::ColorPicker4("color", glm::value_ptr(lights_.at(0).color));
+        ImGui::Text("lights: %zu", lights_.size());
+        if (!lights_.empty()) {
+            ImGui::InputInt("index", &gui_light_idx_);
+            gui_light_idx_ = std::clamp(gui_light_idx_, 0, static_cast<int>(lights_.size()) - 1);
+            auto& light = lights_.at(gui_light_idx_);
+            ImGui::SliderFloat3("pos", glm::value_ptr(light.pos), -100.0f, 100.0f);
+            ImGui::SliderFloat("range", &light.range, 0.0f, 1000.0f);
+            ImGui::ColorPicker4("color", glm::value_ptr(light.color));
+        }
         ImGui::End();
 
+        gpu_profiler_->BeginScope(frame_idx, command_buffer, "imgui");
         gui_->Render(command_buffer, swapchain.GetWidth(), swapchain.GetHeight(), image_idx);
+        gpu_profiler_->EndScope(frame_idx, command_buffer);
     }();
 
     // Transition Swapchain Layout
@@ -477,6 +867,7 @@ void App::DrawFrame() {
         };
         vkCmdPipelineBarrier2(command_buffer, &dependency_info);
     }();
+    gpu_profiler_->EndScope(frame_idx, command_buffer);
 
     spdlog::debug("end command buffer");
     if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
@@ -486,12 +877,12 @@ void App::DrawFrame() {
     spdlog::debug("submit command buffer");
     const auto wait_semaphore_submit_infos = std::vector<VkSemaphoreSubmitInfo>({{
         .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-        .semaphore = sync_object.GetVkImageAvailableSemaphore(),
+        .semaphore = sync_object.GetVkImageAvailableSemaphore(frame_idx),
         .stageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
     }});
     const auto signal_semaphore_submit_infos = std::vector<VkSemaphoreSubmitInfo>({{
         .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-        .semaphore = sync_object.GetVkRenderFinishedSemaphore(),
+        .semaphore = sync_object.GetVkRenderFinishedSemaphore(frame_idx),
     }});
     const auto command_buffers = std::to_array({
         VkCommandBufferSubmitInfo{
@@ -509,14 +900,14 @@ void App::DrawFrame() {
         .pSignalSemaphoreInfos = signal_semaphore_submit_infos.data(),
     };
     if (vkQueueSubmit2(device_resource_.GetGraphicsComputeQueue(), 1, &submit_info,
-                       sync_object.GetVkInFlightFence()) != VK_SUCCESS) {
+                       sync_object.GetVkInFlightFence(frame_idx)) != VK_SUCCESS) {
         throw std::runtime_error("failed to submit draw command buffer!");
     }
 
     spdlog::debug("present");
     const auto swapchains = std::vector<VkSwapchainKHR>{swapchain.GetVkSwapchain()};
     const auto wait_semaphores = std::vector<VkSemaphore>({
-        sync_object.GetVkRenderFinishedSemaphore(),
+        sync_object.GetVkRenderFinishedSemaphore(frame_idx),
     });
     auto results = std::vector<VkResult>(swapchains.size());
     const auto present_info = VkPresentInfoKHR{
@@ -532,8 +923,288 @@ void App::DrawFrame() {
         throw std::runtime_error("failed to present swap chain image!");
     }
 
+    frame_idx_ = (frame_idx_ + 1) % kMaxFramesInFlight;
+}
+
+void App::RunHeadless(const uint32_t num_frames,
+                      const std::optional<std::filesystem::path>& readback_dir) {
+    spdlog::debug("headless loop");
+    if (!device_resource_.IsHeadless()) {
+        throw std::runtime_error("`App::RunHeadless` requires a headless `DeviceResource`!");
+    }
+    const auto device = device_resource_.GetDevice().GetVkDevice();
+    const auto physical_device = device_resource_.GetVkPhysicalDevice();
+    const auto [width, height] = device_resource_.GetRenderSize();
+
+    if (readback_dir.has_value() && readback_buffers_.empty()) {
+        std::filesystem::create_directories(readback_dir.value());
+        // output render targets are 4 bytes per pixel
+        const auto size = static_cast<VkDeviceSize>(width) * height * 4;
+        readback_buffers_.reserve(kMaxFramesInFlight);
+        for (auto frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
+            readback_buffers_.emplace_back(
+                device, physical_device, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, size,
+                nullptr);
+        }
+    }
+
+    timer_.Reset();
+    for (auto frame_i = 0u; frame_i < num_frames; frame_i++) {
+        DrawFrameHeadless(readback_dir);
+    }
+    // waits for the device
+    FlushFrameTimes();
+    spdlog::info("rendered {} frames in {} ms", num_frames, timer_.GetElapsedMilliseconds());
+
+    // write out the frames still waiting in the readback buffers
+    if (readback_dir.has_value()) {
+        for (auto frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
+            auto& pending_readback = pending_readbacks_.at(frame_i);
+            if (pending_readback.has_value()) {
+                const auto filename = fmt::format("frame_{:04}.exr", pending_readback.value());
+                WriteReadbackImage(frame_i, readback_dir.value() / filename);
+                pending_readback.reset();
+            }
+        }
+    }
+}
+
+void App::DrawFrameHeadless(const std::optional<std::filesystem::path>& readback_dir) {
+    spdlog::debug("draw frame (headless)");
+    frame_timer_.Update();
+    const auto& sync_object = device_resource_.GetSyncObject();
+    const auto frame_idx = frame_idx_;
+    const auto command_buffer = command_buffers_.at(frame_idx).GetVkCommandBuffer();
+    const auto [width, height] = device_resource_.GetRenderSize();
+    const auto extent = VkExtent2D{.width = width, .height = height};
+    const auto& output_render_target = draw_->GetOutputRenderTarget();
+
     spdlog::debug("fence: wait and reset");
-    sync_object.WaitAndResetFences();
+    sync_object.WaitForFence(frame_idx);
+    sync_object.ResetFence(frame_idx);
+    ResolveFrameTime(frame_idx);
+    // started after the fence wait, so the CPU time excludes the time blocked on the GPU
+    const auto cpu_timer = Timer();
+
+    // the previous submission of this slot is done, so its readback buffer can be consumed
+    auto& pending_readback = pending_readbacks_.at(frame_idx);
+    if (readback_dir.has_value() && pending_readback.has_value()) {
+        const auto filename = fmt::format("frame_{:04}.exr", pending_readback.value());
+        WriteReadbackImage(frame_idx, readback_dir.value() / filename);
+        pending_readback.reset();
+    }
+
+    spdlog::debug("update ubo");
+    UpdateUniformBuffers(frame_idx);
+    AnimateModels();
+
+    spdlog::debug("reset and begin command buffer");
+    [&]() {
+        if (vkResetCommandBuffer(command_buffer, 0) != VK_SUCCESS) {
+            throw std::runtime_error("failed to reset command buffer!");
+        }
+        const auto begin_info = VkCommandBufferBeginInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        };
+        if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS) {
+            throw std::runtime_error("failed to begin recording command buffer!");
+        }
+    }();
+
+    gpu_profiler_->BeginFrame(frame_idx, command_buffer);
+    gpu_profiler_->BeginScope(frame_idx, command_buffer, "frame");
+
+    spdlog::debug("record command buffer");
+    draw_->RecordCommandBuffer(frame_idx, extent, command_buffer, gpu_profiler_.value());
+
+    // the output is written by a compute/ray tracing shader or as a color attachment
+    constexpr VkAccessFlags2 kOutputWriteAccess =
+        VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+    const auto transition_output = [&](const VkImageLayout old_layout,
+                                       const VkImageLayout new_layout,
+                                       const VkPipelineStageFlags2 src_stage,
+                                       const VkAccessFlags2 src_access,
+                                       const VkPipelineStageFlags2 dst_stage,
+                                       const VkAccessFlags2 dst_access) {
+        const auto barrier = VkImageMemoryBarrier2{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .srcStageMask = src_stage,
+            .srcAccessMask = src_access,
+            .dstStageMask = dst_stage,
+            .dstAccessMask = dst_access,
+            .oldLayout = old_layout,
+            .newLayout = new_layout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = output_render_target.GetVkImage(),
+            .subresourceRange =
+                {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .baseMipLevel = 0,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+        };
+        const auto dependency_info = VkDependencyInfo{
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .imageMemoryBarrierCount = 1,
+            .pImageMemoryBarriers = &barrier,
+        };
+        vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+    };
+
+    if (readback_dir.has_value()) {
+        spdlog::debug("copy output render target to readback buffer");
+        gpu_profiler_->BeginScope(frame_idx, command_buffer, "readback");
+        transition_output(VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, kOutputWriteAccess,
+                          VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT);
+        const auto region = VkBufferImageCopy{
+            .bufferOffset = 0,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource =
+                {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel = 0,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+            .imageOffset = {0, 0, 0},
+            .imageExtent = {width, height, 1},
+        };
+        vkCmdCopyImageToBuffer(command_buffer, output_render_target.GetVkImage(),
+                               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               readback_buffers_.at(frame_idx).GetVkBuffer(), 1, &region);
+        transition_output(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL,
+                          VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_NONE,
+                          VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_SHADER_WRITE_BIT);
+
+        // make the copy visible to the host
+        const auto host_barrier = VkMemoryBarrier2{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+            .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT,
+            .dstAccessMask = VK_ACCESS_2_HOST_READ_BIT,
+        };
+        const auto dependency_info = VkDependencyInfo{
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .memoryBarrierCount = 1,
+            .pMemoryBarriers = &host_barrier,
+        };
+        vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+        gpu_profiler_->EndScope(frame_idx, command_buffer);
+    } else {
+        // the next frame writes the same render target
+        transition_output(VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                          VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, kOutputWriteAccess,
+                          VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_SHADER_WRITE_BIT);
+    }
+
+    gpu_profiler_->EndScope(frame_idx, command_buffer);
+
+    spdlog::debug("end command buffer");
+    if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+
+    spdlog::debug("submit command buffer");
+    const auto command_buffers = std::to_array({
+        VkCommandBufferSubmitInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+            .commandBuffer = command_buffer,
+        },
+    });
+    const auto submit_info = VkSubmitInfo2{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .commandBufferInfoCount = static_cast<uint32_t>(command_buffers.size()),
+        .pCommandBufferInfos = command_buffers.data(),
+    };
+    if (vkQueueSubmit2(device_resource_.GetGraphicsComputeQueue(), 1, &submit_info,
+                       sync_object.GetVkInFlightFence(frame_idx)) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit draw command buffer!");
+    }
+
+    if (readback_dir.has_value()) {
+        pending_readback = frame_count_;
+    }
+    pending_frame_times_.at(frame_idx) = FrameTime{
+        .frame = frame_count_,
+        .cpu_ms = cpu_timer.GetElapsedMilliseconds(),
+        .gpu_ms = std::nullopt,
+    };
+    frame_count_++;
+    frame_idx_ = (frame_idx_ + 1) % kMaxFramesInFlight;
+}
+
+void App::ResolveFrameTime(const uint32_t frame_idx) {
+    const auto profile = gpu_profiler_->Resolve(frame_idx);
+    auto& pending_frame_time = pending_frame_times_.at(frame_idx);
+    if (!pending_frame_time.has_value()) {
+        return;
+    }
+    pending_frame_time->gpu_ms = [&]() -> std::optional<float> {
+        if (!profile.has_value()) {
+            return std::nullopt;
+        }
+        // the outermost scope spans the whole command buffer
+        const auto frame_scope = std::ranges::find_if(
+            profile->scopes, [](const GpuScopeTime& scope) { return scope.name == "frame"; });
+        if (frame_scope == profile->scopes.end()) {
+            return std::nullopt;
+        }
+        return frame_scope->elapsed_ms;
+    }();
+    frame_times_.emplace_back(pending_frame_time.value());
+    pending_frame_time.reset();
+}
+
+std::vector<FrameTime> App::FlushFrameTimes() {
+    device_resource_.DeviceWaitIdle();
+    for (auto frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
+        ResolveFrameTime(frame_i);
+    }
+    std::ranges::sort(frame_times_, {}, &FrameTime::frame);
+    return std::exchange(frame_times_, {});
+}
+
+void App::WriteGpuTrace(const std::filesystem::path& path) const {
+    WriteChromeTrace(path, gpu_profiler_->GetHistory());
+}
+
+void App::WriteReadbackImage(const uint32_t frame_idx, const std::filesystem::path& path) const {
+    const auto [width, height] = device_resource_.GetRenderSize();
+    const auto& readback_buffer = readback_buffers_.at(frame_idx);
+
+    auto raw = std::vector<uint8_t>(readback_buffer.GetSize());
+    readback_buffer.ReadBuffer(raw.data(), raw.size());
+
+    const auto swap_red_blue = [&]() {
+        switch (draw_->GetOutputRenderTarget().GetVkFormat()) {
+            case VK_FORMAT_B8G8R8A8_UNORM:
+                return true;
+            case VK_FORMAT_R8G8B8A8_UNORM:
+                return false;
+            default:
+                throw std::runtime_error("unsupported output render target format for readback!");
+        }
+    }();
+
+    auto pixels = std::vector<float>(raw.size());
+    for (auto pixel_i = 0uz; pixel_i < raw.size(); pixel_i += 4) {
+        const auto red_i = swap_red_blue ? pixel_i + 2 : pixel_i;
+        const auto blue_i = swap_red_blue ? pixel_i : pixel_i + 2;
+        pixels.at(pixel_i + 0) = static_cast<float>(raw.at(red_i)) / 255.0f;
+        pixels.at(pixel_i + 1) = static_cast<float>(raw.at(pixel_i + 1)) / 255.0f;
+        pixels.at(pixel_i + 2) = static_cast<float>(raw.at(blue_i)) / 255.0f;
+        pixels.at(pixel_i + 3) = static_cast<float>(raw.at(pixel_i + 3)) / 255.0f;
+    }
+    spdlog::debug("write {}", path.string());
+    WriteEXR(path, pixels, static_cast<int>(width), static_cast<int>(height), 4);
 }
 
 }  // namespace vlux
\ No newline at end of file
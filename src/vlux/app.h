@@ -2,6 +2,7 @@
 #define APP_H
 
 #include "camera.h"
+#include "common/buffer.h"
 #include "common/command_buffer.h"
 #include "common/command_pool.h"
 #include "control.h"
@@ -10,6 +11,7 @@
 #include "frame_timer.h"
 #include "gui.h"
 #include "light.h"
+#include "profiler/gpu_profiler.h"
 #include "scene/scene.h"
 #include "transform.h"
 #include "uniform_buffer.h"
@@ -23,11 +25,54 @@ class App {
     App(DeviceResource& device_resource, const std::string_view scene_name);
     ~App();
     void Run() { MainLoop(); }
+    /**
+     * @brief Render frames into the output render target without window and swapchain
+     *
+     * @param num_frames number of frames to render
+     * @param readback_dir if set, every frame is read back and written to this directory as EXR
+     */
+    void RunHeadless(const uint32_t num_frames,
+                     const std::optional<std::filesystem::path>& readback_dir);
+
+    // frame-by-frame control of headless rendering (used by vlux-bench)
+    void SetDrawMode(const std::string_view draw_mode);
+    void SetCameraPose(const glm::vec3& pos, const glm::vec2& rot) { camera_->SetPose(pos, rot); }
+    void RenderHeadlessFrame() { DrawFrameHeadless(std::nullopt); }
+    /**
+     * @brief Wait for all submitted frames and take the timings collected since the last call
+     *
+     * @return timings sorted by frame number
+     */
+    std::vector<FrameTime> FlushFrameTimes();
+    /**
+     * @brief Write the recently resolved GPU scopes as a Chrome trace (chrome://tracing, Perfetto)
+     */
+    void WriteGpuTrace(const std::filesystem::path& path) const;
+
+    // point lights; all of them are uploaded every frame, up to kMaxLights
+    /**
+     * @brief Add a point light
+     *
+     * @param light
+     * @return index of the light for `UpdateLight`
+     */
+    size_t AddLight(const LightParams& light);
+    void UpdateLight(const size_t light_idx, const LightParams& light) {
+        lights_.at(light_idx) = light;
+    }
+    const std::vector<LightParams>& GetLights() const { return lights_; }
 
    private:
     void MainLoop();
     void CreateScene();
+    void CreateDrawStrategy();
+    void UpdateUniformBuffers(const uint32_t frame_idx);
     void DrawFrame();
+    void DrawFrameHeadless(const std::optional<std::filesystem::path>& readback_dir);
+    void WriteReadbackImage(const uint32_t frame_idx, const std::filesystem::path& path) const;
+    void ResolveFrameTime(const uint32_t frame_idx);
+    //! advance the instance transforms of `spinning_models_` by one frame
+    void AnimateModels();
 
     DeviceResource& device_resource_;
     std::optional<Gui> gui_ = std::nullopt;
@@ -47,10 +92,26 @@ class App {
     UniformBuffer<TransformParams> transform_ubo_;
     UniformBuffer<CameraParams> camera_ubo_;
     UniformBuffer<CameraMatrixParams> camera_matrix_ubo_;
+    //! the first light, for the raytracer
     UniformBuffer<LightParams> light_ubo_;
+    LightBuffer light_buffer_;
 
     // objects
+    //! models of a config entry with `spin`, rotated every frame about their common center
+    struct SpinningModels {
+        //! range of `Scene::GetModels`
+        size_t first_model;
+        size_t num_models;
+        glm::vec3 pivot;
+        //! degrees per frame about x, y, z
+        glm::vec3 degrees_per_frame;
+    };
+    std::vector<SpinningModels> spinning_models_;
+    //! frames animated so far; frame-based, so headless runs are reproducible
+    uint32_t animation_frame_ = 0;
     std::vector<LightParams> lights_;
+    //! light edited in the GUI
+    int gui_light_idx_ = 0;
 
     // Draw
     std::string draw_mode_;
@@ -58,7 +119,24 @@ class App {
 
     // Resource
     std::optional<CommandPool> command_pool_ = std::nullopt;
-    std::optional<CommandBuffer> command_buffer_ = std::nullopt;
+    //! (kMaxFramesInFlight,)
+    std::vector<CommandBuffer> command_buffers_;
+
+    // frame slot in [0, kMaxFramesInFlight), independent of the swapchain image index
+    uint32_t frame_idx_ = 0;
+
+    // headless
+    //! (kMaxFramesInFlight,)
+    std::vector<Buffer> readback_buffers_;
+    //! (kMaxFramesInFlight,) frame number whose image is waiting in the readback buffer
+    std::array<std::optional<uint32_t>, kMaxFramesInFlight> pending_readbacks_;
+    uint32_t frame_count_ = 0;
+    //! (kMaxFramesInFlight,) timing of the frame submitted last from each slot
+    std::array<std::optional<FrameTime>, kMaxFramesInFlight> pending_frame_times_;
+    std::vector<FrameTime> frame_times_;
+
+    // profiler
+    std::optional<GpuProfiler> gpu_profiler_ = std::nullopt;
 
     // frame timer
     FrameTimer frame_timer_;
@@ -0,0 +1,98 @@
+#include "bench_stats.h"
+
+namespace vlux::bench {
+namespace {
+nlohmann::json SummaryToJson(const Summary& summary) {
+    return {
+        {"mean", summary.mean}, {"min", summary.min}, {"max", summary.max},
+        {"p50", summary.p50},   {"p95", summary.p95}, {"p99", summary.p99},
+    };
+}
+}  // namespace
+
+float Percentile(std::vector<float> values, const float percentile) {
+    if (values.empty()) {
+        throw std::runtime_error("percentile of an empty sample!");
+    }
+    std::ranges::sort(values);
+    const auto rank =
+        std::clamp(percentile, 0.0f, 100.0f) / 100.0f * static_cast<float>(values.size() - 1);
+    const auto lower = static_cast<size_t>(rank);
+    const auto upper = std::min(lower + 1, values.size() - 1);
+    const auto t = rank - static_cast<float>(lower);
+    return values.at(lower) + (values.at(upper) - values.at(lower)) * t;
+}
+
+Summary Summarize(const std::vector<float>& values) {
+    if (values.empty()) {
+        throw std::runtime_error("summary of an empty sample!");
+    }
+    auto sum = 0.0;
+    for (const auto value : values) {
+        sum += value;
+    }
+    const auto [min, max] = std::ranges::minmax(values);
+    return Summary{
+        .mean = static_cast<float>(sum / static_cast<double>(values.size())),
+        .min = min,
+        .max = max,
+        .p50 = Percentile(values, 50.0f),
+        .p95 = Percentile(values, 95.0f),
+        .p99 = Percentile(values, 99.0f),
+    };
+}
+
+nlohmann::json ToJson(const BenchRun& run) {
+    auto cpu_ms = std::vector<float>();
+    auto gpu_ms = std::vector<float>();
+    auto frames = nlohmann::json::array();
+    for (const auto& frame : run.frames) {
+        cpu_ms.emplace_back(frame.cpu_ms);
+        if (frame.gpu_ms.has_value()) {
+            gpu_ms.emplace_back(frame.gpu_ms.value());
+        }
+        frames.push_back({
+            {"frame", frame.frame},
+            {"cpu_ms", frame.cpu_ms},
+            {"gpu_ms", frame.gpu_ms.has_value() ? nlohmann::json(frame.gpu_ms.value()) : nullptr},
+        });
+    }
+
+    return {
+        {"meta",
+         {
+             {"scene", run.scene},
+             {"draw_mode", run.draw_mode},
+             {"device", run.device_name},
+             {"width", run.width},
+             {"height", run.height},
+             {"warmup_frames", run.warmup_frames},
+             {"measured_frames", run.frames.size()},
+         }},
+        {"cpu_ms", cpu_ms.empty() ? nlohmann::json(nullptr) : SummaryToJson(Summarize(cpu_ms))},
+        {"gpu_ms", gpu_ms.empty() ? nlohmann::json(nullptr) : SummaryToJson(Summarize(gpu_ms))},
+        {"frames", frames},
+    };
+}
+
+void WriteBenchJson(const std::filesystem::path& path, const BenchRun& run) {
+    auto file = std::ofstream(path);
+    if (!file.is_open()) {
+        throw std::runtime_error(fmt::format("failed to open file: {}", path.string()));
+    }
+    file << ToJson(run).dump(4) << std::endl;
+}
+
+void WriteBenchCsv(const std::filesystem::path& path, const BenchRun& run) {
+    auto file = std::ofstream(path);
+    if (!file.is_open()) {
+        throw std::runtime_error(fmt::format("failed to open file: {}", path.string()));
+    }
+    file << "frame,cpu_ms,gpu_ms\n";
+    for (const auto& frame : run.frames) {
+        file << fmt::format("{},{:.4f},{}\n", frame.frame, frame.cpu_ms,
+                            frame.gpu_ms.has_value() ? fmt::format("{:.4f}", *frame.gpu_ms) : "");
+    }
+}
+
+}  // namespace vlux::bench
@@ -0,0 +1,50 @@
+#ifndef BENCH_BENCH_STATS_H
+#define BENCH_BENCH_STATS_H
+#include "pch.h"
+//
+#include "frame_timer.h"
+
+namespace vlux::bench {
+
+struct Summary {
+    float mean;
+    float min;
+    float max;
+    float p50;
+    float p95;
+    float p99;
+};
+
+struct BenchRun {
+    std::string scene;
+    std::string draw_mode;
+    std::string device_name;
+    uint32_t width;
+    uint32_t height;
+    uint32_t warmup_frames;
+    std::vector<FrameTime> frames;
+};
+
+/**
+ * @brief Percentile with linear interpolation between closest ranks
+ *
+ * @param values samples, need not be sorted
+ * @param percentile in [0, 100]
+ */
+float Percentile(std::vector<float> values, const float percentile);
+
+Summary Summarize(const std::vector<float>& values);
+
+/**
+ * @brief Serialize a run as `{"meta": ..., "cpu_ms": summary, "gpu_ms": summary, "frames": [...]}`
+ */
+nlohmann::json ToJson(const BenchRun& run);
+
+void WriteBenchJson(const std::filesystem::path& path, const BenchRun& run);
+
+//! one row per frame: `frame,cpu_ms,gpu_ms`
+void WriteBenchCsv(const std::filesystem::path& path, const BenchRun& run);
+
+}  // namespace vlux::bench
+
+#endif
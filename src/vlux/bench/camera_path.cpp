@@ -0,0 +1,54 @@
+#include "camera_path.h"
+
+namespace vlux::bench {
+CameraPath::CameraPath(std::vector<CameraKeyframe>&& keyframes) : keyframes_(std::move(keyframes)) {
+    if (keyframes_.empty()) {
+        throw std::runtime_error("camera path needs at least one keyframe!");
+    }
+    for (auto key_i = 1uz; key_i < keyframes_.size(); key_i++) {
+        if (keyframes_.at(key_i).time <= keyframes_.at(key_i - 1).time) {
+            throw std::runtime_error("camera path keyframes must have increasing time!");
+        }
+    }
+}
+
+CameraKeyframe CameraPath::Sample(const float time) const {
+    const auto duration = GetDuration();
+    if (keyframes_.size() == 1 || duration <= 0.0f) {
+        return keyframes_.front();
+    }
+
+    // wrap into [front.time, back.time]
+    const auto local_time = keyframes_.front().time + std::fmod(std::max(time, 0.0f), duration);
+
+    // first keyframe whose time is greater than local_time
+    const auto next = std::ranges::upper_bound(keyframes_, local_time, {}, &CameraKeyframe::time);
+    if (next == keyframes_.end()) {
+        return keyframes_.back();
+    }
+    const auto& k1 = *next;
+    const auto& k0 = *std::prev(next);
+    const auto t = (local_time - k0.time) / (k1.time - k0.time);
+    return CameraKeyframe{
+        .time = local_time,
+        .pos = glm::mix(k0.pos, k1.pos, t),
+        .rot = glm::mix(k0.rot, k1.rot, t),
+    };
+}
+
+CameraPath LoadCameraPath(const nlohmann::json& camera_path_config) {
+    auto keyframes = std::vector<CameraKeyframe>();
+    keyframes.reserve(camera_path_config.size());
+    for (const auto& keyframe_config : camera_path_config) {
+        const auto pos = keyframe_config.at("pos").get<std::array<float, 3>>();
+        const auto rot = keyframe_config.at("rot").get<std::array<float, 2>>();
+        keyframes.emplace_back(CameraKeyframe{
+            .time = keyframe_config.at("time").get<float>(),
+            .pos = glm::vec3(pos[0], pos[1], pos[2]),
+            .rot = glm::vec2(rot[0], rot[1]),
+        });
+    }
+    return CameraPath(std::move(keyframes));
+}
+
+}  // namespace vlux::bench
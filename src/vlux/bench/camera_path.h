@@ -0,0 +1,47 @@
+#ifndef BENCH_CAMERA_PATH_H
+#define BENCH_CAMERA_PATH_H
+#include "pch.h"
+
+namespace vlux::bench {
+
+struct CameraKeyframe {
+    float time;     // seconds
+    glm::vec3 pos;  // world position
+    glm::vec2 rot;  // (yaw, pitch) in radians, same convention as `Camera::GetRotation`
+};
+
+/**
+ * @brief Deterministic camera path that linearly interpolates between keyframes
+ */
+class CameraPath {
+   public:
+    CameraPath() = delete;
+    /**
+     * @brief Construct a new CameraPath object
+     *
+     * @param keyframes at least one keyframe, sorted by strictly increasing time
+     */
+    explicit CameraPath(std::vector<CameraKeyframe>&& keyframes);
+
+    /**
+     * @brief Sample the path. The path loops, so `time` may exceed the duration.
+     *
+     * @param time seconds from the start of the path
+     * @return interpolated keyframe at `time`
+     */
+    CameraKeyframe Sample(const float time) const;
+
+    float GetDuration() const { return keyframes_.back().time - keyframes_.front().time; }
+
+   private:
+    std::vector<CameraKeyframe> keyframes_;
+};
+
+/**
+ * @brief Parse keyframes from a json array of `{"time": t, "pos": [x, y, z], "rot": [yaw, pitch]}`
+ */
+CameraPath LoadCameraPath(const nlohmann::json& camera_path_config);
+
+}  // namespace vlux::bench
+
+#endif
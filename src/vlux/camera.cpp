@@ -33,6 +33,17 @@ void Camera::UpdateRotation(const float cur_right, const float cur_up, const flo
     };
     rot_.y = clamp(rot_.y);
 
+    UpdateOrientation();
+}
+
+void Camera::SetPose(const glm::vec3& pos, const glm::vec2& rot) {
+    pos_ = pos;
+    rot_.x = rot.x;
+    rot_.y = rot.y;
+    UpdateOrientation();
+}
+
+void Camera::UpdateOrientation() {
     const auto pitch_matrix = glm::rotate(glm::mat4(1.0f), rot_.y, glm::vec3(1, 0, 0));
     const auto yaw_matrix = glm::rotate(glm::mat4(1.0f), rot_.x, glm::vec3(0, 1, 0));
     const auto rotation_matrix = yaw_matrix * pitch_matrix;
@@ -25,9 +25,17 @@ class Camera {
 
     const glm::vec3& GetPosition() const { return pos_; }
     const glm::vec3& GetRotation() const { return rot_; }
+    const glm::mat4x4& GetProjectionMatrix() const { return proj_matrix_; }
     void UpdatePosition(const int move_forward, const int move_right, const int move_up,
                         const float gain);
     void UpdateRotation(const float cur_right, const float cur_up, const float gain);
+    /**
+     * @brief Place the camera directly, e.g. from a scripted camera path
+     *
+     * @param pos world position
+     * @param rot (yaw, pitch) in radians
+     */
+    void SetPose(const glm::vec3& pos, const glm::vec2& rot);
 
     glm::mat4x4 CreateViewMatrix() const;
 
@@ -35,6 +43,8 @@ class Camera {
     CameraMatrixParams CreateCameraMatrixParams();
 
    private:
+    void UpdateOrientation();
+
     glm::vec3 pos_{};
     glm::vec3 rot_{};
 
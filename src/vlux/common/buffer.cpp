@@ -8,19 +8,6 @@
 
 namespace vlux {
 
-namespace {
-void FlushMappedMemory(const VkDeviceMemory buffer_memory, const VkDevice device,
-                       const VkDeviceSize size) {
-    const auto mapped_range = VkMappedMemoryRange{
-        .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-        .memory = buffer_memory,
-        .offset = 0,
-        .size = size,
-    };
-    vkFlushMappedMemoryRanges(device, 1, &mapped_range);
-}
-}  // namespace
-
 Buffer::Buffer(const VkDevice device, const VkPhysicalDevice physical_device,
                const VkBufferUsageFlags usage_flags, const VkMemoryPropertyFlags memory_properties,
                const VkDeviceSize size, const void* data)
@@ -42,61 +29,74 @@ Buffer::Buffer(const VkDevice device, const VkPhysicalDevice physical_device,
     VkMemoryRequirements mem_requirements;
     vkGetBufferMemoryRequirements(device, buffer_, &mem_requirements);
 
-    const auto alloc_flags_info = [&]() -> std::optional<VkMemoryAllocateFlagsInfoKHR> {
-        if (usage_flags & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
-            auto info = VkMemoryAllocateFlagsInfoKHR{
-                .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO_KHR,
-                .pNext = nullptr,
-                .flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR,
-                .deviceMask = 0,
-            };
-            return info;
-        } else {
-            return std::nullopt;
+    // host visible buffers that are only copied from are staging buffers released after upload
+    const auto allocation_type = [&]() {
+        if (usage_flags == VK_BUFFER_USAGE_TRANSFER_SRC_BIT &&
+            (memory_properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+            return AllocationType::kTransient;
         }
+        return AllocationType::kLinear;
     }();
-
-    const auto alloc_info = VkMemoryAllocateInfo{
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = alloc_flags_info.has_value() ? &alloc_flags_info.value() : nullptr,
-        .allocationSize = mem_requirements.size,
-        .memoryTypeIndex =
-            FindMemoryType(mem_requirements.memoryTypeBits, memory_properties, physical_device),
-    };
-
-    if (vkAllocateMemory(device, &alloc_info, nullptr, &buffer_memory_) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate buffer memory!");
-    }
+    allocation_ = GetMemoryAllocator(device, physical_device)
+                      .Allocate(mem_requirements, memory_properties, allocation_type);
 
     if (data != nullptr) {
-        vkMapMemory(device, buffer_memory_, 0, size, 0, &mapped);
-        memcpy(mapped, data, static_cast<size_t>(size));
-        if ((memory_properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0) {
-            FlushMappedMemory(buffer_memory_, device, size);
+        const auto mapped = allocation_.GetMappedData();
+        if (mapped == nullptr) {
+            throw std::runtime_error("failed to map buffer memory!");
         }
-        vkUnmapMemory(device, buffer_memory_);
+        memcpy(mapped, data, static_cast<size_t>(size));
+        allocation_.Flush(0, size);
     }
 
-    vkBindBufferMemory(device, buffer_, buffer_memory_, 0);
+    allocation_.BindBuffer(device, buffer_);
 }
 
 Buffer::~Buffer() {
     if (buffer_ != VK_NULL_HANDLE) {
         vkDestroyBuffer(device_, buffer_, nullptr);
     }
-    if (buffer_memory_ != VK_NULL_HANDLE) {
-        vkFreeMemory(device_, buffer_memory_, nullptr);
+}
+
+Buffer::Buffer(Buffer&& other) noexcept
+    : device_(other.device_),
+      buffer_(std::exchange(other.buffer_, VK_NULL_HANDLE)),
+      allocation_(std::move(other.allocation_)),
+      usage_flags_(other.usage_flags_),
+      memory_properties_(other.memory_properties_),
+      size_(std::exchange(other.size_, 0)) {}
+
+Buffer& Buffer::operator=(Buffer&& other) noexcept {
+    if (this != &other) {
+        if (buffer_ != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device_, buffer_, nullptr);
+        }
+        device_ = other.device_;
+        buffer_ = std::exchange(other.buffer_, VK_NULL_HANDLE);
+        allocation_ = std::move(other.allocation_);
+        usage_flags_ = other.usage_flags_;
+        memory_properties_ = other.memory_properties_;
+        size_ = std::exchange(other.size_, 0);
     }
+    return *this;
 }
 
-void Buffer::UpdateBuffer(const void* data, const VkDeviceSize size) {
+void Buffer::ReadBuffer(void* data, const VkDeviceSize size, const VkDeviceSize offset) const {
+    const auto mapped = static_cast<const std::byte*>(allocation_.GetMappedData());
     if (mapped == nullptr) {
-        throw std::runtime_error("failed to map buffer memory!");
+        throw std::runtime_error("failed to read buffer: memory is not host visible!");
     }
-    memcpy(mapped, data, static_cast<size_t>(size));
-    if ((memory_properties_ & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0) {
-        FlushMappedMemory(buffer_memory_, device_, size);
+    allocation_.Invalidate(offset, size);
+    memcpy(data, mapped + offset, static_cast<size_t>(size));
+}
+
+void Buffer::UpdateBuffer(const void* data, const VkDeviceSize size, const VkDeviceSize offset) {
+    const auto mapped = static_cast<std::byte*>(allocation_.GetMappedData());
+    if (mapped == nullptr) {
+        throw std::runtime_error("failed to map buffer memory!");
     }
+    memcpy(mapped + offset, data, static_cast<size_t>(size));
+    allocation_.Flush(offset, size);
 }
 
 void CopyBuffer(const VkBuffer src_buffer, const VkBuffer dst_buffer, const VkDeviceSize size,
@@ -110,4 +110,4 @@ void CopyBuffer(const VkBuffer src_buffer, const VkBuffer dst_buffer, const VkDe
 
     EndSingleTimeCommands(command_buffer, queue, command_pool, device);
 }
-}  // namespace vlux
\ No newline at end of file
+}  // namespace vlux
@@ -2,11 +2,13 @@
 #define COMMON_BUFFER_H
 
 #include "pch.h"
+//
+#include "memory_allocator.h"
 
 namespace vlux {
 
 /**
- * @brief A wrapper class for VkBuffer and VkDeviceMemory
+ * @brief A wrapper class for VkBuffer and its sub-allocated memory
  */
 class Buffer {
    public:
@@ -26,22 +28,33 @@ class Buffer {
            const VkDeviceSize size, const void* data);
 
     ~Buffer();
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+    Buffer(Buffer&& other) noexcept;
+    Buffer& operator=(Buffer&& other) noexcept;
 
     VkBuffer GetVkBuffer() const { return buffer_; }
     VkDeviceSize GetSize() const { return size_; }
 
-    void UpdateBuffer(const void* data, const VkDeviceSize size);
+    void UpdateBuffer(const void* data, const VkDeviceSize size, const VkDeviceSize offset = 0);
+
+    /**
+     * @brief Copy the contents of a host visible buffer to `data`
+     *
+     * @param data destination of at least `size` bytes
+     * @param size number of bytes to read
+     * @param offset in the buffer to read from
+     */
+    void ReadBuffer(void* data, const VkDeviceSize size, const VkDeviceSize offset = 0) const;
 
    private:
     VkDevice device_ = VK_NULL_HANDLE;
     VkBuffer buffer_ = VK_NULL_HANDLE;
-    VkDeviceMemory buffer_memory_ = VK_NULL_HANDLE;
+    MemoryAllocation allocation_;
 
     VkBufferUsageFlags usage_flags_;
     VkMemoryPropertyFlags memory_properties_;
 
-    void* mapped = nullptr;
-
     VkDeviceSize size_ = 0;
 };
 
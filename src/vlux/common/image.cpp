@@ -36,18 +36,12 @@ ImageBuffer::ImageBuffer(const VkDevice device, const VkPhysicalDevice physical_
     VkMemoryRequirements mem_requirements;
     vkGetImageMemoryRequirements(device, image_, &mem_requirements);
 
-    VkMemoryAllocateInfo allocInfo{
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = mem_requirements.size,
-        .memoryTypeIndex =
-            FindMemoryType(mem_requirements.memoryTypeBits, properties, physical_device_),
-    };
-
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &image_memory_) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate image memory!");
-    }
-
-    vkBindImageMemory(device, image_, image_memory_, 0);
+    // optimal and linear resources live in separate blocks to respect bufferImageGranularity
+    const auto allocation_type =
+        tiling == VK_IMAGE_TILING_OPTIMAL ? AllocationType::kOptimal : AllocationType::kLinear;
+    allocation_ = GetMemoryAllocator(device, physical_device_)
+                      .Allocate(mem_requirements, properties, allocation_type);
+    allocation_.BindImage(device, image_);
 
     // create image view
     const auto view_info = VkImageViewCreateInfo{
@@ -73,9 +67,42 @@ ImageBuffer::ImageBuffer(const VkDevice device, const VkPhysicalDevice physical_
 }
 
 ImageBuffer::~ImageBuffer() {
-    vkDestroyImageView(device_, image_view_, nullptr);
-    vkDestroyImage(device_, image_, nullptr);
-    vkFreeMemory(device_, image_memory_, nullptr);
+    if (image_view_ != VK_NULL_HANDLE) {
+        vkDestroyImageView(device_, image_view_, nullptr);
+    }
+    if (image_ != VK_NULL_HANDLE) {
+        vkDestroyImage(device_, image_, nullptr);
+    }
+}
+
+ImageBuffer::ImageBuffer(ImageBuffer&& other) noexcept
+    : device_(other.device_),
+      physical_device_(other.physical_device_),
+      width_(other.width_),
+      height_(other.height_),
+      format_(other.format_),
+      image_(std::exchange(other.image_, VK_NULL_HANDLE)),
+      allocation_(std::move(other.allocation_)),
+      image_view_(std::exchange(other.image_view_, VK_NULL_HANDLE)) {}
+
+ImageBuffer& ImageBuffer::operator=(ImageBuffer&& other) noexcept {
+    if (this != &other) {
+        if (image_view_ != VK_NULL_HANDLE) {
+            vkDestroyImageView(device_, image_view_, nullptr);
+        }
+        if (image_ != VK_NULL_HANDLE) {
+            vkDestroyImage(device_, image_, nullptr);
+        }
+        device_ = other.device_;
+        physical_device_ = other.physical_device_;
+        width_ = other.width_;
+        height_ = other.height_;
+        format_ = other.format_;
+        image_ = std::exchange(other.image_, VK_NULL_HANDLE);
+        allocation_ = std::move(other.allocation_);
+        image_view_ = std::exchange(other.image_view_, VK_NULL_HANDLE);
+    }
+    return *this;
 }
 
 }  // namespace vlux
\ No newline at end of file
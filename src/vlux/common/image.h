@@ -7,6 +7,8 @@
 #include <limits>
 
 #include "pch.h"
+//
+#include "memory_allocator.h"
 
 namespace vlux {
 class ImageBuffer {
@@ -18,6 +20,10 @@ class ImageBuffer {
                 VkImageAspectFlags aspect_flags);
 
     ~ImageBuffer();
+    ImageBuffer(const ImageBuffer&) = delete;
+    ImageBuffer& operator=(const ImageBuffer&) = delete;
+    ImageBuffer(ImageBuffer&& other) noexcept;
+    ImageBuffer& operator=(ImageBuffer&& other) noexcept;
 
     VkImage GetVkImage() const { return image_; }
     VkImageView GetVkImageView() const { return image_view_; }
@@ -30,9 +36,9 @@ class ImageBuffer {
     uint32_t height_;
 
     VkFormat format_;
-    VkImage image_;
-    VkDeviceMemory image_memory_;
-    VkImageView image_view_;
+    VkImage image_ = VK_NULL_HANDLE;
+    MemoryAllocation allocation_;
+    VkImageView image_view_ = VK_NULL_HANDLE;
 };
 
 // concept for uint8_t or float
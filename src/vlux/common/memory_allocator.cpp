@@ -0,0 +1,291 @@
+#include "memory_allocator.h"
+
+#include <unordered_map>
+
+namespace vlux {
+namespace {
+constexpr VkDeviceSize kDefaultBlockSize = 64ull * 1024 * 1024;
+constexpr VkDeviceSize kTransientBlockSize = 32ull * 1024 * 1024;
+// heaps smaller than this (e.g. the 256 MiB BAR heap) use 1/8 of the heap per block
+constexpr VkDeviceSize kSmallHeapSize = 1024ull * 1024 * 1024;
+
+std::mutex allocators_mutex;
+std::unordered_map<VkDevice, std::unique_ptr<MemoryAllocator>> allocators;
+}  // namespace
+
+MemoryAllocation::MemoryAllocation(MemoryAllocation&& other) noexcept
+    : allocator_(std::exchange(other.allocator_, nullptr)),
+      block_(std::exchange(other.block_, nullptr)),
+      offset_(std::exchange(other.offset_, 0)),
+      size_(std::exchange(other.size_, 0)) {}
+
+MemoryAllocation& MemoryAllocation::operator=(MemoryAllocation&& other) noexcept {
+    if (this != &other) {
+        Release();
+        allocator_ = std::exchange(other.allocator_, nullptr);
+        block_ = std::exchange(other.block_, nullptr);
+        offset_ = std::exchange(other.offset_, 0);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+MemoryAllocation::~MemoryAllocation() { Release(); }
+
+void MemoryAllocation::Release() {
+    if (block_ == nullptr) {
+        return;
+    }
+    allocator_->Free(block_, offset_, size_);
+    allocator_ = nullptr;
+    block_ = nullptr;
+}
+
+void* MemoryAllocation::GetMappedData() const {
+    if (block_ == nullptr || block_->mapped == nullptr) {
+        return nullptr;
+    }
+    return static_cast<uint8_t*>(block_->mapped) + offset_;
+}
+
+void MemoryAllocation::BindBuffer(const VkDevice device, const VkBuffer buffer) const {
+    if (vkBindBufferMemory(device, buffer, block_->memory, offset_) != VK_SUCCESS) {
+        throw std::runtime_error("failed to bind buffer memory!");
+    }
+}
+
+void MemoryAllocation::BindImage(const VkDevice device, const VkImage image) const {
+    if (vkBindImageMemory(device, image, block_->memory, offset_) != VK_SUCCESS) {
+        throw std::runtime_error("failed to bind image memory!");
+    }
+}
+
+void MemoryAllocation::Flush(const VkDeviceSize offset, const VkDeviceSize size) const {
+    allocator_->FlushOrInvalidate(*block_, offset_ + offset, size, true);
+}
+
+void MemoryAllocation::Invalidate(const VkDeviceSize offset, const VkDeviceSize size) const {
+    allocator_->FlushOrInvalidate(*block_, offset_ + offset, size, false);
+}
+
+MemoryAllocator::MemoryAllocator(const VkDevice device, const VkPhysicalDevice physical_device)
+    : device_(device) {
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties_);
+    auto properties = VkPhysicalDeviceProperties{};
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+    non_coherent_atom_size_ = std::max(properties.limits.nonCoherentAtomSize, VkDeviceSize{1});
+    max_allocation_count_ = properties.limits.maxMemoryAllocationCount;
+}
+
+MemoryAllocator::~MemoryAllocator() {
+    for (auto& [key, blocks] : pools_) {
+        for (auto& block : blocks) {
+            if (block->num_allocations > 0) {
+                spdlog::warn("memory block of type {} destroyed with {} live allocations",
+                             block->memory_type, block->num_allocations);
+            }
+            DestroyBlock(*block);
+        }
+    }
+}
+
+uint32_t MemoryAllocator::FindMemoryType(const uint32_t type_filter,
+                                         const VkMemoryPropertyFlags properties) const {
+    for (uint32_t i = 0; i < memory_properties_.memoryTypeCount; i++) {
+        if ((type_filter & (1 << i)) &&
+            (memory_properties_.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+    throw std::runtime_error(
+        fmt::format("failed to find suitable memory type! type_filter: {}, properties: {}",
+                    type_filter, properties));
+}
+
+VkDeviceSize MemoryAllocator::GetBlockSize(const uint32_t memory_type,
+                                           const AllocationType type) const {
+    const auto heap_idx = memory_properties_.memoryTypes[memory_type].heapIndex;
+    const auto heap_size = GetHeapSize(heap_idx);
+    const auto block_size = type == AllocationType::kTransient ? kTransientBlockSize
+                                                               : kDefaultBlockSize;
+    if (heap_size <= kSmallHeapSize) {
+        return std::min(block_size, heap_size / 8);
+    }
+    return block_size;
+}
+
+VkDeviceSize MemoryAllocator::GetHeapSize(const uint32_t heap_idx) const {
+    return memory_properties_.memoryHeaps[heap_idx].size;
+}
+
+MemoryBlock* MemoryAllocator::CreateBlock(const uint32_t memory_type, const AllocationType type,
+                                          const VkDeviceSize size, const bool dedicated) {
+    if (allocation_count_ >= max_allocation_count_) {
+        throw std::runtime_error("exceeded maxMemoryAllocationCount!");
+    }
+    // buffer device address is enabled on the device, so any block may back such a buffer
+    const auto alloc_flags_info = VkMemoryAllocateFlagsInfo{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+        .flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
+    };
+    const auto alloc_info = VkMemoryAllocateInfo{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext = &alloc_flags_info,
+        .allocationSize = size,
+        .memoryTypeIndex = memory_type,
+    };
+
+    auto block = std::make_unique<MemoryBlock>(MemoryBlock{
+        .size = size,
+        .memory_type = memory_type,
+        .type = type,
+        .dedicated = dedicated,
+    });
+    if (vkAllocateMemory(device_, &alloc_info, nullptr, &block->memory) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate device memory!");
+    }
+    allocation_count_++;
+
+    const auto property_flags = memory_properties_.memoryTypes[memory_type].propertyFlags;
+    if (property_flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        if (vkMapMemory(device_, block->memory, 0, VK_WHOLE_SIZE, 0, &block->mapped) !=
+            VK_SUCCESS) {
+            throw std::runtime_error("failed to map device memory!");
+        }
+    }
+    if (type == AllocationType::kTransient) {
+        block->linear.emplace(size);
+    } else {
+        block->free_list.emplace(size);
+    }
+    spdlog::debug("allocate memory block: type {}, {} bytes{}", memory_type, size,
+                  dedicated ? " (dedicated)" : "");
+
+    auto& blocks = pools_[{memory_type, type}];
+    blocks.emplace_back(std::move(block));
+    return blocks.back().get();
+}
+
+void MemoryAllocator::DestroyBlock(MemoryBlock& block) const {
+    if (block.mapped != nullptr) {
+        vkUnmapMemory(device_, block.memory);
+        block.mapped = nullptr;
+    }
+    vkFreeMemory(device_, block.memory, nullptr);
+    block.memory = VK_NULL_HANDLE;
+}
+
+MemoryAllocation MemoryAllocator::Allocate(const VkMemoryRequirements& requirements,
+                                           const VkMemoryPropertyFlags properties,
+                                           const AllocationType type) {
+    const auto memory_type = FindMemoryType(requirements.memoryTypeBits, properties);
+    const auto size = requirements.size;
+    const auto alignment = requirements.alignment;
+
+    const auto lock = std::lock_guard(mutex_);
+    const auto allocate_from = [&](MemoryBlock& block) -> std::optional<MemoryAllocation> {
+        const auto offset = block.linear.has_value() ? block.linear->Allocate(size, alignment)
+                                                     : block.free_list->Allocate(size, alignment);
+        if (!offset.has_value()) {
+            return std::nullopt;
+        }
+        block.num_allocations++;
+        return MemoryAllocation(this, &block, offset.value(), size);
+    };
+
+    const auto block_size = GetBlockSize(memory_type, type);
+    if (size > block_size / 2) {
+        auto* block = CreateBlock(memory_type, type, size, true);
+        return allocate_from(*block).value();
+    }
+    for (auto& block : pools_[{memory_type, type}]) {
+        if (block->dedicated) {
+            continue;
+        }
+        if (auto allocation = allocate_from(*block); allocation.has_value()) {
+            return std::move(allocation.value());
+        }
+    }
+    auto* block = CreateBlock(memory_type, type, block_size, false);
+    return allocate_from(*block).value();
+}
+
+void MemoryAllocator::Free(MemoryBlock* block, const VkDeviceSize offset,
+                           const VkDeviceSize size) {
+    const auto lock = std::lock_guard(mutex_);
+    if (block->linear.has_value()) {
+        block->linear->Free(size);
+    } else {
+        block->free_list->Free(offset, size);
+    }
+    block->num_allocations--;
+    if (block->num_allocations > 0) {
+        return;
+    }
+
+    // keep one empty shared block per pool to avoid reallocating on the next request
+    auto& blocks = pools_.at({block->memory_type, block->type});
+    const auto num_shared_blocks = std::ranges::count_if(
+        blocks, [](const auto& pool_block) { return !pool_block->dedicated; });
+    if (!block->dedicated && num_shared_blocks <= 1) {
+        return;
+    }
+    DestroyBlock(*block);
+    allocation_count_--;
+    std::erase_if(blocks, [&](const auto& pool_block) { return pool_block.get() == block; });
+}
+
+void MemoryAllocator::FlushOrInvalidate(const MemoryBlock& block, const VkDeviceSize offset,
+                                        const VkDeviceSize size, const bool flush) const {
+    const auto property_flags = memory_properties_.memoryTypes[block.memory_type].propertyFlags;
+    if (property_flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) {
+        return;
+    }
+    // ranges must be multiples of nonCoherentAtomSize or reach the end of the memory
+    const auto begin = offset / non_coherent_atom_size_ * non_coherent_atom_size_;
+    const auto end = AlignUp(offset + size, non_coherent_atom_size_);
+    const auto mapped_range = VkMappedMemoryRange{
+        .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+        .memory = block.memory,
+        .offset = begin,
+        .size = end >= block.size ? VK_WHOLE_SIZE : end - begin,
+    };
+    const auto result = flush ? vkFlushMappedMemoryRanges(device_, 1, &mapped_range)
+                              : vkInvalidateMappedMemoryRanges(device_, 1, &mapped_range);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to flush or invalidate mapped memory!");
+    }
+}
+
+std::vector<HeapStats> MemoryAllocator::GetHeapStats() const {
+    const auto lock = std::lock_guard(mutex_);
+    auto heap_stats = std::vector<HeapStats>(memory_properties_.memoryHeapCount);
+    for (const auto& [key, blocks] : pools_) {
+        for (const auto& block : blocks) {
+            const auto heap_idx = memory_properties_.memoryTypes[block->memory_type].heapIndex;
+            auto& stats = heap_stats.at(heap_idx);
+            stats.reserved += block->size;
+            stats.used += block->linear.has_value() ? block->linear->GetUsed()
+                                                    : block->free_list->GetUsed();
+            stats.block_count++;
+            stats.allocation_count += block->num_allocations;
+        }
+    }
+    return heap_stats;
+}
+
+MemoryAllocator& GetMemoryAllocator(const VkDevice device, const VkPhysicalDevice physical_device) {
+    const auto lock = std::lock_guard(allocators_mutex);
+    auto& allocator = allocators[device];
+    if (allocator == nullptr) {
+        allocator = std::make_unique<MemoryAllocator>(device, physical_device);
+    }
+    return *allocator;
+}
+
+void DestroyMemoryAllocator(const VkDevice device) {
+    const auto lock = std::lock_guard(allocators_mutex);
+    allocators.erase(device);
+}
+
+}  // namespace vlux
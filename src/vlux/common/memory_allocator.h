@@ -0,0 +1,150 @@
+#ifndef COMMON_MEMORY_ALLOCATOR_H
+#define COMMON_MEMORY_ALLOCATOR_H
+
+#include "pch.h"
+//
+#include <mutex>
+
+#include "suballocator.h"
+
+namespace vlux {
+
+enum class AllocationType : uint8_t {
+    kLinear,     // buffers and linear tiling images
+    kOptimal,    // optimal tiling images
+    kTransient,  // staging buffers that are released right after an upload
+    kCount,
+};
+
+//! memory usage of a heap
+struct HeapStats {
+    VkDeviceSize reserved = 0;  // bytes allocated with `vkAllocateMemory`
+    VkDeviceSize used = 0;      // bytes handed out to resources
+    uint32_t block_count = 0;
+    uint32_t allocation_count = 0;
+};
+
+//! a `VkDeviceMemory` shared by many allocations
+struct MemoryBlock {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize size = 0;
+    uint32_t memory_type = 0;
+    AllocationType type = AllocationType::kLinear;
+    bool dedicated = false;
+    void* mapped = nullptr;  // persistently mapped if the memory type is host visible
+    uint32_t num_allocations = 0;
+    std::optional<FreeListSuballocator> free_list = std::nullopt;
+    std::optional<LinearSuballocator> linear = std::nullopt;
+};
+
+class MemoryAllocator;
+
+/**
+ * @brief A range of a memory block; returned to its block on destruction
+ */
+class MemoryAllocation {
+   public:
+    MemoryAllocation() = default;
+    MemoryAllocation(const MemoryAllocation&) = delete;
+    MemoryAllocation& operator=(const MemoryAllocation&) = delete;
+    MemoryAllocation(MemoryAllocation&& other) noexcept;
+    MemoryAllocation& operator=(MemoryAllocation&& other) noexcept;
+    ~MemoryAllocation();
+
+    bool IsValid() const { return block_ != nullptr; }
+    VkDeviceMemory GetVkDeviceMemory() const { return block_->memory; }
+    VkDeviceSize GetOffset() const { return offset_; }
+    VkDeviceSize GetSize() const { return size_; }
+    /**
+     * @brief Get the host address of the allocation
+     *
+     * @return nullptr if the memory is not host visible
+     */
+    void* GetMappedData() const;
+
+    void BindBuffer(const VkDevice device, const VkBuffer buffer) const;
+    void BindImage(const VkDevice device, const VkImage image) const;
+
+    // for memory that is not host coherent; ranges are relative to the allocation
+    void Flush(const VkDeviceSize offset, const VkDeviceSize size) const;
+    void Invalidate(const VkDeviceSize offset, const VkDeviceSize size) const;
+
+   private:
+    friend class MemoryAllocator;
+    MemoryAllocation(MemoryAllocator* allocator, MemoryBlock* block, const VkDeviceSize offset,
+                     const VkDeviceSize size)
+        : allocator_(allocator), block_(block), offset_(offset), size_(size) {}
+    void Release();
+
+    MemoryAllocator* allocator_ = nullptr;
+    MemoryBlock* block_ = nullptr;
+    VkDeviceSize offset_ = 0;
+    VkDeviceSize size_ = 0;
+};
+
+/**
+ * @brief Sub-allocates resources from large `VkDeviceMemory` blocks
+ *
+ * Blocks are pooled per (memory type, allocation type). Keeping linear and optimal resources in
+ * separate blocks means neighbors never violate `bufferImageGranularity`. Allocations larger than
+ * half a block get a dedicated block.
+ */
+class MemoryAllocator {
+   public:
+    MemoryAllocator() = delete;
+    MemoryAllocator(const VkDevice device, const VkPhysicalDevice physical_device);
+    MemoryAllocator(const MemoryAllocator&) = delete;
+    MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+    ~MemoryAllocator();
+
+    /**
+     * @brief Allocate memory for a resource; bind it with `MemoryAllocation::BindBuffer/BindImage`
+     *
+     * @param requirements from `vkGet{Buffer,Image}MemoryRequirements`
+     * @param properties required memory properties
+     * @param type
+     */
+    MemoryAllocation Allocate(const VkMemoryRequirements& requirements,
+                              const VkMemoryPropertyFlags properties, const AllocationType type);
+
+    //! (memoryHeapCount,)
+    std::vector<HeapStats> GetHeapStats() const;
+    VkDeviceSize GetHeapSize(const uint32_t heap_idx) const;
+
+   private:
+    friend class MemoryAllocation;
+    void Free(MemoryBlock* block, const VkDeviceSize offset, const VkDeviceSize size);
+    void FlushOrInvalidate(const MemoryBlock& block, const VkDeviceSize offset,
+                           const VkDeviceSize size, const bool flush) const;
+    uint32_t FindMemoryType(const uint32_t type_filter,
+                            const VkMemoryPropertyFlags properties) const;
+    VkDeviceSize GetBlockSize(const uint32_t memory_type, const AllocationType type) const;
+    MemoryBlock* CreateBlock(const uint32_t memory_type, const AllocationType type,
+                             const VkDeviceSize size, const bool dedicated);
+    void DestroyBlock(MemoryBlock& block) const;
+
+    const VkDevice device_;
+    VkPhysicalDeviceMemoryProperties memory_properties_{};
+    VkDeviceSize non_coherent_atom_size_ = 1;
+    uint32_t max_allocation_count_ = 0;
+    uint32_t allocation_count_ = 0;  // live `VkDeviceMemory` objects
+
+    mutable std::mutex mutex_;
+    //! (memory type, allocation type) -> blocks
+    std::map<std::pair<uint32_t, AllocationType>, std::vector<std::unique_ptr<MemoryBlock>>>
+        pools_;
+};
+
+/**
+ * @brief Get the allocator shared by all resources of the device; created on first use
+ */
+MemoryAllocator& GetMemoryAllocator(const VkDevice device, const VkPhysicalDevice physical_device);
+
+/**
+ * @brief Release all blocks of the device. Call before `vkDestroyDevice`.
+ */
+void DestroyMemoryAllocator(const VkDevice device);
+
+}  // namespace vlux
+
+#endif
@@ -16,11 +16,18 @@ QueueFamilyIndices FindQueueFamilies(const VkPhysicalDevice device, const VkSurf
             indices.graphics_compute_family = i;
         }
 
-        auto present_support = VkBool32(false);
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present_support);
+        if (surface == VK_NULL_HANDLE) {
+            // headless: nothing is presented, so the present queue aliases the graphics queue
+            if (indices.graphics_compute_family.has_value()) {
+                indices.present_family = indices.graphics_compute_family;
+            }
+        } else {
+            auto present_support = VkBool32(false);
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present_support);
 
-        if (present_support) {
-            indices.present_family = i;
+            if (present_support) {
+                indices.present_family = i;
+            }
         }
 
         if (IsQueueFamilyIndicesComplete(indices)) {
@@ -28,6 +35,15 @@ QueueFamilyIndices FindQueueFamilies(const VkPhysicalDevice device, const VkSurf
         }
     }
 
+    for (auto i = 0uz; i < queue_families.size(); i++) {
+        const auto queue_flags = queue_families[i].queueFlags;
+        if ((queue_flags & VK_QUEUE_TRANSFER_BIT) &&
+            (queue_flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0) {
+            indices.transfer_family = i;
+            break;
+        }
+    }
+
     return indices;
 }
 
@@ -41,9 +57,15 @@ Queues CreateQueue(const VkDevice device, const VkPhysicalDevice physical_device
     VkQueue present_queue;
     vkGetDeviceQueue(device, indices.present_family.value(), 0, &present_queue);
 
+    auto transfer_queue = graphics_queue;
+    if (indices.transfer_family.has_value()) {
+        vkGetDeviceQueue(device, indices.transfer_family.value(), 0, &transfer_queue);
+    }
+
     return {
         .graphics_compute = graphics_queue,
         .present = present_queue,
+        .transfer = transfer_queue,
     };
 }
 
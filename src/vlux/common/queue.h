@@ -7,11 +7,14 @@ namespace vlux {
 struct Queues {
     VkQueue graphics_compute;
     VkQueue present;
+    VkQueue transfer;  // same as `graphics_compute` if there is no dedicated transfer family
 };
 
 struct QueueFamilyIndices {
     std::optional<uint32_t> graphics_compute_family;
     std::optional<uint32_t> present_family;
+    // a family with transfer but without graphics/compute, i.e. a DMA engine; optional
+    std::optional<uint32_t> transfer_family;
 };
 
 inline bool IsQueueFamilyIndicesComplete(const QueueFamilyIndices& indices) {
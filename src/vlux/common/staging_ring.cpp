@@ -0,0 +1,38 @@
+#include "staging_ring.h"
+
+#include "suballocator.h"
+
+namespace vlux {
+std::optional<VkDeviceSize> StagingRing::Allocate(const VkDeviceSize size,
+                                                  const VkDeviceSize alignment) {
+    if (size > size_) {
+        return std::nullopt;
+    }
+    // an empty ring starts over at the front, so its head never splits the free space; positions
+    // stay monotonic for the `Release` of older submissions
+    if (head_ == tail_) {
+        head_ = AlignUp(head_, size_);
+        tail_ = head_;
+    }
+    auto begin = AlignUp(head_, alignment);
+    // skip the rest of the ring instead of wrapping around in the middle of an allocation
+    if (begin % size_ + size > size_) {
+        begin = AlignUp(head_, size_);
+    }
+    const auto end = begin + size;
+    if (end - tail_ > size_) {
+        return std::nullopt;
+    }
+    head_ = end;
+    return begin % size_;
+}
+
+void StagingRing::Release(const VkDeviceSize position) {
+    if (position > head_) {
+        throw std::runtime_error("invalid staging ring position to release!");
+    }
+    // positions before an empty ring skipped to the front are already released
+    tail_ = std::max(tail_, position);
+}
+
+}  // namespace vlux
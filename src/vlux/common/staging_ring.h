@@ -0,0 +1,48 @@
+#ifndef COMMON_STAGING_RING_H
+#define COMMON_STAGING_RING_H
+
+#include "pch.h"
+
+namespace vlux {
+
+/**
+ * @brief Offset bookkeeping of a ring buffer used for staging
+ *
+ * Positions are virtual and grow monotonically; the physical offset is `position % size`. An
+ * allocation never straddles the end of the ring, and an empty ring starts over at its front.
+ * Space is reclaimed in allocation order with `Release`, e.g. once the submission that read it
+ * has completed.
+ */
+class StagingRing {
+   public:
+    StagingRing() = delete;
+    explicit StagingRing(const VkDeviceSize size) : size_(size) {}
+
+    /**
+     * @brief Reserve `size` bytes
+     *
+     * @return physical offset, or std::nullopt if the ring has no room until older data is released
+     */
+    std::optional<VkDeviceSize> Allocate(const VkDeviceSize size, const VkDeviceSize alignment);
+
+    /**
+     * @brief Release everything allocated before `position`; releasing twice is a no-op
+     *
+     * @param position a value returned by `GetHead`
+     */
+    void Release(const VkDeviceSize position);
+
+    //! virtual position of the next allocation
+    VkDeviceSize GetHead() const { return head_; }
+    VkDeviceSize GetSize() const { return size_; }
+    VkDeviceSize GetUsed() const { return head_ - tail_; }
+
+   private:
+    VkDeviceSize size_;
+    VkDeviceSize head_ = 0;
+    VkDeviceSize tail_ = 0;
+};
+
+}  // namespace vlux
+
+#endif
@@ -0,0 +1,98 @@
+#include "suballocator.h"
+
+namespace vlux {
+VkDeviceSize AlignUp(const VkDeviceSize offset, const VkDeviceSize alignment) {
+    if (alignment <= 1) {
+        return offset;
+    }
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+FreeListSuballocator::FreeListSuballocator(const VkDeviceSize size) : size_(size) {
+    free_ranges_.emplace(0, size);
+}
+
+std::optional<VkDeviceSize> FreeListSuballocator::Allocate(const VkDeviceSize size,
+                                                           const VkDeviceSize alignment) {
+    // best fit: the smallest free range that holds the aligned allocation
+    auto best = free_ranges_.end();
+    for (auto range = free_ranges_.begin(); range != free_ranges_.end(); range++) {
+        const auto [range_offset, range_size] = *range;
+        const auto aligned_offset = AlignUp(range_offset, alignment);
+        if (aligned_offset + size > range_offset + range_size) {
+            continue;
+        }
+        if (best == free_ranges_.end() || range_size < best->second) {
+            best = range;
+        }
+    }
+    if (best == free_ranges_.end()) {
+        return std::nullopt;
+    }
+
+    const auto [range_offset, range_size] = *best;
+    const auto aligned_offset = AlignUp(range_offset, alignment);
+    const auto range_end = range_offset + range_size;
+    const auto allocation_end = aligned_offset + size;
+    free_ranges_.erase(best);
+    // the alignment padding stays free and is merged back on `Free`
+    if (aligned_offset > range_offset) {
+        free_ranges_.emplace(range_offset, aligned_offset - range_offset);
+    }
+    if (allocation_end < range_end) {
+        free_ranges_.emplace(allocation_end, range_end - allocation_end);
+    }
+    used_ += size;
+    return aligned_offset;
+}
+
+void FreeListSuballocator::Free(const VkDeviceSize offset, const VkDeviceSize size) {
+    if (size > used_ || offset + size > size_) {
+        throw std::runtime_error("invalid range to free!");
+    }
+    used_ -= size;
+
+    auto begin = offset;
+    auto end = offset + size;
+    // merge with the following free range
+    const auto next = free_ranges_.lower_bound(offset);
+    if (next != free_ranges_.end() && next->first == end) {
+        end += next->second;
+        free_ranges_.erase(next);
+    }
+    // merge with the preceding free range
+    const auto following = free_ranges_.lower_bound(offset);
+    if (following != free_ranges_.begin()) {
+        const auto prev = std::prev(following);
+        if (prev->first + prev->second == begin) {
+            begin = prev->first;
+            free_ranges_.erase(prev);
+        }
+    }
+    free_ranges_.emplace(begin, end - begin);
+}
+
+std::optional<VkDeviceSize> LinearSuballocator::Allocate(const VkDeviceSize size,
+                                                         const VkDeviceSize alignment) {
+    const auto aligned_offset = AlignUp(head_, alignment);
+    if (aligned_offset + size > size_) {
+        return std::nullopt;
+    }
+    head_ = aligned_offset + size;
+    used_ += size;
+    num_allocations_++;
+    return aligned_offset;
+}
+
+void LinearSuballocator::Free(const VkDeviceSize size) {
+    if (num_allocations_ == 0 || size > used_) {
+        throw std::runtime_error("invalid range to free!");
+    }
+    used_ -= size;
+    num_allocations_--;
+    if (num_allocations_ == 0) {
+        head_ = 0;
+    }
+}
+
+}  // namespace vlux
@@ -0,0 +1,69 @@
+#ifndef COMMON_SUBALLOCATOR_H
+#define COMMON_SUBALLOCATOR_H
+
+#include "pch.h"
+//
+#include <map>
+
+namespace vlux {
+
+/**
+ * @brief Offset bookkeeping of a memory block with a best-fit free list
+ *
+ * Freed ranges are merged with their neighbors, so a block returns to one free range once all of
+ * its allocations are gone.
+ */
+class FreeListSuballocator {
+   public:
+    FreeListSuballocator() = delete;
+    explicit FreeListSuballocator(const VkDeviceSize size);
+
+    /**
+     * @brief Reserve `size` bytes at an offset aligned to `alignment`
+     *
+     * @return offset of the range, or std::nullopt if no free range is large enough
+     */
+    std::optional<VkDeviceSize> Allocate(const VkDeviceSize size, const VkDeviceSize alignment);
+    void Free(const VkDeviceSize offset, const VkDeviceSize size);
+
+    VkDeviceSize GetSize() const { return size_; }
+    VkDeviceSize GetUsed() const { return used_; }
+    bool IsEmpty() const { return used_ == 0; }
+
+   private:
+    VkDeviceSize size_;
+    VkDeviceSize used_ = 0;
+    //! offset -> size of the free ranges
+    std::map<VkDeviceSize, VkDeviceSize> free_ranges_;
+};
+
+/**
+ * @brief Bump allocator for transient allocations
+ *
+ * Allocations only move the head forward; the block is rewound once all of them are freed, which
+ * suits staging buffers that live for a single upload.
+ */
+class LinearSuballocator {
+   public:
+    LinearSuballocator() = delete;
+    explicit LinearSuballocator(const VkDeviceSize size) : size_(size) {}
+
+    std::optional<VkDeviceSize> Allocate(const VkDeviceSize size, const VkDeviceSize alignment);
+    void Free(const VkDeviceSize size);
+
+    VkDeviceSize GetSize() const { return size_; }
+    VkDeviceSize GetUsed() const { return used_; }
+    bool IsEmpty() const { return num_allocations_ == 0; }
+
+   private:
+    VkDeviceSize size_;
+    VkDeviceSize head_ = 0;
+    VkDeviceSize used_ = 0;
+    uint32_t num_allocations_ = 0;
+};
+
+VkDeviceSize AlignUp(const VkDeviceSize offset, const VkDeviceSize alignment);
+
+}  // namespace vlux
+
+#endif
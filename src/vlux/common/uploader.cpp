@@ -0,0 +1,395 @@
+#include "uploader.h"
+
+namespace vlux {
+
+namespace {
+constexpr auto kBufferAlignment = VkDeviceSize{4};
+// covers the texel block size of every uncompressed color format
+constexpr auto kImageAlignment = VkDeviceSize{16};
+
+constexpr auto kColorSubresourceRange = VkImageSubresourceRange{
+    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+    .baseMipLevel = 0,
+    .levelCount = 1,
+    .baseArrayLayer = 0,
+    .layerCount = 1,
+};
+
+VkCommandPool CreateCommandPool(const VkDevice device, const uint32_t queue_family) {
+    const auto pool_info = VkCommandPoolCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
+                 VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .queueFamilyIndex = queue_family,
+    };
+    VkCommandPool command_pool;
+    if (vkCreateCommandPool(device, &pool_info, nullptr, &command_pool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upload command pool!");
+    }
+    return command_pool;
+}
+
+VkCommandBuffer AllocateCommandBuffer(const VkDevice device, const VkCommandPool command_pool) {
+    const auto alloc_info = VkCommandBufferAllocateInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = command_pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+    };
+    VkCommandBuffer command_buffer;
+    if (vkAllocateCommandBuffers(device, &alloc_info, &command_buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate upload command buffer!");
+    }
+    return command_buffer;
+}
+
+void BeginCommandBuffer(const VkCommandBuffer command_buffer) {
+    const auto begin_info = VkCommandBufferBeginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+    if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording upload command buffer!");
+    }
+}
+
+void EndCommandBuffer(const VkCommandBuffer command_buffer) {
+    if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record upload command buffer!");
+    }
+}
+
+void RecordBarriers(const VkCommandBuffer command_buffer,
+                    const std::vector<VkBufferMemoryBarrier2>& buffer_barriers,
+                    const std::vector<VkImageMemoryBarrier2>& image_barriers) {
+    if (buffer_barriers.empty() && image_barriers.empty()) {
+        return;
+    }
+    const auto dependency_info = VkDependencyInfo{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .bufferMemoryBarrierCount = static_cast<uint32_t>(buffer_barriers.size()),
+        .pBufferMemoryBarriers = buffer_barriers.data(),
+        .imageMemoryBarrierCount = static_cast<uint32_t>(image_barriers.size()),
+        .pImageMemoryBarriers = image_barriers.data(),
+    };
+    vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+}
+
+/**
+ * @brief Rewrite the scope of the barriers recorded after the copies
+ *
+ * A queue family release only has a source scope and the matching acquire only a destination
+ * scope; without an ownership transfer both scopes are used in a single barrier.
+ */
+template <typename Barrier>
+std::vector<Barrier> ToPostBarriers(std::vector<Barrier> barriers, const bool release,
+                                    const bool acquire) {
+    for (auto& barrier : barriers) {
+        barrier.srcStageMask = acquire ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_COPY_BIT;
+        barrier.srcAccessMask = acquire ? VK_ACCESS_2_NONE : VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        barrier.dstStageMask =
+            release ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        barrier.dstAccessMask = release ? VK_ACCESS_2_NONE : VK_ACCESS_2_MEMORY_READ_BIT;
+    }
+    return barriers;
+}
+}  // namespace
+
+Uploader::Uploader(const UploaderInput& input)
+    : device_(input.device),
+      physical_device_(input.physical_device),
+      graphics_queue_(input.graphics_queue),
+      graphics_family_(input.graphics_family),
+      transfer_queue_(input.transfer_queue),
+      transfer_family_(input.transfer_family),
+      staging_ring_(input.staging_size) {
+    graphics_command_pool_ = CreateCommandPool(device_, graphics_family_);
+    transfer_command_pool_ =
+        IsSameFamily() ? graphics_command_pool_ : CreateCommandPool(device_, transfer_family_);
+    staging_buffer_.emplace(
+        device_, physical_device_, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        input.staging_size, nullptr);
+}
+
+Uploader::~Uploader() {
+    Wait();
+    for (auto& batch : free_batches_) {
+        DestroyBatch(batch);
+    }
+    if (!IsSameFamily()) {
+        vkDestroyCommandPool(device_, transfer_command_pool_, nullptr);
+    }
+    vkDestroyCommandPool(device_, graphics_command_pool_, nullptr);
+}
+
+void Uploader::UploadBuffer(const VkBuffer dst_buffer, const void* data,
+                            const VkDeviceSize size, const VkDeviceSize dst_offset) {
+    const auto lock = std::lock_guard(mutex_);
+    const auto [src_buffer, src_offset] = Stage(data, size, kBufferAlignment);
+    auto& batch = GetRecordingBatch();
+
+    const auto copy_region = VkBufferCopy{
+        .srcOffset = src_offset,
+        .dstOffset = dst_offset,
+        .size = size,
+    };
+    vkCmdCopyBuffer(batch.transfer_command_buffer, src_buffer, dst_buffer, 1, &copy_region);
+
+    batch.buffer_barriers.emplace_back(VkBufferMemoryBarrier2{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+        .srcQueueFamilyIndex = IsSameFamily() ? VK_QUEUE_FAMILY_IGNORED : transfer_family_,
+        .dstQueueFamilyIndex = IsSameFamily() ? VK_QUEUE_FAMILY_IGNORED : graphics_family_,
+        .buffer = dst_buffer,
+        .offset = dst_offset,
+        .size = size,
+    });
+}
+
+void Uploader::UploadImage(const VkImage dst_image, const void* data, const VkDeviceSize size,
+                           const uint32_t width, const uint32_t height) {
+    const auto lock = std::lock_guard(mutex_);
+    const auto [src_buffer, src_offset] = Stage(data, size, kImageAlignment);
+    auto& batch = GetRecordingBatch();
+
+    // the previous contents are discarded, so no ownership transfer is needed before the copy
+    [&]() {
+        const auto barrier = VkImageMemoryBarrier2{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .srcStageMask = VK_PIPELINE_STAGE_2_NONE,
+            .srcAccessMask = VK_ACCESS_2_NONE,
+            .dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+            .dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = dst_image,
+            .subresourceRange = kColorSubresourceRange,
+        };
+        RecordBarriers(batch.transfer_command_buffer, {}, {barrier});
+    }();
+
+    const auto region = VkBufferImageCopy{
+        .bufferOffset = src_offset,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource{
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .mipLevel = 0,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        },
+        .imageOffset = {0, 0, 0},
+        .imageExtent = {.width = width, .height = height, .depth = 1},
+    };
+    vkCmdCopyBufferToImage(batch.transfer_command_buffer, src_buffer, dst_image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    batch.image_barriers.emplace_back(VkImageMemoryBarrier2{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        .srcQueueFamilyIndex = IsSameFamily() ? VK_QUEUE_FAMILY_IGNORED : transfer_family_,
+        .dstQueueFamilyIndex = IsSameFamily() ? VK_QUEUE_FAMILY_IGNORED : graphics_family_,
+        .image = dst_image,
+        .subresourceRange = kColorSubresourceRange,
+    });
+}
+
+void Uploader::Flush() {
+    const auto lock = std::lock_guard(mutex_);
+    FlushLocked();
+}
+
+void Uploader::Wait() {
+    const auto lock = std::lock_guard(mutex_);
+    FlushLocked();
+    while (!in_flight_.empty()) {
+        RetireOldest();
+    }
+}
+
+Uploader::Batch& Uploader::GetRecordingBatch() {
+    if (recording_.has_value()) {
+        return recording_.value();
+    }
+
+    // recycle the batches the GPU has already finished
+    while (!in_flight_.empty() &&
+           vkGetFenceStatus(device_, in_flight_.front().fence) == VK_SUCCESS) {
+        RetireOldest();
+    }
+
+    if (free_batches_.empty()) {
+        recording_.emplace(CreateBatch());
+    } else {
+        recording_.emplace(std::move(free_batches_.back()));
+        free_batches_.pop_back();
+    }
+    BeginCommandBuffer(recording_->transfer_command_buffer);
+    return recording_.value();
+}
+
+Uploader::Batch Uploader::CreateBatch() const {
+    auto batch = Batch{};
+    batch.transfer_command_buffer = AllocateCommandBuffer(device_, transfer_command_pool_);
+    if (!IsSameFamily()) {
+        batch.acquire_command_buffer = AllocateCommandBuffer(device_, graphics_command_pool_);
+        const auto semaphore_info = VkSemaphoreCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        };
+        if (vkCreateSemaphore(device_, &semaphore_info, nullptr, &batch.transfer_finished) !=
+            VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload semaphore!");
+        }
+    }
+    const auto fence_info = VkFenceCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    };
+    if (vkCreateFence(device_, &fence_info, nullptr, &batch.fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upload fence!");
+    }
+    return batch;
+}
+
+void Uploader::DestroyBatch(Batch& batch) const {
+    vkFreeCommandBuffers(device_, transfer_command_pool_, 1, &batch.transfer_command_buffer);
+    if (batch.acquire_command_buffer != VK_NULL_HANDLE) {
+        vkFreeCommandBuffers(device_, graphics_command_pool_, 1, &batch.acquire_command_buffer);
+    }
+    if (batch.transfer_finished != VK_NULL_HANDLE) {
+        vkDestroySemaphore(device_, batch.transfer_finished, nullptr);
+    }
+    vkDestroyFence(device_, batch.fence, nullptr);
+}
+
+void Uploader::FlushLocked() {
+    if (!recording_.has_value()) {
+        return;
+    }
+    auto& batch = recording_.value();
+    batch.ring_end = staging_ring_.GetHead();
+
+    const auto transfer_command_buffer_info = VkCommandBufferSubmitInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .commandBuffer = batch.transfer_command_buffer,
+    };
+
+    if (IsSameFamily()) {
+        RecordBarriers(batch.transfer_command_buffer,
+                       ToPostBarriers(batch.buffer_barriers, false, false),
+                       ToPostBarriers(batch.image_barriers, false, false));
+        EndCommandBuffer(batch.transfer_command_buffer);
+
+        const auto submit_info = VkSubmitInfo2{
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            .commandBufferInfoCount = 1,
+            .pCommandBufferInfos = &transfer_command_buffer_info,
+        };
+        if (vkQueueSubmit2(transfer_queue_, 1, &submit_info, batch.fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit upload command buffer!");
+        }
+    } else {
+        // release on the transfer queue
+        RecordBarriers(batch.transfer_command_buffer,
+                       ToPostBarriers(batch.buffer_barriers, true, false),
+                       ToPostBarriers(batch.image_barriers, true, false));
+        EndCommandBuffer(batch.transfer_command_buffer);
+
+        const auto signal_info = VkSemaphoreSubmitInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .semaphore = batch.transfer_finished,
+            .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        };
+        const auto transfer_submit_info = VkSubmitInfo2{
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            .commandBufferInfoCount = 1,
+            .pCommandBufferInfos = &transfer_command_buffer_info,
+            .signalSemaphoreInfoCount = 1,
+            .pSignalSemaphoreInfos = &signal_info,
+        };
+        if (vkQueueSubmit2(transfer_queue_, 1, &transfer_submit_info, VK_NULL_HANDLE) !=
+            VK_SUCCESS) {
+            throw std::runtime_error("failed to submit upload command buffer!");
+        }
+
+        // acquire on the graphics queue
+        BeginCommandBuffer(batch.acquire_command_buffer);
+        RecordBarriers(batch.acquire_command_buffer,
+                       ToPostBarriers(batch.buffer_barriers, false, true),
+                       ToPostBarriers(batch.image_barriers, false, true));
+        EndCommandBuffer(batch.acquire_command_buffer);
+
+        const auto wait_info = VkSemaphoreSubmitInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .semaphore = batch.transfer_finished,
+            .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        };
+        const auto acquire_command_buffer_info = VkCommandBufferSubmitInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+            .commandBuffer = batch.acquire_command_buffer,
+        };
+        const auto acquire_submit_info = VkSubmitInfo2{
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            .waitSemaphoreInfoCount = 1,
+            .pWaitSemaphoreInfos = &wait_info,
+            .commandBufferInfoCount = 1,
+            .pCommandBufferInfos = &acquire_command_buffer_info,
+        };
+        if (vkQueueSubmit2(graphics_queue_, 1, &acquire_submit_info, batch.fence) !=
+            VK_SUCCESS) {
+            throw std::runtime_error("failed to submit upload acquire command buffer!");
+        }
+    }
+
+    in_flight_.emplace_back(std::move(batch));
+    recording_.reset();
+}
+
+void Uploader::RetireOldest() {
+    auto& batch = in_flight_.front();
+    if (vkWaitForFences(device_, 1, &batch.fence, VK_TRUE, UINT64_MAX) != VK_SUCCESS) {
+        throw std::runtime_error("failed to wait for upload fence!");
+    }
+    vkResetFences(device_, 1, &batch.fence);
+    staging_ring_.Release(batch.ring_end);
+
+    batch.oversized_staging.clear();
+    batch.buffer_barriers.clear();
+    batch.image_barriers.clear();
+    free_batches_.emplace_back(std::move(batch));
+    in_flight_.pop_front();
+}
+
+std::pair<VkBuffer, VkDeviceSize> Uploader::Stage(const void* data, const VkDeviceSize size,
+                                                  const VkDeviceSize alignment) {
+    // a one-off staging buffer, released with the batch
+    const auto stage_oversized = [&]() -> std::pair<VkBuffer, VkDeviceSize> {
+        auto& batch = GetRecordingBatch();
+        const auto& staging = batch.oversized_staging.emplace_back(
+            device_, physical_device_, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, size,
+            data);
+        return {staging.GetVkBuffer(), 0};
+    };
+    if (size > staging_ring_.GetSize()) {
+        return stage_oversized();
+    }
+
+    auto offset = staging_ring_.Allocate(size, alignment);
+    while (!offset.has_value()) {
+        // the ring is full: submit what we have and reclaim the space of the oldest batch
+        FlushLocked();
+        if (in_flight_.empty()) {
+            // nothing left to reclaim
+            return stage_oversized();
+        }
+        RetireOldest();
+        offset = staging_ring_.Allocate(size, alignment);
+    }
+    staging_buffer_->UpdateBuffer(data, size, offset.value());
+    return {staging_buffer_->GetVkBuffer(), offset.value()};
+}
+
+}  // namespace vlux
@@ -0,0 +1,109 @@
+#ifndef COMMON_UPLOADER_H
+#define COMMON_UPLOADER_H
+
+#include "pch.h"
+//
+#include <deque>
+#include <mutex>
+
+#include "buffer.h"
+#include "staging_ring.h"
+
+namespace vlux {
+
+struct UploaderInput {
+    VkDevice device;
+    VkPhysicalDevice physical_device;
+    VkQueue graphics_queue;
+    uint32_t graphics_family;
+    VkQueue transfer_queue;  // may be the graphics queue
+    uint32_t transfer_family;
+    VkDeviceSize staging_size;
+};
+
+/**
+ * @brief Batches buffer and image uploads into one command buffer per submission
+ *
+ * Source data is copied into a persistently mapped staging ring right away, so the caller may
+ * free it on return. Copies run on the transfer queue; if that is a separate family, ownership is
+ * released there and acquired on the graphics queue. Batches complete asynchronously and are
+ * tracked with fences; the queue is never idled. Resources are ready for use after `Wait`.
+ */
+class Uploader {
+   public:
+    Uploader() = delete;
+    explicit Uploader(const UploaderInput& input);
+    Uploader(const Uploader&) = delete;
+    Uploader& operator=(const Uploader&) = delete;
+    ~Uploader();
+
+    /**
+     * @brief Copy `data` into `dst_buffer` at `dst_offset`
+     */
+    void UploadBuffer(const VkBuffer dst_buffer, const void* data, const VkDeviceSize size,
+                      const VkDeviceSize dst_offset = 0);
+
+    /**
+     * @brief Copy tightly packed texels into mip 0 of a 2D color image. The image must be in
+     * `VK_IMAGE_LAYOUT_UNDEFINED` and ends in `VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL`.
+     */
+    void UploadImage(const VkImage dst_image, const void* data, const VkDeviceSize size,
+                     const uint32_t width, const uint32_t height);
+
+    //! submit the recorded copies without waiting for them
+    void Flush();
+    //! submit the recorded copies and wait until every submitted batch has completed
+    void Wait();
+
+   private:
+    struct Batch {
+        VkCommandBuffer transfer_command_buffer = VK_NULL_HANDLE;
+        // acquires ownership on the graphics queue; unused if the families are the same
+        VkCommandBuffer acquire_command_buffer = VK_NULL_HANDLE;
+        VkSemaphore transfer_finished = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        // staging ring position after the last copy of the batch
+        VkDeviceSize ring_end = 0;
+        // staging buffers of uploads larger than the ring
+        std::vector<Buffer> oversized_staging;
+        std::vector<VkBufferMemoryBarrier2> buffer_barriers;
+        std::vector<VkImageMemoryBarrier2> image_barriers;
+    };
+
+    bool IsSameFamily() const { return graphics_family_ == transfer_family_; }
+    Batch& GetRecordingBatch();
+    Batch CreateBatch() const;
+    void DestroyBatch(Batch& batch) const;
+    void FlushLocked();
+    void RetireOldest();
+    /**
+     * @brief Copy `data` to staging memory
+     *
+     * @return (buffer, offset) to copy from
+     */
+    std::pair<VkBuffer, VkDeviceSize> Stage(const void* data, const VkDeviceSize size,
+                                            const VkDeviceSize alignment);
+
+    const VkDevice device_;
+    const VkPhysicalDevice physical_device_;
+    const VkQueue graphics_queue_;
+    const uint32_t graphics_family_;
+    const VkQueue transfer_queue_;
+    const uint32_t transfer_family_;
+    VkCommandPool graphics_command_pool_ = VK_NULL_HANDLE;
+    VkCommandPool transfer_command_pool_ = VK_NULL_HANDLE;
+
+    std::optional<Buffer> staging_buffer_ = std::nullopt;
+    StagingRing staging_ring_;
+
+    std::optional<Batch> recording_ = std::nullopt;
+    //! submitted batches, oldest first
+    std::deque<Batch> in_flight_;
+    std::vector<Batch> free_batches_;
+
+    std::mutex mutex_;
+};
+
+}  // namespace vlux
+
+#endif
@@ -8,15 +8,24 @@
 namespace vlux {
 namespace {
 constexpr auto kDeviceExtensions = std::to_array<const char*>(
-    {VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_EXT_ROBUSTNESS_2_EXTENSION_NAME,
-     VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME, VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME,
-     VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
-     VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME, VK_KHR_SPIRV_1_4_EXTENSION_NAME,
-     VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME, VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME,
-     VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME});
+    {VK_EXT_ROBUSTNESS_2_EXTENSION_NAME, VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME,
+     VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME, VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME,
+     VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME,
+     VK_KHR_SPIRV_1_4_EXTENSION_NAME, VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME,
+     VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME,
+     VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME});
+
+// the swapchain extension is only required when presenting to a surface
+std::vector<const char*> GetDeviceExtensions(const VkSurfaceKHR surface) {
+    auto extensions = std::vector<const char*>(kDeviceExtensions.begin(), kDeviceExtensions.end());
+    if (surface != VK_NULL_HANDLE) {
+        extensions.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
+    return extensions;
 }
+}  // namespace
 
-bool CheckDeviceExtensionSupport(VkPhysicalDevice physical_device) {
+bool CheckDeviceExtensionSupport(VkPhysicalDevice physical_device, const VkSurfaceKHR surface) {
     uint32_t extension_count;
     vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &extension_count, nullptr);
 
@@ -24,8 +33,9 @@ bool CheckDeviceExtensionSupport(VkPhysicalDevice physical_device) {
     vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &extension_count,
                                          available_extensions.data());
 
+    const auto device_extensions = GetDeviceExtensions(surface);
     auto required_extensions =
-        std::set<std::string>(kDeviceExtensions.begin(), kDeviceExtensions.end());
+        std::set<std::string>(device_extensions.begin(), device_extensions.end());
     for (const auto& extension : available_extensions) {
         required_extensions.erase(extension.extensionName);
     }
@@ -33,12 +43,38 @@ bool CheckDeviceExtensionSupport(VkPhysicalDevice physical_device) {
     return required_extensions.empty();
 }
 
+bool CheckMeshShaderSupport(const VkPhysicalDevice physical_device) {
+    uint32_t extension_count;
+    vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &extension_count, nullptr);
+    auto available_extensions = std::vector<VkExtensionProperties>(extension_count);
+    vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &extension_count,
+                                         available_extensions.data());
+    const auto has_extension =
+        std::ranges::any_of(available_extensions, [](const VkExtensionProperties& extension) {
+            return std::string_view(extension.extensionName) == VK_EXT_MESH_SHADER_EXTENSION_NAME;
+        });
+    if (!has_extension) {
+        return false;
+    }
+
+    auto mesh_shader_features = VkPhysicalDeviceMeshShaderFeaturesEXT{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT,
+    };
+    auto features = VkPhysicalDeviceFeatures2{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext = &mesh_shader_features,
+    };
+    vkGetPhysicalDeviceFeatures2(physical_device, &features);
+    return mesh_shader_features.taskShader && mesh_shader_features.meshShader;
+}
+
 bool IsDeviceSuitable(const VkPhysicalDevice physical_device, const VkSurfaceKHR surface) {
     const auto indices = FindQueueFamilies(physical_device, surface);
-    auto extensions_supported = CheckDeviceExtensionSupport(physical_device);
+    auto extensions_supported = CheckDeviceExtensionSupport(physical_device, surface);
 
-    bool swapchain_adequate = false;
-    if (extensions_supported) {
+    // no swapchain is created when headless
+    bool swapchain_adequate = surface == VK_NULL_HANDLE;
+    if (extensions_supported && surface != VK_NULL_HANDLE) {
         auto swapchain_support = QuerySwapChainSupport(physical_device, surface);
         swapchain_adequate =
             !swapchain_support.formats.empty() && !swapchain_support.present_modes.empty();
@@ -48,13 +84,17 @@ bool IsDeviceSuitable(const VkPhysicalDevice physical_device, const VkSurfaceKHR
     vkGetPhysicalDeviceFeatures(physical_device, &supported_features);
 
     return IsQueueFamilyIndicesComplete(indices) && extensions_supported && swapchain_adequate &&
-           supported_features.samplerAnisotropy;
+           supported_features.samplerAnisotropy && supported_features.multiDrawIndirect;
 }
 
-Device::Device(const VkPhysicalDevice physical_device, const VkSurfaceKHR surface) {
+Device::Device(const VkPhysicalDevice physical_device, const VkSurfaceKHR surface)
+    : mesh_shader_enabled_(CheckMeshShaderSupport(physical_device)) {
     const auto indices = FindQueueFamilies(physical_device, surface);
     std::set<uint32_t> unique_queue_families = {indices.graphics_compute_family.value(),
                                                 indices.present_family.value()};
+    if (indices.transfer_family.has_value()) {
+        unique_queue_families.insert(indices.transfer_family.value());
+    }
 
     const float queue_priority = 1.0f;
     const auto queue_create_infos = [&]() {
@@ -71,15 +111,41 @@ Device::Device(const VkPhysicalDevice physical_device, const VkSurfaceKHR surfac
         return queue_create_infos;
     }();
 
+    // chained in front of the required features when enabled
+    auto mesh_shader_features = VkPhysicalDeviceMeshShaderFeaturesEXT{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT,
+        .pNext = nullptr,
+        .taskShader = VK_TRUE,
+        .meshShader = VK_TRUE,
+    };
+
     auto scalar_block_layout_features = VkPhysicalDeviceScalarBlockLayoutFeatures{
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SCALAR_BLOCK_LAYOUT_FEATURES,
-        .pNext = nullptr,
+        .pNext = mesh_shader_enabled_ ? &mesh_shader_features : nullptr,
         .scalarBlockLayout = VK_TRUE,
     };
 
+    // gl_DrawID of the indirect draw path
+    auto shader_draw_parameters_features = VkPhysicalDeviceShaderDrawParametersFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_DRAW_PARAMETERS_FEATURES,
+        .pNext = &scalar_block_layout_features,
+        .shaderDrawParameters = VK_TRUE,
+    };
+
+    // one bindless array of the scene's textures, sized at allocation, indexed by material slot
+    auto descriptor_indexing_features = VkPhysicalDeviceDescriptorIndexingFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
+        .pNext = &shader_draw_parameters_features,
+        .shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+        .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+        .descriptorBindingPartiallyBound = VK_TRUE,
+        .descriptorBindingVariableDescriptorCount = VK_TRUE,
+        .runtimeDescriptorArray = VK_TRUE,
+    };
+
     auto syncronization_2_features = VkPhysicalDeviceSynchronization2Features{
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES,
-        .pNext = &scalar_block_layout_features,
+        .pNext = &descriptor_indexing_features,
         .synchronization2 = VK_TRUE,
     };
 
@@ -122,11 +188,16 @@ Device::Device(const VkPhysicalDevice physical_device, const VkSurfaceKHR surfac
             VkPhysicalDeviceFeatures{
                 .robustBufferAccess = VK_TRUE,
                 .independentBlend = VK_TRUE,
+                .multiDrawIndirect = VK_TRUE,
                 .samplerAnisotropy = VK_TRUE,
                 .shaderInt64 = VK_TRUE,
             },
     };
 
+    auto device_extensions = GetDeviceExtensions(surface);
+    if (mesh_shader_enabled_) {
+        device_extensions.emplace_back(VK_EXT_MESH_SHADER_EXTENSION_NAME);
+    }
     const auto create_info = VkDeviceCreateInfo{
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
         .pNext = &device_features,
@@ -134,8 +205,8 @@ Device::Device(const VkPhysicalDevice physical_device, const VkSurfaceKHR surfac
         .pQueueCreateInfos = queue_create_infos.data(),
         .enabledLayerCount = static_cast<uint32_t>(kValidationLayers.size()),
         .ppEnabledLayerNames = kValidationLayers.data(),
-        .enabledExtensionCount = static_cast<uint32_t>(kDeviceExtensions.size()),
-        .ppEnabledExtensionNames = kDeviceExtensions.data(),
+        .enabledExtensionCount = static_cast<uint32_t>(device_extensions.size()),
+        .ppEnabledExtensionNames = device_extensions.data(),
     };
 
     if (vkCreateDevice(physical_device, &create_info, nullptr, &device_) != VK_SUCCESS) {
@@ -2,10 +2,16 @@
 #define DEVICE_H
 #include "pch.h"
 //
+#include "common/memory_allocator.h"
 #include "common/queue.h"
 
 namespace vlux {
-bool CheckDeviceExtensionSupport(VkPhysicalDevice physical_device);
+bool CheckDeviceExtensionSupport(VkPhysicalDevice physical_device, const VkSurfaceKHR surface);
+
+/**
+ * @brief Whether `VK_EXT_mesh_shader` is available with task and mesh shaders
+ */
+bool CheckMeshShaderSupport(const VkPhysicalDevice physical_device);
 
 bool IsDeviceSuitable(const VkPhysicalDevice physical_device, const VkSurfaceKHR surface);
 
@@ -17,12 +23,18 @@ class Device {
    public:
     Device(const VkPhysicalDevice physical_device, const VkSurfaceKHR surface);
 
-    ~Device() { vkDestroyDevice(device_, nullptr); }
+    ~Device() {
+        DestroyMemoryAllocator(device_);
+        vkDestroyDevice(device_, nullptr);
+    }
 
     VkDevice GetVkDevice() const { return device_; }
+    //! `VK_EXT_mesh_shader` is optional; it is enabled if the physical device supports it
+    bool IsMeshShaderEnabled() const { return mesh_shader_enabled_; }
 
    private:
     VkDevice device_ = VK_NULL_HANDLE;
+    bool mesh_shader_enabled_ = false;
 };
 
 }  // namespace vlux
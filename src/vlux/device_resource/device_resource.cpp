@@ -18,7 +18,23 @@ DeviceResource::DeviceResource(const Window& window, const bool vsync) : window_
     queues_ = CreateQueue(device_->GetVkDevice(), physical_device_, surface_->GetVkSurface());
     spdlog::debug("Creating swapchain");
     swapchain_.emplace(physical_device_, device_->GetVkDevice(), surface_->GetVkSurface(),
-                       window_.GetGLFWwindow(), vsync);
+                       window_->GetGLFWwindow(), vsync);
+    spdlog::debug("Creating sync object");
+    sync_object_.emplace(device_->GetVkDevice());
+}
+
+DeviceResource::DeviceResource(const uint32_t width, const uint32_t height)
+    : headless_size_(width, height) {
+    spdlog::debug("Creating Vulkan instance (headless)");
+    instance_.emplace(/*headless=*/true);
+    spdlog::debug("Creating debug messenger");
+    debug_messenger_.emplace(instance_->GetVkInstance());
+    spdlog::debug("Picking physical device");
+    physical_device_ = PickPhysicalDevice(instance_->GetVkInstance(), VK_NULL_HANDLE);
+    spdlog::debug("Creating logical device");
+    device_.emplace(physical_device_, VK_NULL_HANDLE);
+    spdlog::debug("Creating queues");
+    queues_ = CreateQueue(device_->GetVkDevice(), physical_device_, VK_NULL_HANDLE);
     spdlog::debug("Creating sync object");
     sync_object_.emplace(device_->GetVkDevice());
 }
@@ -28,10 +44,13 @@ DeviceResource::~DeviceResource() {}
 void DeviceResource::DeviceWaitIdle() const { vkDeviceWaitIdle(device_->GetVkDevice()); }
 
 void DeviceResource::RecreateSwapChain() {
+    if (IsHeadless()) {
+        throw std::runtime_error("no swapchain to recreate in headless mode!");
+    }
     int width = 0, height = 0;
-    glfwGetFramebufferSize(window_.GetGLFWwindow(), &width, &height);
+    glfwGetFramebufferSize(window_->GetGLFWwindow(), &width, &height);
     while (width == 0 || height == 0) {
-        glfwGetFramebufferSize(window_.GetGLFWwindow(), &width, &height);
+        glfwGetFramebufferSize(window_->GetGLFWwindow(), &width, &height);
         glfwWaitEvents();
     }
 
@@ -40,6 +59,6 @@ void DeviceResource::RecreateSwapChain() {
     swapchain_.reset();
 
     swapchain_.emplace(physical_device_, device_->GetVkDevice(), surface_->GetVkSurface(),
-                       window_.GetGLFWwindow(), false);
+                       window_->GetGLFWwindow(), false);
 }
 }  // namespace vlux
\ No newline at end of file
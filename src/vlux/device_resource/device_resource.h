@@ -15,11 +15,35 @@ namespace vlux {
 class DeviceResource {
    public:
     DeviceResource(const Window& window, const bool vsync);
+    /**
+     * @brief Construct a new DeviceResource object without window, surface and swapchain
+     *
+     * @param width width of the render targets
+     * @param height height of the render targets
+     */
+    DeviceResource(const uint32_t width, const uint32_t height);
     ~DeviceResource();  // TODO: destructor order
 
     // accessor
-    GLFWwindow* GetGLFWwindow() const { return window_.GetGLFWwindow(); }
-    const Window& GetWindow() const { return window_; }
+    bool IsHeadless() const { return !window_.has_value(); }
+    GLFWwindow* GetGLFWwindow() const { return GetWindow().GetGLFWwindow(); }
+    const Window& GetWindow() const {
+        if (!window_.has_value()) {
+            throw std::runtime_error("`DeviceResource::window_` has no values.");
+        }
+        return window_.value();
+    }
+    /**
+     * @brief Get the size of the render targets
+     *
+     * @return the window size, or the size given on construction when headless
+     */
+    std::pair<uint32_t, uint32_t> GetRenderSize() const {
+        if (window_.has_value()) {
+            return window_->GetWindowSize();
+        }
+        return headless_size_;
+    }
     const Device& GetDevice() const {
         if (!device_.has_value()) {
             throw std::runtime_error("`DeviceResource::device_` has no values.");
@@ -32,6 +56,10 @@ class DeviceResource {
         }
         return surface_.value();
     }
+    //! `VK_NULL_HANDLE` when headless
+    VkSurfaceKHR GetVkSurface() const {
+        return surface_.has_value() ? surface_->GetVkSurface() : VK_NULL_HANDLE;
+    }
     VkPhysicalDevice GetVkPhysicalDevice() const {
         if (physical_device_ == VK_NULL_HANDLE) {
             throw std::runtime_error("`DeviceResource::physical_device_ == `VK_NULL_HANDLE`");
@@ -58,6 +86,7 @@ class DeviceResource {
     }
     const VkQueue& GetGraphicsComputeQueue() const { return queues_.graphics_compute; }
     const VkQueue& GetPresentQueue() const { return queues_.present; }
+    const VkQueue& GetTransferQueue() const { return queues_.transfer; }
 
     // method
     void DeviceWaitIdle() const;
@@ -65,7 +94,8 @@ class DeviceResource {
     void RecreateSwapChain();
 
    private:
-    const Window window_;
+    const std::optional<Window> window_ = std::nullopt;
+    const std::pair<uint32_t, uint32_t> headless_size_ = {0, 0};
     VkPhysicalDevice physical_device_ = VK_NULL_HANDLE;
     Queues queues_;
 
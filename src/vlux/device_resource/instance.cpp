@@ -13,11 +13,14 @@ const auto kEnabledValidationFeatures = std::vector<VkValidationFeatureEnableEXT
 };
 }
 
-std::vector<const char*> GetRequiredExtensions() {
-    uint32_t glfw_extension_count = 0;
-    const char** glfw_extensions;
-    glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
-    std::vector<const char*> extensions(glfw_extensions, glfw_extensions + glfw_extension_count);
+std::vector<const char*> GetRequiredExtensions(const bool headless) {
+    auto extensions = std::vector<const char*>();
+    if (!headless) {
+        uint32_t glfw_extension_count = 0;
+        const char** glfw_extensions;
+        glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
+        extensions.assign(glfw_extensions, glfw_extensions + glfw_extension_count);
+    }
     if (!kValidationLayers.empty()) {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
         // extensions.push_back(VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME);
@@ -25,7 +28,7 @@ std::vector<const char*> GetRequiredExtensions() {
     return extensions;
 }
 
-Instance::Instance() {
+Instance::Instance(const bool headless) {
     const auto app_info = VkApplicationInfo{
         .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
         .pApplicationName = "Vlux",
@@ -45,7 +48,7 @@ Instance::Instance() {
     auto debug_create_info = CreateDebugMessengerCreateInfo();
     debug_create_info.pNext = &validaton_features;
 
-    const auto extensions = GetRequiredExtensions();
+    const auto extensions = GetRequiredExtensions(headless);
 
     const auto create_info = [&]() {
         auto create_info = VkInstanceCreateInfo{
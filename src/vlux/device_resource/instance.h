@@ -5,7 +5,12 @@
 namespace vlux {
 class Instance {
    public:
-    Instance();
+    /**
+     * @brief Construct a new Instance object
+     *
+     * @param headless skip the window system extensions required by GLFW
+     */
+    explicit Instance(const bool headless = false);
     ~Instance() { vkDestroyInstance(instance_, nullptr); }
 
     VkInstance GetVkInstance() const { return instance_; }
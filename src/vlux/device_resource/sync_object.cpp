@@ -6,37 +6,47 @@ SyncObject::SyncObject(const VkDevice device) : device_(device) {
         .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
     };
 
+    // created signaled so that the first wait on each frame slot returns immediately
     const auto kFenceInfo = VkFenceCreateInfo{
         .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .flags = VK_FENCE_CREATE_SIGNALED_BIT,
     };
 
-    if (vkCreateSemaphore(device, &kSemaphoreInfo, nullptr, &image_available_semaphore_) !=
-        VK_SUCCESS) {
-        throw std::runtime_error("failed to create semaphore for a frame!");
-    }
-    if (vkCreateSemaphore(device, &kSemaphoreInfo, nullptr, &render_finished_semaphore_) !=
-        VK_SUCCESS) {
-        throw std::runtime_error("failed to create semaphore for a frame!");
-    }
-    if (vkCreateFence(device, &kFenceInfo, nullptr, &in_flight_fence_) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create fence for a frame");
+    for (auto frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
+        if (vkCreateSemaphore(device, &kSemaphoreInfo, nullptr,
+                              &image_available_semaphores_.at(frame_i)) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create semaphore for a frame!");
+        }
+        if (vkCreateSemaphore(device, &kSemaphoreInfo, nullptr,
+                              &render_finished_semaphores_.at(frame_i)) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create semaphore for a frame!");
+        }
+        if (vkCreateFence(device, &kFenceInfo, nullptr, &in_flight_fences_.at(frame_i)) !=
+            VK_SUCCESS) {
+            throw std::runtime_error("failed to create fence for a frame");
+        }
     }
 }
 
 SyncObject::~SyncObject() {
-    vkDestroySemaphore(device_, render_finished_semaphore_, nullptr);
-    vkDestroySemaphore(device_, image_available_semaphore_, nullptr);
-    vkDestroyFence(device_, in_flight_fence_, nullptr);
+    for (auto frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
+        vkDestroySemaphore(device_, render_finished_semaphores_.at(frame_i), nullptr);
+        vkDestroySemaphore(device_, image_available_semaphores_.at(frame_i), nullptr);
+        vkDestroyFence(device_, in_flight_fences_.at(frame_i), nullptr);
+    }
 }
 
-void SyncObject::WaitAndResetFences() const {
-    if (vkWaitForFences(device_, 1, &in_flight_fence_, VK_TRUE,
+void SyncObject::WaitForFence(const uint32_t frame_idx) const {
+    if (vkWaitForFences(device_, 1, &in_flight_fences_.at(frame_idx), VK_TRUE,
                         std::numeric_limits<uint64_t>::max()) != VK_SUCCESS) {
         throw std::runtime_error("failed to wait for a fence!");
     }
-    if (vkResetFences(device_, 1, &in_flight_fence_) != VK_SUCCESS) {
+}
+
+void SyncObject::ResetFence(const uint32_t frame_idx) const {
+    if (vkResetFences(device_, 1, &in_flight_fences_.at(frame_idx)) != VK_SUCCESS) {
         throw std::runtime_error("failed to reset a fence!");
     }
 }
 
-}  // namespace vlux
\ No newline at end of file
+}  // namespace vlux
@@ -11,19 +11,34 @@ class SyncObject {
     ~SyncObject();
 
     // accessor
-    VkSemaphore GetVkImageAvailableSemaphore() const { return image_available_semaphore_; }
-    VkSemaphore GetVkRenderFinishedSemaphore() const { return render_finished_semaphore_; }
-    VkFence GetVkInFlightFence() const { return in_flight_fence_; }
+    VkSemaphore GetVkImageAvailableSemaphore(const uint32_t frame_idx) const {
+        return image_available_semaphores_.at(frame_idx);
+    }
+    VkSemaphore GetVkRenderFinishedSemaphore(const uint32_t frame_idx) const {
+        return render_finished_semaphores_.at(frame_idx);
+    }
+    VkFence GetVkInFlightFence(const uint32_t frame_idx) const {
+        return in_flight_fences_.at(frame_idx);
+    }
 
     // methods
-    void WaitAndResetFences() const;
+    /**
+     * @brief Block until the GPU has finished the last submission that used the frame slot.
+     *
+     * @param frame_idx frame slot in [0, kMaxFramesInFlight)
+     */
+    void WaitForFence(const uint32_t frame_idx) const;
+    void ResetFence(const uint32_t frame_idx) const;
 
    private:
     const VkDevice device_;
-    VkSemaphore image_available_semaphore_;
-    VkSemaphore render_finished_semaphore_;
-    VkFence in_flight_fence_;
+    //! (kMaxFramesInFlight,)
+    std::array<VkSemaphore, kMaxFramesInFlight> image_available_semaphores_;
+    //! (kMaxFramesInFlight,)
+    std::array<VkSemaphore, kMaxFramesInFlight> render_finished_semaphores_;
+    //! (kMaxFramesInFlight,)
+    std::array<VkFence, kMaxFramesInFlight> in_flight_fences_;
 };
 
 }  // namespace vlux
-#endif
\ No newline at end of file
+#endif
@@ -3,18 +3,34 @@
 
 #include "common/image.h"
 #include "device_resource/device_resource.h"
+#include "profiler/gpu_profiler.h"
 namespace vlux::draw {
+//! GPU culling results of one frame
+struct CullingStats {
+    uint32_t draw_count;
+    //! drawn by the early and the late occlusion phase
+    uint32_t early_drawn;
+    uint32_t late_drawn;
+    uint32_t frustum_culled;
+    //! in the frustum but behind the Hi-Z pyramid
+    uint32_t occluded;
+};
+
 class DrawStrategy {
    public:
     virtual ~DrawStrategy() = default;
 
-    virtual void RecordCommandBuffer(const uint32_t image_idx, const VkExtent2D& swapchain_extent,
-                                     const VkCommandBuffer command_buffer) = 0;
+    virtual void RecordCommandBuffer(const uint32_t frame_idx, const VkExtent2D& swapchain_extent,
+                                     const VkCommandBuffer command_buffer,
+                                     GpuProfiler& gpu_profiler) = 0;
     virtual void OnRecreateSwapChain(const DeviceResource& device_resource) = 0;
     virtual const ImageBuffer& GetOutputRenderTarget() const = 0;
 
     virtual void SetMode(const uint32_t mode) = 0;
     virtual uint32_t GetMode() const = 0;
+
+    //! std::nullopt unless the strategy culls on the GPU
+    virtual std::optional<CullingStats> GetCullingStats() const { return std::nullopt; }
 };
 }  // namespace vlux::draw
 
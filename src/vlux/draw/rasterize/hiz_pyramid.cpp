@@ -0,0 +1,196 @@
+#include "hiz_pyramid.h"
+
+#include "shader/shader.h"
+#include "spdlog/spdlog.h"
+
+namespace vlux::draw::rasterize {
+namespace {
+// see shader/rasterize/hiz_build.comp
+constexpr auto kHiZGroupSize = uint32_t{8};
+}  // namespace
+
+std::vector<HiZLevel> ComputeHiZLevels(const uint32_t depth_width, const uint32_t depth_height) {
+    auto levels = std::vector<HiZLevel>();
+    auto level = HiZLevel{
+        .offset = 0,
+        .width = std::max((depth_width + 1) / 2, uint32_t{1}),
+        .height = std::max((depth_height + 1) / 2, uint32_t{1}),
+    };
+    while (true) {
+        levels.emplace_back(level);
+        if (level.width == 1 && level.height == 1) {
+            return levels;
+        }
+        level = HiZLevel{
+            .offset = level.offset + level.width * level.height,
+            .width = (level.width + 1) / 2,
+            .height = (level.height + 1) / 2,
+        };
+    }
+}
+
+HiZPyramid::HiZPyramid(const VkDevice device, const VkPhysicalDevice physical_device,
+                       const ImageBuffer& depth, const uint32_t depth_width,
+                       const uint32_t depth_height)
+    : depth_size_(depth_width, depth_height),
+      levels_(ComputeHiZLevels(depth_width, depth_height)) {
+    const auto num_texels = levels_.back().offset + 1;
+    spdlog::debug("Hi-Z pyramid: {} levels, {} texels", levels_.size(), num_texels);
+    pyramid_.emplace(device, physical_device, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(float) * num_texels, nullptr);
+
+    // DescriptorSetLayout
+    [&]() {
+        constexpr auto kLayoutBindings = std::to_array({
+            // depth
+            VkDescriptorSetLayoutBinding{
+                .binding = 0,
+                .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                .descriptorCount = 1,
+                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                .pImmutableSamplers = nullptr,
+            },
+            // pyramid
+            VkDescriptorSetLayoutBinding{
+                .binding = 1,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .descriptorCount = 1,
+                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                .pImmutableSamplers = nullptr,
+            },
+        });
+        const auto layout_info = VkDescriptorSetLayoutCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .bindingCount = static_cast<uint32_t>(kLayoutBindings.size()),
+            .pBindings = kLayoutBindings.data(),
+        };
+        descriptor_set_layout_.emplace(device, layout_info);
+    }();
+
+    // DescriptorPool and DescriptorSets; the depth target and the pyramid are shared by all
+    // frame slots, so one set suffices
+    [&]() {
+        constexpr auto kPoolSizes = std::to_array({
+            VkDescriptorPoolSize{
+                .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                .descriptorCount = 1,
+            },
+            VkDescriptorPoolSize{
+                .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .descriptorCount = 1,
+            },
+        });
+        const auto pool_info = VkDescriptorPoolCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .maxSets = 1,
+            .poolSizeCount = static_cast<uint32_t>(kPoolSizes.size()),
+            .pPoolSizes = kPoolSizes.data(),
+        };
+        descriptor_pool_.emplace(device, pool_info);
+
+        const auto set_layout = descriptor_set_layout_->GetVkDescriptorSetLayout();
+        const auto alloc_info = VkDescriptorSetAllocateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool = descriptor_pool_->GetVkDescriptorPool(),
+            .descriptorSetCount = 1,
+            .pSetLayouts = &set_layout,
+        };
+        descriptor_sets_.emplace(device, alloc_info);
+
+        const auto depth_image_info = VkDescriptorImageInfo{
+            .imageView = depth.GetVkImageView(),
+            .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+        };
+        const auto pyramid_buffer_info = VkDescriptorBufferInfo{
+            .buffer = pyramid_->GetVkBuffer(),
+            .offset = 0,
+            .range = VK_WHOLE_SIZE,
+        };
+        const auto descriptor_write = std::to_array({
+            VkWriteDescriptorSet{
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptor_sets_->GetVkDescriptorSet(0),
+                .dstBinding = 0,
+                .dstArrayElement = 0,
+                .descriptorCount = 1,
+                .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                .pImageInfo = &depth_image_info,
+            },
+            VkWriteDescriptorSet{
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptor_sets_->GetVkDescriptorSet(0),
+                .dstBinding = 1,
+                .dstArrayElement = 0,
+                .descriptorCount = 1,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo = &pyramid_buffer_info,
+            },
+        });
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptor_write.size()),
+                               descriptor_write.data(), 0, nullptr);
+    }();
+
+    // PipelineLayout and ComputePipeline
+    [&]() {
+        constexpr auto kPushConstantRanges = std::to_array({VkPushConstantRange{
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .offset = 0,
+            .size = sizeof(HiZPushConstants),
+        }});
+        const auto set_layout = descriptor_set_layout_->GetVkDescriptorSetLayout();
+        const auto pipeline_layout_info = VkPipelineLayoutCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount = 1,
+            .pSetLayouts = &set_layout,
+            .pushConstantRangeCount = static_cast<uint32_t>(kPushConstantRanges.size()),
+            .pPushConstantRanges = kPushConstantRanges.data(),
+        };
+        pipeline_layout_.emplace(device, pipeline_layout_info);
+
+        const auto comp_shader =
+            Shader("rasterize/hiz_build.comp.spv", VK_SHADER_STAGE_COMPUTE_BIT, device);
+        const auto pipeline_info = VkComputePipelineCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage = comp_shader.GetStageInfo(),
+            .layout = pipeline_layout_->GetVkPipelineLayout(),
+        };
+        build_pipeline_.emplace(device, pipeline_info);
+    }();
+}
+
+void HiZPyramid::RecordBuild(const VkCommandBuffer command_buffer) const {
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                      build_pipeline_->GetVkComputePipeline());
+    const auto descriptor_set = descriptor_sets_->GetVkDescriptorSet(0);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            pipeline_layout_->GetVkPipelineLayout(), 0, 1, &descriptor_set, 0,
+                            nullptr);
+
+    // every level reads the one before it
+    const auto barrier = VkBufferMemoryBarrier{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = pyramid_->GetVkBuffer(),
+        .offset = 0,
+        .size = VK_WHOLE_SIZE,
+    };
+    for (uint32_t level_i = 0; level_i < levels_.size(); level_i++) {
+        const auto push_constants = HiZPushConstants{
+            .depth_size = depth_size_,
+            .level = level_i,
+        };
+        vkCmdPushConstants(command_buffer, pipeline_layout_->GetVkPipelineLayout(),
+                           VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(HiZPushConstants),
+                           &push_constants);
+        const auto& level = levels_[level_i];
+        vkCmdDispatch(command_buffer, (level.width + kHiZGroupSize - 1) / kHiZGroupSize,
+                      (level.height + kHiZGroupSize - 1) / kHiZGroupSize, 1);
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &barrier, 0,
+                             nullptr);
+    }
+}
+}  // namespace vlux::draw::rasterize
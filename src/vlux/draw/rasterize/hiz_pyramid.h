@@ -0,0 +1,91 @@
+#ifndef DRAW_RASTERIZE_HIZ_PYRAMID_H
+#define DRAW_RASTERIZE_HIZ_PYRAMID_H
+
+#include "pch.h"
+//
+#include "common/buffer.h"
+#include "common/compute_pipeline.h"
+#include "common/descriptor_pool.h"
+#include "common/descriptor_set_layout.h"
+#include "common/descriptor_sets.h"
+#include "common/image.h"
+#include "common/pipeline_layout.h"
+
+namespace vlux::draw::rasterize {
+
+//! one level of the Hi-Z pyramid, see shader/rasterize/hiz.glsl
+struct HiZLevel {
+    //! first texel of the level in the pyramid buffer
+    uint32_t offset;
+    uint32_t width;
+    uint32_t height;
+};
+
+/**
+ * @brief Levels of the Hi-Z pyramid of a depth target
+ *
+ * Level 0 has half the resolution of the depth target (rounded up) and every further level
+ * halves the previous one, down to a single texel. The levels are packed back to back.
+ *
+ * @param depth_width
+ * @param depth_height
+ * @return std::vector<HiZLevel> finest level first
+ */
+std::vector<HiZLevel> ComputeHiZLevels(const uint32_t depth_width, const uint32_t depth_height);
+
+struct HiZPushConstants {
+    glm::uvec2 depth_size;
+    //! level written by the dispatch
+    uint32_t level;
+};
+
+/**
+ * @brief Max-depth pyramid of the G-buffer depth, built by compute
+ *
+ * Every texel holds the farthest depth of the texels of the finer level (or the depth target)
+ * it covers, so a box whose nearest depth is farther than the texels under its screen rect is
+ * hidden. The levels live in one float storage buffer; `ImageBuffer` has no mip chain.
+ */
+class HiZPyramid {
+   public:
+    /**
+     * @brief Construct a new HiZPyramid object
+     *
+     * @param device
+     * @param physical_device
+     * @param depth depth target, sampled in `VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL`
+     * @param depth_width
+     * @param depth_height
+     */
+    HiZPyramid(const VkDevice device, const VkPhysicalDevice physical_device,
+               const ImageBuffer& depth, const uint32_t depth_width, const uint32_t depth_height);
+    ~HiZPyramid() = default;
+    HiZPyramid(const HiZPyramid&) = delete;
+    HiZPyramid& operator=(const HiZPyramid&) = delete;
+
+    /**
+     * @brief Rebuild every level from the depth target; outside a render pass
+     *
+     * The depth writes must be visible to compute shader reads, and the pyramid is visible to
+     * compute shader reads afterwards.
+     */
+    void RecordBuild(const VkCommandBuffer command_buffer) const;
+
+    const Buffer& GetBuffer() const { return pyramid_.value(); }
+    const std::vector<HiZLevel>& GetLevels() const { return levels_; }
+    glm::uvec2 GetDepthSize() const { return depth_size_; }
+
+   private:
+    glm::uvec2 depth_size_;
+    std::vector<HiZLevel> levels_;
+    std::optional<Buffer> pyramid_;
+
+    std::optional<DescriptorPool> descriptor_pool_;
+    std::optional<DescriptorSetLayout> descriptor_set_layout_;
+    std::optional<DescriptorSets> descriptor_sets_;
+    std::optional<PipelineLayout> pipeline_layout_;
+    std::optional<ComputePipeline> build_pipeline_;
+};
+}  // namespace vlux::draw::rasterize
+
+#endif
@@ -0,0 +1,377 @@
+#include "indirect_draw.h"
+
+#include "common/queue.h"
+#include "common/uploader.h"
+#include "shader/shader.h"
+#include "spdlog/spdlog.h"
+
+namespace vlux::draw::rasterize {
+namespace {
+// see shader/rasterize/draw_cull.comp
+constexpr auto kCullGroupSize = uint32_t{64};
+constexpr auto kUploaderStagingSize = VkDeviceSize{16} * 1024 * 1024;
+
+/**
+ * @brief Storage buffer holding `data`; never empty
+ */
+template <typename T>
+Buffer CreateStorageBuffer(const VkDevice device, const VkPhysicalDevice physical_device,
+                           Uploader& uploader, const std::span<const T> data) {
+    const auto size = sizeof(T) * std::max(data.size(), size_t{1});
+    auto buffer = Buffer(
+        device, physical_device,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, size, nullptr);
+    if (!data.empty()) {
+        uploader.UploadBuffer(buffer.GetVkBuffer(), data.data(), sizeof(T) * data.size());
+    }
+    return buffer;
+}
+}  // namespace
+
+IndirectDraw::IndirectDraw(const Scene& scene, const UniformBuffer<TransformParams>& transform_ubo,
+                           const HiZPyramid& hiz_pyramid,
+                           const std::vector<Buffer>& model_transforms,
+                           const DeviceResource& device_resource)
+    : draw_count_(static_cast<uint32_t>(scene.GetModels().size())),
+      geometry_pool_(scene.GetGeometryPool()),
+      hiz_pyramid_(hiz_pyramid) {
+    const auto device = device_resource.GetDevice().GetVkDevice();
+    const auto physical_device = device_resource.GetVkPhysicalDevice();
+
+    // every model is a range of the scene's geometry pool, so the records only point into it
+    spdlog::debug("record geometry of {} models", draw_count_);
+    [&]() {
+        const auto& models = scene.GetModels();
+        const auto stride = GetVertexStride(geometry_pool_.GetVertexFormat());
+        const auto index_size = GetIndexSize(geometry_pool_.GetIndexType());
+        auto draw_records = std::vector<DrawRecord>();
+        auto draw_lods = std::vector<DrawLod>();
+        draw_records.reserve(models.size());
+        for (uint32_t model_i = 0; model_i < models.size(); model_i++) {
+            const auto& model = models[model_i];
+            const auto& vertex_buffer = model.GetVertexBuffers()[0];
+            const auto& bounds = vertex_buffer.GetBoundingBox();
+            const auto& quantization = vertex_buffer.GetQuantization();
+            draw_records.emplace_back(DrawRecord{
+                .aabb_min = glm::vec4(bounds.min, 0.0f),
+                .aabb_max = glm::vec4(bounds.max, 0.0f),
+                .dequantize_scale = glm::vec4(quantization.scale, 0.0f),
+                .dequantize_offset = glm::vec4(quantization.offset, 0.0f),
+                .lod_offset = static_cast<uint32_t>(draw_lods.size()),
+                .lod_count = static_cast<uint32_t>(model.GetIndexBuffers().size()),
+                .vertex_offset = static_cast<int32_t>(vertex_buffer.GetOffset() / stride),
+                .material_id = model_i,
+            });
+            for (const auto& index_buffer : model.GetIndexBuffers()) {
+                draw_lods.emplace_back(DrawLod{
+                    .first_index = static_cast<uint32_t>(index_buffer.GetOffset() / index_size),
+                    .index_count = static_cast<uint32_t>(index_buffer.GetSize()),
+                    .error = index_buffer.GetLodError(),
+                });
+            }
+        }
+
+        const auto queue_family_indices =
+            FindQueueFamilies(physical_device, device_resource.GetVkSurface());
+        auto uploader = Uploader({
+            .device = device,
+            .physical_device = physical_device,
+            .graphics_queue = device_resource.GetGraphicsComputeQueue(),
+            .graphics_family = queue_family_indices.graphics_compute_family.value(),
+            .transfer_queue = device_resource.GetTransferQueue(),
+            .transfer_family = queue_family_indices.transfer_family.value_or(
+                queue_family_indices.graphics_compute_family.value()),
+            .staging_size = kUploaderStagingSize,
+        });
+        draw_records_.emplace(CreateStorageBuffer(device, physical_device, uploader,
+                                                  std::span<const DrawRecord>(draw_records)));
+        draw_lods_.emplace(CreateStorageBuffer(device, physical_device, uploader,
+                                               std::span<const DrawLod>(draw_lods)));
+        // everything counts as visible before the first occlusion test
+        const auto draw_visibility = std::vector<uint32_t>(draw_count_, 1);
+        draw_visibility_.emplace(CreateStorageBuffer(device, physical_device, uploader,
+                                                     std::span<const uint32_t>(draw_visibility)));
+        uploader.Wait();
+    }();
+
+    // per-frame outputs of the culling passes
+    [&]() {
+        const auto num_draws = VkDeviceSize{std::max(draw_count_, uint32_t{1})} *
+                               std::to_underlying(CullPhase::kCount);
+        const auto zero_counters = CullCounters{};
+        indirect_commands_.reserve(kMaxFramesInFlight);
+        visible_draw_ids_.reserve(kMaxFramesInFlight);
+        cull_counters_.reserve(kMaxFramesInFlight);
+        cull_counters_readback_.reserve(kMaxFramesInFlight);
+        for (auto frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
+            indirect_commands_.emplace_back(
+                device, physical_device,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                num_draws * sizeof(VkDrawIndexedIndirectCommand), nullptr);
+            visible_draw_ids_.emplace_back(device, physical_device,
+                                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                           num_draws * sizeof(uint32_t), nullptr);
+            cull_counters_.emplace_back(
+                device, physical_device,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                    VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(CullCounters), nullptr);
+            cull_counters_readback_.emplace_back(
+                device, physical_device, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                sizeof(CullCounters), &zero_counters);
+        }
+    }();
+
+    // DescriptorSetLayout
+    spdlog::debug("setup draw culling descriptor set layout");
+    [&]() {
+        const auto storage_buffer = [](const uint32_t binding) {
+            return VkDescriptorSetLayoutBinding{
+                .binding = binding,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .descriptorCount = 1,
+                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                .pImmutableSamplers = nullptr,
+            };
+        };
+        const auto layout_bindings = std::to_array({
+            // transform
+            VkDescriptorSetLayoutBinding{
+                .binding = 0,
+                .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                .descriptorCount = 1,
+                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                .pImmutableSamplers = nullptr,
+            },
+            // draw records, lods, indirect commands, visible draw ids, counters, visibility,
+            // Hi-Z pyramid, model transforms
+            storage_buffer(1),
+            storage_buffer(2),
+            storage_buffer(3),
+            storage_buffer(4),
+            storage_buffer(5),
+            storage_buffer(6),
+            storage_buffer(7),
+            storage_buffer(8),
+        });
+        const auto layout_info = VkDescriptorSetLayoutCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .bindingCount = static_cast<uint32_t>(layout_bindings.size()),
+            .pBindings = layout_bindings.data(),
+        };
+        descriptor_set_layout_.emplace(device, layout_info);
+    }();
+
+    // DescriptorPool
+    [&]() {
+        const auto pool_sizes = std::to_array({
+            // transform
+            VkDescriptorPoolSize{
+                .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight),
+            },
+            // draw records + lods + indirect commands + visible draw ids + counters + visibility
+            // + Hi-Z pyramid + model transforms
+            VkDescriptorPoolSize{
+                .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight) * 8,
+            },
+        });
+        const auto pool_info = VkDescriptorPoolCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .maxSets = kMaxFramesInFlight,
+            .poolSizeCount = static_cast<uint32_t>(pool_sizes.size()),
+            .pPoolSizes = pool_sizes.data(),
+        };
+        descriptor_pool_.emplace(device, pool_info);
+    }();
+
+    // DescriptorSets
+    [&]() {
+        descriptor_sets_.reserve(kMaxFramesInFlight);
+        for (auto frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
+            const auto set_layout = descriptor_set_layout_->GetVkDescriptorSetLayout();
+            const auto alloc_info = VkDescriptorSetAllocateInfo{
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                .descriptorPool = descriptor_pool_->GetVkDescriptorPool(),
+                .descriptorSetCount = 1,
+                .pSetLayouts = &set_layout,
+            };
+            descriptor_sets_.emplace_back(device, alloc_info);
+
+            const auto transform_ubo_buffer_info = VkDescriptorBufferInfo{
+                .buffer = transform_ubo.GetVkBufferUniform(frame_i),
+                .offset = 0,
+                .range = transform_ubo.GetUniformBufferObjectSize(),
+            };
+            const auto storage_buffers = std::to_array({
+                draw_records_->GetVkBuffer(),
+                draw_lods_->GetVkBuffer(),
+                indirect_commands_.at(frame_i).GetVkBuffer(),
+                visible_draw_ids_.at(frame_i).GetVkBuffer(),
+                cull_counters_.at(frame_i).GetVkBuffer(),
+                draw_visibility_->GetVkBuffer(),
+                hiz_pyramid_.GetBuffer().GetVkBuffer(),
+                model_transforms.at(frame_i).GetVkBuffer(),
+            });
+            auto buffer_infos = std::vector<VkDescriptorBufferInfo>();
+            for (const auto buffer : storage_buffers) {
+                buffer_infos.emplace_back(VkDescriptorBufferInfo{
+                    .buffer = buffer,
+                    .offset = 0,
+                    .range = VK_WHOLE_SIZE,
+                });
+            }
+
+            auto descriptor_write = std::vector<VkWriteDescriptorSet>();
+            descriptor_write.emplace_back(VkWriteDescriptorSet{
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptor_sets_.at(frame_i).GetVkDescriptorSet(0),
+                .dstBinding = 0,
+                .dstArrayElement = 0,
+                .descriptorCount = 1,
+                .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                .pBufferInfo = &transform_ubo_buffer_info,
+            });
+            for (uint32_t buffer_i = 0; buffer_i < buffer_infos.size(); buffer_i++) {
+                descriptor_write.emplace_back(VkWriteDescriptorSet{
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = descriptor_sets_.at(frame_i).GetVkDescriptorSet(0),
+                    .dstBinding = buffer_i + 1,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .pBufferInfo = &buffer_infos[buffer_i],
+                });
+            }
+            vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptor_write.size()),
+                                   descriptor_write.data(), 0, nullptr);
+        }
+    }();
+
+    // PipelineLayout and ComputePipeline
+    spdlog::debug("setup draw culling pipeline");
+    [&]() {
+        constexpr auto kPushConstantRanges = std::to_array({VkPushConstantRange{
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .offset = 0,
+            .size = sizeof(CullPushConstants),
+        }});
+        const auto set_layout = descriptor_set_layout_->GetVkDescriptorSetLayout();
+        const auto pipeline_layout_info = VkPipelineLayoutCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount = 1,
+            .pSetLayouts = &set_layout,
+            .pushConstantRangeCount = static_cast<uint32_t>(kPushConstantRanges.size()),
+            .pPushConstantRanges = kPushConstantRanges.data(),
+        };
+        pipeline_layout_.emplace(device, pipeline_layout_info);
+
+        const auto comp_shader =
+            Shader("rasterize/draw_cull.comp.spv", VK_SHADER_STAGE_COMPUTE_BIT, device);
+        const auto pipeline_info = VkComputePipelineCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage = comp_shader.GetStageInfo(),
+            .layout = pipeline_layout_->GetVkPipelineLayout(),
+        };
+        cull_pipeline_.emplace(device, pipeline_info);
+    }();
+}
+
+void IndirectDraw::Resolve(const uint32_t frame_idx) {
+    auto counters = CullCounters{};
+    cull_counters_readback_.at(frame_idx).ReadBuffer(&counters, sizeof(CullCounters));
+    culling_stats_ = CullingStats{
+        .draw_count = draw_count_,
+        .early_drawn = counters.draw_counts[std::to_underlying(CullPhase::kEarly)],
+        .late_drawn = counters.draw_counts[std::to_underlying(CullPhase::kLate)],
+        .frustum_culled = counters.frustum_culled,
+        .occluded = counters.occluded,
+    };
+}
+
+void IndirectDraw::RecordCulling(const uint32_t frame_idx, const VkCommandBuffer command_buffer,
+                                 const CullPhase phase, const glm::vec3& camera_pos,
+                                 const float pixels_per_unit) const {
+    const auto counters = cull_counters_.at(frame_idx).GetVkBuffer();
+    if (phase == CullPhase::kEarly) {
+        // the counters are accumulated with atomics; the visibility of the previous frame's late
+        // phase is read, and the Hi-Z pyramid it read is rebuilt later in this frame
+        vkCmdFillBuffer(command_buffer, counters, 0, sizeof(CullCounters), 0);
+        const auto clear_barrier = VkMemoryBarrier{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        };
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clear_barrier, 0,
+                             nullptr, 0, nullptr);
+    }
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                      cull_pipeline_->GetVkComputePipeline());
+    const auto descriptor_set = descriptor_sets_.at(frame_idx).GetVkDescriptorSet(0);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            pipeline_layout_->GetVkPipelineLayout(), 0, 1, &descriptor_set, 0,
+                            nullptr);
+    const auto push_constants = CullPushConstants{
+        .camera_position = glm::vec4(camera_pos, pixels_per_unit),
+        .draw_count = draw_count_,
+        .phase = std::to_underlying(phase),
+        .depth_size = hiz_pyramid_.GetDepthSize(),
+        .hiz_level_count = static_cast<uint32_t>(hiz_pyramid_.GetLevels().size()),
+    };
+    vkCmdPushConstants(command_buffer, pipeline_layout_->GetVkPipelineLayout(),
+                       VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants), &push_constants);
+    vkCmdDispatch(command_buffer, (draw_count_ + kCullGroupSize - 1) / kCullGroupSize, 1, 1);
+
+    // commands and counts are read by the draw, the visible draw ids by the vertex shader
+    const auto cull_barrier = VkMemoryBarrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT |
+                         VK_ACCESS_TRANSFER_READ_BIT,
+    };
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 1, &cull_barrier, 0, nullptr, 0, nullptr);
+
+    if (phase == CullPhase::kLate) {
+        // read back by `Resolve` once the frame slot comes around again
+        const auto region = VkBufferCopy{
+            .srcOffset = 0,
+            .dstOffset = 0,
+            .size = sizeof(CullCounters),
+        };
+        vkCmdCopyBuffer(command_buffer, counters,
+                        cull_counters_readback_.at(frame_idx).GetVkBuffer(), 1, &region);
+        const auto readback_barrier = VkMemoryBarrier{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+        };
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &readback_barrier, 0, nullptr, 0,
+                             nullptr);
+    }
+}
+
+void IndirectDraw::RecordDraw(const uint32_t frame_idx, const VkCommandBuffer command_buffer,
+                              const CullPhase phase) const {
+    const auto phase_i = std::to_underlying(phase);
+    vkCmdBindIndexBuffer(command_buffer, geometry_pool_.GetIndexBuffer().GetVkBuffer(), 0,
+                         geometry_pool_.GetIndexType());
+    vkCmdDrawIndexedIndirectCount(
+        command_buffer, indirect_commands_.at(frame_idx).GetVkBuffer(),
+        VkDeviceSize{GetDrawIdOffset(phase)} * sizeof(VkDrawIndexedIndirectCommand),
+        cull_counters_.at(frame_idx).GetVkBuffer(),
+        offsetof(CullCounters, draw_counts) + sizeof(uint32_t) * phase_i, draw_count_,
+        sizeof(VkDrawIndexedIndirectCommand));
+}
+}  // namespace vlux::draw::rasterize
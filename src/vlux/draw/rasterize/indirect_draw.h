@@ -0,0 +1,170 @@
+#ifndef DRAW_RASTERIZE_INDIRECT_DRAW_H
+#define DRAW_RASTERIZE_INDIRECT_DRAW_H
+
+#include "pch.h"
+//
+#include "common/buffer.h"
+#include "common/compute_pipeline.h"
+#include "common/descriptor_pool.h"
+#include "common/descriptor_set_layout.h"
+#include "common/descriptor_sets.h"
+#include "common/pipeline_layout.h"
+#include "device_resource/device_resource.h"
+#include "draw/draw_strategy.h"
+#include "hiz_pyramid.h"
+#include "scene/scene.h"
+#include "transform.h"
+#include "uniform_buffer.h"
+
+namespace vlux::draw::rasterize {
+
+//! one per model; std430 layout, see shader/rasterize/indirect.glsl
+struct DrawRecord {
+    //! xyz: object-space bounds
+    glm::vec4 aabb_min;
+    glm::vec4 aabb_max;
+    //! dequantization of `VertexFormat::kCompact` positions
+    glm::vec4 dequantize_scale;
+    glm::vec4 dequantize_offset;
+    //! first `DrawLod` of the model, full detail first
+    uint32_t lod_offset;
+    uint32_t lod_count;
+    //! first vertex of the model in the vertex buffer of the geometry pool
+    int32_t vertex_offset;
+    //! index into the material buffer and the texture arrays
+    uint32_t material_id;
+};
+static_assert(sizeof(DrawRecord) == 80);
+
+//! indices of one LOD level in the index buffer of the geometry pool
+struct DrawLod {
+    uint32_t first_index;
+    uint32_t index_count;
+    //! see `IndexBuffer::GetLodError`
+    float error;
+    uint32_t padding;
+};
+
+//! two-phase occlusion culling, see shader/rasterize/draw_cull.comp
+enum class CullPhase : uint32_t {
+    //! draws the records that passed the occlusion test last frame
+    kEarly,
+    //! tests every record against the Hi-Z of the early depth and draws the newly visible ones
+    kLate,
+    kCount
+};
+
+//! written by the culling passes; std430 layout
+struct CullCounters {
+    //! indirect commands written by each phase
+    std::array<uint32_t, std::to_underlying(CullPhase::kCount)> draw_counts;
+    uint32_t frustum_culled;
+    uint32_t occluded;
+};
+
+struct CullPushConstants {
+    //! xyz: world-space camera position, w: pixels covered by one world unit at distance 1
+    glm::vec4 camera_position;
+    uint32_t draw_count;
+    //! `CullPhase`
+    uint32_t phase;
+    glm::uvec2 depth_size;
+    uint32_t hiz_level_count;
+};
+
+/**
+ * @brief Geometry and culling of the GPU-driven G-buffer path
+ *
+ * Every model is a range of the scene's `GeometryPool`, described by a `DrawRecord`. Each
+ * frame a compute pass tests the records against the view frustum, picks a LOD level and
+ * appends the survivors to an indirect command buffer, so the whole scene is drawn with one
+ * `vkCmdDrawIndexedIndirectCount` per `CullPhase`. The shaders map `gl_DrawID` back to the
+ * record through the visible draw ids.
+ *
+ * Occlusion is culled in two phases: the early phase draws what was visible last frame, then
+ * the late phase tests every record against a Hi-Z pyramid of that depth and draws the rest.
+ */
+class IndirectDraw {
+   public:
+    /**
+     * @param model_transforms (kMaxFramesInFlight,) instance transform of each model, kept up
+     * to date by the owner; the records are culled with their model's transform applied
+     */
+    IndirectDraw(const Scene& scene, const UniformBuffer<TransformParams>& transform_ubo,
+                 const HiZPyramid& hiz_pyramid, const std::vector<Buffer>& model_transforms,
+                 const DeviceResource& device_resource);
+    ~IndirectDraw() = default;
+    IndirectDraw(const IndirectDraw&) = delete;
+    IndirectDraw& operator=(const IndirectDraw&) = delete;
+
+    /**
+     * @brief Read the counters of the last submission of the frame slot
+     *
+     * Must be called after the fence of the frame slot has been waited on.
+     */
+    void Resolve(const uint32_t frame_idx);
+
+    /**
+     * @brief Cull the draw records into the indirect commands of `frame_idx`; outside a render pass
+     *
+     * The late phase reads the Hi-Z pyramid, so it must be rebuilt in between.
+     *
+     * @param frame_idx
+     * @param command_buffer
+     * @param phase
+     * @param camera_pos world space
+     * @param pixels_per_unit pixels covered by one world unit at distance 1, for LOD selection
+     */
+    void RecordCulling(const uint32_t frame_idx, const VkCommandBuffer command_buffer,
+                       const CullPhase phase, const glm::vec3& camera_pos,
+                       const float pixels_per_unit) const;
+    //! draw the commands of `phase`; the graphics descriptor sets must be bound
+    void RecordDraw(const uint32_t frame_idx, const VkCommandBuffer command_buffer,
+                    const CullPhase phase) const;
+
+    uint32_t GetDrawCount() const { return draw_count_; }
+    //! first visible draw id of `phase`, added to `gl_DrawID`
+    uint32_t GetDrawIdOffset(const CullPhase phase) const {
+        return std::to_underlying(phase) * draw_count_;
+    }
+    //! of the last resolved frame
+    const CullingStats& GetCullingStats() const { return culling_stats_; }
+    //! vertices of every model, read by the vertex shader as a storage buffer
+    const Buffer& GetVertexBuffer() const { return geometry_pool_.GetVertexBuffer(); }
+    const Buffer& GetDrawRecords() const { return draw_records_.value(); }
+    //! record index of each indirect command, indexed by `GetDrawIdOffset` + `gl_DrawID`
+    const Buffer& GetVisibleDrawIds(const uint32_t frame_idx) const {
+        return visible_draw_ids_.at(frame_idx);
+    }
+
+   private:
+    uint32_t draw_count_;
+    const GeometryPool& geometry_pool_;
+    const HiZPyramid& hiz_pyramid_;
+    CullingStats culling_stats_{};
+
+    std::optional<Buffer> draw_records_;
+    std::optional<Buffer> draw_lods_;
+    //! one flag per record, written by the late phase and read by the next early phase
+    std::optional<Buffer> draw_visibility_;
+
+    //! (kMaxFramesInFlight,) VkDrawIndexedIndirectCommand per visible record, `draw_count_`
+    //! slots per phase
+    std::vector<Buffer> indirect_commands_;
+    //! (kMaxFramesInFlight,) laid out as `indirect_commands_`
+    std::vector<Buffer> visible_draw_ids_;
+    //! (kMaxFramesInFlight,) `CullCounters`
+    std::vector<Buffer> cull_counters_;
+    //! (kMaxFramesInFlight,) host-visible copy of `cull_counters_`
+    std::vector<Buffer> cull_counters_readback_;
+
+    std::optional<DescriptorPool> descriptor_pool_;
+    std::optional<DescriptorSetLayout> descriptor_set_layout_;
+    //! (kMaxFramesInFlight,)
+    std::vector<DescriptorSets> descriptor_sets_;
+    std::optional<PipelineLayout> pipeline_layout_;
+    std::optional<ComputePipeline> cull_pipeline_;
+};
+}  // namespace vlux::draw::rasterize
+
+#endif
@@ -16,33 +16,101 @@ namespace vlux::draw::rasterize {
 namespace {
 constexpr auto kNumDescriptorSetGraphics = 2;
 constexpr auto kNumDescriptorSetCompute = 3;
+// see shader/rasterize/light.glsl
+constexpr auto kLightTileSize = uint32_t{16};
+constexpr auto kMaxLightsPerTile = uint32_t{255};
+//! largest screen-space error of a LOD level, in pixels
+constexpr auto kLodPixelError = 1.0f;
+// see shader/rasterize/meshlet.glsl
+constexpr auto kMeshletsPerTask = uint32_t{32};
+
+/**
+ * @brief Coarsest LOD level of `model` whose error projects to at most `kLodPixelError`
+ *
+ * The error is projected at the point of the bounding sphere closest to the camera, after the
+ * instance transform of the model.
+ *
+ * @param model
+ * @param camera_pos
+ * @param pixels_per_unit pixels covered by one world unit at distance 1
+ * @return index into `model.GetIndexBuffers()`
+ */
+size_t SelectLod(const Model& model, const glm::vec3& camera_pos, const float pixels_per_unit) {
+    const auto& bounds = model.GetVertexBuffers()[0].GetBoundingSphere();
+    const auto& transform = model.GetTransform();
+    const auto scale = std::max({glm::length(glm::vec3(transform[0])),
+                                 glm::length(glm::vec3(transform[1])),
+                                 glm::length(glm::vec3(transform[2]))});
+    const auto center = glm::vec3(transform * glm::vec4(bounds.center, 1.0f));
+    const auto distance = glm::length(center - camera_pos) - bounds.radius * scale;
+    if (distance <= 0.0f) {
+        return 0;
+    }
+    const auto& index_buffers = model.GetIndexBuffers();
+    auto lod = size_t{0};
+    while (lod + 1 < index_buffers.size() &&
+           index_buffers[lod + 1].GetLodError() * pixels_per_unit <= kLodPixelError * distance) {
+        lod++;
+    }
+    return lod;
+}
+
+//! `Model::GetTransform` by material id, i.e. model index; never empty
+std::vector<glm::mat4> GetModelTransforms(const Scene& scene) {
+    auto transforms = std::vector<glm::mat4>();
+    transforms.reserve(scene.GetModels().size());
+    for (const auto& model : scene.GetModels()) {
+        transforms.emplace_back(model.GetTransform());
+    }
+    // a zero-sized buffer is invalid
+    if (transforms.empty()) {
+        transforms.emplace_back(1.0f);
+    }
+    return transforms;
+}
 }  // namespace
 
 DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo,
                              const UniformBuffer<CameraParams>& camera_ubo,
-                             const UniformBuffer<LightParams>& light_ubo, Scene& scene,
-                             const DeviceResource& device_resource)
-    : scene_(scene) {
+                             const LightBuffer& light_buffer, const Camera& camera,
+                             Scene& scene, const DeviceResource& device_resource,
+                             const GeometryPath geometry_path)
+    : camera_(camera), scene_(scene), geometry_path_(geometry_path) {
     const auto device = device_resource.GetDevice().GetVkDevice();
     const auto physical_device = device_resource.GetVkPhysicalDevice();
-    const auto [width, height] = device_resource.GetWindow().GetWindowSize();
+    const auto [width, height] = device_resource.GetRenderSize();
+
+    const auto use_mesh_shader = geometry_path_ == GeometryPath::kMeshShader;
+    if (use_mesh_shader) {
+        if (!device_resource.GetDevice().IsMeshShaderEnabled()) {
+            throw std::runtime_error("mesh shader draw path requires VK_EXT_mesh_shader");
+        }
+        vkCmdDrawMeshTasksEXT = reinterpret_cast<PFN_vkCmdDrawMeshTasksEXT>(
+            vkGetDeviceProcAddr(device, "vkCmdDrawMeshTasksEXT"));
+    }
+    const auto use_indirect = geometry_path_ == GeometryPath::kIndirect;
+    // the transform is read by the vertex shader, or by both the task (culling) and mesh shaders
+    const auto geometry_stages = use_mesh_shader
+                                     ? VkShaderStageFlags{VK_SHADER_STAGE_TASK_BIT_EXT |
+                                                          VK_SHADER_STAGE_MESH_BIT_EXT}
+                                     : VkShaderStageFlags{VK_SHADER_STAGE_VERTEX_BIT};
 
     spdlog::debug("setup render targets");
-    // Color
+    // the G-buffer is only sampled by the deferred pass; see shader/rasterize/gbuffer.glsl
+    constexpr auto kGBufferUsage =
+        VkImageUsageFlags{VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT};
+
+    // Color (albedo)
     render_targets_[RenderTargetType::kColor].emplace(
-        device, physical_device, width, height, VK_FORMAT_R32G32B32A32_SFLOAT,
-        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
-            VK_IMAGE_USAGE_SAMPLED_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, VK_IMAGE_ASPECT_COLOR_BIT);
+        device, physical_device, width, height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_TILING_OPTIMAL, kGBufferUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0,
+        VK_IMAGE_ASPECT_COLOR_BIT);
 
-    // Normal
+    // Normal (octahedral)
     render_targets_[RenderTargetType::kNormal].emplace(
-        device, physical_device, width, height, VK_FORMAT_R32G32B32A32_SFLOAT,
-        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
-            VK_IMAGE_USAGE_SAMPLED_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, VK_IMAGE_ASPECT_COLOR_BIT);
+        device, physical_device, width, height, VK_FORMAT_R16G16_SNORM, VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_TILING_OPTIMAL, kGBufferUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0,
+        VK_IMAGE_ASPECT_COLOR_BIT);
 
     // Depth Stencil
     render_targets_[RenderTargetType::kDepthStencil].emplace(
@@ -51,45 +119,17 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
         VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, VK_IMAGE_ASPECT_DEPTH_BIT);
 
-    // Position
-    render_targets_[RenderTargetType::kPosition].emplace(
-        device, physical_device, width, height, VK_FORMAT_R32G32B32A32_SFLOAT,
-        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
-            VK_IMAGE_USAGE_SAMPLED_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, VK_IMAGE_ASPECT_COLOR_BIT);
-
     // Emissive
     render_targets_[RenderTargetType::kEmissive].emplace(
-        device, physical_device, width, height, VK_FORMAT_R32G32B32A32_SFLOAT,
-        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
-            VK_IMAGE_USAGE_SAMPLED_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, VK_IMAGE_ASPECT_COLOR_BIT);
-
-    // BaseColorFactor
-    render_targets_[RenderTargetType::kBaseColorFactor].emplace(
-        device, physical_device, width, height, VK_FORMAT_R32G32B32A32_SFLOAT,
-        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
-            VK_IMAGE_USAGE_SAMPLED_BIT,
+        device, physical_device, width, height, VK_FORMAT_B10G11R11_UFLOAT_PACK32,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_TILING_OPTIMAL, kGBufferUsage,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, VK_IMAGE_ASPECT_COLOR_BIT);
 
-    // MetallicRoughnessFactor
-    render_targets_[RenderTargetType::kMetallicRoughnessFactor].emplace(
-        device, physical_device, width, height, VK_FORMAT_R32G32B32A32_SFLOAT,
-        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
-            VK_IMAGE_USAGE_SAMPLED_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, VK_IMAGE_ASPECT_COLOR_BIT);
-
-    // MetallicRoughness
-    render_targets_[RenderTargetType::kMetallicRoughness].emplace(
-        device, physical_device, width, height, VK_FORMAT_R32G32B32A32_SFLOAT,
-        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
-            VK_IMAGE_USAGE_SAMPLED_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, VK_IMAGE_ASPECT_COLOR_BIT);
+    // OcclusionRoughnessMetallic (+ flags)
+    render_targets_[RenderTargetType::kOcclusionRoughnessMetallic].emplace(
+        device, physical_device, width, height, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_TILING_OPTIMAL, kGBufferUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0,
+        VK_IMAGE_ASPECT_COLOR_BIT);
 
     // Finalized
     render_targets_[RenderTargetType::kFinalized].emplace(
@@ -99,78 +139,182 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
             VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, VK_IMAGE_ASPECT_COLOR_BIT);
 
-    // texture sampler
-    spdlog::debug("setup texture samplers");
+    // light grid: per screen tile, the number of lights followed by their indices
+    [&]() {
+        const auto num_tiles_x = (width + kLightTileSize - 1) / kLightTileSize;
+        const auto num_tiles_y = (height + kLightTileSize - 1) / kLightTileSize;
+        const auto grid_size = VkDeviceSize{num_tiles_x} * num_tiles_y * (kMaxLightsPerTile + 1) *
+                               sizeof(uint32_t);
+        light_grid_.emplace(device, physical_device, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, grid_size, nullptr);
+    }();
+
+    // instance transforms, per frame in flight since `Scene::SetModelTransform` may change
+    // them between frames; rewritten by `UpdateModelTransforms`
+    spdlog::debug("setup model transforms");
+    [&]() {
+        const auto transforms = GetModelTransforms(scene);
+        model_transforms_.reserve(kMaxFramesInFlight);
+        for (size_t frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
+            model_transforms_.emplace_back(
+                device, physical_device, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                sizeof(glm::mat4) * transforms.size(), transforms.data());
+        }
+        model_transform_versions_.fill(scene.GetTransformVersion());
+    }();
+
+    // GPU-driven geometry, culled against the Hi-Z pyramid of the depth target
+    if (use_indirect) {
+        spdlog::debug("setup indirect draw");
+        hiz_pyramid_.emplace(device, physical_device,
+                             render_targets_.at(RenderTargetType::kDepthStencil).value(), width,
+                             height);
+        indirect_draw_.emplace(scene, transform_ubo, hiz_pyramid_.value(), model_transforms_,
+                               device_resource);
+    }
+
+    // materials, indexed by material id, i.e. model index
+    spdlog::debug("setup materials");
     [&]() {
-        for (auto type_i = 0; type_i < std::to_underlying(TextureSamplerType::kCount); type_i++) {
-            texture_samplers_[static_cast<TextureSamplerType>(type_i)].emplace(physical_device,
-                                                                               device);
+        auto materials = std::vector<MaterialParams>();
+        materials.reserve(scene.GetModels().size());
+        for (const auto& model : scene.GetModels()) {
+            materials.emplace_back(model.GetMaterialParams());
         }
+        // a zero-sized buffer is invalid
+        if (materials.empty()) {
+            materials.emplace_back();
+        }
+        materials_.emplace(
+            device, physical_device, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            sizeof(MaterialParams) * materials.size(), materials.data());
     }();
 
+    // texture sampler, shared by every texture
+    spdlog::debug("setup texture sampler");
+    texture_sampler_.emplace(physical_device, device);
+
     // DescriptorSetLayout
     spdlog::debug("setup graphics descriptor set layout");
     [&]() {
-        graphics_descriptor_set_layout_.reserve(kNumDescriptorSetGraphics);
+        graphics_descriptor_set_layout_.reserve(kNumDescriptorSetGraphics + 1);
         {
-            constexpr auto kLayoutBindings = std::to_array({
+            const auto kLayoutBindings = std::to_array({
                 // transform
                 VkDescriptorSetLayoutBinding{
                     .binding = 0,
                     .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
                     .descriptorCount = 1,
-                    .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+                    .stageFlags = geometry_stages,
                     .pImmutableSamplers = nullptr,
                 },
-                // color
+                // bindless: every texture of the scene once, sized at allocation; the materials
+                // hold the slots
                 VkDescriptorSetLayoutBinding{
                     .binding = 1,
                     .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                    .descriptorCount = 1,
-                    .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
-                    .pImmutableSamplers = nullptr,
-                },
-                // normal
-                VkDescriptorSetLayoutBinding{
-                    .binding = 2,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                    .descriptorCount = 1,
+                    .descriptorCount = kMaxTextures,
                     .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
                     .pImmutableSamplers = nullptr,
                 },
-                // emissive
+            });
+            constexpr auto kBindingFlags = std::to_array<VkDescriptorBindingFlags>({
+                0,
+                VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT |
+                    VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                    VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT,
+            });
+            const auto binding_flags_info = VkDescriptorSetLayoutBindingFlagsCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+                .bindingCount = static_cast<uint32_t>(kBindingFlags.size()),
+                .pBindingFlags = kBindingFlags.data(),
+            };
+
+            const auto layout_info = VkDescriptorSetLayoutCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                .pNext = &binding_flags_info,
+                .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+                .bindingCount = static_cast<uint32_t>(kLayoutBindings.size()),
+                .pBindings = kLayoutBindings.data(),
+            };
+            graphics_descriptor_set_layout_.emplace_back(device, layout_info);
+        }
+        {
+            auto layout_bindings = std::vector<VkDescriptorSetLayoutBinding>{
+                // materials
                 VkDescriptorSetLayoutBinding{
-                    .binding = 3,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    .binding = 0,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                     .descriptorCount = 1,
                     .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
                     .pImmutableSamplers = nullptr,
                 },
-                // metallic roughness
+                // model transforms; see shader/rasterize/model_transform.glsl
                 VkDescriptorSetLayoutBinding{
-                    .binding = 4,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    .binding = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                     .descriptorCount = 1,
-                    .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+                    .stageFlags = geometry_stages,
                     .pImmutableSamplers = nullptr,
                 },
-            });
+            };
+            // draw records, visible draw ids, vertex buffer; see shader_indirect.vert
+            if (use_indirect) {
+                for (uint32_t binding = 2; binding <= 4; binding++) {
+                    layout_bindings.emplace_back(VkDescriptorSetLayoutBinding{
+                        .binding = binding,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+                        .pImmutableSamplers = nullptr,
+                    });
+                }
+            }
 
             const auto layout_info = VkDescriptorSetLayoutCreateInfo{
                 .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-                .bindingCount = static_cast<uint32_t>(kLayoutBindings.size()),
-                .pBindings = kLayoutBindings.data(),
+                .bindingCount = static_cast<uint32_t>(layout_bindings.size()),
+                .pBindings = layout_bindings.data(),
             };
             graphics_descriptor_set_layout_.emplace_back(device, layout_info);
         }
-        {
+        // set = 2, meshlets; see shader/rasterize/meshlet.glsl
+        if (use_mesh_shader) {
+            constexpr auto kStages = VkShaderStageFlags{VK_SHADER_STAGE_TASK_BIT_EXT |
+                                                        VK_SHADER_STAGE_MESH_BIT_EXT};
             constexpr auto kLayoutBindings = std::to_array({
-                // material
+                // meshlets
                 VkDescriptorSetLayoutBinding{
                     .binding = 0,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                     .descriptorCount = 1,
-                    .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+                    .stageFlags = kStages,
+                    .pImmutableSamplers = nullptr,
+                },
+                // meshlet vertices
+                VkDescriptorSetLayoutBinding{
+                    .binding = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_MESH_BIT_EXT,
+                    .pImmutableSamplers = nullptr,
+                },
+                // meshlet triangles
+                VkDescriptorSetLayoutBinding{
+                    .binding = 2,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_MESH_BIT_EXT,
+                    .pImmutableSamplers = nullptr,
+                },
+                // vertex buffer
+                VkDescriptorSetLayoutBinding{
+                    .binding = 3,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_MESH_BIT_EXT,
                     .pImmutableSamplers = nullptr,
                 },
             });
@@ -183,26 +327,43 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
             graphics_descriptor_set_layout_.emplace_back(device, layout_info);
         }
     }();
+    // sets 0 and 1 are shared by all models; only the meshlets are bound per model
+    const auto num_sets_per_model = use_mesh_shader ? uint32_t{1} : uint32_t{0};
+    const auto num_model = static_cast<uint32_t>(scene.GetModels().size());
+    const auto num_sets_per_frame =
+        static_cast<uint32_t>(kNumDescriptorSetGraphics) + num_sets_per_model * num_model;
+    // the `kNoTexture` slot included
+    const auto num_textures = static_cast<uint32_t>(scene.GetTextures().size());
 
     // DescriptorPool
     spdlog::debug("setup graphics descriptor pool");
     [&]() {
-        const auto num_model = static_cast<uint32_t>(scene.GetModels().size());
+        // materials + model transforms, plus draw records + visible draw ids + vertex buffer of
+        // the indirect path, plus meshlets + meshlet vertices + meshlet triangles + vertex buffer
+        // per model
+        const auto num_storage_buffers =
+            (use_indirect ? 5 : 2) + (use_mesh_shader ? num_model * 4 : 0);
         const auto pool_sizes = std::to_array({
-            // transform + material
+            // transform
             VkDescriptorPoolSize{
                 .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight) * num_model * 2,
+                .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight),
             },
-            // color + normal + emissive + metallic roughness
+            // textures
             VkDescriptorPoolSize{
                 .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight) * num_model * 4,
+                .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight) * num_textures,
+            },
+            VkDescriptorPoolSize{
+                .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight) * num_storage_buffers,
             },
         });
         const auto pool_info = VkDescriptorPoolCreateInfo{
             .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-            .maxSets = kMaxFramesInFlight * num_model * kNumDescriptorSetGraphics,
+            // for the texture array of set 0
+            .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+            .maxSets = kMaxFramesInFlight * num_sets_per_frame,
             .poolSizeCount = static_cast<uint32_t>(pool_sizes.size()),
             .pPoolSizes = pool_sizes.data(),
         };
@@ -235,17 +396,6 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                 .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
                 .finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
             },
-            // Position
-            VkAttachmentDescription{
-                .format = render_targets_.at(RenderTargetType::kPosition)->GetVkFormat(),
-                .samples = VK_SAMPLE_COUNT_1_BIT,
-                .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-                .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-                .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-                .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-                .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                .finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            },
             // Emissive
             VkAttachmentDescription{
                 .format = render_targets_.at(RenderTargetType::kEmissive)->GetVkFormat(),
@@ -257,32 +407,10 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                 .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
                 .finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
             },
-            // BaseColorFactor
+            // OcclusionRoughnessMetallic
             VkAttachmentDescription{
-                .format = render_targets_.at(RenderTargetType::kBaseColorFactor)->GetVkFormat(),
-                .samples = VK_SAMPLE_COUNT_1_BIT,
-                .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-                .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-                .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-                .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-                .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                .finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            },
-            // MetallicRoughnessFactor
-            VkAttachmentDescription{
-                .format =
-                    render_targets_.at(RenderTargetType::kMetallicRoughnessFactor)->GetVkFormat(),
-                .samples = VK_SAMPLE_COUNT_1_BIT,
-                .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-                .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-                .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-                .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-                .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                .finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            },
-            // MetallicRoughness
-            VkAttachmentDescription{
-                .format = render_targets_.at(RenderTargetType::kMetallicRoughness)->GetVkFormat(),
+                .format = render_targets_.at(RenderTargetType::kOcclusionRoughnessMetallic)
+                              ->GetVkFormat(),
                 .samples = VK_SAMPLE_COUNT_1_BIT,
                 .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
                 .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
@@ -300,7 +428,7 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                 .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
                 .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
                 .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                .finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                .finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
             },
         });
 
@@ -316,34 +444,19 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                 .attachment = 1,
                 .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
             },
-            // position
+            // emissive
             {
                 .attachment = 2,
                 .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
             },
-            // emissive
+            // occlusion roughness metallic
             {
                 .attachment = 3,
                 .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
             },
-            // base color factor
-            {
-                .attachment = 4,
-                .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            },
-            // metallic roughness factor
-            {
-                .attachment = 5,
-                .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            },
-            // metallic roughness
-            {
-                .attachment = 6,
-                .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            },
         });
         constexpr auto kDepthStencilAttachmentRef = VkAttachmentReference{
-            .attachment = 7,
+            .attachment = 4,
             .layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
         };
         subpass.emplace_back(VkSubpassDescription{
@@ -354,17 +467,31 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
         });
 
         constexpr auto kDependencies = std::to_array({
+            // the render targets are shared by all frame slots, so the deferred pass of the
+            // previous frame (compute) must be done reading them before they are overwritten
             VkSubpassDependency{
                 .srcSubpass = VK_SUBPASS_EXTERNAL,
                 .dstSubpass = 0,
                 .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
-                                VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                                VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+                                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
                 .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
                                 VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
                 .srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
                 .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
                                  VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
             },
+            // the deferred pass samples every attachment, depth included, in the final layouts
+            VkSubpassDependency{
+                .srcSubpass = 0,
+                .dstSubpass = VK_SUBPASS_EXTERNAL,
+                .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                                VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                .dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                 VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+            },
         });
 
         const auto render_pass_info = VkRenderPassCreateInfo{
@@ -377,11 +504,42 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
             .pDependencies = kDependencies.data(),
         };
         render_pass_.emplace(device, render_pass_info);
+
+        if (!use_indirect) {
+            return;
+        }
+        // the late phase draws on top of the early one, after the Hi-Z build sampled the depth
+        auto load_attachment_descs = attachment_descs;
+        for (auto& desc : load_attachment_descs) {
+            desc.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+            desc.initialLayout = desc.finalLayout;
+        }
+        auto load_dependencies = kDependencies;
+        load_dependencies[0].srcAccessMask |= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        load_dependencies[0].dstAccessMask |=
+            VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+        const auto load_render_pass_info = VkRenderPassCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+            .attachmentCount = static_cast<uint32_t>(load_attachment_descs.size()),
+            .pAttachments = load_attachment_descs.data(),
+            .subpassCount = static_cast<uint32_t>(subpass.size()),
+            .pSubpasses = subpass.data(),
+            .dependencyCount = static_cast<uint32_t>(load_dependencies.size()),
+            .pDependencies = load_dependencies.data(),
+        };
+        render_pass_load_.emplace(device, load_render_pass_info);
     }();
 
     // PipelineLayout (Graphics)
     spdlog::debug("setup graphics pipeline layout");
     [&]() {
+        const auto kPushConstantRanges = std::to_array({VkPushConstantRange{
+            .stageFlags = geometry_stages,
+            .offset = 0,
+            .size = static_cast<uint32_t>(use_mesh_shader ? sizeof(MeshletPushConstants)
+                                          : use_indirect  ? sizeof(IndirectPushConstants)
+                                                          : sizeof(VertexPushConstants)),
+        }});
         graphics_pipeline_layout_.reserve(kMaxFramesInFlight);
         for (auto frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
             auto set_layout = std::vector<VkDescriptorSetLayout>();
@@ -393,6 +551,8 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                 .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
                 .setLayoutCount = static_cast<uint32_t>(set_layout.size()),
                 .pSetLayouts = set_layout.data(),
+                .pushConstantRangeCount = static_cast<uint32_t>(kPushConstantRanges.size()),
+                .pPushConstantRanges = kPushConstantRanges.data(),
             };
             graphics_pipeline_layout_.emplace_back(device, pipeline_layout_info);
         }
@@ -401,23 +561,44 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
     // GraphicsPipeline
     spdlog::debug("setup graphics pipeline");
     [&]() {
-        const auto vert_path = std::filesystem::path("rasterize/shader.vert.spv");
-        const auto frag_path = std::filesystem::path("rasterize/shader.frag.spv");
-        const auto vert_shader = Shader(vert_path, VK_SHADER_STAGE_VERTEX_BIT, device);
-        const auto frag_shader = Shader(frag_path, VK_SHADER_STAGE_FRAGMENT_BIT, device);
-
-        const auto shader_stages = std::vector<VkPipelineShaderStageCreateInfo>{
-            vert_shader.GetStageInfo(), frag_shader.GetStageInfo()};
+        // one vertex shader per vertex format; the mesh shader and the indirect vertex shader
+        // fetch either format from a storage buffer
+        const auto vertex_format = scene_.GetVertexFormat();
+        const auto frag_shader =
+            Shader("rasterize/shader.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT, device);
+        auto task_shader = std::optional<Shader>();
+        auto mesh_shader = std::optional<Shader>();
+        auto vert_shader = std::optional<Shader>();
+        auto shader_stages = std::vector<VkPipelineShaderStageCreateInfo>();
+        if (use_mesh_shader) {
+            task_shader.emplace("rasterize/shader.task.spv", VK_SHADER_STAGE_TASK_BIT_EXT, device);
+            mesh_shader.emplace("rasterize/shader.mesh.spv", VK_SHADER_STAGE_MESH_BIT_EXT, device);
+            shader_stages.emplace_back(task_shader->GetStageInfo());
+            shader_stages.emplace_back(mesh_shader->GetStageInfo());
+        } else {
+            const auto vert_path = use_indirect
+                                       ? std::filesystem::path("rasterize/shader_indirect.vert.spv")
+                                   : vertex_format == VertexFormat::kCompact
+                                       ? std::filesystem::path("rasterize/shader_compact.vert.spv")
+                                       : std::filesystem::path("rasterize/shader.vert.spv");
+            vert_shader.emplace(vert_path, VK_SHADER_STAGE_VERTEX_BIT, device);
+            shader_stages.emplace_back(vert_shader->GetStageInfo());
+        }
+        shader_stages.emplace_back(frag_shader.GetStageInfo());
 
-        constexpr auto kBindingDescription = GetBindingDescription();
-        constexpr auto kAttributeDescriptions = GetAttributeDescriptions();
+        const auto binding_description = GetBindingDescription(vertex_format);
+        const auto attribute_descriptions = GetAttributeDescriptions(vertex_format);
 
         const auto vertex_input_info = VkPipelineVertexInputStateCreateInfo{
             .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
             .vertexBindingDescriptionCount = 1,
-            .pVertexBindingDescriptions = &kBindingDescription,
-            .vertexAttributeDescriptionCount = static_cast<uint32_t>(kAttributeDescriptions.size()),
-            .pVertexAttributeDescriptions = kAttributeDescriptions.data(),
+            .pVertexBindingDescriptions = &binding_description,
+            .vertexAttributeDescriptionCount = static_cast<uint32_t>(attribute_descriptions.size()),
+            .pVertexAttributeDescriptions = attribute_descriptions.data(),
+        };
+        // the indirect vertex shader pulls its vertices
+        constexpr auto kEmptyVertexInputInfo = VkPipelineVertexInputStateCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
         };
 
         constexpr auto kInputAssembly = VkPipelineInputAssemblyStateCreateInfo{
@@ -483,18 +664,6 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                 .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
                                   VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
             },
-            // Position
-            VkPipelineColorBlendAttachmentState{
-                .blendEnable = VK_FALSE,
-                .srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
-                .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
-                .colorBlendOp = VK_BLEND_OP_ADD,
-                .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
-                .dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
-                .alphaBlendOp = VK_BLEND_OP_ADD,
-                .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
-                                  VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
-            },
             // Emissive
             VkPipelineColorBlendAttachmentState{
                 .blendEnable = VK_TRUE,
@@ -507,31 +676,7 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                 .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
                                   VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
             },
-            // BaseColorFactor
-            VkPipelineColorBlendAttachmentState{
-                .blendEnable = VK_FALSE,
-                .srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
-                .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
-                .colorBlendOp = VK_BLEND_OP_ADD,
-                .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
-                .dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
-                .alphaBlendOp = VK_BLEND_OP_ADD,
-                .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
-                                  VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
-            },
-            // MetallicRoughnessFactor
-            VkPipelineColorBlendAttachmentState{
-                .blendEnable = VK_FALSE,
-                .srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
-                .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
-                .colorBlendOp = VK_BLEND_OP_ADD,
-                .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
-                .dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
-                .alphaBlendOp = VK_BLEND_OP_ADD,
-                .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
-                                  VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
-            },
-            // MetallicRoughness
+            // OcclusionRoughnessMetallic
             VkPipelineColorBlendAttachmentState{
                 .blendEnable = VK_FALSE,
                 .srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
@@ -576,8 +721,11 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                 .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
                 .stageCount = static_cast<uint32_t>(shader_stages.size()),
                 .pStages = shader_stages.data(),
-                .pVertexInputState = &vertex_input_info,
-                .pInputAssemblyState = &kInputAssembly,
+                // mesh shading pipelines have no vertex input
+                .pVertexInputState = use_mesh_shader ? nullptr
+                                     : use_indirect  ? &kEmptyVertexInputInfo
+                                                     : &vertex_input_info,
+                .pInputAssemblyState = use_mesh_shader ? nullptr : &kInputAssembly,
                 .pViewportState = &kViewportState,
                 .pRasterizationState = &kRasterizer,
                 .pMultisampleState = &kMultisampling,
@@ -596,21 +744,31 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
     // Graphics DescriptorSets
     spdlog::debug("setup graphics descriptor sets");
     [&]() {
-        // allocate descriptor sets
+        // allocate descriptor sets: sets 0 and 1, then the meshlet set of every model
         spdlog::debug("allocate descriptor sets");
         graphics_descriptor_sets_.reserve(kMaxFramesInFlight);
-        const auto model_size = scene.GetModels().size();
         for (auto frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
             auto set_layout = std::vector<VkDescriptorSetLayout>();
-            set_layout.reserve(model_size * graphics_descriptor_set_layout_.size());
-            for (size_t model_i = 0; model_i < model_size; model_i++) {
-                for (const auto& layout : graphics_descriptor_set_layout_) {
-                    set_layout.emplace_back(layout.GetVkDescriptorSetLayout());
-                }
+            set_layout.reserve(num_sets_per_frame);
+            for (const auto& layout : graphics_descriptor_set_layout_) {
+                set_layout.emplace_back(layout.GetVkDescriptorSetLayout());
+            }
+            for (uint32_t model_i = 0; model_i < num_sets_per_model * num_model; model_i++) {
+                set_layout.emplace_back(
+                    graphics_descriptor_set_layout_.back().GetVkDescriptorSetLayout());
             }
 
+            // only set 0 has a variable-count binding; the other counts are ignored
+            auto variable_counts = std::vector<uint32_t>(set_layout.size(), 0);
+            variable_counts.front() = num_textures;
+            const auto variable_count_info = VkDescriptorSetVariableDescriptorCountAllocateInfo{
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO,
+                .descriptorSetCount = static_cast<uint32_t>(variable_counts.size()),
+                .pDescriptorCounts = variable_counts.data(),
+            };
             const auto alloc_info = VkDescriptorSetAllocateInfo{
                 .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                .pNext = &variable_count_info,
                 .descriptorPool = graphics_descriptor_pool_->GetVkDescriptorPool(),
                 .descriptorSetCount = static_cast<uint32_t>(set_layout.size()),
                 .pSetLayouts = set_layout.data(),
@@ -618,126 +776,121 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
             graphics_descriptor_sets_.emplace_back(device, alloc_info);
         }
 
+        // `Scene::GetTextures`; the `kNoTexture` slot is a null descriptor
+        auto texture_image_infos = std::vector<VkDescriptorImageInfo>();
+        texture_image_infos.reserve(num_textures);
+        for (const auto& texture : scene_.GetTextures()) {
+            texture_image_infos.emplace_back(VkDescriptorImageInfo{
+                .sampler = texture_sampler_->GetSampler(),
+                .imageView = texture == nullptr ? VK_NULL_HANDLE : texture->GetImageView(),
+                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            });
+        }
+
         // update descriptor sets
         spdlog::debug("update descriptor sets");
         for (auto frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
-            for (auto model_i = 0; const auto& model : scene_.GetModels()) {
-                auto descriptor_write = std::vector<VkWriteDescriptorSet>();
-                // transform
-                const auto transform_ubo_buffer_info = VkDescriptorBufferInfo{
-                    .buffer = transform_ubo.GetVkBufferUniform(frame_i),
-                    .offset = 0,
-                    .range = transform_ubo.GetUniformBufferObjectSize(),
-                };
-                descriptor_write.emplace_back(VkWriteDescriptorSet{
-                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .dstSet = graphics_descriptor_sets_.at(frame_i).GetVkDescriptorSet(model_i),
-                    .dstBinding = 0,
-                    .dstArrayElement = 0,
-                    .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                    .pBufferInfo = &transform_ubo_buffer_info,
-                });
-
-                const auto get_image_view = [&](const auto texture) -> VkImageView {
-                    if (texture == nullptr) {
-                        return VK_NULL_HANDLE;
-                    }
-                    return texture->GetImageView();
-                };
-
-                const auto base_color_image_view = get_image_view(model.GetBaseColorTexture());
-                const auto normal_image_view = get_image_view(model.GetNormalTexture());
-                const auto emissive_image_view = get_image_view(model.GetEmissiveTexture());
-                const auto occlusion_roughness_metallic_image_view =
-                    get_image_view(model.GetMetallicRoughnessTexture());
-
-                // color
-                const auto base_color_image_info = VkDescriptorImageInfo{
-                    .sampler = texture_samplers_.at(TextureSamplerType::kColor)->GetSampler(),
-                    .imageView = base_color_image_view,
-                    .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                };
-                descriptor_write.emplace_back(VkWriteDescriptorSet{
-                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .dstSet = graphics_descriptor_sets_.at(frame_i).GetVkDescriptorSet(model_i),
-                    .dstBinding = 1,
-                    .dstArrayElement = 0,
-                    .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                    .pImageInfo = &base_color_image_info,
-                });
-
-                // normal
-                const auto normal_image_info = VkDescriptorImageInfo{
-                    .sampler = texture_samplers_.at(TextureSamplerType::kNormal)->GetSampler(),
-                    .imageView = normal_image_view,
-                    .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                };
-                descriptor_write.emplace_back(VkWriteDescriptorSet{
-                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .dstSet = graphics_descriptor_sets_.at(frame_i).GetVkDescriptorSet(model_i),
-                    .dstBinding = 2,
-                    .dstArrayElement = 0,
-                    .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                    .pImageInfo = &normal_image_info,
-                });
+            const auto& descriptor_sets = graphics_descriptor_sets_.at(frame_i);
+            auto descriptor_write = std::vector<VkWriteDescriptorSet>();
+            // transform
+            const auto transform_ubo_buffer_info = VkDescriptorBufferInfo{
+                .buffer = transform_ubo.GetVkBufferUniform(frame_i),
+                .offset = 0,
+                .range = transform_ubo.GetUniformBufferObjectSize(),
+            };
+            descriptor_write.emplace_back(VkWriteDescriptorSet{
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptor_sets.GetVkDescriptorSet(0),
+                .dstBinding = 0,
+                .dstArrayElement = 0,
+                .descriptorCount = 1,
+                .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                .pBufferInfo = &transform_ubo_buffer_info,
+            });
+            // textures
+            descriptor_write.emplace_back(VkWriteDescriptorSet{
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptor_sets.GetVkDescriptorSet(0),
+                .dstBinding = 1,
+                .dstArrayElement = 0,
+                .descriptorCount = static_cast<uint32_t>(texture_image_infos.size()),
+                .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                .pImageInfo = texture_image_infos.data(),
+            });
 
-                // emissive
-                const auto emissive_image_info = VkDescriptorImageInfo{
-                    .sampler = texture_samplers_.at(TextureSamplerType::kEmissive)->GetSampler(),
-                    .imageView = emissive_image_view,
-                    .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                };
-                descriptor_write.emplace_back(VkWriteDescriptorSet{
-                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .dstSet = graphics_descriptor_sets_.at(frame_i).GetVkDescriptorSet(model_i),
-                    .dstBinding = 3,
-                    .dstArrayElement = 0,
-                    .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                    .pImageInfo = &emissive_image_info,
+            // materials, model transforms, then draw records, visible draw ids, vertex buffer of
+            // the indirect path
+            auto storage_buffers = std::vector<VkBuffer>{
+                materials_->GetVkBuffer(), model_transforms_.at(frame_i).GetVkBuffer()};
+            if (use_indirect) {
+                storage_buffers.emplace_back(indirect_draw_->GetDrawRecords().GetVkBuffer());
+                storage_buffers.emplace_back(
+                    indirect_draw_->GetVisibleDrawIds(frame_i).GetVkBuffer());
+                storage_buffers.emplace_back(indirect_draw_->GetVertexBuffer().GetVkBuffer());
+            }
+            auto buffer_infos = std::vector<VkDescriptorBufferInfo>();
+            for (const auto buffer : storage_buffers) {
+                buffer_infos.emplace_back(VkDescriptorBufferInfo{
+                    .buffer = buffer,
+                    .offset = 0,
+                    .range = VK_WHOLE_SIZE,
                 });
-
-                // metallic roughness
-                const auto occlusion_roughness_metallic_image_info = VkDescriptorImageInfo{
-                    .sampler =
-                        texture_samplers_.at(TextureSamplerType::kOcclusionRoughnessMetallic)
-                            ->GetSampler(),
-                    .imageView = occlusion_roughness_metallic_image_view,
-                    .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                };
+            }
+            for (uint32_t binding = 0; binding < buffer_infos.size(); binding++) {
                 descriptor_write.emplace_back(VkWriteDescriptorSet{
                     .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .dstSet = graphics_descriptor_sets_.at(frame_i).GetVkDescriptorSet(model_i),
-                    .dstBinding = 4,
+                    .dstSet = descriptor_sets.GetVkDescriptorSet(1),
+                    .dstBinding = binding,
                     .dstArrayElement = 0,
                     .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                    .pImageInfo = &occlusion_roughness_metallic_image_info,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .pBufferInfo = &buffer_infos[binding],
                 });
+            }
 
-                // material
-                const auto material_ubo_buffer_info = VkDescriptorBufferInfo{
-                    .buffer = model.GetMaterialUbo().GetVkBufferUniform(frame_i),
-                    .offset = 0,
-                    .range = model.GetMaterialUbo().GetUniformBufferObjectSize(),
-                };
-                descriptor_write.emplace_back(VkWriteDescriptorSet{
-                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .dstSet = graphics_descriptor_sets_.at(frame_i).GetVkDescriptorSet(model_i + 1),
-                    .dstBinding = 0,
-                    .dstArrayElement = 0,
-                    .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                    .pBufferInfo = &material_ubo_buffer_info,
+            // meshlets
+            auto meshlet_buffer_infos = std::vector<std::vector<VkDescriptorBufferInfo>>();
+            meshlet_buffer_infos.reserve(num_sets_per_model * num_model);
+            for (uint32_t model_i = 0; use_mesh_shader && model_i < num_model; model_i++) {
+                const auto& model = scene_.GetModels()[model_i];
+                const auto& meshlet_buffer = model.GetMeshletBuffer();
+                if (!meshlet_buffer) {
+                    throw std::runtime_error("model has no meshlets for the mesh shader path");
+                }
+                auto& infos = meshlet_buffer_infos.emplace_back();
+                for (const auto buffer : {meshlet_buffer->GetMeshlets().GetVkBuffer(),
+                                          meshlet_buffer->GetVertices().GetVkBuffer(),
+                                          meshlet_buffer->GetTriangles().GetVkBuffer()}) {
+                    infos.emplace_back(VkDescriptorBufferInfo{
+                        .buffer = buffer,
+                        .offset = 0,
+                        .range = VK_WHOLE_SIZE,
+                    });
+                }
+                // the model's range of the geometry pool
+                const auto& vertex_buffer = model.GetVertexBuffers()[0];
+                infos.emplace_back(VkDescriptorBufferInfo{
+                    .buffer = vertex_buffer.GetVkBuffer(),
+                    .offset = vertex_buffer.GetOffset(),
+                    .range = GetVertexStride(vertex_buffer.GetVertexFormat()) *
+                             vertex_buffer.GetSize(),
                 });
-
-                vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptor_write.size()),
-                                       descriptor_write.data(), 0, nullptr);
-                model_i += kNumDescriptorSetGraphics;
+                for (uint32_t binding = 0; binding < infos.size(); binding++) {
+                    descriptor_write.emplace_back(VkWriteDescriptorSet{
+                        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                        .dstSet =
+                            descriptor_sets.GetVkDescriptorSet(kNumDescriptorSetGraphics + model_i),
+                        .dstBinding = binding,
+                        .dstArrayElement = 0,
+                        .descriptorCount = 1,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .pBufferInfo = &infos[binding],
+                    });
+                }
             }
+
+            vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptor_write.size()),
+                                   descriptor_write.data(), 0, nullptr);
         }
     }();
 
@@ -746,15 +899,13 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
     [&]() {
         framebuffer_.reserve(kMaxFramesInFlight);
         for (size_t frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
-            const auto attachments = std::to_array(
-                {render_targets_.at(RenderTargetType::kColor)->GetVkImageView(),
-                 render_targets_.at(RenderTargetType::kNormal)->GetVkImageView(),
-                 render_targets_.at(RenderTargetType::kPosition)->GetVkImageView(),
-                 render_targets_.at(RenderTargetType::kEmissive)->GetVkImageView(),
-                 render_targets_.at(RenderTargetType::kBaseColorFactor)->GetVkImageView(),
-                 render_targets_.at(RenderTargetType::kMetallicRoughnessFactor)->GetVkImageView(),
-                 render_targets_.at(RenderTargetType::kMetallicRoughness)->GetVkImageView(),
-                 render_targets_.at(RenderTargetType::kDepthStencil)->GetVkImageView()});
+            const auto attachments = std::to_array({
+                render_targets_.at(RenderTargetType::kColor)->GetVkImageView(),
+                render_targets_.at(RenderTargetType::kNormal)->GetVkImageView(),
+                render_targets_.at(RenderTargetType::kEmissive)->GetVkImageView(),
+                render_targets_.at(RenderTargetType::kOcclusionRoughnessMetallic)->GetVkImageView(),
+                render_targets_.at(RenderTargetType::kDepthStencil)->GetVkImageView(),
+            });
             const auto framebuffer_info = VkFramebufferCreateInfo{
                 .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
                 .renderPass = render_pass_->GetVkRenderPass(),
@@ -777,16 +928,20 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                 .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
                 .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight) * 2,
             },
-            // depth
+            // color + normal + emissive + occlusion roughness metallic + depth
             VkDescriptorPoolSize{
                 .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-                .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight),
+                .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight) * 5,
             },
-            // color + normal + position + emissive + base color factor + metallic_roughness factor
-            // + finalized
+            // finalized
             VkDescriptorPoolSize{
                 .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight) * 7,
+                .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight),
+            },
+            // lights + light grid
+            VkDescriptorPoolSize{
+                .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight) * 2,
             },
         });
 
@@ -837,7 +992,7 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                 // color
                 VkDescriptorSetLayoutBinding{
                     .binding = 0,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
                     .descriptorCount = 1,
                     .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
                     .pImmutableSamplers = nullptr,
@@ -845,54 +1000,30 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                 // normal
                 VkDescriptorSetLayoutBinding{
                     .binding = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
                     .descriptorCount = 1,
                     .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
                     .pImmutableSamplers = nullptr,
                 },
-                // position
+                // emissive
                 VkDescriptorSetLayoutBinding{
                     .binding = 2,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
                     .descriptorCount = 1,
                     .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
                     .pImmutableSamplers = nullptr,
                 },
-                // emissive
+                // occlusion roughness metallic
                 VkDescriptorSetLayoutBinding{
                     .binding = 3,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                    .descriptorCount = 1,
-                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
-                    .pImmutableSamplers = nullptr,
-                },
-                // base color factor
-                VkDescriptorSetLayoutBinding{
-                    .binding = 4,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                    .descriptorCount = 1,
-                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
-                    .pImmutableSamplers = nullptr,
-                },
-                // metallic roughness factor
-                VkDescriptorSetLayoutBinding{
-                    .binding = 5,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                    .descriptorCount = 1,
-                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
-                    .pImmutableSamplers = nullptr,
-                },
-                // metallic roughness
-                VkDescriptorSetLayoutBinding{
-                    .binding = 6,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
                     .descriptorCount = 1,
                     .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
                     .pImmutableSamplers = nullptr,
                 },
                 // depth
                 VkDescriptorSetLayoutBinding{
-                    .binding = 7,
+                    .binding = 4,
                     .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
                     .descriptorCount = 1,
                     .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
@@ -900,7 +1031,7 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                 },
                 // output
                 VkDescriptorSetLayoutBinding{
-                    .binding = 8,
+                    .binding = 5,
                     .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
                     .descriptorCount = 1,
                     .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
@@ -919,10 +1050,18 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
         // set = 2
         {
             constexpr auto kLayoutBindings = std::to_array({
-                // light
+                // lights
                 VkDescriptorSetLayoutBinding{
                     .binding = 0,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                    .pImmutableSamplers = nullptr,
+                },
+                // light grid
+                VkDescriptorSetLayoutBinding{
+                    .binding = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                     .descriptorCount = 1,
                     .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
                     .pImmutableSamplers = nullptr,
@@ -968,8 +1107,12 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
     spdlog::debug("setup compute pipeline");
     [&]() {
         compute_pipeline_.reserve(kMaxFramesInFlight);
+        light_cull_pipeline_.reserve(kMaxFramesInFlight);
         const auto comp_path = std::filesystem::path("rasterize/deferred.comp.spv");
         const auto comp_shader = Shader(comp_path, VK_SHADER_STAGE_COMPUTE_BIT, device);
+        // the light culling pass binds a subset of the deferred pass resources
+        const auto light_cull_path = std::filesystem::path("rasterize/light_cull.comp.spv");
+        const auto light_cull_shader = Shader(light_cull_path, VK_SHADER_STAGE_COMPUTE_BIT, device);
 
         for (auto frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
             const auto pipeline_info = VkComputePipelineCreateInfo{
@@ -978,6 +1121,13 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                 .layout = compute_pipeline_layout_.at(frame_i).GetVkPipelineLayout(),
             };
             compute_pipeline_.emplace_back(device, pipeline_info);
+
+            const auto light_cull_pipeline_info = VkComputePipelineCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+                .stage = light_cull_shader.GetStageInfo(),
+                .layout = compute_pipeline_layout_.at(frame_i).GetVkPipelineLayout(),
+            };
+            light_cull_pipeline_.emplace_back(device, light_cull_pipeline_info);
         }
     }();
 
@@ -1015,34 +1165,20 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
             };
             const auto color_image_info = VkDescriptorImageInfo{
                 .imageView = render_targets_.at(RenderTargetType::kColor)->GetVkImageView(),
-                .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
             };
             const auto normal_image_info = VkDescriptorImageInfo{
                 .imageView = render_targets_.at(RenderTargetType::kNormal)->GetVkImageView(),
-                .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
-            };
-            const auto position_image_info = VkDescriptorImageInfo{
-                .imageView = render_targets_.at(RenderTargetType::kPosition)->GetVkImageView(),
-                .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
             };
             const auto emissive_image_info = VkDescriptorImageInfo{
                 .imageView = render_targets_.at(RenderTargetType::kEmissive)->GetVkImageView(),
-                .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
-            };
-            const auto base_color_factor_image_info = VkDescriptorImageInfo{
-                .imageView =
-                    render_targets_.at(RenderTargetType::kBaseColorFactor)->GetVkImageView(),
-                .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
-            };
-            const auto occlusion_roughnes_metallic_factor_image_info = VkDescriptorImageInfo{
-                .imageView = render_targets_.at(RenderTargetType::kMetallicRoughnessFactor)
-                                 ->GetVkImageView(),
-                .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
             };
             const auto occlusion_roughness_metallic_image_info = VkDescriptorImageInfo{
-                .imageView =
-                    render_targets_.at(RenderTargetType::kMetallicRoughness)->GetVkImageView(),
-                .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+                .imageView = render_targets_.at(RenderTargetType::kOcclusionRoughnessMetallic)
+                                 ->GetVkImageView(),
+                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
             };
             const auto depth_image_info = VkDescriptorImageInfo{
                 .imageView = render_targets_.at(RenderTargetType::kDepthStencil)->GetVkImageView(),
@@ -1052,10 +1188,15 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                 .imageView = render_targets_.at(RenderTargetType::kFinalized)->GetVkImageView(),
                 .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
             };
-            const auto light_ubo_buffer_info = VkDescriptorBufferInfo{
-                .buffer = light_ubo.GetVkBufferUniform(frame_i),
+            const auto light_buffer_info = VkDescriptorBufferInfo{
+                .buffer = light_buffer.GetVkBuffer(frame_i),
+                .offset = 0,
+                .range = light_buffer.GetSize(),
+            };
+            const auto light_grid_buffer_info = VkDescriptorBufferInfo{
+                .buffer = light_grid_->GetVkBuffer(),
                 .offset = 0,
-                .range = light_ubo.GetUniformBufferObjectSize(),
+                .range = light_grid_->GetSize(),
             };
             const auto descriptor_write = std::to_array({
                 VkWriteDescriptorSet{
@@ -1082,7 +1223,7 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                     .dstBinding = 0,
                     .dstArrayElement = 0,
                     .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
                     .pImageInfo = &color_image_info,
                 },
                 VkWriteDescriptorSet{
@@ -1091,7 +1232,7 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                     .dstBinding = 1,
                     .dstArrayElement = 0,
                     .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
                     .pImageInfo = &normal_image_info,
                 },
                 VkWriteDescriptorSet{
@@ -1100,8 +1241,8 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                     .dstBinding = 2,
                     .dstArrayElement = 0,
                     .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                    .pImageInfo = &position_image_info,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                    .pImageInfo = &emissive_image_info,
                 },
                 VkWriteDescriptorSet{
                     .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
@@ -1109,8 +1250,8 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                     .dstBinding = 3,
                     .dstArrayElement = 0,
                     .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                    .pImageInfo = &emissive_image_info,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                    .pImageInfo = &occlusion_roughness_metallic_image_info,
                 },
                 VkWriteDescriptorSet{
                     .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
@@ -1118,8 +1259,8 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                     .dstBinding = 4,
                     .dstArrayElement = 0,
                     .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                    .pImageInfo = &base_color_factor_image_info,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                    .pImageInfo = &depth_image_info,
                 },
                 VkWriteDescriptorSet{
                     .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
@@ -1128,43 +1269,25 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
                     .dstArrayElement = 0,
                     .descriptorCount = 1,
                     .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                    .pImageInfo = &occlusion_roughnes_metallic_factor_image_info,
-                },
-                VkWriteDescriptorSet{
-                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .dstSet = compute_descriptor_sets_.at(frame_i).GetVkDescriptorSet(1),
-                    .dstBinding = 6,
-                    .dstArrayElement = 0,
-                    .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                    .pImageInfo = &occlusion_roughness_metallic_image_info,
-                },
-                VkWriteDescriptorSet{
-                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .dstSet = compute_descriptor_sets_.at(frame_i).GetVkDescriptorSet(1),
-                    .dstBinding = 7,
-                    .dstArrayElement = 0,
-                    .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-                    .pImageInfo = &depth_image_info,
+                    .pImageInfo = &finalized_image_info,
                 },
                 VkWriteDescriptorSet{
                     .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .dstSet = compute_descriptor_sets_.at(frame_i).GetVkDescriptorSet(1),
-                    .dstBinding = 8,
+                    .dstSet = compute_descriptor_sets_.at(frame_i).GetVkDescriptorSet(2),
+                    .dstBinding = 0,
                     .dstArrayElement = 0,
                     .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                    .pImageInfo = &finalized_image_info,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .pBufferInfo = &light_buffer_info,
                 },
                 VkWriteDescriptorSet{
                     .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
                     .dstSet = compute_descriptor_sets_.at(frame_i).GetVkDescriptorSet(2),
-                    .dstBinding = 0,
+                    .dstBinding = 1,
                     .dstArrayElement = 0,
                     .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                    .pBufferInfo = &light_ubo_buffer_info,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .pBufferInfo = &light_grid_buffer_info,
                 },
             });
             vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptor_write.size()),
@@ -1174,9 +1297,12 @@ DrawRasterize::DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo
     spdlog::debug("setup done");
 }
 
-void DrawRasterize::RecordCommandBuffer(const uint32_t image_idx,
+void DrawRasterize::RecordCommandBuffer(const uint32_t frame_idx,
                                         const VkExtent2D& swapchain_extent,
-                                        const VkCommandBuffer command_buffer) {
+                                        const VkCommandBuffer command_buffer,
+                                        GpuProfiler& gpu_profiler) {
+    UpdateModelTransforms(frame_idx);
+
     constexpr auto kClearValues = std::to_array<VkClearValue>({
         // Color
         {
@@ -1192,13 +1318,6 @@ void DrawRasterize::RecordCommandBuffer(const uint32_t image_idx,
                     {0.0f, 0.0f, 0.0f, 1.0f},
                 },
         },
-        // Position
-        {
-            .color =
-                {
-                    {0.0f, 0.0f, 0.0f, 0.0f},
-                },
-        },
         // Emissive
         {
             .color =
@@ -1206,21 +1325,7 @@ void DrawRasterize::RecordCommandBuffer(const uint32_t image_idx,
                     {0.0f, 0.0f, 0.0f, 0.0f},
                 },
         },
-        // BaseColorFactor
-        {
-            .color =
-                {
-                    {0.0f, 0.0f, 0.0f, 0.0f},
-                },
-        },
-        // MetallicRoughnessFactor
-        {
-            .color =
-                {
-                    {0.0f, 0.0f, 0.0f, 0.0f},
-                },
-        },
-        // MetallicRoughness
+        // OcclusionRoughnessMetallic (no flags set)
         {
             .color =
                 {
@@ -1233,162 +1338,215 @@ void DrawRasterize::RecordCommandBuffer(const uint32_t image_idx,
         },
     });
 
-    const auto render_pass_info = VkRenderPassBeginInfo{
-        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-        .renderPass = render_pass_->GetVkRenderPass(),
-        .framebuffer = framebuffer_.at(image_idx).GetVkFrameBuffer(),
-        .renderArea =
-            {
-                .offset = {0, 0},
-                .extent = swapchain_extent,
-            },
-        .clearValueCount = static_cast<uint32_t>(kClearValues.size()),
-        .pClearValues = kClearValues.data(),
-    };
+    // the load pass of the late phase ignores the clear values
+    const auto begin_gbuffer_pass = [&](const RenderPass& render_pass) {
+        const auto render_pass_info = VkRenderPassBeginInfo{
+            .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+            .renderPass = render_pass.GetVkRenderPass(),
+            .framebuffer = framebuffer_.at(frame_idx).GetVkFrameBuffer(),
+            .renderArea =
+                {
+                    .offset = {0, 0},
+                    .extent = swapchain_extent,
+                },
+            .clearValueCount = static_cast<uint32_t>(kClearValues.size()),
+            .pClearValues = kClearValues.data(),
+        };
+        vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          graphics_pipeline_.at(frame_idx).GetVkGraphicsPipeline());
+        // bindless transform, textures and materials, shared by every draw
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                graphics_pipeline_layout_.at(frame_idx).GetVkPipelineLayout(), 0,
+                                static_cast<uint32_t>(kNumDescriptorSetGraphics),
+                                graphics_descriptor_sets_.at(frame_idx).GetVkDescriptorSetPtr(), 0,
+                                nullptr);
+
+        const auto viewport = VkViewport{
+            .x = 0.0f,
+            .y = 0.0f,
+            .width = static_cast<float>(swapchain_extent.width),
+            .height = static_cast<float>(swapchain_extent.height),
+            .minDepth = 0.0f,
+            .maxDepth = 1.0f,
+        };
+        vkCmdSetViewport(command_buffer, 0, 1, &viewport);
 
-    vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
-    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                      graphics_pipeline_.at(image_idx).GetVkGraphicsPipeline());
-
-    const auto viewport = VkViewport{
-        .x = 0.0f,
-        .y = 0.0f,
-        .width = static_cast<float>(swapchain_extent.width),
-        .height = static_cast<float>(swapchain_extent.height),
-        .minDepth = 0.0f,
-        .maxDepth = 1.0f,
+        const auto scissor = VkRect2D{
+            .offset = {0, 0},
+            .extent = swapchain_extent,
+        };
+        vkCmdSetScissor(command_buffer, 0, 1, &scissor);
     };
-    vkCmdSetViewport(command_buffer, 0, 1, &viewport);
 
-    const auto scissor = VkRect2D{
-        .offset = {0, 0},
-        .extent = swapchain_extent,
+    // gl_DrawID picks the record, which holds the material id
+    const auto record_indirect_draw = [&](const CullPhase phase) {
+        const auto indirect_push_constants = IndirectPushConstants{
+            .vertex_format = std::to_underlying(scene_.GetVertexFormat()),
+            .draw_id_offset = indirect_draw_->GetDrawIdOffset(phase),
+        };
+        vkCmdPushConstants(command_buffer,
+                           graphics_pipeline_layout_.at(frame_idx).GetVkPipelineLayout(),
+                           VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(IndirectPushConstants),
+                           &indirect_push_constants);
+        indirect_draw_->RecordDraw(frame_idx, command_buffer, phase);
     };
-    vkCmdSetScissor(command_buffer, 0, 1, &scissor);
-
-    for (auto model_i = 0; const auto& model : scene_.GetModels()) {
-        const auto vertex_buffers =
-            std::vector<VkBuffer>{model.GetVertexBuffers()[0].GetVkBuffer()};
-        const auto offsets = std::vector<VkDeviceSize>{0};
-        vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers.data(), offsets.data());
-        vkCmdBindIndexBuffer(command_buffer, model.GetIndexBuffers()[0].GetVkBuffer(), 0,
-                             VK_INDEX_TYPE_UINT16);
-        const auto descriptor_set = std::to_array({
-            graphics_descriptor_sets_.at(image_idx).GetVkDescriptorSet(model_i),
-            graphics_descriptor_sets_.at(image_idx).GetVkDescriptorSet(model_i + 1),
-        });
-        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                graphics_pipeline_layout_.at(image_idx).GetVkPipelineLayout(), 0,
-                                static_cast<uint32_t>(descriptor_set.size()), descriptor_set.data(),
-                                0, nullptr);
-        vkCmdDrawIndexed(command_buffer,
-                         static_cast<uint32_t>(model.GetIndexBuffers()[0].GetSize()), 1, 0, 0, 0);
-        model_i += kNumDescriptorSetGraphics;
+
+    const auto& camera_pos = camera_.GetPosition();
+    const auto pixels_per_unit = 0.5f * static_cast<float>(swapchain_extent.height) *
+                                 std::abs(camera_.GetProjectionMatrix()[1][1]);
+    if (indirect_draw_) {
+        indirect_draw_->Resolve(frame_idx);
+        gpu_profiler.BeginScope(frame_idx, command_buffer, "draw culling");
+        indirect_draw_->RecordCulling(frame_idx, command_buffer, CullPhase::kEarly, camera_pos,
+                                      pixels_per_unit);
+        gpu_profiler.EndScope(frame_idx, command_buffer);
+    }
+
+    gpu_profiler.BeginScope(frame_idx, command_buffer, "gbuffer");
+    begin_gbuffer_pass(render_pass_.value());
+    if (indirect_draw_) {
+        record_indirect_draw(CullPhase::kEarly);
+    } else {
+        for (uint32_t model_i = 0; model_i < scene_.GetModels().size(); model_i++) {
+            const auto& model = scene_.GetModels()[model_i];
+            const auto& quantization = model.GetVertexBuffers()[0].GetQuantization();
+
+            if (geometry_path_ == GeometryPath::kMeshShader) {
+                // only the meshlet buffers are bound per model
+                const auto meshlet_set = graphics_descriptor_sets_.at(frame_idx).GetVkDescriptorSet(
+                    kNumDescriptorSetGraphics + model_i);
+                vkCmdBindDescriptorSets(
+                    command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    graphics_pipeline_layout_.at(frame_idx).GetVkPipelineLayout(),
+                    kNumDescriptorSetGraphics, 1, &meshlet_set, 0, nullptr);
+                // one task workgroup culls kMeshletsPerTask meshlets; LOD 0 only, the culling
+                // already drops the clusters a coarser level would save
+                const auto meshlet_count = model.GetMeshletBuffer()->GetMeshletCount();
+                const auto meshlet_push_constants = MeshletPushConstants{
+                    .dequantize_scale = glm::vec4(quantization.scale, 0.0f),
+                    .dequantize_offset = glm::vec4(quantization.offset, 0.0f),
+                    .camera_position = glm::vec4(camera_pos, 1.0f),
+                    .vertex_format = std::to_underlying(scene_.GetVertexFormat()),
+                    .meshlet_count = meshlet_count,
+                    .material_id = model_i,
+                };
+                vkCmdPushConstants(command_buffer,
+                                   graphics_pipeline_layout_.at(frame_idx).GetVkPipelineLayout(),
+                                   VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, 0,
+                                   sizeof(MeshletPushConstants), &meshlet_push_constants);
+                const auto task_count = (meshlet_count + kMeshletsPerTask - 1) / kMeshletsPerTask;
+                vkCmdDrawMeshTasksEXT(command_buffer, task_count, 1, 1);
+                continue;
+            }
+
+            const auto vertex_buffers =
+                std::vector<VkBuffer>{model.GetVertexBuffers()[0].GetVkBuffer()};
+            const auto offsets = std::vector<VkDeviceSize>{model.GetVertexBuffers()[0].GetOffset()};
+            vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers.data(), offsets.data());
+            const auto& index_buffer =
+                model.GetIndexBuffers()[SelectLod(model, camera_pos, pixels_per_unit)];
+            vkCmdBindIndexBuffer(command_buffer, index_buffer.GetVkBuffer(),
+                                 index_buffer.GetOffset(), index_buffer.GetIndexType());
+            const auto vertex_push_constants = VertexPushConstants{
+                .dequantize_scale = glm::vec4(quantization.scale, 0.0f),
+                .dequantize_offset = glm::vec4(quantization.offset, 0.0f),
+                .material_id = model_i,
+            };
+            vkCmdPushConstants(command_buffer,
+                               graphics_pipeline_layout_.at(frame_idx).GetVkPipelineLayout(),
+                               VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VertexPushConstants),
+                               &vertex_push_constants);
+            vkCmdDrawIndexed(command_buffer, static_cast<uint32_t>(index_buffer.GetSize()), 1, 0,
+                             0, 0);
+        }
     }
 
     spdlog::debug("End render pass");
     vkCmdEndRenderPass(command_buffer);
+    gpu_profiler.EndScope(frame_idx, command_buffer);
+
+    // late occlusion phase: test against the early depth and draw what it missed
+    if (indirect_draw_) {
+        gpu_profiler.BeginScope(frame_idx, command_buffer, "hi-z");
+        hiz_pyramid_->RecordBuild(command_buffer);
+        gpu_profiler.EndScope(frame_idx, command_buffer);
+
+        gpu_profiler.BeginScope(frame_idx, command_buffer, "occlusion culling");
+        indirect_draw_->RecordCulling(frame_idx, command_buffer, CullPhase::kLate, camera_pos,
+                                      pixels_per_unit);
+        gpu_profiler.EndScope(frame_idx, command_buffer);
+
+        gpu_profiler.BeginScope(frame_idx, command_buffer, "gbuffer late");
+        begin_gbuffer_pass(render_pass_load_.value());
+        record_indirect_draw(CullPhase::kLate);
+        vkCmdEndRenderPass(command_buffer);
+        gpu_profiler.EndScope(frame_idx, command_buffer);
+    }
 
     // compute
     spdlog::debug("Compute");
 
-    // Transition
+    // the render pass leaves the G-buffer and depth in read-only layouts for the dispatches
     [&]() {
-        // normal: write -> read
-        const auto barrier = VkImageMemoryBarrier{
-            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-            .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT,
-            .oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .image = render_targets_.at(RenderTargetType::kNormal)->GetVkImage(),
-            .subresourceRange =
-                {
-                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                    .baseMipLevel = 0,
-                    .levelCount = 1,
-                    .baseArrayLayer = 0,
-                    .layerCount = 1,
-                },
+        const auto div_up = [](const uint32_t x, const uint32_t y) -> uint32_t {
+            return (x + y - 1) / y;
         };
-        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1,
-                             &barrier);
-    }();
+        // both passes run one 16x16 workgroup per light tile
+        const auto group_count_x = div_up(swapchain_extent.width, kLightTileSize);
+        const auto group_count_y = div_up(swapchain_extent.height, kLightTileSize);
+        vkCmdBindDescriptorSets(
+            command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+            compute_pipeline_layout_.at(frame_idx).GetVkPipelineLayout(), 0,
+            static_cast<uint32_t>(compute_descriptor_sets_.at(frame_idx).GetSize()),
+            compute_descriptor_sets_.at(frame_idx).GetVkDescriptorSetPtr(), 0, nullptr);
 
-    [&]() {
-        // depth: write -> read
-        const auto barrier = VkImageMemoryBarrier{
-            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-            .srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-            .dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
-            .oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-            .newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+        // light culling
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                          light_cull_pipeline_.at(frame_idx).GetVkComputePipeline());
+        gpu_profiler.BeginScope(frame_idx, command_buffer, "light culling");
+        vkCmdDispatch(command_buffer, group_count_x, group_count_y, 1);
+        gpu_profiler.EndScope(frame_idx, command_buffer);
+
+        // light grid: write -> read
+        const auto barrier = VkBufferMemoryBarrier{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
             .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
             .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .image = render_targets_.at(RenderTargetType::kDepthStencil)->GetVkImage(),
-            .subresourceRange =
-                {
-                    .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
-                    .baseMipLevel = 0,
-                    .levelCount = 1,
-                    .baseArrayLayer = 0,
-                    .layerCount = 1,
-                },
+            .buffer = light_grid_->GetVkBuffer(),
+            .offset = 0,
+            .size = VK_WHOLE_SIZE,
         };
-        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
-                             VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, 0, 0, nullptr, 0, nullptr, 1,
-                             &barrier);
-    }();
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &barrier, 0,
+                             nullptr);
 
-    [&]() {
-        const auto div_up = [](const uint32_t x, const uint32_t y) -> uint32_t {
-            return (x + y - 1) / y;
-        };
-        // thread size is 16x16 in the shader
-        const auto group_count_x = div_up(swapchain_extent.width, 16);
-        const auto group_count_y = div_up(swapchain_extent.height, 16);
+        // shading
         vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
-                          compute_pipeline_.at(image_idx).GetVkComputePipeline());
+                          compute_pipeline_.at(frame_idx).GetVkComputePipeline());
 
         const auto mode = ModePushConstants{.mode = mode_};
         vkCmdPushConstants(command_buffer,
-                           compute_pipeline_layout_.at(image_idx).GetVkPipelineLayout(),
+                           compute_pipeline_layout_.at(frame_idx).GetVkPipelineLayout(),
                            VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ModePushConstants), &mode);
-        vkCmdBindDescriptorSets(
-            command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
-            compute_pipeline_layout_.at(image_idx).GetVkPipelineLayout(), 0,
-            static_cast<uint32_t>(compute_descriptor_sets_.at(image_idx).GetSize()),
-            compute_descriptor_sets_.at(image_idx).GetVkDescriptorSetPtr(), 0, nullptr);
+        gpu_profiler.BeginScope(frame_idx, command_buffer, "deferred");
         vkCmdDispatch(command_buffer, group_count_x, group_count_y, 1);
+        gpu_profiler.EndScope(frame_idx, command_buffer);
     }();
+}
 
-    [&]() {
-        // depth: read -> write
-        const auto barrier = VkImageMemoryBarrier{
-            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-            .srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
-            .dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-            .oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
-            .newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .image = render_targets_.at(RenderTargetType::kDepthStencil)->GetVkImage(),
-            .subresourceRange =
-                {
-                    .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
-                    .baseMipLevel = 0,
-                    .levelCount = 1,
-                    .baseArrayLayer = 0,
-                    .layerCount = 1,
-                },
-        };
-        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
-                             VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, 0, 0, nullptr, 0, nullptr, 1,
-                             &barrier);
-    }();
+void DrawRasterize::UpdateModelTransforms(const uint32_t frame_idx) {
+    auto& version = model_transform_versions_.at(frame_idx);
+    if (version == scene_.GetTransformVersion()) {
+        return;
+    }
+    // the fence of this frame has been waited on, so its buffer is no longer read
+    const auto transforms = GetModelTransforms(scene_);
+    model_transforms_.at(frame_idx).UpdateBuffer(transforms.data(),
+                                                 sizeof(glm::mat4) * transforms.size());
+    version = scene_.GetTransformVersion();
 }
 
 void DrawRasterize::OnRecreateSwapChain([[maybe_unused]] const DeviceResource& device_resource) {}
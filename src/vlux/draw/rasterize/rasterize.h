@@ -4,6 +4,7 @@
 #include "pch.h"
 //
 #include "camera.h"
+#include "common/buffer.h"
 #include "common/compute_pipeline.h"
 #include "common/descriptor_pool.h"
 #include "common/descriptor_set_layout.h"
@@ -14,6 +15,7 @@
 #include "common/pipeline_layout.h"
 #include "common/render_pass.h"
 #include "draw/draw_strategy.h"
+#include "indirect_draw.h"
 #include "light.h"
 #include "scene/scene.h"
 #include "texture/texture_sampler.h"
@@ -26,16 +28,60 @@ struct ModePushConstants {
     uint32_t mode;
 };
 
+//! dequantization of `VertexFormat::kCompact` positions, see shader_compact.vert
+struct VertexPushConstants {
+    glm::vec4 dequantize_scale;
+    glm::vec4 dequantize_offset;
+    //! index into the material buffer and the texture arrays
+    uint32_t material_id;
+};
+
+//! `VertexPushConstants` followed by what the task and mesh shaders need, see meshlet.glsl
+struct MeshletPushConstants {
+    glm::vec4 dequantize_scale;
+    glm::vec4 dequantize_offset;
+    //! world space
+    glm::vec4 camera_position;
+    //! `VertexFormat`
+    uint32_t vertex_format;
+    uint32_t meshlet_count;
+    //! see `VertexPushConstants::material_id`
+    uint32_t material_id;
+};
+
+//! per-draw data of `GeometryPath::kIndirect` comes from the draw records, see shader_indirect.vert
+struct IndirectPushConstants {
+    //! `VertexFormat`
+    uint32_t vertex_format;
+    //! `IndirectDraw::GetDrawIdOffset` of the drawn phase
+    uint32_t draw_id_offset;
+};
+
+//! how the G-buffer pass produces its triangles
+enum class GeometryPath {
+    //! vertex shader over the index buffer of the selected LOD
+    kVertex,
+    //! task shader culls the meshlets of LOD 0, mesh shader emits the survivors;
+    //! requires `Device::IsMeshShaderEnabled()`
+    kMeshShader,
+    //! a compute pass culls whole models and selects their LOD, then one indirect draw call
+    //! renders the survivors from the scene's `GeometryPool`; occlusion is culled in
+    //! two phases against a Hi-Z pyramid
+    kIndirect,
+};
+
 class DrawRasterize final : public DrawStrategy {
    public:
     DrawRasterize(const UniformBuffer<TransformParams>& transform_ubo,
                   const UniformBuffer<CameraParams>& camera_ubo,
-                  const UniformBuffer<LightParams>& light_ubo, Scene& scene,
-                  const DeviceResource& device_resource);
+                  const LightBuffer& light_buffer, const Camera& camera, Scene& scene,
+                  const DeviceResource& device_resource,
+                  const GeometryPath geometry_path = GeometryPath::kVertex);
     ~DrawRasterize() override = default;
 
-    void RecordCommandBuffer(const uint32_t image_idx, const VkExtent2D& swapchain_extent,
-                             const VkCommandBuffer command_buffer) override;
+    void RecordCommandBuffer(const uint32_t frame_idx, const VkExtent2D& swapchain_extent,
+                             const VkCommandBuffer command_buffer,
+                             GpuProfiler& gpu_profiler) override;
 
     void OnRecreateSwapChain(const DeviceResource& device_resource) override;
     const ImageBuffer& GetOutputRenderTarget() const override {
@@ -45,15 +91,44 @@ class DrawRasterize final : public DrawStrategy {
     void SetMode(const uint32_t mode) override { mode_ = mode; }
     uint32_t GetMode() const override { return mode_; }
 
+    std::optional<CullingStats> GetCullingStats() const override {
+        if (!indirect_draw_) {
+            return std::nullopt;
+        }
+        return indirect_draw_->GetCullingStats();
+    }
+
    private:
+    //! rewrites `model_transforms_` of the frame if the scene's transforms changed since
+    void UpdateModelTransforms(const uint32_t frame_idx);
+
+    //! picks the LOD level of every model
+    const Camera& camera_;
     const Scene& scene_;
+    const GeometryPath geometry_path_;
+
+    PFN_vkCmdDrawMeshTasksEXT vkCmdDrawMeshTasksEXT = nullptr;
+
+    //! geometry and culling of `GeometryPath::kIndirect`
+    std::optional<HiZPyramid> hiz_pyramid_;
+    std::optional<IndirectDraw> indirect_draw_;
+
+    //! `MaterialParams` by material id, i.e. model index
+    std::optional<Buffer> materials_;
+    //! (kMaxFramesInFlight,) `Model::GetTransform` by material id, see model_transform.glsl
+    std::vector<Buffer> model_transforms_;
+    //! `Scene::GetTransformVersion` each of `model_transforms_` was written at
+    std::array<uint64_t, kMaxFramesInFlight> model_transform_versions_{};
 
     std::optional<RenderPass> render_pass_;
+    //! `render_pass_` that keeps the attachments, for the late phase of `GeometryPath::kIndirect`
+    std::optional<RenderPass> render_pass_load_;
 
     std::optional<DescriptorPool> graphics_descriptor_pool_;
     //! (kMaxFramesInFlight,)
     std::vector<DescriptorSets> graphics_descriptor_sets_;
-    //! (kNumDescriptorSetGraphics,)
+    //! (kNumDescriptorSetGraphics,), plus the meshlet set of `GeometryPath::kMeshShader`;
+    //! sets 0 and 1 are bindless and shared by all models, only the meshlet set is per model
     std::vector<DescriptorSetLayout> graphics_descriptor_set_layout_;
     //! (kMaxFramesInFlight,)
     std::vector<PipelineLayout> graphics_pipeline_layout_;
@@ -69,32 +144,27 @@ class DrawRasterize final : public DrawStrategy {
     std::vector<PipelineLayout> compute_pipeline_layout_;
     //! (kMaxFramesInFlight,)
     std::vector<ComputePipeline> compute_pipeline_;
+    //! (kMaxFramesInFlight,) bins the lights into screen tiles; shares the compute pipeline layout
+    std::vector<ComputePipeline> light_cull_pipeline_;
     //! (kMaxFramesInFlight,)
     std::vector<FrameBuffer> framebuffer_;
+    //! per screen tile, the number of lights followed by their indices
+    std::optional<Buffer> light_grid_;
 
-    // render targets
+    // render targets; the G-buffer layout is documented in shader/rasterize/gbuffer.glsl
     enum class RenderTargetType {
         kColor,
         kNormal,
         kDepthStencil,
-        kPosition,
         kEmissive,
-        kBaseColorFactor,
-        kMetallicRoughnessFactor,
-        kMetallicRoughness,
+        kOcclusionRoughnessMetallic,
         kFinalized,
         kCount
     };
     std::unordered_map<RenderTargetType, std::optional<ImageBuffer>> render_targets_;
 
-    enum class TextureSamplerType {
-        kColor,
-        kNormal,
-        kEmissive,
-        kOcclusionRoughnessMetallic,
-        kCount
-    };
-    std::unordered_map<TextureSamplerType, std::optional<TextureSampler>> texture_samplers_;
+    //! of every texture in set 0
+    std::optional<TextureSampler> texture_sampler_;
 
     // mode
     uint32_t mode_{0};
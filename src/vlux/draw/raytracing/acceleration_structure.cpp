@@ -1,12 +1,20 @@
 #include "acceleration_structure.h"
 
-#include "common/utils.h"
-
 namespace vlux::draw::raytracing {
+VkTransformMatrixKHR ToVkTransformMatrix(const glm::mat4& transform) {
+    auto matrix = VkTransformMatrixKHR{};
+    for (auto row = 0; row < 3; row++) {
+        for (auto col = 0; col < 4; col++) {
+            matrix.matrix[row][col] = transform[col][row];
+        }
+    }
+    return matrix;
+}
+
 AccelerationStructure::AccelerationStructure(
     const VkDevice device, const VkPhysicalDevice physical_device,
     const VkAccelerationStructureBuildSizesInfoKHR build_size_info)
-    : device_(device) {
+    : device_(device), size_(build_size_info.accelerationStructureSize) {
     const auto buffer_create_info = VkBufferCreateInfo{
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         .size = build_size_info.accelerationStructureSize,
@@ -28,34 +36,31 @@ AccelerationStructure::AccelerationStructure(
     };
     // VkAccelerationStructureMemoryRequirementsInfoKHR{};
     vkGetBufferMemoryRequirements2(device, &memory_requirements_info, &memory_requirements);
-    const auto memory_allocate_frags_info = VkMemoryAllocateFlagsInfo{
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
-        .flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR,
-    };
-    const auto memory_allocate_info = VkMemoryAllocateInfo{
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = &memory_allocate_frags_info,
-        .allocationSize = memory_requirements.memoryRequirements.size,
-        .memoryTypeIndex = FindMemoryType(memory_requirements.memoryRequirements.memoryTypeBits,
-                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, physical_device),
-    };
-    if (vkAllocateMemory(device, &memory_allocate_info, nullptr, &memory_) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to allocate memory for acceleration structure");
-    }
-    if (vkBindBufferMemory(device, buffer_, memory_, 0) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to bind memory to acceleration structure buffer");
-    }
+    // acceleration structures must start at a multiple of 256 bytes
+    auto requirements = memory_requirements.memoryRequirements;
+    requirements.alignment = std::max(requirements.alignment, VkDeviceSize{256});
+    allocation_ = GetMemoryAllocator(device, physical_device)
+                      .Allocate(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                AllocationType::kLinear);
+    allocation_.BindBuffer(device, buffer_);
 }
 
 AccelerationStructure::~AccelerationStructure() {
+    if (handle_ != VK_NULL_HANDLE) {
+        vkDestroyAccelerationStructureKHR = reinterpret_cast<PFN_vkDestroyAccelerationStructureKHR>(
+            vkGetDeviceProcAddr(device_, "vkDestroyAccelerationStructureKHR"));
+        vkDestroyAccelerationStructureKHR(device_, handle_, nullptr);
+    }
     if (buffer_ != VK_NULL_HANDLE) {
         vkDestroyBuffer(device_, buffer_, nullptr);
     }
-    if (memory_ != VK_NULL_HANDLE) {
-        vkFreeMemory(device_, memory_, nullptr);
-    }
-    vkDestroyAccelerationStructureKHR = reinterpret_cast<PFN_vkDestroyAccelerationStructureKHR>(
-        vkGetDeviceProcAddr(device_, "vkDestroyAccelerationStructureKHR"));
-    vkDestroyAccelerationStructureKHR(device_, handle_, nullptr);
 }
+
+AccelerationStructure::AccelerationStructure(AccelerationStructure&& other) noexcept
+    : device_(other.device_),
+      handle_(std::exchange(other.handle_, VK_NULL_HANDLE)),
+      device_address_(std::exchange(other.device_address_, 0)),
+      allocation_(std::move(other.allocation_)),
+      buffer_(std::exchange(other.buffer_, VK_NULL_HANDLE)),
+      size_(std::exchange(other.size_, 0)) {}
 }  // namespace vlux::draw::raytracing
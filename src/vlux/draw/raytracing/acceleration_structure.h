@@ -2,31 +2,43 @@
 #define DRAW_RAYTRACING_ACCELERATION_STRUCTURE_H
 
 #include "pch.h"
+//
+#include "common/memory_allocator.h"
 
 namespace vlux::draw::raytracing {
+//! glm is column major, VkTransformMatrixKHR is a row-major 3x4
+VkTransformMatrixKHR ToVkTransformMatrix(const glm::mat4& transform);
+
 class AccelerationStructure {
    public:
     AccelerationStructure() = default;
     AccelerationStructure(const VkDevice device, const VkPhysicalDevice physical_device,
                           const VkAccelerationStructureBuildSizesInfoKHR build_size_info);
     ~AccelerationStructure();
+    AccelerationStructure(const AccelerationStructure&) = delete;
+    AccelerationStructure& operator=(const AccelerationStructure&) = delete;
+    AccelerationStructure(AccelerationStructure&& other) noexcept;
+    AccelerationStructure& operator=(AccelerationStructure&&) = delete;
 
     VkBuffer GetBuffer() const { return buffer_; }
+    //! bytes of the acceleration structure storage
+    VkDeviceSize GetSize() const { return size_; }
     VkAccelerationStructureKHR GetHandle() const { return handle_; }
     VkAccelerationStructureKHR& MutableHandle() { return handle_; }
     void SetDeviceAddress(const uint64_t device_address) { device_address_ = device_address; }
     uint64_t GetDeviceAddress() const { return device_address_; }
 
    private:
-    VkDevice device_;
-    VkAccelerationStructureKHR handle_;
-    uint64_t device_address_;
-    VkDeviceMemory memory_;
-    VkBuffer buffer_;
+    VkDevice device_ = VK_NULL_HANDLE;
+    VkAccelerationStructureKHR handle_ = VK_NULL_HANDLE;
+    uint64_t device_address_ = 0;
+    MemoryAllocation allocation_;
+    VkBuffer buffer_ = VK_NULL_HANDLE;
+    VkDeviceSize size_ = 0;
 
     PFN_vkDestroyAccelerationStructureKHR vkDestroyAccelerationStructureKHR;
 };
 
 }  // namespace vlux::draw::raytracing
 
-#endif
\ No newline at end of file
+#endif
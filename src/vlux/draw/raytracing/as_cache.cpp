@@ -0,0 +1,89 @@
+#include "as_cache.h"
+
+namespace vlux::draw::raytracing {
+namespace {
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+uint64_t HashValue(const T& value, const uint64_t hash) {
+    return HashBytes(std::as_bytes(std::span(&value, 1)), hash);
+}
+}  // namespace
+
+uint64_t HashBlasGeometry(const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer,
+                          const VkBuildAccelerationStructureFlagsKHR build_flags) {
+    // the dequantization is baked into the build as its transform
+    const auto& quantization = vertex_buffer.GetQuantization();
+    auto hash = HashValue(vertex_buffer.GetContentHash(), kFnv1aOffsetBasis);
+    hash = HashValue(index_buffer.GetContentHash(), hash);
+    hash = HashValue(vertex_buffer.GetVertexFormat(), hash);
+    hash = HashValue(index_buffer.GetIndexType(), hash);
+    hash = HashValue(quantization.scale, hash);
+    hash = HashValue(quantization.offset, hash);
+    return HashValue(build_flags, hash);
+}
+
+std::array<uint8_t, VK_UUID_SIZE> GetDriverUUID(const VkPhysicalDevice physical_device) {
+    auto id_properties = VkPhysicalDeviceIDProperties{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES,
+    };
+    auto properties = VkPhysicalDeviceProperties2{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &id_properties,
+    };
+    vkGetPhysicalDeviceProperties2(physical_device, &properties);
+    auto driver_uuid = std::array<uint8_t, VK_UUID_SIZE>();
+    std::ranges::copy(id_properties.driverUUID, driver_uuid.begin());
+    return driver_uuid;
+}
+
+std::filesystem::path GetASCachePath(const std::filesystem::path& cache_dir,
+                                     const uint64_t geometry_hash,
+                                     std::span<const uint8_t, VK_UUID_SIZE> driver_uuid) {
+    auto driver = std::string();
+    for (const auto byte : driver_uuid) {
+        driver += fmt::format("{:02x}", byte);
+    }
+    return cache_dir / fmt::format("{:016x}-{}.blas", geometry_hash, driver);
+}
+
+std::optional<SerializedASHeader> ParseSerializedASHeader(std::span<const std::byte> data) {
+    if (data.size() < sizeof(SerializedASHeader)) {
+        return std::nullopt;
+    }
+    auto header = SerializedASHeader{};
+    std::memcpy(&header, data.data(), sizeof(SerializedASHeader));
+    if (header.serialized_size != data.size() || header.deserialized_size == 0 ||
+        header.handle_count != 0) {
+        return std::nullopt;
+    }
+    return header;
+}
+
+bool WriteASCacheFile(const std::filesystem::path& path, std::span<const std::byte> data) {
+    auto error = std::error_code();
+    std::filesystem::create_directories(path.parent_path(), error);
+    if (error) {
+        return false;
+    }
+    auto temp_path = path;
+    temp_path += ".tmp";
+    {
+        auto file = std::ofstream(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(data.data()),
+                   static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, path, error);
+    if (error) {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace vlux::draw::raytracing
@@ -0,0 +1,69 @@
+#ifndef DRAW_RAYTRACING_AS_CACHE_H
+#define DRAW_RAYTRACING_AS_CACHE_H
+
+#include "pch.h"
+//
+#include <span>
+
+#include "model/index.h"
+#include "model/vertex.h"
+#include "utils/hash.h"
+
+namespace vlux::draw::raytracing {
+
+/**
+ * @brief Content hash of everything a bottom level build reads
+ *
+ * @param vertex_buffer
+ * @param index_buffer
+ * @param build_flags
+ * @return uint64_t equal hashes build identical acceleration structures on the same driver
+ */
+uint64_t HashBlasGeometry(const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer,
+                          const VkBuildAccelerationStructureFlagsKHR build_flags);
+
+//! `VkPhysicalDeviceIDProperties::driverUUID`
+std::array<uint8_t, VK_UUID_SIZE> GetDriverUUID(const VkPhysicalDevice physical_device);
+
+/**
+ * @brief File of a serialized bottom level acceleration structure
+ *
+ * The driver UUID is part of the name, so drivers never read each other's files; the
+ * `accelerationStructureUUID` in the header is checked when the file is loaded.
+ */
+std::filesystem::path GetASCachePath(const std::filesystem::path& cache_dir,
+                                     const uint64_t geometry_hash,
+                                     std::span<const uint8_t, VK_UUID_SIZE> driver_uuid);
+
+//! leading bytes of `VK_COPY_ACCELERATION_STRUCTURE_MODE_SERIALIZE_KHR` output
+struct SerializedASHeader {
+    std::array<uint8_t, VK_UUID_SIZE> driver_uuid;
+    //! `accelerationStructureUUID`, see `vkGetDeviceAccelerationStructureCompatibilityKHR`
+    std::array<uint8_t, VK_UUID_SIZE> compatibility_uuid;
+    //! of the whole blob, header included
+    uint64_t serialized_size;
+    //! `VkAccelerationStructureCreateInfoKHR::size` to deserialize into
+    uint64_t deserialized_size;
+    //! bottom level handles that follow the header; 0 for a bottom level structure
+    uint64_t handle_count;
+};
+static_assert(sizeof(SerializedASHeader) == 56);
+
+/**
+ * @brief Read the header of a serialized acceleration structure
+ *
+ * @return std::optional<SerializedASHeader> nullopt if `data` is truncated or not a serialized
+ * bottom level acceleration structure
+ */
+std::optional<SerializedASHeader> ParseSerializedASHeader(std::span<const std::byte> data);
+
+/**
+ * @brief Write through a temporary file, so an interrupted run leaves no partial file behind
+ *
+ * @return bool false if the file could not be written; the cache is then left as it was
+ */
+bool WriteASCacheFile(const std::filesystem::path& path, std::span<const std::byte> data);
+
+}  // namespace vlux::draw::raytracing
+
+#endif
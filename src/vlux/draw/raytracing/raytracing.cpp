@@ -4,16 +4,46 @@
 
 #include <cstdint>
 
+#include "as_cache.h"
 #include "common/buffer.h"
 #include "common/descriptor_set_layout.h"
+#include "common/suballocator.h"
 #include "model/index.h"
 #include "model/vertex.h"
-#include "scratch_buffer.h"
 #include "shader/shader.h"
+#include "utils/io.h"
 #include "utils/math.h"
 namespace vlux::draw::raytracing {
 namespace {
 constexpr auto kNumDescriptorSetRaytracing = 3;
+//! scratch bytes shared by the bottom level builds of one batch
+constexpr auto kBlasScratchBudget = VkDeviceSize{256} << 20;
+//! refits degrade the top level acceleration structure, so it is rebuilt after this many
+constexpr auto kTlasUpdatesPerBuild = uint32_t{64};
+constexpr auto kTlasFlags = VkBuildAccelerationStructureFlagsKHR{
+    VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+    VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_DATA_ACCESS_KHR |
+    VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR};
+//! of the device addresses serialized acceleration structures are copied to and from
+constexpr auto kSerializedASAlignment = uint64_t{256};
+
+VkBuildAccelerationStructureFlagsKHR GetBlasFlags(const RaytracingOptions& options) {
+    auto flags = VkBuildAccelerationStructureFlagsKHR{
+        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+        VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_DATA_ACCESS_KHR};
+    if (options.compact_blas) {
+        flags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
+    }
+    return flags;
+}
+}  // namespace
+
+RaytracingOptions ParseRaytracingOptions(const nlohmann::json& config) {
+    const auto defaults = RaytracingOptions{};
+    return {
+        .compact_blas = config.value("compact_blas", defaults.compact_blas),
+        .as_cache_dir = config.value("as_cache_dir", defaults.as_cache_dir),
+    };
 }
 
 DrawRaytracing::DrawRaytracing(const UniformBuffer<TransformParams>& transform_ubo,
@@ -21,11 +51,12 @@ DrawRaytracing::DrawRaytracing(const UniformBuffer<TransformParams>& transform_u
                                const UniformBuffer<CameraMatrixParams>& camera_matrix_ubo,
                                const UniformBuffer<LightParams>& light_ubo, Scene& scene,
                                const VkQueue queue, const VkCommandPool command_pool,
-                               const DeviceResource& device_resource)
-    : scene_(scene), device_(device_resource.GetDevice().GetVkDevice()) {
+                               const DeviceResource& device_resource,
+                               const RaytracingOptions& options)
+    : scene_(scene), options_(options), device_(device_resource.GetDevice().GetVkDevice()) {
     const auto device = device_resource.GetDevice().GetVkDevice();
     const auto physical_device = device_resource.GetVkPhysicalDevice();
-    const auto [width, height] = device_resource.GetWindow().GetWindowSize();
+    const auto [width, height] = device_resource.GetRenderSize();
 
     // Get the ray tracing and accelertion structure related function pointers required by this
     // sample
@@ -34,6 +65,20 @@ DrawRaytracing::DrawRaytracing(const UniformBuffer<TransformParams>& transform_u
         vkGetDeviceProcAddr(device, "vkGetBufferDeviceAddressKHR"));
     vkCmdBuildAccelerationStructuresKHR = reinterpret_cast<PFN_vkCmdBuildAccelerationStructuresKHR>(
         vkGetDeviceProcAddr(device, "vkCmdBuildAccelerationStructuresKHR"));
+    vkCmdWriteAccelerationStructuresPropertiesKHR =
+        reinterpret_cast<PFN_vkCmdWriteAccelerationStructuresPropertiesKHR>(
+            vkGetDeviceProcAddr(device, "vkCmdWriteAccelerationStructuresPropertiesKHR"));
+    vkCmdCopyAccelerationStructureKHR = reinterpret_cast<PFN_vkCmdCopyAccelerationStructureKHR>(
+        vkGetDeviceProcAddr(device, "vkCmdCopyAccelerationStructureKHR"));
+    vkCmdCopyAccelerationStructureToMemoryKHR =
+        reinterpret_cast<PFN_vkCmdCopyAccelerationStructureToMemoryKHR>(
+            vkGetDeviceProcAddr(device, "vkCmdCopyAccelerationStructureToMemoryKHR"));
+    vkCmdCopyMemoryToAccelerationStructureKHR =
+        reinterpret_cast<PFN_vkCmdCopyMemoryToAccelerationStructureKHR>(
+            vkGetDeviceProcAddr(device, "vkCmdCopyMemoryToAccelerationStructureKHR"));
+    vkGetDeviceAccelerationStructureCompatibilityKHR =
+        reinterpret_cast<PFN_vkGetDeviceAccelerationStructureCompatibilityKHR>(
+            vkGetDeviceProcAddr(device, "vkGetDeviceAccelerationStructureCompatibilityKHR"));
     vkBuildAccelerationStructuresKHR = reinterpret_cast<PFN_vkBuildAccelerationStructuresKHR>(
         vkGetDeviceProcAddr(device, "vkBuildAccelerationStructuresKHR"));
     vkCreateAccelerationStructureKHR = reinterpret_cast<PFN_vkCreateAccelerationStructureKHR>(
@@ -54,14 +99,9 @@ DrawRaytracing::DrawRaytracing(const UniformBuffer<TransformParams>& transform_u
     vkCreateRayTracingPipelinesKHR = reinterpret_cast<PFN_vkCreateRayTracingPipelinesKHR>(
         vkGetDeviceProcAddr(device, "vkCreateRayTracingPipelinesKHR"));
 
-    // texture sampler
-    spdlog::debug("setup texture samplers");
-    [&]() {
-        for (auto type_i = 0; type_i < std::to_underlying(TextureSamplerType::kCount); type_i++) {
-            texture_samplers_[static_cast<TextureSamplerType>(type_i)].emplace(physical_device,
-                                                                               device);
-        }
-    }();
+    // texture sampler, shared by every texture
+    spdlog::debug("setup texture sampler");
+    texture_sampler_.emplace(physical_device, device);
 
     spdlog::debug("get ray tracing pipeline properties");
     raytracing_pipeline_properties_ = {
@@ -92,8 +132,23 @@ DrawRaytracing::DrawRaytracing(const UniformBuffer<TransformParams>& transform_u
             VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, VK_IMAGE_ASPECT_COLOR_BIT);
 
-    spdlog::debug("create bottom level acceleration structure");
-    CreateBottomLevelAS(device, physical_device, queue, command_pool);
+    spdlog::debug("create geometry nodes");
+    CreateGeometryNodes(device, physical_device);
+
+    const auto cache_paths = GetBottomLevelASCachePaths(physical_device);
+    if (cache_paths.empty() ||
+        !LoadBottomLevelAS(cache_paths, device, physical_device, queue, command_pool)) {
+        spdlog::debug("create bottom level acceleration structure");
+        CreateBottomLevelAS(device, physical_device, queue, command_pool);
+        if (options_.compact_blas) {
+            spdlog::debug("compact bottom level acceleration structures");
+            CompactBottomLevelAS(device, physical_device, queue, command_pool);
+        }
+        if (!cache_paths.empty()) {
+            spdlog::debug("save bottom level acceleration structures");
+            SaveBottomLevelAS(cache_paths, device, physical_device, queue, command_pool);
+        }
+    }
     spdlog::debug("create top level acceleration structure");
     CreateTopLevelAS(device, physical_device, queue, command_pool);
 
@@ -156,45 +211,31 @@ DrawRaytracing::DrawRaytracing(const UniformBuffer<TransformParams>& transform_u
                     .descriptorCount = 1,
                     .stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR,
                 },
-                // color
+                // every texture of the scene once, sized at allocation; see GeometryNode
                 VkDescriptorSetLayoutBinding{
                     .binding = 1,
                     .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                    .descriptorCount = static_cast<uint32_t>(scene_.GetModels().size()),
-                    .stageFlags =
-                        VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR,
-                    .pImmutableSamplers = nullptr,
-                },
-                // normal
-                VkDescriptorSetLayoutBinding{
-                    .binding = 2,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                    .descriptorCount = static_cast<uint32_t>(scene_.GetModels().size()),
-                    .stageFlags =
-                        VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR,
-                    .pImmutableSamplers = nullptr,
-                },
-                // emissive
-                VkDescriptorSetLayoutBinding{
-                    .binding = 3,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                    .descriptorCount = static_cast<uint32_t>(scene_.GetModels().size()),
-                    .stageFlags =
-                        VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR,
-                    .pImmutableSamplers = nullptr,
-                },
-                // occlusion roughness metallic
-                VkDescriptorSetLayoutBinding{
-                    .binding = 4,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                    .descriptorCount = static_cast<uint32_t>(scene_.GetModels().size()),
+                    .descriptorCount = kMaxTextures,
                     .stageFlags =
                         VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR,
                     .pImmutableSamplers = nullptr,
                 },
             });
+            constexpr auto kBindingFlags = std::to_array<VkDescriptorBindingFlags>({
+                0,
+                VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT |
+                    VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                    VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT,
+            });
+            const auto binding_flags_info = VkDescriptorSetLayoutBindingFlagsCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+                .bindingCount = static_cast<uint32_t>(kBindingFlags.size()),
+                .pBindingFlags = kBindingFlags.data(),
+            };
             const auto layout_info = VkDescriptorSetLayoutCreateInfo{
                 .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                .pNext = &binding_flags_info,
+                .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
                 .bindingCount = static_cast<uint32_t>(layout_bindings.size()),
                 .pBindings = layout_bindings.data(),
             };
@@ -221,6 +262,8 @@ DrawRaytracing::DrawRaytracing(const UniformBuffer<TransformParams>& transform_u
         }
     }();
 
+    // the `kNoTexture` slot included
+    const auto num_textures = static_cast<uint32_t>(scene.GetTextures().size());
     spdlog::debug("create descriptor pool");
     [&]() {
         const auto num_model = static_cast<uint32_t>(scene.GetModels().size());
@@ -240,10 +283,10 @@ DrawRaytracing::DrawRaytracing(const UniformBuffer<TransformParams>& transform_u
                 .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
                 .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight) * 3,
             },
-            // color + normal + emissive + occlusion roughness metallic
+            // textures
             VkDescriptorPoolSize{
                 .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight) * num_model * 4,
+                .descriptorCount = static_cast<uint32_t>(kMaxFramesInFlight) * num_textures,
             },
             // geometry
             VkDescriptorPoolSize{
@@ -253,6 +296,8 @@ DrawRaytracing::DrawRaytracing(const UniformBuffer<TransformParams>& transform_u
         });
         const auto pool_info = VkDescriptorPoolCreateInfo{
             .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            // for the texture array of set 1
+            .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
             .maxSets = kMaxFramesInFlight * kNumDescriptorSetRaytracing * num_model,
             .poolSizeCount = static_cast<uint32_t>(pool_sizes.size()),
             .pPoolSizes = pool_sizes.data(),
@@ -272,8 +317,17 @@ DrawRaytracing::DrawRaytracing(const UniformBuffer<TransformParams>& transform_u
                 set_layout.emplace_back(layout.GetVkDescriptorSetLayout());
             }
 
+            // only set 1 has a variable-count binding; the other counts are ignored
+            auto variable_counts = std::vector<uint32_t>(set_layout.size(), 0);
+            variable_counts.at(1) = num_textures;
+            const auto variable_count_info = VkDescriptorSetVariableDescriptorCountAllocateInfo{
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO,
+                .descriptorSetCount = static_cast<uint32_t>(variable_counts.size()),
+                .pDescriptorCounts = variable_counts.data(),
+            };
             const auto alloc_info = VkDescriptorSetAllocateInfo{
                 .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                .pNext = &variable_count_info,
                 .descriptorPool = raytracing_descriptor_pool_->GetVkDescriptorPool(),
                 .descriptorSetCount = static_cast<uint32_t>(set_layout.size()),
                 .pSetLayouts = set_layout.data(),
@@ -283,58 +337,13 @@ DrawRaytracing::DrawRaytracing(const UniformBuffer<TransformParams>& transform_u
 
         // update descriptor sets
         spdlog::debug("update descriptor sets");
-        // aggregate image view
-        const auto get_image_view = [&](const auto texture) -> VkImageView {
-            if (texture == nullptr) {
-                return VK_NULL_HANDLE;
-            }
-            return texture->GetImageView();
-        };
-
-        // base color
-        auto base_color_image_infos = std::vector<VkDescriptorImageInfo>();
-        base_color_image_infos.reserve(scene.GetModels().size());
-
-        // normal
-        auto normal_image_infos = std::vector<VkDescriptorImageInfo>();
-        normal_image_infos.reserve(scene.GetModels().size());
-
-        // emissive
-        auto emissive_image_infos = std::vector<VkDescriptorImageInfo>();
-        emissive_image_infos.reserve(scene.GetModels().size());
-
-        // occlusion roughness metallic
-        auto occlusion_roughness_metallic_image_infos = std::vector<VkDescriptorImageInfo>();
-        occlusion_roughness_metallic_image_infos.reserve(scene.GetModels().size());
-
-        for (const auto& model : scene.GetModels()) {
-            const auto base_color_image_view = get_image_view(model.GetBaseColorTexture());
-            base_color_image_infos.emplace_back(VkDescriptorImageInfo{
-                .sampler = texture_samplers_.at(TextureSamplerType::kColor)->GetSampler(),
-                .imageView = base_color_image_view,
-                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            });
-
-            const auto normal_image_view = get_image_view(model.GetNormalTexture());
-            normal_image_infos.emplace_back(VkDescriptorImageInfo{
-                .sampler = texture_samplers_.at(TextureSamplerType::kNormal)->GetSampler(),
-                .imageView = normal_image_view,
-                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            });
-
-            const auto emissive_image_view = get_image_view(model.GetEmissiveTexture());
-            emissive_image_infos.emplace_back(VkDescriptorImageInfo{
-                .sampler = texture_samplers_.at(TextureSamplerType::kEmmisive)->GetSampler(),
-                .imageView = emissive_image_view,
-                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            });
-
-            const auto occlusion_roughness_metallic_image_view =
-                get_image_view(model.GetMetallicRoughnessTexture());
-            occlusion_roughness_metallic_image_infos.emplace_back(VkDescriptorImageInfo{
-                .sampler = texture_samplers_.at(TextureSamplerType::kOcclusionRoughnessMetallic)
-                               ->GetSampler(),
-                .imageView = occlusion_roughness_metallic_image_view,
+        // `Scene::GetTextures`; the `kNoTexture` slot is a null descriptor
+        auto texture_image_infos = std::vector<VkDescriptorImageInfo>();
+        texture_image_infos.reserve(num_textures);
+        for (const auto& texture : scene.GetTextures()) {
+            texture_image_infos.emplace_back(VkDescriptorImageInfo{
+                .sampler = texture_sampler_->GetSampler(),
+                .imageView = texture == nullptr ? VK_NULL_HANDLE : texture->GetImageView(),
                 .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
             });
         }
@@ -423,37 +432,9 @@ DrawRaytracing::DrawRaytracing(const UniformBuffer<TransformParams>& transform_u
                      .dstSet = raytracing_descriptor_sets_.at(frame_i).GetVkDescriptorSet(1),
                      .dstBinding = 1,
                      .dstArrayElement = 0,
-                     .descriptorCount = static_cast<uint32_t>(base_color_image_infos.size()),
+                     .descriptorCount = static_cast<uint32_t>(texture_image_infos.size()),
                      .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                     .pImageInfo = base_color_image_infos.data(),
-                 },
-                 VkWriteDescriptorSet{
-                     .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                     .dstSet = raytracing_descriptor_sets_.at(frame_i).GetVkDescriptorSet(1),
-                     .dstBinding = 2,
-                     .dstArrayElement = 0,
-                     .descriptorCount = static_cast<uint32_t>(normal_image_infos.size()),
-                     .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                     .pImageInfo = normal_image_infos.data(),
-                 },
-                 VkWriteDescriptorSet{
-                     .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                     .dstSet = raytracing_descriptor_sets_.at(frame_i).GetVkDescriptorSet(1),
-                     .dstBinding = 3,
-                     .dstArrayElement = 0,
-                     .descriptorCount = static_cast<uint32_t>(emissive_image_infos.size()),
-                     .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                     .pImageInfo = emissive_image_infos.data(),
-                 },
-                 VkWriteDescriptorSet{
-                     .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                     .dstSet = raytracing_descriptor_sets_.at(frame_i).GetVkDescriptorSet(1),
-                     .dstBinding = 4,
-                     .dstArrayElement = 0,
-                     .descriptorCount =
-                         static_cast<uint32_t>(occlusion_roughness_metallic_image_infos.size()),
-                     .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                     .pImageInfo = occlusion_roughness_metallic_image_infos.data(),
+                     .pImageInfo = texture_image_infos.data(),
                  },
                  VkWriteDescriptorSet{
                      .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
@@ -608,10 +589,13 @@ DrawRaytracing::DrawRaytracing(const UniformBuffer<TransformParams>& transform_u
 
 void DrawRaytracing::OnRecreateSwapChain(const DeviceResource& device_resource) {}
 
-void DrawRaytracing::RecordCommandBuffer(const uint32_t image_idx,
+void DrawRaytracing::RecordCommandBuffer(const uint32_t frame_idx,
                                          const VkExtent2D& swapchain_extent,
-                                         const VkCommandBuffer command_buffer) {
+                                         const VkCommandBuffer command_buffer,
+                                         GpuProfiler& gpu_profiler) {
     spdlog::debug("record command buffer");
+    RecordTopLevelASUpdate(frame_idx, command_buffer);
+
     const auto handle_size = raytracing_pipeline_properties_.shaderGroupHandleSize;
     // align
     const auto handle_size_aligned =
@@ -640,69 +624,104 @@ void DrawRaytracing::RecordCommandBuffer(const uint32_t image_idx,
 
     spdlog::debug("dispatch ray tracing commands");
     vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR,
-                      raytracing_pipeline_.at(image_idx).GetVkRaytracingPipeline());
+                      raytracing_pipeline_.at(frame_idx).GetVkRaytracingPipeline());
 
     vkCmdBindDescriptorSets(
         command_buffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR,
-        raytracing_pipeline_layout_.at(image_idx).GetVkPipelineLayout(), 0,
-        static_cast<uint32_t>(raytracing_descriptor_sets_.at(image_idx).GetSize()),
-        raytracing_descriptor_sets_.at(image_idx).GetVkDescriptorSetPtr(), 0, 0);
+        raytracing_pipeline_layout_.at(frame_idx).GetVkPipelineLayout(), 0,
+        static_cast<uint32_t>(raytracing_descriptor_sets_.at(frame_idx).GetSize()),
+        raytracing_descriptor_sets_.at(frame_idx).GetVkDescriptorSetPtr(), 0, 0);
 
     vkCmdPushConstants(command_buffer,
-                       raytracing_pipeline_layout_.at(image_idx).GetVkPipelineLayout(),
+                       raytracing_pipeline_layout_.at(frame_idx).GetVkPipelineLayout(),
                        VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR, 0,
                        sizeof(uint32_t), &mode_);
 
+    gpu_profiler.BeginScope(frame_idx, command_buffer, "trace_rays");
     vkCmdTraceRaysKHR(command_buffer, &raygen_shader_sbt_entry, &miss_shader_sbt_entry,
                       &hit_shader_sbt_entry, &callable_shader_sbt_entry,
                       static_cast<uint32_t>(swapchain_extent.width),
                       static_cast<uint32_t>(swapchain_extent.height), 1);
+    gpu_profiler.EndScope(frame_idx, command_buffer);
     spdlog::debug("finish recording command buffer");
 }
 
+void DrawRaytracing::CreateGeometryNodes(const VkDevice device,
+                                         const VkPhysicalDevice physical_device) {
+    geometry_nodes_.reserve(scene_.GetModels().size());
+    for (const auto& model : scene_.GetModels()) {
+        const auto& texture_indices = model.GetMaterialParams().texture_indices;
+        const auto& vertex_buffer = model.GetVertexBuffers().at(0);
+        const auto& quantization = vertex_buffer.GetQuantization();
+        // rays always hit the full-detail level
+        const auto& index_buffer = model.GetIndexBuffers().at(0);
+        geometry_nodes_.emplace_back(GeometryNode{
+            .vertex_buffer_device_address =
+                GetBufferDeviceAddress(device, vertex_buffer.GetVkBuffer()) +
+                vertex_buffer.GetOffset(),
+            .index_buffer_device_address =
+                GetBufferDeviceAddress(device, index_buffer.GetVkBuffer()) +
+                index_buffer.GetOffset(),
+            .texture_index_base_color = static_cast<int32_t>(texture_indices.x),
+            .texture_index_normal = static_cast<int32_t>(texture_indices.y),
+            .texture_index_emissive = static_cast<int32_t>(texture_indices.z),
+            .texture_index_occlusion_roughness_metallic = static_cast<int32_t>(texture_indices.w),
+            .index_size = static_cast<uint32_t>(GetIndexSize(index_buffer.GetIndexType())),
+            .vertex_format = static_cast<uint32_t>(vertex_buffer.GetVertexFormat()),
+            .dequantize_scale = glm::vec4(quantization.scale, 0.0f),
+            .dequantize_offset = glm::vec4(quantization.offset, 0.0f),
+        });
+    }
+
+    geometry_node_buffer_.emplace(
+        device, physical_device,
+        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        static_cast<uint32_t>(geometry_nodes_.size()) * sizeof(GeometryNode),
+        geometry_nodes_.data());
+}
+
 void DrawRaytracing::CreateBottomLevelAS(const VkDevice device,
                                          const VkPhysicalDevice physical_device,
                                          const VkQueue queue, const VkCommandPool command_pool) {
-    // Setup identity transform matrix
-    const auto transform_matrix = VkTransformMatrixKHR{
-        .matrix =
-            {
-                {1.0f, 0.0f, 0.0f, 0.0f},
-                {0.0f, 1.0f, 0.0f, 0.0f},
-                {0.0f, 0.0f, 1.0f, 0.0f},
-            },
-    };
-
     const auto num_models = scene_.GetModels().size();
     bottom_level_as_.reserve(num_models);
-    vertex_buffer_.reserve(num_models);
-    index_buffer_.reserve(num_models);
     transform_buffer_.reserve(num_models);
-    geometry_nodes_.reserve(num_models);
-    for (auto model_i = 0; const auto& model : scene_.GetModels()) {
-        const auto& vertices = model.GetVertexBuffers().at(0).GetVertices();
-        const auto& indices = model.GetIndexBuffers().at(0).GetIndices();
-
-        // Vertex buffer
-        spdlog::debug("create vertex buffer");
-        vertex_buffer_.emplace_back(
-            device, physical_device,
-            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
-                VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            sizeof(Vertex) * vertices.size(), vertices.data());
-
-        // Index buffer
-        spdlog::debug("create index buffer");
-        index_buffer_.emplace_back(
-            device, physical_device,
-            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
-                VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            sizeof(Index) * indices.size(), indices.data());
-
-        // Transform buffer
+    // one geometry per build; build infos point into it, so it must not reallocate
+    auto geometries = std::vector<VkAccelerationStructureGeometryKHR>();
+    geometries.reserve(num_models);
+    auto build_infos = std::vector<VkAccelerationStructureBuildGeometryInfoKHR>();
+    build_infos.reserve(num_models);
+    auto range_infos = std::vector<VkAccelerationStructureBuildRangeInfoKHR>();
+    range_infos.reserve(num_models);
+    auto scratch_sizes = std::vector<VkDeviceSize>();
+    scratch_sizes.reserve(num_models);
+    const auto blas_flags = GetBlasFlags(options_);
+    for (const auto& model : scene_.GetModels()) {
+        const auto& vertex_buffer = model.GetVertexBuffers().at(0);
+        const auto vertex_format = vertex_buffer.GetVertexFormat();
+        const auto& quantization = vertex_buffer.GetQuantization();
+        // rays always hit the full-detail level
+        const auto& index_buffer = model.GetIndexBuffers().at(0);
+
+        // the geometry lives in the scene's geometry pool, shared with the rasterizer
+        const auto vertex_buffer_address =
+            GetBufferDeviceAddress(device, vertex_buffer.GetVkBuffer()) +
+            vertex_buffer.GetOffset();
+        const auto index_buffer_address =
+            GetBufferDeviceAddress(device, index_buffer.GetVkBuffer()) + index_buffer.GetOffset();
+
+        // Transform buffer: dequantizes compact positions, identity for float vertices
         spdlog::debug("create transform buffer");
+        const auto transform_matrix = VkTransformMatrixKHR{
+            .matrix =
+                {
+                    {quantization.scale.x, 0.0f, 0.0f, quantization.offset.x},
+                    {0.0f, quantization.scale.y, 0.0f, quantization.offset.y},
+                    {0.0f, 0.0f, quantization.scale.z, quantization.offset.z},
+                },
+        };
         transform_buffer_.emplace_back(
             device, physical_device,
             VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
@@ -711,8 +730,7 @@ void DrawRaytracing::CreateBottomLevelAS(const VkDevice device,
             sizeof(VkTransformMatrixKHR), &transform_matrix);
 
         // Build
-        auto geometries = std::vector<VkAccelerationStructureGeometryKHR>();
-        geometries.emplace_back(VkAccelerationStructureGeometryKHR{
+        const auto& geometry = geometries.emplace_back(VkAccelerationStructureGeometryKHR{
             .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
             .geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR,
             .geometry =
@@ -721,21 +739,19 @@ void DrawRaytracing::CreateBottomLevelAS(const VkDevice device,
                         VkAccelerationStructureGeometryTrianglesDataKHR{
                             .sType =
                                 VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR,
-                            .vertexFormat = VK_FORMAT_R32G32B32_SFLOAT,
+                            .vertexFormat = vertex_format == VertexFormat::kCompact
+                                                ? VK_FORMAT_R16G16B16A16_SNORM
+                                                : VK_FORMAT_R32G32B32_SFLOAT,
                             .vertexData =
                                 {
-                                    .deviceAddress = GetBufferDeviceAddress(
-                                        device, vertex_buffer_.back().GetVkBuffer()),
+                                    .deviceAddress = vertex_buffer_address,
                                 },
-                            .vertexStride = sizeof(Vertex),
-                            .maxVertex = static_cast<uint32_t>(vertices.size() - 1),
-                            .indexType = std::is_same<Index, uint16_t>::value
-                                             ? VK_INDEX_TYPE_UINT16
-                                             : VK_INDEX_TYPE_UINT32,
+                            .vertexStride = GetVertexStride(vertex_format),
+                            .maxVertex = static_cast<uint32_t>(vertex_buffer.GetSize() - 1),
+                            .indexType = index_buffer.GetIndexType(),
                             .indexData =
                                 {
-                                    .deviceAddress = GetBufferDeviceAddress(
-                                        device, index_buffer_.back().GetVkBuffer()),
+                                    .deviceAddress = index_buffer_address,
                                 },
                             .transformData =
                                 {
@@ -746,37 +762,21 @@ void DrawRaytracing::CreateBottomLevelAS(const VkDevice device,
             .flags = VK_GEOMETRY_OPAQUE_BIT_KHR,
         });
 
-        geometry_nodes_.emplace_back(GeometryNode{
-            .vertex_buffer_device_address =
-                GetBufferDeviceAddress(device, vertex_buffer_.back().GetVkBuffer()),
-            .index_buffer_device_address =
-                GetBufferDeviceAddress(device, index_buffer_.back().GetVkBuffer()),
-            .texture_index_base_color =
-                model.GetBaseColorTexture() == nullptr ? -1 : static_cast<int32_t>(model_i),
-            .texture_index_normal =
-                model.GetNormalTexture() == nullptr ? -1 : static_cast<int32_t>(model_i),
-            .texture_index_emissive =
-                model.GetEmissiveTexture() == nullptr ? -1 : static_cast<int32_t>(model_i),
-            .texture_index_occlusion_roughness_metallic =
-                model.GetMetallicRoughnessTexture() == nullptr ? -1 : static_cast<int32_t>(model_i),
-        });
-
         // Get size info
         const auto acceleration_structure_build_geometry_info =
             VkAccelerationStructureBuildGeometryInfoKHR{
                 .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
                 .type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
-                .flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
-                         VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_DATA_ACCESS_KHR,
-                .geometryCount = static_cast<uint32_t>(geometries.size()),
-                .pGeometries = geometries.data(),
+                .flags = blas_flags,
+                .geometryCount = 1,
+                .pGeometries = &geometry,
             };
 
         auto acceleration_structure_build_sizes_info = VkAccelerationStructureBuildSizesInfoKHR{
             .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR,
         };
-        assert(indices.size() % 3 == 0);
-        const auto num_triangles = static_cast<uint32_t>(indices.size() / 3);
+        assert(index_buffer.GetSize() % 3 == 0);
+        const auto num_triangles = static_cast<uint32_t>(index_buffer.GetSize() / 3);
         vkGetAccelerationStructureBuildSizesKHR(
             device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
             &acceleration_structure_build_geometry_info, &num_triangles,
@@ -795,120 +795,375 @@ void DrawRaytracing::CreateBottomLevelAS(const VkDevice device,
         vkCreateAccelerationStructureKHR(device, &acceleration_structure_createInfo, nullptr,
                                          &bottom_level_as_.back().MutableHandle());
 
-        // Create a small scratch buffer used during build of the bottom level acceleration
-        // structure
-        auto scratch_buffer = RayTracingScratchBuffer(
-            device, physical_device, acceleration_structure_build_sizes_info.buildScratchSize);
-
-        const auto geometry_info = VkAccelerationStructureBuildGeometryInfoKHR{
+        // the scratch address is filled in once the batches are planned
+        build_infos.emplace_back(VkAccelerationStructureBuildGeometryInfoKHR{
             .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
             .type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
-            .flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
-                     VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_DATA_ACCESS_KHR,
+            .flags = blas_flags,
             .mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
             .dstAccelerationStructure = bottom_level_as_.back().GetHandle(),
-            .geometryCount = static_cast<uint32_t>(geometries.size()),
-            .pGeometries = geometries.data(),
-            .scratchData =
-                {
-                    .deviceAddress = scratch_buffer.GetDeviceAddress(),
-                },
-        };
-
-        const auto range_info = VkAccelerationStructureBuildRangeInfoKHR{
+            .geometryCount = 1,
+            .pGeometries = &geometry,
+        });
+        range_infos.emplace_back(VkAccelerationStructureBuildRangeInfoKHR{
             .primitiveCount = num_triangles,
             .primitiveOffset = 0,
             .firstVertex = 0,
             .transformOffset = 0,
-        };
-        const auto range_infos = std::to_array({
-            &range_info,
         });
+        scratch_sizes.emplace_back(acceleration_structure_build_sizes_info.buildScratchSize);
+    }
+
+    // Build every bottom level acceleration structure in one submission. The builds of a batch
+    // run concurrently on disjoint ranges of one scratch pool; the next batch reuses the pool.
+    if (!build_infos.empty()) {
+        const auto scratch_plan = PlanScratchBatches(
+            scratch_sizes, GetScratchOffsetAlignment(physical_device), kBlasScratchBudget);
+        spdlog::debug("build {} bottom level acceleration structures in {} batches, {} bytes",
+                      build_infos.size(), scratch_plan.batches.size(), scratch_plan.pool_size);
+        const auto scratch_buffer =
+            RayTracingScratchBuffer(device, physical_device, scratch_plan.pool_size);
+        auto range_info_ptrs = std::vector<const VkAccelerationStructureBuildRangeInfoKHR*>();
+        range_info_ptrs.reserve(range_infos.size());
+        for (size_t build_i = 0; build_i < build_infos.size(); build_i++) {
+            build_infos[build_i].scratchData.deviceAddress =
+                scratch_buffer.GetDeviceAddress() + scratch_plan.offsets[build_i];
+            range_info_ptrs.emplace_back(&range_infos[build_i]);
+        }
+
+        // the next batch overwrites the scratch memory of the previous one
+        const auto scratch_barrier = VkMemoryBarrier{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+            .dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR |
+                             VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+        };
         const auto command_buffer = BeginSingleTimeCommands(command_pool, device);
-        vkCmdBuildAccelerationStructuresKHR(command_buffer, 1, &geometry_info, range_infos.data());
+        for (size_t batch_i = 0; const auto& batch : scratch_plan.batches) {
+            if (batch_i++ > 0) {
+                vkCmdPipelineBarrier(command_buffer,
+                                     VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                                     VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1,
+                                     &scratch_barrier, 0, nullptr, 0, nullptr);
+            }
+            vkCmdBuildAccelerationStructuresKHR(command_buffer,
+                                                static_cast<uint32_t>(batch.count),
+                                                &build_infos[batch.first],
+                                                &range_info_ptrs[batch.first]);
+        }
         EndSingleTimeCommands(command_buffer, queue, command_pool, device);
+    }
 
+    for (auto& blas : bottom_level_as_) {
         const auto acceleration_device_address_info = VkAccelerationStructureDeviceAddressInfoKHR{
             .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR,
-            .accelerationStructure = bottom_level_as_.back().GetHandle(),
+            .accelerationStructure = blas.GetHandle(),
         };
-        bottom_level_as_.back().SetDeviceAddress(
+        blas.SetDeviceAddress(
             vkGetAccelerationStructureDeviceAddressKHR(device, &acceleration_device_address_info));
+    }
+}
 
-        model_i++;
+void DrawRaytracing::CompactBottomLevelAS(const VkDevice device,
+                                          const VkPhysicalDevice physical_device,
+                                          const VkQueue queue, const VkCommandPool command_pool) {
+    if (bottom_level_as_.empty()) {
+        return;
     }
+    const auto num_blas = static_cast<uint32_t>(bottom_level_as_.size());
 
-    geometry_node_buffer_.emplace(
-        device, physical_device,
-        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
-            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        static_cast<uint32_t>(geometry_nodes_.size()) * sizeof(GeometryNode),
-        geometry_nodes_.data());
+    const auto compacted_sizes = QueryBottomLevelASProperties(
+        VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, device, queue, command_pool);
+
+    // Copy into acceleration structures of the compacted size
+    auto compacted = std::vector<AccelerationStructure>();
+    compacted.reserve(num_blas);
+    for (const auto size : compacted_sizes) {
+        const auto build_size_info = VkAccelerationStructureBuildSizesInfoKHR{
+            .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR,
+            .accelerationStructureSize = size,
+        };
+        auto& blas = compacted.emplace_back(device, physical_device, build_size_info);
+        const auto acceleration_structure_create_info = VkAccelerationStructureCreateInfoKHR{
+            .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR,
+            .buffer = blas.GetBuffer(),
+            .size = size,
+            .type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
+        };
+        vkCreateAccelerationStructureKHR(device, &acceleration_structure_create_info, nullptr,
+                                         &blas.MutableHandle());
+    }
+    [&]() {
+        const auto command_buffer = BeginSingleTimeCommands(command_pool, device);
+        for (uint32_t blas_i = 0; blas_i < num_blas; blas_i++) {
+            const auto copy_info = VkCopyAccelerationStructureInfoKHR{
+                .sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR,
+                .src = bottom_level_as_[blas_i].GetHandle(),
+                .dst = compacted[blas_i].GetHandle(),
+                .mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR,
+            };
+            vkCmdCopyAccelerationStructureKHR(command_buffer, &copy_info);
+        }
+        EndSingleTimeCommands(command_buffer, queue, command_pool, device);
+    }();
+
+    for (auto& blas : compacted) {
+        const auto acceleration_device_address_info = VkAccelerationStructureDeviceAddressInfoKHR{
+            .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR,
+            .accelerationStructure = blas.GetHandle(),
+        };
+        blas.SetDeviceAddress(
+            vkGetAccelerationStructureDeviceAddressKHR(device, &acceleration_device_address_info));
+    }
+
+    const auto sum_sizes = [](const std::vector<AccelerationStructure>& blases) {
+        auto size = VkDeviceSize{0};
+        for (const auto& blas : blases) {
+            size += blas.GetSize();
+        }
+        return size;
+    };
+    const auto original_size = sum_sizes(bottom_level_as_);
+    const auto compacted_size = sum_sizes(compacted);
+    spdlog::info("compacted {} bottom level acceleration structures: {:.1f} MiB -> {:.1f} MiB",
+                 num_blas, static_cast<double>(original_size) / (1 << 20),
+                 static_cast<double>(compacted_size) / (1 << 20));
+    // the originals are freed here
+    bottom_level_as_ = std::move(compacted);
+}
+
+std::vector<VkDeviceSize> DrawRaytracing::QueryBottomLevelASProperties(
+    const VkQueryType query_type, const VkDevice device, const VkQueue queue,
+    const VkCommandPool command_pool) {
+    const auto num_blas = static_cast<uint32_t>(bottom_level_as_.size());
+    auto query_pool = VkQueryPool{VK_NULL_HANDLE};
+    const auto query_pool_info = VkQueryPoolCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = query_type,
+        .queryCount = num_blas,
+    };
+    if (vkCreateQueryPool(device, &query_pool_info, nullptr, &query_pool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create query pool for acceleration structures");
+    }
+    auto handles = std::vector<VkAccelerationStructureKHR>();
+    handles.reserve(num_blas);
+    for (const auto& blas : bottom_level_as_) {
+        handles.emplace_back(blas.GetHandle());
+    }
+    [&]() {
+        const auto command_buffer = BeginSingleTimeCommands(command_pool, device);
+        vkCmdResetQueryPool(command_buffer, query_pool, 0, num_blas);
+        vkCmdWriteAccelerationStructuresPropertiesKHR(command_buffer, num_blas, handles.data(),
+                                                      query_type, query_pool, 0);
+        EndSingleTimeCommands(command_buffer, queue, command_pool, device);
+    }();
+    auto properties = std::vector<VkDeviceSize>(num_blas);
+    const auto result = vkGetQueryPoolResults(
+        device, query_pool, 0, num_blas, sizeof(VkDeviceSize) * properties.size(),
+        properties.data(), sizeof(VkDeviceSize), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    vkDestroyQueryPool(device, query_pool, nullptr);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to get acceleration structure properties");
+    }
+    return properties;
+}
+
+std::vector<std::filesystem::path> DrawRaytracing::GetBottomLevelASCachePaths(
+    const VkPhysicalDevice physical_device) const {
+    if (options_.as_cache_dir.empty()) {
+        return {};
+    }
+    const auto driver_uuid = GetDriverUUID(physical_device);
+    const auto blas_flags = GetBlasFlags(options_);
+    auto cache_paths = std::vector<std::filesystem::path>();
+    cache_paths.reserve(scene_.GetModels().size());
+    for (const auto& model : scene_.GetModels()) {
+        const auto geometry_hash = HashBlasGeometry(model.GetVertexBuffers().at(0),
+                                                    model.GetIndexBuffers().at(0), blas_flags);
+        cache_paths.emplace_back(
+            GetASCachePath(options_.as_cache_dir, geometry_hash, driver_uuid));
+    }
+    return cache_paths;
+}
+
+bool DrawRaytracing::LoadBottomLevelAS(const std::vector<std::filesystem::path>& cache_paths,
+                                       const VkDevice device,
+                                       const VkPhysicalDevice physical_device,
+                                       const VkQueue queue, const VkCommandPool command_pool) {
+    if (cache_paths.empty()) {
+        return false;
+    }
+
+    // The scene is loaded from the cache only if every file is present and compatible; a
+    // partial hit is rebuilt as a whole
+    auto blobs = std::vector<std::vector<char>>();
+    blobs.reserve(cache_paths.size());
+    auto deserialized_sizes = std::vector<VkDeviceSize>();
+    deserialized_sizes.reserve(cache_paths.size());
+    for (const auto& path : cache_paths) {
+        if (!std::filesystem::exists(path)) {
+            spdlog::info("acceleration structure cache miss: {}", path.string());
+            return false;
+        }
+        auto& blob = blobs.emplace_back(ReadFile(path));
+        const auto header = ParseSerializedASHeader(std::as_bytes(std::span(blob)));
+        if (!header.has_value()) {
+            spdlog::warn("acceleration structure cache: {} is corrupt; rebuild", path.string());
+            return false;
+        }
+        const auto version_info = VkAccelerationStructureVersionInfoKHR{
+            .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_VERSION_INFO_KHR,
+            .pVersionData = reinterpret_cast<const uint8_t*>(blob.data()),
+        };
+        auto compatibility = VK_ACCELERATION_STRUCTURE_COMPATIBILITY_INCOMPATIBLE_KHR;
+        vkGetDeviceAccelerationStructureCompatibilityKHR(device, &version_info, &compatibility);
+        if (compatibility != VK_ACCELERATION_STRUCTURE_COMPATIBILITY_COMPATIBLE_KHR) {
+            spdlog::info("acceleration structure cache: {} was written by another driver; rebuild",
+                         path.string());
+            return false;
+        }
+        deserialized_sizes.emplace_back(header->deserialized_size);
+    }
+
+    auto staging_buffers = std::vector<SerializedASBuffer>();
+    staging_buffers.reserve(blobs.size());
+    for (const auto& blob : blobs) {
+        auto& staging = staging_buffers.emplace_back(CreateSerializedASBuffer(
+            device, physical_device,
+            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, blob.size()));
+        staging.buffer.UpdateBuffer(blob.data(), blob.size(), staging.offset);
+    }
+
+    bottom_level_as_.reserve(blobs.size());
+    for (const auto size : deserialized_sizes) {
+        const auto build_size_info = VkAccelerationStructureBuildSizesInfoKHR{
+            .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR,
+            .accelerationStructureSize = size,
+        };
+        auto& blas = bottom_level_as_.emplace_back(device, physical_device, build_size_info);
+        const auto acceleration_structure_create_info = VkAccelerationStructureCreateInfoKHR{
+            .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR,
+            .buffer = blas.GetBuffer(),
+            .size = size,
+            .type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
+        };
+        vkCreateAccelerationStructureKHR(device, &acceleration_structure_create_info, nullptr,
+                                         &blas.MutableHandle());
+    }
+    [&]() {
+        const auto command_buffer = BeginSingleTimeCommands(command_pool, device);
+        for (size_t blas_i = 0; blas_i < bottom_level_as_.size(); blas_i++) {
+            const auto copy_info = VkCopyMemoryToAccelerationStructureInfoKHR{
+                .sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_ACCELERATION_STRUCTURE_INFO_KHR,
+                .src = {.deviceAddress = staging_buffers[blas_i].device_address},
+                .dst = bottom_level_as_[blas_i].GetHandle(),
+                .mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_DESERIALIZE_KHR,
+            };
+            vkCmdCopyMemoryToAccelerationStructureKHR(command_buffer, &copy_info);
+        }
+        EndSingleTimeCommands(command_buffer, queue, command_pool, device);
+    }();
+
+    for (auto& blas : bottom_level_as_) {
+        const auto acceleration_device_address_info = VkAccelerationStructureDeviceAddressInfoKHR{
+            .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR,
+            .accelerationStructure = blas.GetHandle(),
+        };
+        blas.SetDeviceAddress(
+            vkGetAccelerationStructureDeviceAddressKHR(device, &acceleration_device_address_info));
+    }
+    spdlog::info("loaded {} bottom level acceleration structures from {}",
+                 bottom_level_as_.size(), options_.as_cache_dir.string());
+    return true;
+}
+
+void DrawRaytracing::SaveBottomLevelAS(const std::vector<std::filesystem::path>& cache_paths,
+                                       const VkDevice device,
+                                       const VkPhysicalDevice physical_device,
+                                       const VkQueue queue, const VkCommandPool command_pool) {
+    assert(cache_paths.size() == bottom_level_as_.size());
+    if (bottom_level_as_.empty()) {
+        return;
+    }
+    const auto serialized_sizes = QueryBottomLevelASProperties(
+        VK_QUERY_TYPE_ACCELERATION_STRUCTURE_SERIALIZATION_SIZE_KHR, device, queue, command_pool);
+
+    auto readback_buffers = std::vector<SerializedASBuffer>();
+    readback_buffers.reserve(serialized_sizes.size());
+    for (const auto size : serialized_sizes) {
+        readback_buffers.emplace_back(CreateSerializedASBuffer(
+            device, physical_device, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, size));
+    }
+    [&]() {
+        const auto command_buffer = BeginSingleTimeCommands(command_pool, device);
+        for (size_t blas_i = 0; blas_i < bottom_level_as_.size(); blas_i++) {
+            const auto copy_info = VkCopyAccelerationStructureToMemoryInfoKHR{
+                .sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_TO_MEMORY_INFO_KHR,
+                .src = bottom_level_as_[blas_i].GetHandle(),
+                .dst = {.deviceAddress = readback_buffers[blas_i].device_address},
+                .mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_SERIALIZE_KHR,
+            };
+            vkCmdCopyAccelerationStructureToMemoryKHR(command_buffer, &copy_info);
+        }
+        EndSingleTimeCommands(command_buffer, queue, command_pool, device);
+    }();
+
+    auto blob = std::vector<std::byte>();
+    auto total_size = VkDeviceSize{0};
+    for (size_t blas_i = 0; blas_i < bottom_level_as_.size(); blas_i++) {
+        blob.resize(serialized_sizes[blas_i]);
+        const auto& readback = readback_buffers[blas_i];
+        readback.buffer.ReadBuffer(blob.data(), blob.size(), readback.offset);
+        if (!WriteASCacheFile(cache_paths[blas_i], blob)) {
+            spdlog::warn("acceleration structure cache: failed to write {}",
+                         cache_paths[blas_i].string());
+            continue;
+        }
+        total_size += blob.size();
+    }
+    spdlog::info("saved bottom level acceleration structures to {}: {:.1f} MiB",
+                 options_.as_cache_dir.string(), static_cast<double>(total_size) / (1 << 20));
 }
 
 void DrawRaytracing::CreateTopLevelAS(const VkDevice device, const VkPhysicalDevice physical_device,
                                       const VkQueue queue, const VkCommandPool command_pool) {
-    const auto transform_matrix = VkTransformMatrixKHR{
-        .matrix =
+    // Buffers for instance data, persistent so that transform changes only need a refit
+    const auto instances = GetTopLevelInstances();
+    instance_buffers_.reserve(kMaxFramesInFlight);
+    for (auto frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
+        instance_buffers_.emplace_back(
+            device, physical_device,
+            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+                VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            sizeof(VkAccelerationStructureInstanceKHR) * instances.size(), instances.data());
+    }
+
+    // Get size info; the instance data is not read
+    const auto acceleration_structure_geometry = VkAccelerationStructureGeometryKHR{
+        .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
+        .geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR,
+        .geometry =
             {
-                {1.0f, 0.0f, 0.0f, 0.0f},
-                {0.0f, 1.0f, 0.0f, 0.0f},
-                {0.0f, 0.0f, 1.0f, 0.0f},
+                .instances =
+                    {
+                        .sType =
+                            VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR,
+                        .arrayOfPointers = VK_FALSE,
+                    },
             },
+        .flags = VK_GEOMETRY_OPAQUE_BIT_KHR,
     };
-
-    auto instances = std::vector<VkAccelerationStructureInstanceKHR>();
-    instances.reserve(bottom_level_as_.size());
-    for (const auto& blas : bottom_level_as_) {
-        instances.emplace_back(VkAccelerationStructureInstanceKHR{
-            .transform = transform_matrix,
-            .instanceCustomIndex = 0,
-            .mask = 0xFF,
-            .instanceShaderBindingTableRecordOffset = 0,
-            .flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR,
-            .accelerationStructureReference = blas.GetDeviceAddress(),
-        });
-    }
-    // Buffer for instance data
-    const auto instance_buffer =
-        Buffer(device, physical_device,
-               VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
-                   VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
-               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-               sizeof(VkAccelerationStructureInstanceKHR) * instances.size(), instances.data());
-    const auto instance_data_device_address = VkDeviceOrHostAddressConstKHR{
-        .deviceAddress = GetBufferDeviceAddress(device, instance_buffer.GetVkBuffer()),
-    };
-    const auto acceleration_structure_geometry = std::to_array({
-        VkAccelerationStructureGeometryKHR{
-            .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
-            .geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR,
-            .geometry =
-                {
-                    .instances =
-                        {
-                            .sType =
-                                VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR,
-                            .arrayOfPointers = VK_FALSE,
-                            .data = instance_data_device_address,
-                        },
-                },
-            .flags = VK_GEOMETRY_OPAQUE_BIT_KHR,
-        },
-    });
-
     const auto acceleration_structure_build_geometry_info =
         VkAccelerationStructureBuildGeometryInfoKHR{
             .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
             .type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
-            .flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
-                     VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_DATA_ACCESS_KHR,
-            .geometryCount = static_cast<uint32_t>(acceleration_structure_geometry.size()),
-            .pGeometries = acceleration_structure_geometry.data(),
+            .flags = kTlasFlags,
+            .geometryCount = 1,
+            .pGeometries = &acceleration_structure_geometry,
         };
 
-    const auto primitive_count = static_cast<uint32_t>(bottom_level_as_.size());
+    const auto primitive_count = static_cast<uint32_t>(instances.size());
     auto acceleration_structure_build_sizes_info = VkAccelerationStructureBuildSizesInfoKHR{
         .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR,
     };
@@ -927,45 +1182,136 @@ void DrawRaytracing::CreateTopLevelAS(const VkDevice device, const VkPhysicalDev
     vkCreateAccelerationStructureKHR(device, &acceleration_structure_create_info, nullptr,
                                      &top_level_as_->MutableHandle());
 
-    // Create a small scratch buffer used during build of the top level acceleration structure
-    const auto scratch_buffer = RayTracingScratchBuffer(
-        device, physical_device, acceleration_structure_build_sizes_info.buildScratchSize);
+    // Kept for the refits of the top level acceleration structure
+    const auto scratch_size = std::max(acceleration_structure_build_sizes_info.buildScratchSize,
+                                       acceleration_structure_build_sizes_info.updateScratchSize);
+    tlas_scratch_buffer_.emplace(device, physical_device, scratch_size);
+
+    const auto command_buffer = BeginSingleTimeCommands(command_pool, device);
+    RecordTopLevelASBuild(0, command_buffer, VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR);
+    EndSingleTimeCommands(command_buffer, queue, command_pool, device);
+    tlas_transform_version_ = scene_.GetTransformVersion();
+
+    const auto acceleration_device_address_info = VkAccelerationStructureDeviceAddressInfoKHR{
+        .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR,
+        .accelerationStructure = top_level_as_->GetHandle(),
+    };
+    top_level_as_->SetDeviceAddress(
+        vkGetAccelerationStructureDeviceAddressKHR(device, &acceleration_device_address_info));
+}
+
+std::vector<VkAccelerationStructureInstanceKHR> DrawRaytracing::GetTopLevelInstances() const {
+    auto instances = std::vector<VkAccelerationStructureInstanceKHR>();
+    instances.reserve(bottom_level_as_.size());
+    for (size_t model_i = 0; model_i < bottom_level_as_.size(); model_i++) {
+        instances.emplace_back(VkAccelerationStructureInstanceKHR{
+            .transform = ToVkTransformMatrix(scene_.GetModels()[model_i].GetTransform()),
+            .instanceCustomIndex = 0,
+            .mask = 0xFF,
+            .instanceShaderBindingTableRecordOffset = 0,
+            .flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR,
+            .accelerationStructureReference = bottom_level_as_[model_i].GetDeviceAddress(),
+        });
+    }
+    return instances;
+}
 
+void DrawRaytracing::RecordTopLevelASBuild(const uint32_t frame_idx,
+                                           const VkCommandBuffer command_buffer,
+                                           const VkBuildAccelerationStructureModeKHR mode) {
+    const auto acceleration_structure_geometry = VkAccelerationStructureGeometryKHR{
+        .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
+        .geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR,
+        .geometry =
+            {
+                .instances =
+                    {
+                        .sType =
+                            VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR,
+                        .arrayOfPointers = VK_FALSE,
+                        .data =
+                            {
+                                .deviceAddress = GetBufferDeviceAddress(
+                                    device_, instance_buffers_.at(frame_idx).GetVkBuffer()),
+                            },
+                    },
+            },
+        .flags = VK_GEOMETRY_OPAQUE_BIT_KHR,
+    };
+    // an update refits the structure in place
     const auto acceleration_build_geometry_info = VkAccelerationStructureBuildGeometryInfoKHR{
         .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
         .type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
-        .flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
-                 VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_DATA_ACCESS_KHR,
-        .mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
+        .flags = kTlasFlags,
+        .mode = mode,
+        .srcAccelerationStructure = mode == VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR
+                                        ? top_level_as_->GetHandle()
+                                        : VK_NULL_HANDLE,
         .dstAccelerationStructure = top_level_as_->GetHandle(),
-        .geometryCount = static_cast<uint32_t>(acceleration_structure_geometry.size()),
-        .pGeometries = acceleration_structure_geometry.data(),
+        .geometryCount = 1,
+        .pGeometries = &acceleration_structure_geometry,
         .scratchData =
             {
-                .deviceAddress = scratch_buffer.GetDeviceAddress(),
+                .deviceAddress = tlas_scratch_buffer_->GetDeviceAddress(),
             },
     };
 
-    auto acceleration_structure_build_range_info = VkAccelerationStructureBuildRangeInfoKHR{
-        .primitiveCount = primitive_count,
+    const auto acceleration_structure_build_range_info = VkAccelerationStructureBuildRangeInfoKHR{
+        .primitiveCount = static_cast<uint32_t>(bottom_level_as_.size()),
         .primitiveOffset = 0,
         .firstVertex = 0,
         .transformOffset = 0,
     };
-    std::vector<VkAccelerationStructureBuildRangeInfoKHR*>
-        acceleration_build_structure_range_infos = {&acceleration_structure_build_range_info};
-
-    const auto command_buffer = BeginSingleTimeCommands(command_pool, device);
+    const auto* range_info = &acceleration_structure_build_range_info;
     vkCmdBuildAccelerationStructuresKHR(command_buffer, 1, &acceleration_build_geometry_info,
-                                        acceleration_build_structure_range_infos.data());
-    EndSingleTimeCommands(command_buffer, queue, command_pool, device);
+                                        &range_info);
+}
 
-    const auto acceleration_device_address_info = VkAccelerationStructureDeviceAddressInfoKHR{
-        .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR,
-        .accelerationStructure = top_level_as_->GetHandle(),
+void DrawRaytracing::RecordTopLevelASUpdate(const uint32_t frame_idx,
+                                            const VkCommandBuffer command_buffer) {
+    const auto transform_version = scene_.GetTransformVersion();
+    if (transform_version == tlas_transform_version_) {
+        return;
+    }
+
+    // the fence of the frame slot has been waited on, so its instance buffer is free
+    const auto instances = GetTopLevelInstances();
+    instance_buffers_.at(frame_idx).UpdateBuffer(
+        instances.data(), sizeof(VkAccelerationStructureInstanceKHR) * instances.size());
+
+    // the previous frame may still trace or refit the structure
+    const auto before_build = VkMemoryBarrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR |
+                         VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+        .dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR |
+                         VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
     };
-    top_level_as_->SetDeviceAddress(
-        vkGetAccelerationStructureDeviceAddressKHR(device, &acceleration_device_address_info));
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR |
+                             VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                         VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1,
+                         &before_build, 0, nullptr, 0, nullptr);
+
+    if (tlas_update_count_ < kTlasUpdatesPerBuild) {
+        RecordTopLevelASBuild(frame_idx, command_buffer,
+                              VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR);
+        tlas_update_count_++;
+    } else {
+        RecordTopLevelASBuild(frame_idx, command_buffer,
+                              VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR);
+        tlas_update_count_ = 0;
+    }
+
+    const auto after_build = VkMemoryBarrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+        .dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR,
+    };
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                         VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, 0, 1, &after_build, 0,
+                         nullptr, 0, nullptr);
+    tlas_transform_version_ = transform_version;
 }
 
 void DrawRaytracing::CreateShaderBindingTable(const VkDevice device,
@@ -1008,6 +1354,23 @@ void DrawRaytracing::CreateShaderBindingTable(const VkDevice device,
     spdlog::debug("finish creating shader binding table");
 }
 
+DrawRaytracing::SerializedASBuffer DrawRaytracing::CreateSerializedASBuffer(
+    const VkDevice device, const VkPhysicalDevice physical_device, const VkBufferUsageFlags usage,
+    const VkDeviceSize size) {
+    // buffers are sub-allocated, so their addresses are only aligned to the memory requirements;
+    // pad the buffer and round the address up instead
+    auto buffer = Buffer(device, physical_device, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | usage,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         size + kSerializedASAlignment - 1, nullptr);
+    const auto base_address = GetBufferDeviceAddress(device, buffer.GetVkBuffer());
+    const auto device_address = AlignUp(base_address, kSerializedASAlignment);
+    return {
+        .buffer = std::move(buffer),
+        .offset = device_address - base_address,
+        .device_address = device_address,
+    };
+}
+
 uint64_t DrawRaytracing::GetBufferDeviceAddress(const VkDevice device, const VkBuffer buffer) {
     const auto buffer_device_address_info = VkBufferDeviceAddressInfoKHR{
         .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
@@ -14,6 +14,7 @@
 #include "draw/draw_strategy.h"
 #include "light.h"
 #include "scene/scene.h"
+#include "scratch_buffer.h"
 #include "texture/texture_sampler.h"
 #include "transform.h"
 #include "uniform_buffer.h"
@@ -22,30 +23,52 @@ namespace vlux::draw::raytracing {
 struct GeometryNode {
     uint64_t vertex_buffer_device_address;
     uint64_t index_buffer_device_address;
+    //! slots of `Scene::GetTextures`; `kNoTexture` is a null descriptor that samples zero
     int32_t texture_index_base_color;
     int32_t texture_index_normal;
     int32_t texture_index_emissive;
     int32_t texture_index_occlusion_roughness_metallic;
+    //! bytes per index, 2 or 4
+    uint32_t index_size;
+    //! `VertexFormat`; compact positions are dequantized with the scale and offset
+    uint32_t vertex_format;
+    alignas(16) glm::vec4 dequantize_scale;
+    alignas(16) glm::vec4 dequantize_offset;
 };
 
 struct ModePushConstants {
     uint32_t mode;
 };
+
+struct RaytracingOptions {
+    //! copy every bottom level acceleration structure into one of its compacted size
+    bool compact_blas = true;
+    //! serialized bottom level acceleration structures are kept here across runs; empty disables
+    std::filesystem::path as_cache_dir;
+};
+
+/**
+ * @brief Read the `raytracing` section of the app config; missing keys keep the defaults
+ */
+RaytracingOptions ParseRaytracingOptions(const nlohmann::json& config);
+
 class DrawRaytracing : public DrawStrategy {
    public:
     DrawRaytracing(const UniformBuffer<TransformParams>& transform_ubo,
                    const UniformBuffer<CameraParams>& camera_ubo,
                    const UniformBuffer<CameraMatrixParams>& camera_matrix_ubo,
                    const UniformBuffer<LightParams>& light_ubo, Scene& scene, const VkQueue queue,
-                   const VkCommandPool command_pool, const DeviceResource& device_resource);
+                   const VkCommandPool command_pool, const DeviceResource& device_resource,
+                   const RaytracingOptions& options = {});
     ~DrawRaytracing() override = default;
     DrawRaytracing(const DrawRaytracing&) = delete;
     DrawRaytracing& operator=(const DrawRaytracing&) = delete;
     DrawRaytracing(DrawRaytracing&&) = default;
     DrawRaytracing& operator=(DrawRaytracing&&) = default;
 
-    void RecordCommandBuffer(const uint32_t image_idx, const VkExtent2D& swapchain_extent,
-                             const VkCommandBuffer command_buffer) override;
+    void RecordCommandBuffer(const uint32_t frame_idx, const VkExtent2D& swapchain_extent,
+                             const VkCommandBuffer command_buffer,
+                             GpuProfiler& gpu_profiler) override;
 
     void OnRecreateSwapChain(const DeviceResource& device_resource) override;
 
@@ -57,12 +80,66 @@ class DrawRaytracing : public DrawStrategy {
     uint32_t GetMode() const override { return mode_; };
 
    private:
+    void CreateGeometryNodes(const VkDevice device, const VkPhysicalDevice physical_device);
+
     void CreateBottomLevelAS(const VkDevice device, const VkPhysicalDevice physical_device,
                              const VkQueue queue, const VkCommandPool command_pool);
 
+    //! replace the bottom level acceleration structures with compacted copies
+    void CompactBottomLevelAS(const VkDevice device, const VkPhysicalDevice physical_device,
+                              const VkQueue queue, const VkCommandPool command_pool);
+
+    //! one cache file per model, see `GetASCachePath`
+    std::vector<std::filesystem::path> GetBottomLevelASCachePaths(
+        const VkPhysicalDevice physical_device) const;
+
+    /**
+     * @brief Deserialize every bottom level acceleration structure from the cache
+     *
+     * @return bool false, leaving `bottom_level_as_` empty, if a file is missing or was written
+     * by an incompatible driver; the structures must then be rebuilt
+     */
+    bool LoadBottomLevelAS(const std::vector<std::filesystem::path>& cache_paths,
+                           const VkDevice device, const VkPhysicalDevice physical_device,
+                           const VkQueue queue, const VkCommandPool command_pool);
+
+    //! host visible buffer of a serialized acceleration structure
+    struct SerializedASBuffer {
+        Buffer buffer;
+        //! of the aligned bytes in `buffer`
+        VkDeviceSize offset;
+        VkDeviceAddress device_address;
+    };
+    //! buffer with `size` bytes at a `kSerializedASAlignment` aligned device address
+    SerializedASBuffer CreateSerializedASBuffer(const VkDevice device,
+                                                const VkPhysicalDevice physical_device,
+                                                const VkBufferUsageFlags usage,
+                                                const VkDeviceSize size);
+
+    //! serialize the bottom level acceleration structures into the cache
+    void SaveBottomLevelAS(const std::vector<std::filesystem::path>& cache_paths,
+                           const VkDevice device, const VkPhysicalDevice physical_device,
+                           const VkQueue queue, const VkCommandPool command_pool);
+
+    //! `query_type` of every bottom level acceleration structure; their builds have completed
+    std::vector<VkDeviceSize> QueryBottomLevelASProperties(const VkQueryType query_type,
+                                                           const VkDevice device,
+                                                           const VkQueue queue,
+                                                           const VkCommandPool command_pool);
+
     void CreateTopLevelAS(const VkDevice device, const VkPhysicalDevice physical_device,
                           const VkQueue queue, const VkCommandPool command_pool);
 
+    //! one instance per model, placed by `Model::GetTransform`
+    std::vector<VkAccelerationStructureInstanceKHR> GetTopLevelInstances() const;
+
+    //! build or update the top level acceleration structure from `instance_buffers_[frame_idx]`
+    void RecordTopLevelASBuild(const uint32_t frame_idx, const VkCommandBuffer command_buffer,
+                               const VkBuildAccelerationStructureModeKHR mode);
+
+    //! refit the top level acceleration structure if a model transform changed since it was built
+    void RecordTopLevelASUpdate(const uint32_t frame_idx, const VkCommandBuffer command_buffer);
+
     void CreateShaderBindingTable(const VkDevice device, const VkPhysicalDevice physical_device,
                                   const VkPipeline pipeline);
 
@@ -70,6 +147,7 @@ class DrawRaytracing : public DrawStrategy {
 
     // scene
     const Scene& scene_;
+    const RaytracingOptions options_;
 
     // device resource
     const VkDevice device_;
@@ -81,13 +159,19 @@ class DrawRaytracing : public DrawStrategy {
     // Ray tracing acceleration structure
     std::vector<AccelerationStructure> bottom_level_as_;
     std::optional<AccelerationStructure> top_level_as_;
+    //! (kMaxFramesInFlight,) instances of `top_level_as_`, rewritten when a transform changes
+    std::vector<Buffer> instance_buffers_;
+    //! fits both a build and an update of `top_level_as_`
+    std::optional<RayTracingScratchBuffer> tlas_scratch_buffer_;
+    //! `Scene::GetTransformVersion` of the instances in `top_level_as_`
+    uint64_t tlas_transform_version_ = 0;
+    //! refits since the last full build of `top_level_as_`
+    uint32_t tlas_update_count_ = 0;
 
     std::vector<VkRayTracingShaderGroupCreateInfoKHR> shader_groups_{};
 
     uint32_t mode_{0};
 
-    std::vector<Buffer> vertex_buffer_;
-    std::vector<Buffer> index_buffer_;
     std::vector<Buffer> transform_buffer_;
     std::optional<Buffer> raygen_shader_binding_table_;
     std::optional<Buffer> miss_shader_binding_table_;
@@ -109,14 +193,8 @@ class DrawRaytracing : public DrawStrategy {
     //! (kMaxFramesInFlight,)
     std::vector<RaytracingPipeline> raytracing_pipeline_;
 
-    enum class TextureSamplerType {
-        kColor,
-        kNormal,
-        kEmmisive,
-        kOcclusionRoughnessMetallic,
-        kCount
-    };
-    std::unordered_map<TextureSamplerType, std::optional<TextureSampler>> texture_samplers_;
+    //! of every texture in set 1
+    std::optional<TextureSampler> texture_sampler_;
 
     PFN_vkGetBufferDeviceAddressKHR vkGetBufferDeviceAddressKHR;
     PFN_vkCreateAccelerationStructureKHR vkCreateAccelerationStructureKHR;
@@ -124,6 +202,12 @@ class DrawRaytracing : public DrawStrategy {
     PFN_vkGetAccelerationStructureBuildSizesKHR vkGetAccelerationStructureBuildSizesKHR;
     PFN_vkGetAccelerationStructureDeviceAddressKHR vkGetAccelerationStructureDeviceAddressKHR;
     PFN_vkCmdBuildAccelerationStructuresKHR vkCmdBuildAccelerationStructuresKHR;
+    PFN_vkCmdWriteAccelerationStructuresPropertiesKHR vkCmdWriteAccelerationStructuresPropertiesKHR;
+    PFN_vkCmdCopyAccelerationStructureKHR vkCmdCopyAccelerationStructureKHR;
+    PFN_vkCmdCopyAccelerationStructureToMemoryKHR vkCmdCopyAccelerationStructureToMemoryKHR;
+    PFN_vkCmdCopyMemoryToAccelerationStructureKHR vkCmdCopyMemoryToAccelerationStructureKHR;
+    PFN_vkGetDeviceAccelerationStructureCompatibilityKHR
+        vkGetDeviceAccelerationStructureCompatibilityKHR;
     PFN_vkBuildAccelerationStructuresKHR vkBuildAccelerationStructuresKHR;
     PFN_vkCmdTraceRaysKHR vkCmdTraceRaysKHR;
     PFN_vkGetRayTracingShaderGroupHandlesKHR vkGetRayTracingShaderGroupHandlesKHR;
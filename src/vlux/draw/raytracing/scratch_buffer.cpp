@@ -1,9 +1,47 @@
 #include "scratch_buffer.h"
 
-#include "common/utils.h"
-
 namespace vlux::draw::raytracing {
 
+ScratchPlan PlanScratchBatches(std::span<const VkDeviceSize> scratch_sizes,
+                               const VkDeviceSize alignment, const VkDeviceSize budget) {
+    const auto align_up = [alignment](const VkDeviceSize x) {
+        return (x + alignment - 1) / alignment * alignment;
+    };
+    auto plan = ScratchPlan{
+        .offsets = std::vector<VkDeviceSize>(scratch_sizes.size()),
+        .batches = {},
+        .pool_size = 0,
+    };
+    auto batch_size = VkDeviceSize{0};
+    for (size_t build_i = 0; build_i < scratch_sizes.size(); build_i++) {
+        const auto size = align_up(scratch_sizes[build_i]);
+        if (plan.batches.empty() || (batch_size > 0 && batch_size + size > budget)) {
+            plan.batches.emplace_back(ScratchBatch{.first = build_i, .count = 0});
+            batch_size = 0;
+        }
+        plan.offsets[build_i] = batch_size;
+        plan.batches.back().count++;
+        batch_size += size;
+        plan.pool_size = std::max(plan.pool_size, batch_size);
+    }
+    return plan;
+}
+
+VkDeviceSize GetScratchOffsetAlignment(const VkPhysicalDevice physical_device) {
+    auto acceleration_structure_properties = VkPhysicalDeviceAccelerationStructurePropertiesKHR{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR,
+    };
+    auto properties = VkPhysicalDeviceProperties2{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &acceleration_structure_properties,
+    };
+    vkGetPhysicalDeviceProperties2(physical_device, &properties);
+    return std::max(
+        static_cast<VkDeviceSize>(
+            acceleration_structure_properties.minAccelerationStructureScratchOffsetAlignment),
+        VkDeviceSize{1});
+}
+
 RayTracingScratchBuffer::RayTracingScratchBuffer(const VkDevice device,
                                                  const VkPhysicalDevice physical_device,
                                                  const VkDeviceSize size)
@@ -24,25 +62,14 @@ RayTracingScratchBuffer::RayTracingScratchBuffer(const VkDevice device,
     VkMemoryRequirements memory_requirements{};
     vkGetBufferMemoryRequirements(device, handle_, &memory_requirements);
 
-    const auto memory_allocate_flags_info = VkMemoryAllocateFlagsInfo{
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
-        .flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR,
-    };
-
-    const auto memory_allocate_info = VkMemoryAllocateInfo{
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = &memory_allocate_flags_info,
-        .allocationSize = memory_requirements.size,
-        .memoryTypeIndex = FindMemoryType(memory_requirements.memoryTypeBits,
-                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, physical_device)};
+    // scratch addresses must be aligned to minAccelerationStructureScratchOffsetAlignment
+    memory_requirements.alignment =
+        std::max(memory_requirements.alignment, GetScratchOffsetAlignment(physical_device));
 
-    if (vkAllocateMemory(device, &memory_allocate_info, nullptr, &memory_) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to allocate memory for scratch buffer");
-    }
-
-    if (vkBindBufferMemory(device, handle_, memory_, 0) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to bind memory to scratch buffer");
-    }
+    allocation_ = GetMemoryAllocator(device, physical_device)
+                      .Allocate(memory_requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                AllocationType::kLinear);
+    allocation_.BindBuffer(device, handle_);
 
     const auto buffer_device_address_info = VkBufferDeviceAddressInfoKHR{
         .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
@@ -55,8 +82,5 @@ RayTracingScratchBuffer::~RayTracingScratchBuffer() {
     if (handle_ != VK_NULL_HANDLE) {
         vkDestroyBuffer(device_, handle_, nullptr);
     }
-    if (memory_ != VK_NULL_HANDLE) {
-        vkFreeMemory(device_, memory_, nullptr);
-    }
 }
 }  // namespace vlux::draw::raytracing
@@ -2,22 +2,63 @@
 #define DRAW_RAYTRACING_SCRATCH_BUFFER_H
 
 #include "pch.h"
+//
+#include <span>
+
+#include "common/memory_allocator.h"
 
 namespace vlux::draw::raytracing {
+
+//! builds that share one submission of `vkCmdBuildAccelerationStructuresKHR`
+struct ScratchBatch {
+    //! first build of the batch
+    size_t first;
+    size_t count;
+};
+
+//! scratch layout of a sequence of acceleration structure builds, see `PlanScratchBatches`
+struct ScratchPlan {
+    //! per build, offset into the scratch pool; builds of a batch never overlap
+    std::vector<VkDeviceSize> offsets;
+    std::vector<ScratchBatch> batches;
+    //! size of the scratch pool that fits the largest batch
+    VkDeviceSize pool_size;
+};
+
+/**
+ * @brief Pack builds into batches whose scratch fits a budget
+ *
+ * Builds keep their order. Each batch takes builds until the next one would exceed `budget`;
+ * a build larger than the budget gets a batch of its own. All batches reuse the same pool,
+ * so consecutive batches need a barrier on the scratch memory.
+ *
+ * @param scratch_sizes `buildScratchSize` of each build
+ * @param alignment `minAccelerationStructureScratchOffsetAlignment`
+ * @param budget scratch bytes per batch
+ * @return ScratchPlan
+ */
+ScratchPlan PlanScratchBatches(std::span<const VkDeviceSize> scratch_sizes,
+                               const VkDeviceSize alignment, const VkDeviceSize budget);
+
+//! `minAccelerationStructureScratchOffsetAlignment` of the device
+VkDeviceSize GetScratchOffsetAlignment(const VkPhysicalDevice physical_device);
+
 class RayTracingScratchBuffer {
    public:
     RayTracingScratchBuffer() = default;
     RayTracingScratchBuffer(const VkDevice device, const VkPhysicalDevice physical_device,
                             const VkDeviceSize size);
     ~RayTracingScratchBuffer();
+    RayTracingScratchBuffer(const RayTracingScratchBuffer&) = delete;
+    RayTracingScratchBuffer& operator=(const RayTracingScratchBuffer&) = delete;
 
     uint64_t GetDeviceAddress() const { return device_address_; }
 
    private:
-    VkDevice device_;
-    uint64_t device_address_;
-    VkBuffer handle_;
-    VkDeviceMemory memory_;
+    VkDevice device_ = VK_NULL_HANDLE;
+    uint64_t device_address_ = 0;
+    VkBuffer handle_ = VK_NULL_HANDLE;
+    MemoryAllocation allocation_;
 
     PFN_vkGetBufferDeviceAddressKHR vkGetBufferDeviceAddressKHR;
 };
@@ -3,6 +3,13 @@
 #include "pch.h"
 
 namespace vlux {
+//! CPU and GPU time of one rendered frame
+struct FrameTime {
+    uint32_t frame;
+    float cpu_ms;
+    std::optional<float> gpu_ms;  // std::nullopt if timestamps are unsupported
+};
+
 class FrameTimer {
    public:
     FrameTimer();
@@ -1 +1,37 @@
-#include "light.h"
\ No newline at end of file
+#include "light.h"
+
+namespace vlux {
+namespace {
+struct LightBufferHeader {
+    alignas(16) uint32_t num_lights;
+};
+}  // namespace
+
+LightBuffer::LightBuffer(const VkDevice device, const VkPhysicalDevice physical_device) {
+    const auto buffer_size =
+        static_cast<VkDeviceSize>(sizeof(LightBufferHeader) + sizeof(LightParams) * kMaxLights);
+    const auto header = LightBufferHeader{.num_lights = 0};
+    buffers_.reserve(kMaxFramesInFlight);
+    for (size_t i = 0; i < kMaxFramesInFlight; i++) {
+        buffers_.emplace_back(
+            device, physical_device, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            buffer_size, nullptr);
+        buffers_.back().UpdateBuffer(&header, sizeof(header));
+    }
+}
+
+void LightBuffer::UpdateLightBuffer(const std::span<const LightParams> lights,
+                                    const uint32_t cur_frame) {
+    if (lights.size() > kMaxLights) {
+        throw std::runtime_error(
+            fmt::format("too many lights: {} (max {})", lights.size(), kMaxLights));
+    }
+    auto& buffer = buffers_.at(cur_frame);
+    const auto header = LightBufferHeader{.num_lights = static_cast<uint32_t>(lights.size())};
+    buffer.UpdateBuffer(&header, sizeof(header));
+    if (!lights.empty()) {
+        buffer.UpdateBuffer(lights.data(), lights.size_bytes(), sizeof(LightBufferHeader));
+    }
+}
+}  // namespace vlux
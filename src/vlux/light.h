@@ -2,6 +2,10 @@
 #define LIGHT_H
 
 #include "pch.h"
+//
+#include <span>
+
+#include "common/buffer.h"
 
 namespace vlux {
 struct LightParams {
@@ -9,6 +13,38 @@ struct LightParams {
     alignas(4) float range;
     alignas(16) glm::vec4 color;
 };
+
+//! capacity of `LightBuffer`
+constexpr auto kMaxLights = uint32_t{4096};
+
+/**
+ * @brief Per-frame storage buffers of point lights
+ *
+ * The layout matches `ssbo_light` in shader/rasterize/light.glsl (std430):
+ * `uint num_lights` padded to 16 bytes, followed by `LightParams[kMaxLights]`.
+ */
+class LightBuffer {
+   public:
+    LightBuffer(const VkDevice device, const VkPhysicalDevice physical_device);
+    ~LightBuffer() = default;
+    LightBuffer(const LightBuffer&) = delete;
+    LightBuffer& operator=(const LightBuffer&) = delete;
+
+    VkBuffer GetVkBuffer(const size_t idx) const { return buffers_.at(idx).GetVkBuffer(); }
+    VkDeviceSize GetSize() const { return buffers_.front().GetSize(); }
+
+    /**
+     * @brief Upload the lights used by the frame slot `cur_frame`
+     *
+     * @param lights at most `kMaxLights` lights
+     * @param cur_frame
+     */
+    void UpdateLightBuffer(const std::span<const LightParams> lights, const uint32_t cur_frame);
+
+   private:
+    //! (kMaxFramesInFlight,)
+    std::vector<Buffer> buffers_;
+};
 }  // namespace vlux
 
-#endif  // LIGHT_H
\ No newline at end of file
+#endif  // LIGHT_H
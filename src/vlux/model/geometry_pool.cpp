@@ -0,0 +1,61 @@
+#include "geometry_pool.h"
+
+#include <numeric>
+
+#include "index.h"
+
+namespace vlux {
+namespace {
+constexpr auto kGeometryUsage =
+    VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+    VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+    VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+
+VkDeviceSize GetMinStorageBufferOffsetAlignment(const VkPhysicalDevice physical_device) {
+    auto properties = VkPhysicalDeviceProperties{};
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+    return properties.limits.minStorageBufferOffsetAlignment;
+}
+}  // namespace
+
+GeometryPool::GeometryPool(const VkDevice device, const VkPhysicalDevice physical_device,
+                           const VertexFormat vertex_format, const VkIndexType index_type,
+                           const GeometryPoolCapacity& capacity)
+    : vertex_format_(vertex_format),
+      index_type_(index_type),
+      // the mesh shader path binds a model's vertices as a storage buffer at its offset
+      vertex_alignment_(std::lcm(VkDeviceSize{GetVertexStride(vertex_format)},
+                                 GetMinStorageBufferOffsetAlignment(physical_device))),
+      index_alignment_(GetIndexSize(index_type)),
+      vertex_ranges_(GetVertexStride(vertex_format) * capacity.num_vertices +
+                     vertex_alignment_ * capacity.num_vertex_buffers),
+      index_ranges_(GetIndexSize(index_type) * capacity.num_indices +
+                    index_alignment_ * capacity.num_index_buffers) {
+    // buffers are never empty
+    vertex_buffer_.emplace(device, physical_device,
+                           kGeometryUsage | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                           std::max(vertex_ranges_.GetSize(), VkDeviceSize{1}), nullptr);
+    index_buffer_.emplace(device, physical_device,
+                          kGeometryUsage | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                          std::max(index_ranges_.GetSize(), VkDeviceSize{1}), nullptr);
+}
+
+VkDeviceSize GeometryPool::AllocateVertices(const VkDeviceSize size) {
+    const auto offset = vertex_ranges_.Allocate(size, vertex_alignment_);
+    if (!offset.has_value()) {
+        throw std::runtime_error("geometry pool: out of vertex capacity!");
+    }
+    return offset.value();
+}
+
+VkDeviceSize GeometryPool::AllocateIndices(const VkDeviceSize size) {
+    const auto offset = index_ranges_.Allocate(size, index_alignment_);
+    if (!offset.has_value()) {
+        throw std::runtime_error("geometry pool: out of index capacity!");
+    }
+    return offset.value();
+}
+
+}  // namespace vlux
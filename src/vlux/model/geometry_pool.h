@@ -0,0 +1,63 @@
+#ifndef MODEL_GEOMETRY_POOL_H
+#define MODEL_GEOMETRY_POOL_H
+
+#include "pch.h"
+//
+#include "common/buffer.h"
+#include "common/suballocator.h"
+#include "vertex.h"
+
+namespace vlux {
+
+//! what a `GeometryPool` has to hold; each buffer may waste up to one alignment of padding
+struct GeometryPoolCapacity {
+    size_t num_vertex_buffers = 0;
+    size_t num_vertices = 0;
+    size_t num_index_buffers = 0;
+    size_t num_indices = 0;
+};
+
+/**
+ * @brief Device-local vertex and index buffers shared by every model of a scene
+ *
+ * `VertexBuffer` and `IndexBuffer` are ranges of the pool, so the indirect path draws the whole
+ * scene from the two buffers, the other paths bind a model's range by offset, and the ray
+ * tracer reads the same memory by device address. Every vertex range starts at a whole vertex
+ * and at a valid storage buffer offset, and every index range at a whole index of the scene's
+ * single index type.
+ */
+class GeometryPool {
+   public:
+    GeometryPool(const VkDevice device, const VkPhysicalDevice physical_device,
+                 const VertexFormat vertex_format, const VkIndexType index_type,
+                 const GeometryPoolCapacity& capacity);
+    ~GeometryPool() = default;
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+    GeometryPool(GeometryPool&&) = default;
+    GeometryPool& operator=(GeometryPool&&) = delete;
+
+    //! @return byte offset of `size` bytes in the vertex buffer
+    VkDeviceSize AllocateVertices(const VkDeviceSize size);
+    //! @return byte offset of `size` bytes in the index buffer
+    VkDeviceSize AllocateIndices(const VkDeviceSize size);
+
+    const Buffer& GetVertexBuffer() const { return vertex_buffer_.value(); }
+    const Buffer& GetIndexBuffer() const { return index_buffer_.value(); }
+    VertexFormat GetVertexFormat() const { return vertex_format_; }
+    VkIndexType GetIndexType() const { return index_type_; }
+
+   private:
+    VertexFormat vertex_format_;
+    VkIndexType index_type_;
+    VkDeviceSize vertex_alignment_;
+    VkDeviceSize index_alignment_;
+    LinearSuballocator vertex_ranges_;
+    LinearSuballocator index_ranges_;
+    std::optional<Buffer> vertex_buffer_;
+    std::optional<Buffer> index_buffer_;
+};
+
+}  // namespace vlux
+
+#endif
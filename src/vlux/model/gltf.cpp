@@ -1,11 +1,58 @@
 #include "gltf.h"
 
+#include <numeric>
+
 #include "common/image.h"
+#include "vertex_decode.h"
 
 namespace vlux {
 
 namespace {
 
+/**
+ * @brief Widen the indices of `accessor`
+ *
+ * @throw std::runtime_error if the accessor is out of its buffer or an index is not below
+ * `num_vertices`
+ */
+template <typename T>
+std::vector<Index> ReadIndices(const tinygltf::Model& model, const tinygltf::Accessor& accessor,
+                               const size_t num_vertices) {
+    if (accessor.count == 0) {
+        return {};
+    }
+    const auto* data = GetBufferViewData(model, accessor.bufferView, accessor.byteOffset,
+                                         sizeof(T) * accessor.count);
+    auto indices = std::vector<Index>(accessor.count);
+    for (size_t i = 0; i < accessor.count; i++) {
+        auto index = T{};
+        memcpy(&index, data + sizeof(T) * i, sizeof(T));
+        if (index >= num_vertices) {
+            throw std::runtime_error(fmt::format("invalid index: {}", index));
+        }
+        indices[i] = index;
+    }
+    return indices;
+}
+
+/**
+ * @brief Decode the `name` attribute of `primitive` into `member` of every vertex
+ */
+template <typename T>
+void DecodeVertexAttribute(const tinygltf::Primitive& primitive, const tinygltf::Model& model,
+                           const std::string& name, T Vertex::*member,
+                           std::vector<Vertex>& vertices) {
+    const auto& accessor = model.accessors[primitive.attributes.at(name)];
+    if (accessor.count != vertices.size()) {
+        throw std::runtime_error(fmt::format("count mismatched: `{}`", name));
+    }
+    if (vertices.empty()) {
+        return;
+    }
+    DecodeAccessor(model, accessor, T::length(),
+                   reinterpret_cast<std::byte*>(&(vertices.front().*member)), sizeof(Vertex));
+}
+
 // TODO: This function is not working correctly
 std::vector<glm::vec4> ComputeTangentFrame(const std::vector<Vertex>& vertices,
                                            const std::vector<Index>& indices) {
@@ -68,27 +115,11 @@ std::vector<glm::vec4> ComputeTangentFrame(const std::vector<Vertex>& vertices,
 }
 }  // namespace
 
-GltfObject LoadGltfObjects(const tinygltf::Primitive& primitive, const tinygltf::Model& model,
-                           const VkQueue graphics_queue, const VkCommandPool command_pool,
-                           const VkPhysicalDevice physical_device, const VkDevice device,
-                           const float scale, const glm::vec3& translation,
-                           const glm::vec3& rotation) {
-    auto indices = std::vector<Index>();
-    [&]() {
-        {
-            const auto& attribute = primitive.indices;
-            const auto& accessor = model.accessors[attribute];
-            const auto& bufferView = model.bufferViews[accessor.bufferView];
-            const auto& buffer = model.buffers[bufferView.buffer];
-            const uint16_t* indices_tmp = reinterpret_cast<const uint16_t*>(
-                &buffer.data[bufferView.byteOffset + accessor.byteOffset]);
-            indices.resize(accessor.count);
-            for (size_t i = 0; i < accessor.count; i++) {
-                indices[i] = static_cast<uint16_t>(indices_tmp[i]);
-            }
-        }
-    }();
-
+GltfPrimitive DecodeGltfPrimitive(const tinygltf::Primitive& primitive,
+                                  const tinygltf::Model& model, const float scale,
+                                  const glm::vec3& translation, const glm::vec3& rotation,
+                                  const MeshOptimizationOptions& mesh_optimization,
+                                  const LodOptions& lod) {
     // Create rotation matrices
     glm::mat4 rot_yaw =
         glm::rotate(glm::mat4(1.0f), glm::radians(rotation.x), glm::vec3(0.0f, 1.0f, 0.0f));
@@ -98,78 +129,65 @@ GltfObject LoadGltfObjects(const tinygltf::Primitive& primitive, const tinygltf:
         glm::rotate(glm::mat4(1.0f), glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
     const auto rotation_matrix = rot_yaw * rot_pitch * rot_roll;
 
-    // Vertices
-    auto vertices_size = 0uz;
-    auto vertices = std::vector<Vertex>();
-    [&]() {
-        auto positions = std::vector<glm::vec3>();
-        const auto& attribute = primitive.attributes.at("POSITION");
-        const auto& accessor = model.accessors[attribute];
-        const auto& bufferView = model.bufferViews[accessor.bufferView];
-        const auto& buffer = model.buffers[bufferView.buffer];
-        const float* pos = reinterpret_cast<const float*>(
-            &buffer.data[bufferView.byteOffset + accessor.byteOffset]);
-        vertices_size = accessor.count;
-        vertices.resize(vertices_size);
-
-        for (size_t i = 0; i < vertices_size; ++i) {
-            vertices[i].pos = {pos[i * 3 + 0], pos[i * 3 + 1], pos[i * 3 + 2]};
-
-            // Rotate
-            vertices[i].pos = glm::vec3(rotation_matrix * glm::vec4(vertices[i].pos, 1.0f));
-
-            // scale + translation
-            vertices[i].pos = vertices[i].pos * scale + translation;
-        }
-    }();
+    // Vertices: every attribute is decoded straight into its `Vertex` field
+    const auto& position_accessor = model.accessors[primitive.attributes.at("POSITION")];
+    auto vertices = std::vector<Vertex>(position_accessor.count);
+    DecodeVertexAttribute(primitive, model, "POSITION", &Vertex::pos, vertices);
+    DecodeVertexAttribute(primitive, model, "NORMAL", &Vertex::normal, vertices);
+    DecodeVertexAttribute(primitive, model, "TEXCOORD_0", &Vertex::uv, vertices);
+    const auto has_tangents = primitive.attributes.contains("TANGENT");
+    if (has_tangents) {
+        DecodeVertexAttribute(primitive, model, "TANGENT", &Vertex::tangent, vertices);
+    }
+    TransformVertices(vertices, rotation_matrix, scale, translation, has_tangents);
 
+    // indices of any component type are widened here; `IndexBuffer` narrows them again
+    auto indices = std::vector<Index>();
     [&]() {
-        const auto& attribute = primitive.attributes.at("TEXCOORD_0");
-        const auto& accessor = model.accessors[attribute];
-        const auto& bufferView = model.bufferViews[accessor.bufferView];
-        const auto& buffer = model.buffers[bufferView.buffer];
-        const float* uv = reinterpret_cast<const float*>(
-            &buffer.data[bufferView.byteOffset + accessor.byteOffset]);
-        assert(vertices_size == accessor.count && "count mismatched: `TEXCOORD_0`");
-        for (size_t i = 0; i < vertices_size; ++i) {
-            vertices[i].uv = {uv[i * 2 + 0], uv[i * 2 + 1]};
+        // non-indexed primitives draw their vertices in order
+        if (primitive.indices < 0) {
+            indices.resize(vertices.size());
+            std::iota(indices.begin(), indices.end(), Index{0});
+            return;
         }
-    }();
-
-    [&]() {
-        const auto& attribute = primitive.attributes.at("NORMAL");
-        const auto& accessor = model.accessors[attribute];
-        const auto& bufferView = model.bufferViews[accessor.bufferView];
-        const auto& buffer = model.buffers[bufferView.buffer];
-        const float* normal = reinterpret_cast<const float*>(
-            &buffer.data[bufferView.byteOffset + accessor.byteOffset]);
-        assert(vertices_size == accessor.count && "count mismatched: `NORMAL`");
-        for (size_t i = 0; i < vertices_size; ++i) {
-            vertices[i].normal = {normal[i * 3 + 0], normal[i * 3 + 1], normal[i * 3 + 2]};
-            vertices[i].normal = glm::vec3(rotation_matrix * glm::vec4(vertices[i].normal, 1.0f));
+        const auto& accessor = model.accessors.at(primitive.indices);
+        switch (accessor.componentType) {
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                indices = ReadIndices<uint8_t>(model, accessor, vertices.size());
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                indices = ReadIndices<uint16_t>(model, accessor, vertices.size());
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+                indices = ReadIndices<uint32_t>(model, accessor, vertices.size());
+                break;
+            default:
+                throw std::runtime_error(
+                    fmt::format("unsupported index component type: {}", accessor.componentType));
         }
     }();
-    [&]() {
-        if (primitive.attributes.contains("TANGENT")) {
-            const auto& attribute = primitive.attributes.at("TANGENT");
-            const auto& accessor = model.accessors[attribute];
-            const auto& bufferView = model.bufferViews[accessor.bufferView];
-            const auto& buffer = model.buffers[bufferView.buffer];
-            const float* tangent = reinterpret_cast<const float*>(
-                &buffer.data[bufferView.byteOffset + accessor.byteOffset]);
-            assert(vertices_size == accessor.count && "count mismatched: `TANGENT`");
-            for (size_t i = 0; i < vertices_size; ++i) {
-                vertices[i].tangent = {tangent[i * 4 + 0], tangent[i * 4 + 1], tangent[i * 4 + 2],
-                                       tangent[i * 4 + 3]};
-            }
-
-        } else {
-            const auto tangents = ComputeTangentFrame(vertices, indices);
-            for (size_t i = 0; i < vertices_size; i++) {
-                vertices[i].tangent = {tangents[i].x, tangents[i].y, tangents[i].z, tangents[i].w};
-            }
+
+    if (!has_tangents) {
+        const auto tangents = ComputeTangentFrame(vertices, indices);
+        for (size_t i = 0; i < vertices.size(); i++) {
+            vertices[i].tangent = {tangents[i].x, tangents[i].y, tangents[i].z, tangents[i].w};
         }
-    }();
+    }
+
+    if (mesh_optimization.enable) {
+        const auto stats = OptimizeMesh(vertices, indices, mesh_optimization);
+        spdlog::debug("mesh optimization: {} -> {} vertices, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} "
+                      "-> {:.3f}",
+                      stats.before.num_vertices, stats.after.num_vertices, stats.before.GetAcmr(),
+                      stats.after.GetAcmr(), stats.before.GetAtvr(), stats.after.GetAtvr());
+    }
+
+    // every level indexes the same vertices, so it can be drawn with the same vertex buffer
+    auto lods = lod.enable ? GenerateLods(vertices, indices, lod) : std::vector<MeshLod>();
+    for (const auto& level : lods) {
+        spdlog::debug("lod: {} -> {} triangles, error {:.5f}", indices.size() / 3,
+                      level.indices.size() / 3, level.error);
+    }
 
     // Loading material
     const auto material = model.materials[primitive.material];
@@ -182,78 +200,61 @@ GltfObject LoadGltfObjects(const tinygltf::Primitive& primitive, const tinygltf:
     const auto metallic_factor = static_cast<float>(material.pbrMetallicRoughness.metallicFactor);
     const auto roughness_factor = static_cast<float>(material.pbrMetallicRoughness.roughnessFactor);
 
-    // texture
-    const auto get_image_idx = [&](const auto texture_idx) {
-        const auto& texture = model.textures[texture_idx];
-        return texture.source;
-    };
-
-    const auto create_image = [&](const auto image_idx) {
-        const auto& image = model.images[image_idx];
-        return Image(image.image, image.width, image.height, image.component);
+    // texture: only the image index is resolved here; the pixels are shared across primitives
+    const auto get_image_idx = [&](const int texture_idx) {
+        if (texture_idx == -1) {
+            return -1;
+        }
+        return model.textures[texture_idx].source;
     };
 
-    const auto create_texture = [&](const auto& image) {
-        return std::make_shared<Texture<uint8_t>>(image, graphics_queue, command_pool, device,
-                                                  physical_device);
+    return {
+        .indices = std::move(indices),
+        .lods = std::move(lods),
+        .vertices = std::move(vertices),
+        .base_color_factor = base_color_factor,
+        .metallic_factor = metallic_factor,
+        .roughness_factor = roughness_factor,
+        .base_color_image = get_image_idx(material.pbrMetallicRoughness.baseColorTexture.index),
+        .normal_image = get_image_idx(material.normalTexture.index),
+        .emissive_image = get_image_idx(material.emissiveTexture.index),
+        .occlusion_roughness_metallic_image =
+            get_image_idx(material.pbrMetallicRoughness.metallicRoughnessTexture.index),
     };
+}
 
-    auto base_color_texture = [&]() -> std::shared_ptr<Texture<uint8_t>> {
-        const auto idx = material.pbrMetallicRoughness.baseColorTexture.index;
-        if (idx == -1) {
-            return nullptr;
-        }
-        const auto image = create_image(get_image_idx(idx));
-        return create_texture(image);
-    }();
-
-    auto normal_texture = [&]() -> std::shared_ptr<Texture<uint8_t>> {
-        const auto idx = material.normalTexture.index;
-        if (idx == -1) {
-            return nullptr;
-        }
-        auto image = create_image(get_image_idx(idx));
-        return create_texture(image);
-    }();
-
-    auto occlusion_texture = [&]() -> std::shared_ptr<Texture<uint8_t>> {
-        const auto idx = material.occlusionTexture.index;
-        if (idx == -1) {
-            return nullptr;
-        }
-        auto image = create_image(get_image_idx(idx));
-        return create_texture(image);
-    }();
-
-    auto emmisive_texture = [&]() -> std::shared_ptr<Texture<uint8_t>> {
-        const auto idx = material.emissiveTexture.index;
-        if (idx == -1) {
-            return nullptr;
-        }
-        auto image = create_image(get_image_idx(idx));
-        return create_texture(image);
-    }();
-
-    auto metallic_roughness_texture = [&]() -> std::shared_ptr<Texture<uint8_t>> {
-        const auto idx = material.pbrMetallicRoughness.metallicRoughnessTexture.index;
-        if (idx == -1) {
+GltfObject CreateGltfObject(GltfPrimitive&& primitive, const tinygltf::Model& model,
+                            const std::filesystem::path& path, TextureCache& texture_cache,
+                            Uploader& uploader, const VkPhysicalDevice physical_device,
+                            const VkDevice device) {
+    const auto get_texture = [&](const int image_idx) -> std::shared_ptr<Texture<uint8_t>> {
+        if (image_idx == -1) {
             return nullptr;
         }
-        auto image = create_image(get_image_idx(idx));
-        return create_texture(image);
-    }();
+        const auto create_texture = [&]() {
+            const auto& gltf_image = model.images[image_idx];
+            const auto image =
+                Image(gltf_image.image, gltf_image.width, gltf_image.height, gltf_image.component);
+            return std::make_shared<Texture<uint8_t>>(image, uploader, device, physical_device,
+                                                      kGltfTextureFormat);
+        };
+        return texture_cache.GetOrCreate(
+            {.path = path, .image_index = image_idx, .format = kGltfTextureFormat},
+            create_texture);
+    };
 
     return {
-        .indices = indices,
-        .vertices = vertices,
-        .base_color_factor = base_color_factor,
-        .metallic_factor = metallic_factor,
-        .roughness_factor = roughness_factor,
-        .base_color_texture = base_color_texture,
-        .normal_texture = normal_texture,
-        .occlusion_texture = occlusion_texture,
-        .emissive_texture = emmisive_texture,
-        .occlusion_roughness_metallic_texture = metallic_roughness_texture,
+        .indices = std::move(primitive.indices),
+        .lods = std::move(primitive.lods),
+        .vertices = std::move(primitive.vertices),
+        .base_color_factor = primitive.base_color_factor,
+        .metallic_factor = primitive.metallic_factor,
+        .roughness_factor = primitive.roughness_factor,
+        .base_color_texture = get_texture(primitive.base_color_image),
+        .normal_texture = get_texture(primitive.normal_image),
+        .emissive_texture = get_texture(primitive.emissive_image),
+        .occlusion_roughness_metallic_texture =
+            get_texture(primitive.occlusion_roughness_metallic_image),
     };
 }
 
@@ -265,7 +266,8 @@ tinygltf::Model LoadTinyGltfModel(const std::filesystem::path& path) {
     std::string err;
     std::string warn;
 
-    static tinygltf::TinyGLTF gltf;
+    // one loader per call: models are loaded from several threads
+    tinygltf::TinyGLTF gltf;
 
     if (path.extension().string() == ".glb") {
         if (!gltf.LoadBinaryFromFile(&model, &err, &warn, path.string())) {
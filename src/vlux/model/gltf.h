@@ -4,9 +4,12 @@
 #include "pch.h"
 //
 #include "index.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
 #include "vertex.h"
 //
 #include "../texture/texture.h"
+#include "../texture/texture_cache.h"
 
 namespace vlux::internal {
 bool ComputeTangentFrame(std::vector<Vertex>& vertices, const std::vector<Index>& indices);
@@ -15,38 +18,76 @@ bool ComputeTangentFrame(std::vector<Vertex>& vertices, const std::vector<Index>
 namespace vlux {
 tinygltf::Model LoadTinyGltfModel(const std::filesystem::path& path);
 
+constexpr auto kGltfTextureFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+/**
+ * @brief CPU side of a glTF primitive: decoded attributes, material factors and the indices of
+ * its images (-1 if the slot is unused). Only the slots consumed by the renderers are kept; the
+ * occlusion texture is not.
+ */
+struct GltfPrimitive {
+    std::vector<Index> indices;
+    //! simplified levels of `indices`, most detailed first
+    std::vector<MeshLod> lods;
+    std::vector<Vertex> vertices;
+    glm::vec4 base_color_factor;
+    float metallic_factor;
+    float roughness_factor;
+    int base_color_image = -1;
+    int normal_image = -1;
+    int emissive_image = -1;
+    int occlusion_roughness_metallic_image = -1;
+};
+
 struct GltfObject {
     std::vector<Index> indices;
+    std::vector<MeshLod> lods;
     std::vector<Vertex> vertices;
     glm::vec4 base_color_factor;
     float metallic_factor;
     float roughness_factor;
     std::shared_ptr<Texture<uint8_t>> base_color_texture;
     std::shared_ptr<Texture<uint8_t>> normal_texture;
-    std::shared_ptr<Texture<uint8_t>> occlusion_texture;
     std::shared_ptr<Texture<uint8_t>> emissive_texture;
     std::shared_ptr<Texture<uint8_t>> occlusion_roughness_metallic_texture;
 };
 
 /**
- * @brief
+ * @brief Decode the attributes and material of a primitive. No Vulkan calls are made, so
+ * primitives can be decoded on worker threads.
  *
  * @param primitive
  * @param model
- * @param graphics_queue
- * @param command_pool
- * @param physical_device
- * @param device
  * @param scale
  * @param translation
  * @param rotation vec3 (yaw, pitch, roll). It is in degrees.
+ * @param mesh_optimization applied to the decoded vertices and indices
+ * @param lod LOD chain generated from the optimized indices
+ * @return GltfPrimitive
+ */
+GltfPrimitive DecodeGltfPrimitive(const tinygltf::Primitive& primitive,
+                                  const tinygltf::Model& model, const float scale,
+                                  const glm::vec3& translation = {0.0f, 0.0f, 0.0f},
+                                  const glm::vec3& rotation = {0.0f, 0.0f, 0.0f},
+                                  const MeshOptimizationOptions& mesh_optimization = {},
+                                  const LodOptions& lod = {});
+
+/**
+ * @brief Look up or create the textures of a decoded primitive
+ *
+ * @param primitive
+ * @param model the asset `primitive` was decoded from
+ * @param path path of `model`, used as the texture cache key
+ * @param texture_cache
+ * @param uploader uploads new textures; they are ready once it has been waited for
+ * @param physical_device
+ * @param device
  * @return GltfObject
  */
-GltfObject LoadGltfObjects(const tinygltf::Primitive& primitive, const tinygltf::Model& model,
-                           const VkQueue graphics_queue, const VkCommandPool command_pool,
-                           const VkPhysicalDevice physical_device, const VkDevice device,
-                           const float scale, const glm::vec3& translation = {0.0f, 0.0f, 0.0f},
-                           const glm::vec3& rotation = {0.0f, 0.0f, 0.0f});
+GltfObject CreateGltfObject(GltfPrimitive&& primitive, const tinygltf::Model& model,
+                            const std::filesystem::path& path, TextureCache& texture_cache,
+                            Uploader& uploader, const VkPhysicalDevice physical_device,
+                            const VkDevice device);
 
 class GLTF {
    public:
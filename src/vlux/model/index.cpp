@@ -1,23 +1,113 @@
 #include "index.h"
 
+#include <limits>
+
+#include "geometry_pool.h"
+#include "utils/hash.h"
+
 namespace vlux {
-IndexBuffer::IndexBuffer(const VkDevice device, const VkPhysicalDevice physical_device,
-                         const VkQueue queue, const VkCommandPool command_pool,
-                         std::vector<Index>&& indices)
-    : device_(device), index_count_(indices.size()), indices_(std::move(indices)) {
-    const auto buffer_size = static_cast<VkDeviceSize>(sizeof(Index) * indices_.size());
-    assert(buffer_size > 0);
-    const auto staging_buffer =
-        Buffer(device_, physical_device, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-               buffer_size, indices_.data());
-
-    buffer_.emplace(device_, physical_device,
-                    VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer_size, nullptr);
-
-    CopyBuffer(staging_buffer.GetVkBuffer(), buffer_->GetVkBuffer(), buffer_size, command_pool,
-               queue, device_);
-}
-
-}  // namespace vlux
\ No newline at end of file
+namespace {
+template <typename T>
+std::vector<std::byte> PackIndicesAs(const std::span<const Index> indices) {
+    auto packed = std::vector<std::byte>(sizeof(T) * indices.size());
+    auto* dst = reinterpret_cast<T*>(packed.data());
+    for (size_t i = 0; i < indices.size(); i++) {
+        dst[i] = static_cast<T>(indices[i]);
+    }
+    return packed;
+}
+
+template <typename T>
+std::vector<Index> UnpackIndicesAs(const std::span<const std::byte> packed_indices) {
+    auto indices = std::vector<Index>(packed_indices.size() / sizeof(T));
+    for (size_t i = 0; i < indices.size(); i++) {
+        auto index = T{};
+        memcpy(&index, packed_indices.data() + sizeof(T) * i, sizeof(T));
+        indices[i] = index;
+    }
+    return indices;
+}
+}  // namespace
+
+VkIndexType SelectIndexType(const Index max_index) {
+    if (max_index <= std::numeric_limits<uint16_t>::max()) {
+        return VK_INDEX_TYPE_UINT16;
+    }
+    return VK_INDEX_TYPE_UINT32;
+}
+
+size_t GetIndexSize(const VkIndexType index_type) {
+    switch (index_type) {
+        case VK_INDEX_TYPE_UINT16:
+            return sizeof(uint16_t);
+        case VK_INDEX_TYPE_UINT32:
+            return sizeof(uint32_t);
+        default:
+            throw std::runtime_error(fmt::format("unsupported index type: {}",
+                                                 static_cast<int>(index_type)));
+    }
+}
+
+std::vector<std::byte> PackIndices(const std::span<const Index> indices,
+                                   const VkIndexType index_type) {
+    switch (index_type) {
+        case VK_INDEX_TYPE_UINT16:
+            return PackIndicesAs<uint16_t>(indices);
+        case VK_INDEX_TYPE_UINT32:
+            return PackIndicesAs<uint32_t>(indices);
+        default:
+            throw std::runtime_error(fmt::format("unsupported index type: {}",
+                                                 static_cast<int>(index_type)));
+    }
+}
+
+std::vector<Index> UnpackIndices(const std::span<const std::byte> packed_indices,
+                                 const VkIndexType index_type) {
+    switch (index_type) {
+        case VK_INDEX_TYPE_UINT16:
+            return UnpackIndicesAs<uint16_t>(packed_indices);
+        case VK_INDEX_TYPE_UINT32:
+            return UnpackIndicesAs<uint32_t>(packed_indices);
+        default:
+            throw std::runtime_error(fmt::format("unsupported index type: {}",
+                                                 static_cast<int>(index_type)));
+    }
+}
+
+IndexBuffer::IndexBuffer(GeometryPool& pool, Uploader& uploader,
+                         const std::span<const Index> indices, const float lod_error)
+    : index_count_(indices.size()),
+      index_type_(pool.GetIndexType()),
+      lod_error_(lod_error),
+      buffer_(pool.GetIndexBuffer().GetVkBuffer()) {
+    assert(indices.empty() || index_type_ == VK_INDEX_TYPE_UINT32 ||
+           SelectIndexType(std::ranges::max(indices)) == VK_INDEX_TYPE_UINT16);
+    Upload(pool, uploader, PackIndices(indices, index_type_));
+}
+
+IndexBuffer::IndexBuffer(GeometryPool& pool, Uploader& uploader,
+                         const std::span<const std::byte> packed_indices,
+                         const VkIndexType index_type, const float lod_error)
+    : index_count_(packed_indices.size() / GetIndexSize(index_type)),
+      index_type_(pool.GetIndexType()),
+      lod_error_(lod_error),
+      buffer_(pool.GetIndexBuffer().GetVkBuffer()) {
+    if (index_type == index_type_) {
+        Upload(pool, uploader, packed_indices);
+        return;
+    }
+    if (index_type_ != VK_INDEX_TYPE_UINT32) {
+        throw std::runtime_error("indices do not fit in the index type of the geometry pool");
+    }
+    Upload(pool, uploader, PackIndices(UnpackIndices(packed_indices, index_type), index_type_));
+}
+
+void IndexBuffer::Upload(GeometryPool& pool, Uploader& uploader,
+                         const std::span<const std::byte> packed_indices) {
+    assert(!packed_indices.empty());
+    offset_ = pool.AllocateIndices(packed_indices.size());
+    content_hash_ = HashBytes(packed_indices);
+    uploader.UploadBuffer(buffer_, packed_indices.data(), packed_indices.size(), offset_);
+}
+
+}  // namespace vlux
@@ -3,28 +3,102 @@
 
 #include "pch.h"
 //
+#include <span>
+
 #include "common/buffer.h"
+#include "common/uploader.h"
 
 namespace vlux {
-using Index = uint16_t;
+//! CPU side index; `IndexBuffer` stores indices at the narrowest width that fits
+using Index = uint32_t;
+
+/**
+ * @brief Narrowest index type that can hold `max_index`
+ *
+ * uint8 is not selected: it needs VK_EXT_index_type_uint8 and cannot be used for BLAS geometry,
+ * so 8-bit indices are stored as uint16.
+ *
+ * @param max_index
+ * @return VK_INDEX_TYPE_UINT16 or VK_INDEX_TYPE_UINT32
+ */
+VkIndexType SelectIndexType(const Index max_index);
+
+/**
+ * @brief Size of an index of `index_type` in bytes
+ */
+size_t GetIndexSize(const VkIndexType index_type);
+
+/**
+ * @brief Store `indices` as `index_type`
+ *
+ * @param indices every index must fit in `index_type`
+ * @param index_type
+ * @return packed indices
+ */
+std::vector<std::byte> PackIndices(const std::span<const Index> indices,
+                                   const VkIndexType index_type);
 
+/**
+ * @brief Inverse of `PackIndices`
+ */
+std::vector<Index> UnpackIndices(const std::span<const std::byte> packed_indices,
+                                 const VkIndexType index_type);
+
+class GeometryPool;
+
+/**
+ * @brief Indices of a mesh in a range of the scene's `GeometryPool`, stored as the pool's index
+ * type
+ */
 class IndexBuffer {
    public:
-    IndexBuffer(const VkDevice device, const VkPhysicalDevice physical_device, const VkQueue queue,
-                const VkCommandPool command_pool, std::vector<Index>&& indices);
+    /**
+     * @param pool
+     * @param uploader
+     * @param indices every index must fit in `pool.GetIndexType()`
+     * @param lod_error world-space error of `indices` against the full-detail mesh, 0 for it
+     */
+    IndexBuffer(GeometryPool& pool, Uploader& uploader, const std::span<const Index> indices,
+                const float lod_error = 0.0f);
+    /**
+     * @brief Upload indices that are already packed, e.g. from a memory-mapped file
+     *
+     * They are copied as is if `index_type` is the pool's and widened otherwise.
+     *
+     * @param pool
+     * @param uploader
+     * @param packed_indices see `PackIndices`
+     * @param index_type of `packed_indices`
+     * @param lod_error see above
+     */
+    IndexBuffer(GeometryPool& pool, Uploader& uploader,
+                const std::span<const std::byte> packed_indices, const VkIndexType index_type,
+                const float lod_error = 0.0f);
     ~IndexBuffer() = default;
 
-    VkBuffer GetVkBuffer() const { return buffer_->GetVkBuffer(); }
+    //! the pool's index buffer, shared with the other models
+    VkBuffer GetVkBuffer() const { return buffer_; }
+    //! byte offset of the first index in `GetVkBuffer()`
+    VkDeviceSize GetOffset() const { return offset_; }
+    VkIndexType GetIndexType() const { return index_type_; }
     size_t GetSize() const { return index_count_; }
-    const std::vector<Index>& GetIndices() const { return indices_; }
+    float GetLodError() const { return lod_error_; }
+    //! `HashBytes` of the indices as stored in the buffer
+    uint64_t GetContentHash() const { return content_hash_; }
 
    private:
-    const VkDevice device_;
+    //! copy `packed_indices`, stored as `index_type_`, into a new range of `pool`
+    void Upload(GeometryPool& pool, Uploader& uploader,
+                const std::span<const std::byte> packed_indices);
+
     const size_t index_count_;
+    const VkIndexType index_type_;
+    const float lod_error_;
+    const VkBuffer buffer_;
 
-    std::optional<Buffer> buffer_;
-    std::vector<Index> indices_;
+    VkDeviceSize offset_;
+    uint64_t content_hash_;
 };
 }  // namespace vlux
 
-#endif
\ No newline at end of file
+#endif
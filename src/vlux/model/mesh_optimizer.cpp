@@ -0,0 +1,354 @@
+#include "mesh_optimizer.h"
+
+#include <cmath>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+
+namespace vlux {
+namespace {
+// Forsyth's scoring parameters; the cache size only shapes the score, it need not match the GPU
+constexpr auto kScoringCacheSize = size_t{32};
+constexpr auto kCacheDecayPower = 1.5f;
+constexpr auto kLastTriangleScore = 0.75f;
+constexpr auto kValenceBoostScale = 2.0f;
+constexpr auto kValenceBoostPower = 0.5f;
+constexpr auto kInvalidTriangle = std::numeric_limits<size_t>::max();
+
+float GetVertexScore(const int cache_position, const uint32_t remaining_valence) {
+    if (remaining_valence == 0) {
+        // no triangle left to use it
+        return -1.0f;
+    }
+    auto score = 0.0f;
+    if (cache_position >= 0) {
+        if (cache_position < 3) {
+            // used by the last triangle; fixed score so that strips are not favoured over fans
+            score = kLastTriangleScore;
+        } else {
+            const auto scale = 1.0f / static_cast<float>(kScoringCacheSize - 3);
+            score = std::pow(1.0f - static_cast<float>(cache_position - 3) * scale,
+                             kCacheDecayPower);
+        }
+    }
+    // favour vertices with few triangles left so that they can leave the cache
+    score += kValenceBoostScale *
+             std::pow(static_cast<float>(remaining_valence), -kValenceBoostPower);
+    return score;
+}
+
+static_assert(sizeof(Vertex) == sizeof(float) * 12, "Vertex is compared bytewise; no padding");
+std::string_view GetVertexBytes(const Vertex& vertex) {
+    return {reinterpret_cast<const char*>(&vertex), sizeof(Vertex)};
+}
+}  // namespace
+
+MeshOptimizationOptions ParseMeshOptimizationOptions(const nlohmann::json& config) {
+    const auto defaults = MeshOptimizationOptions{};
+    return {
+        .enable = config.value("enable", defaults.enable),
+        .overdraw = config.value("overdraw", defaults.overdraw),
+        .overdraw_threshold = config.value("overdraw_threshold", defaults.overdraw_threshold),
+    };
+}
+
+VertexCacheStats AnalyzeVertexCache(const std::span<const Index> indices,
+                                    const size_t vertex_count, const size_t cache_size) {
+    auto stats = VertexCacheStats{.num_triangles = indices.size() / 3};
+    // a vertex is cached if it was transformed within the last `cache_size` misses
+    auto timestamps = std::vector<size_t>(vertex_count, 0);
+    auto timestamp = cache_size + 1;
+    auto used = std::vector<bool>(vertex_count, false);
+    for (const auto index : indices) {
+        if (timestamp - timestamps[index] > cache_size) {
+            timestamps[index] = timestamp++;
+            stats.num_transformed++;
+        }
+        if (!used[index]) {
+            used[index] = true;
+            stats.num_vertices++;
+        }
+    }
+    return stats;
+}
+
+void WeldVertices(std::vector<Vertex>& vertices, std::vector<Index>& indices) {
+    // keys view into `vertices`, which is not modified until the remap is done
+    auto unique_vertices = std::unordered_map<std::string_view, Index>();
+    unique_vertices.reserve(vertices.size());
+    auto remap = std::vector<Index>(vertices.size());
+    auto welded = std::vector<Vertex>();
+    welded.reserve(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const auto [it, inserted] = unique_vertices.emplace(GetVertexBytes(vertices[i]),
+                                                            static_cast<Index>(welded.size()));
+        if (inserted) {
+            welded.emplace_back(vertices[i]);
+        }
+        remap[i] = it->second;
+    }
+    for (auto& index : indices) {
+        index = remap[index];
+    }
+    vertices = std::move(welded);
+}
+
+std::vector<Index> OptimizeVertexCache(const std::span<const Index> indices,
+                                       const size_t vertex_count) {
+    const auto num_triangles = indices.size() / 3;
+
+    // triangles of each vertex: adjacency[offsets[v], offsets[v] + valence[v]); emitted
+    // triangles are swapped to the back and dropped from the valence
+    auto valence = std::vector<uint32_t>(vertex_count, 0);
+    for (const auto index : indices) {
+        valence[index]++;
+    }
+    auto offsets = std::vector<size_t>(vertex_count + 1, 0);
+    for (size_t v = 0; v < vertex_count; v++) {
+        offsets[v + 1] = offsets[v] + valence[v];
+    }
+    auto adjacency = std::vector<size_t>(indices.size());
+    [&]() {
+        auto cursor = std::vector<size_t>(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < num_triangles; t++) {
+            for (size_t k = 0; k < 3; k++) {
+                adjacency[cursor[indices[t * 3 + k]]++] = t;
+            }
+        }
+    }();
+
+    auto cache_position = std::vector<int>(vertex_count, -1);
+    auto vertex_score = std::vector<float>(vertex_count);
+    for (size_t v = 0; v < vertex_count; v++) {
+        vertex_score[v] = GetVertexScore(-1, valence[v]);
+    }
+    auto triangle_score = std::vector<float>(num_triangles);
+    for (size_t t = 0; t < num_triangles; t++) {
+        triangle_score[t] = vertex_score[indices[t * 3 + 0]] + vertex_score[indices[t * 3 + 1]] +
+                            vertex_score[indices[t * 3 + 2]];
+    }
+    auto emitted = std::vector<bool>(num_triangles, false);
+
+    auto cache = std::vector<Index>();
+    auto next_cache = std::vector<Index>();
+    cache.reserve(kScoringCacheSize + 3);
+    next_cache.reserve(kScoringCacheSize + 3);
+
+    auto result = std::vector<Index>();
+    result.reserve(num_triangles * 3);
+    auto best_triangle = kInvalidTriangle;
+    if (num_triangles > 0) {
+        const auto it = std::ranges::max_element(triangle_score);
+        best_triangle = static_cast<size_t>(std::distance(triangle_score.begin(), it));
+    }
+    auto scan_cursor = size_t{0};
+    for (size_t num_emitted = 0; num_emitted < num_triangles; num_emitted++) {
+        if (best_triangle == kInvalidTriangle) {
+            // nothing in the cache has triangles left: continue with the next one in input order
+            while (emitted[scan_cursor]) {
+                scan_cursor++;
+            }
+            best_triangle = scan_cursor;
+        }
+        const auto triangle = best_triangle;
+        emitted[triangle] = true;
+
+        next_cache.clear();
+        for (size_t k = 0; k < 3; k++) {
+            const auto v = indices[triangle * 3 + k];
+            result.emplace_back(v);
+
+            auto* triangles = adjacency.data() + offsets[v];
+            const auto it = std::find(triangles, triangles + valence[v], triangle);
+            std::swap(*it, triangles[valence[v] - 1]);
+            valence[v]--;
+
+            if (std::ranges::find(next_cache, v) == next_cache.end()) {
+                next_cache.emplace_back(v);
+            }
+        }
+        // least recently used entries move back
+        for (const auto v : cache) {
+            if (std::ranges::find(next_cache, v) == next_cache.end()) {
+                next_cache.emplace_back(v);
+            }
+        }
+        for (size_t i = kScoringCacheSize; i < next_cache.size(); i++) {
+            cache_position[next_cache[i]] = -1;
+        }
+        for (size_t i = 0; i < std::min<size_t>(next_cache.size(), kScoringCacheSize); i++) {
+            cache_position[next_cache[i]] = static_cast<int>(i);
+        }
+
+        // rescore the vertices that moved, evicted ones included, and their triangles
+        for (const auto v : next_cache) {
+            const auto score = GetVertexScore(cache_position[v], valence[v]);
+            const auto delta = score - vertex_score[v];
+            vertex_score[v] = score;
+            for (size_t i = 0; i < valence[v]; i++) {
+                triangle_score[adjacency[offsets[v] + i]] += delta;
+            }
+        }
+        if (next_cache.size() > kScoringCacheSize) {
+            next_cache.resize(kScoringCacheSize);
+        }
+        std::swap(cache, next_cache);
+
+        // the next triangle is the best one using a cached vertex
+        best_triangle = kInvalidTriangle;
+        auto best_score = std::numeric_limits<float>::lowest();
+        for (const auto v : cache) {
+            for (size_t i = 0; i < valence[v]; i++) {
+                const auto t = adjacency[offsets[v] + i];
+                if (triangle_score[t] > best_score) {
+                    best_score = triangle_score[t];
+                    best_triangle = t;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<Index> OptimizeOverdraw(const std::span<const Index> indices,
+                                    const std::span<const Vertex> vertices, const float threshold) {
+    constexpr auto kCacheSize = size_t{16};
+    const auto num_triangles = indices.size() / 3;
+    if (num_triangles == 0) {
+        return {indices.begin(), indices.end()};
+    }
+
+    // one FIFO cache simulation shared by both passes, see `AnalyzeVertexCache`; advancing the
+    // timestamp by more than the cache size empties the cache without touching every vertex
+    auto timestamps = std::vector<size_t>(vertices.size(), 0);
+    auto timestamp = kCacheSize + 1;
+    const auto reset_cache = [&]() { timestamp += kCacheSize + 1; };
+    const auto count_misses = [&](const size_t t) {
+        auto misses = size_t{0};
+        for (size_t k = 0; k < 3; k++) {
+            const auto v = indices[t * 3 + k];
+            if (timestamp - timestamps[v] > kCacheSize) {
+                timestamps[v] = timestamp++;
+                misses++;
+            }
+        }
+        return misses;
+    };
+
+    // hard boundaries: triangles missing the cache with every vertex can start a cluster for free
+    auto cluster_starts = std::vector<size_t>();
+    for (size_t t = 0; t < num_triangles; t++) {
+        const auto misses = count_misses(t);
+        if (t == 0 || misses == 3) {
+            cluster_starts.emplace_back(t);
+        }
+    }
+
+    // soft boundaries: split a cluster wherever its running ACMR drops below the threshold
+    auto clusters = std::vector<std::pair<size_t, size_t>>();  // [begin, end) triangles
+    for (size_t c = 0; c < cluster_starts.size(); c++) {
+        const auto begin = cluster_starts[c];
+        const auto end = c + 1 < cluster_starts.size() ? cluster_starts[c + 1] : num_triangles;
+        // ACMR of the whole cluster, drawn with a cold cache
+        reset_cache();
+        auto cluster_misses = size_t{0};
+        for (size_t t = begin; t < end; t++) {
+            cluster_misses += count_misses(t);
+        }
+        const auto cluster_acmr =
+            static_cast<float>(cluster_misses) / static_cast<float>(end - begin);
+
+        reset_cache();
+        auto start = begin;
+        auto misses = size_t{0};
+        for (size_t t = begin; t < end; t++) {
+            misses += count_misses(t);
+            const auto running_acmr =
+                static_cast<float>(misses) / static_cast<float>(t + 1 - start);
+            if (t + 1 < end && running_acmr <= cluster_acmr * threshold) {
+                clusters.emplace_back(start, t + 1);
+                start = t + 1;
+                misses = 0;
+                // a new cluster starts with a cold cache
+                reset_cache();
+            }
+        }
+        clusters.emplace_back(start, end);
+    }
+
+    // sort clusters by how far they face away from the mesh center
+    auto mesh_center = glm::vec3(0.0f);
+    for (const auto& vertex : vertices) {
+        mesh_center += vertex.pos;
+    }
+    mesh_center /= static_cast<float>(std::max<size_t>(vertices.size(), 1));
+
+    auto cluster_keys = std::vector<std::pair<float, size_t>>();
+    cluster_keys.reserve(clusters.size());
+    for (size_t c = 0; c < clusters.size(); c++) {
+        auto area_weighted_center = glm::vec3(0.0f);
+        auto area_weighted_normal = glm::vec3(0.0f);
+        auto total_area = 0.0f;
+        for (size_t t = clusters[c].first; t < clusters[c].second; t++) {
+            const auto& p0 = vertices[indices[t * 3 + 0]].pos;
+            const auto& p1 = vertices[indices[t * 3 + 1]].pos;
+            const auto& p2 = vertices[indices[t * 3 + 2]].pos;
+            const auto normal = glm::cross(p1 - p0, p2 - p0);  // length: twice the area
+            const auto area = glm::length(normal);
+            area_weighted_center += (p0 + p1 + p2) * (area / 3.0f);
+            area_weighted_normal += normal;
+            total_area += area;
+        }
+        auto key = 0.0f;
+        if (total_area > 0.0f && glm::length(area_weighted_normal) > 0.0f) {
+            key = glm::dot(area_weighted_center / total_area - mesh_center,
+                           glm::normalize(area_weighted_normal));
+        }
+        cluster_keys.emplace_back(key, c);
+    }
+    std::ranges::stable_sort(cluster_keys, std::ranges::greater{},
+                             [](const auto& key) { return key.first; });
+
+    auto result = std::vector<Index>();
+    result.reserve(indices.size());
+    for (const auto& [key, c] : cluster_keys) {
+        result.insert(result.end(), indices.begin() + clusters[c].first * 3,
+                      indices.begin() + clusters[c].second * 3);
+    }
+    return result;
+}
+
+void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<Index>& indices) {
+    constexpr auto kUnused = std::numeric_limits<Index>::max();
+    auto remap = std::vector<Index>(vertices.size(), kUnused);
+    auto reordered = std::vector<Vertex>();
+    reordered.reserve(vertices.size());
+    for (auto& index : indices) {
+        if (remap[index] == kUnused) {
+            remap[index] = static_cast<Index>(reordered.size());
+            reordered.emplace_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices = std::move(reordered);
+}
+
+MeshOptimizationStats OptimizeMesh(std::vector<Vertex>& vertices, std::vector<Index>& indices,
+                                   const MeshOptimizationOptions& options) {
+    auto stats = MeshOptimizationStats{
+        .before = AnalyzeVertexCache(indices, vertices.size()),
+    };
+    if (indices.empty() || indices.size() % 3 != 0) {
+        stats.after = stats.before;
+        return stats;
+    }
+    WeldVertices(vertices, indices);
+    indices = OptimizeVertexCache(indices, vertices.size());
+    if (options.overdraw) {
+        indices = OptimizeOverdraw(indices, vertices, options.overdraw_threshold);
+    }
+    OptimizeVertexFetch(vertices, indices);
+    stats.after = AnalyzeVertexCache(indices, vertices.size());
+    return stats;
+}
+}  // namespace vlux
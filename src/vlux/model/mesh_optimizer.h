@@ -0,0 +1,111 @@
+#ifndef MODEL_MESH_OPTIMIZER_H
+#define MODEL_MESH_OPTIMIZER_H
+#include "pch.h"
+//
+#include <span>
+
+#include "index.h"
+#include "vertex.h"
+
+namespace vlux {
+/**
+ * @brief Post-transform vertex cache behaviour of a triangle list, simulated with a FIFO cache
+ */
+struct VertexCacheStats {
+    size_t num_transformed = 0;
+    size_t num_triangles = 0;
+    size_t num_vertices = 0;
+
+    //! average cache miss ratio: transformed vertices per triangle, 0.5 at best, 3 at worst
+    float GetAcmr() const {
+        return num_triangles == 0 ? 0.0f : static_cast<float>(num_transformed) / num_triangles;
+    }
+    //! average transform to vertex ratio: 1 at best
+    float GetAtvr() const {
+        return num_vertices == 0 ? 0.0f : static_cast<float>(num_transformed) / num_vertices;
+    }
+    VertexCacheStats& operator+=(const VertexCacheStats& other) {
+        num_transformed += other.num_transformed;
+        num_triangles += other.num_triangles;
+        num_vertices += other.num_vertices;
+        return *this;
+    }
+};
+
+struct MeshOptimizationOptions {
+    bool enable = true;
+    //! reorder triangles to draw outward-facing clusters first
+    bool overdraw = true;
+    //! ACMR increase allowed when splitting the triangle order into clusters for overdraw
+    float overdraw_threshold = 1.05f;
+};
+
+struct MeshOptimizationStats {
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+/**
+ * @brief Read the `mesh_optimization` section of the app config; missing keys keep the defaults
+ */
+MeshOptimizationOptions ParseMeshOptimizationOptions(const nlohmann::json& config);
+
+/**
+ * @brief Simulate a FIFO post-transform cache of `cache_size` entries
+ *
+ * @param indices triangle list
+ * @param vertex_count
+ * @param cache_size
+ * @return VertexCacheStats
+ */
+VertexCacheStats AnalyzeVertexCache(const std::span<const Index> indices,
+                                    const size_t vertex_count, const size_t cache_size = 16);
+
+/**
+ * @brief Merge bitwise identical vertices; vertices are kept in order of first occurrence
+ */
+void WeldVertices(std::vector<Vertex>& vertices, std::vector<Index>& indices);
+
+/**
+ * @brief Reorder triangles for post-transform cache locality (Forsyth, "Linear-Speed Vertex
+ * Cache Optimisation")
+ *
+ * @param indices triangle list
+ * @param vertex_count
+ * @return reordered indices
+ */
+std::vector<Index> OptimizeVertexCache(const std::span<const Index> indices,
+                                       const size_t vertex_count);
+
+/**
+ * @brief Reorder clusters of a cache-optimized triangle list so that outward-facing ones are drawn
+ * first (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw")
+ *
+ * @param indices triangle list, ideally from `OptimizeVertexCache`
+ * @param vertices
+ * @param threshold ACMR increase allowed by splitting into more clusters
+ * @return reordered indices
+ */
+std::vector<Index> OptimizeOverdraw(const std::span<const Index> indices,
+                                    const std::span<const Vertex> vertices, const float threshold);
+
+/**
+ * @brief Reorder vertices in order of first use and drop unreferenced ones
+ */
+void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<Index>& indices);
+
+/**
+ * @brief Weld, reorder for the vertex cache, optionally for overdraw, then for vertex fetch
+ *
+ * Meshes that are not triangle lists are left as is.
+ *
+ * @param vertices
+ * @param indices
+ * @param options
+ * @return cache stats before and after
+ */
+MeshOptimizationStats OptimizeMesh(std::vector<Vertex>& vertices, std::vector<Index>& indices,
+                                   const MeshOptimizationOptions& options);
+}  // namespace vlux
+
+#endif
@@ -0,0 +1,300 @@
+#include "mesh_simplifier.h"
+
+#include <cmath>
+#include <string_view>
+#include <unordered_map>
+
+#include "mesh_optimizer.h"
+
+namespace vlux {
+namespace {
+//! levels smaller than this are not worth a draw of their own
+constexpr auto kMinLodIndexCount = size_t{3 * 32};
+//! a level has to drop at least this fraction of the indices of the previous one
+constexpr auto kMinLodReduction = 0.1f;
+
+/**
+ * @brief Sum of squared distances to weighted planes, as a symmetric 4x4 matrix
+ */
+struct Quadric {
+    // a2, ab, ac, ad, b2, bc, bd, c2, cd, d2
+    std::array<double, 10> m{};
+    double weight = 0.0;
+
+    Quadric& operator+=(const Quadric& other) {
+        for (size_t i = 0; i < m.size(); i++) {
+            m[i] += other.m[i];
+        }
+        weight += other.weight;
+        return *this;
+    }
+
+    double Evaluate(const glm::vec3& p) const {
+        const auto x = static_cast<double>(p.x);
+        const auto y = static_cast<double>(p.y);
+        const auto z = static_cast<double>(p.z);
+        return m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z + 2.0 * m[3] * x +
+               m[4] * y * y + 2.0 * m[5] * y * z + 2.0 * m[6] * y + m[7] * z * z +
+               2.0 * m[8] * z + m[9];
+    }
+};
+
+Quadric CreateTriangleQuadric(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2) {
+    const auto normal = glm::cross(p1 - p0, p2 - p0);
+    const auto length = glm::length(normal);
+    if (length == 0.0f) {
+        return {};
+    }
+    const auto n = normal / length;
+    const auto a = static_cast<double>(n.x);
+    const auto b = static_cast<double>(n.y);
+    const auto c = static_cast<double>(n.z);
+    const auto d = -static_cast<double>(glm::dot(n, p0));
+    // weighted by area
+    const auto w = static_cast<double>(length) * 0.5;
+    return {
+        .m = {a * a * w, a * b * w, a * c * w, a * d * w, b * b * w, b * c * w, b * d * w,
+              c * c * w, c * d * w, d * d * w},
+        .weight = w,
+    };
+}
+
+//! squared world-space distance, averaged over the area of the merged quadrics
+double GetCollapseCost(const Quadric& quadric, const glm::vec3& p) {
+    return quadric.weight > 0.0 ? std::max(quadric.Evaluate(p), 0.0) / quadric.weight : 0.0;
+}
+
+uint64_t GetEdgeKey(const Index a, const Index b) {
+    return (uint64_t{std::min(a, b)} << 32) | std::max(a, b);
+}
+
+/**
+ * @brief Vertices that must not move: ends of border edges and vertices sharing their position
+ * with another vertex (attribute seams)
+ */
+std::vector<bool> FindLockedVertices(const std::span<const Vertex> vertices,
+                                     const std::span<const Index> indices) {
+    auto locked = std::vector<bool>(vertices.size(), false);
+
+    auto positions = std::unordered_map<std::string_view, Index>();
+    positions.reserve(vertices.size());
+    for (size_t v = 0; v < vertices.size(); v++) {
+        const auto key = std::string_view(reinterpret_cast<const char*>(&vertices[v].pos),
+                                          sizeof(glm::vec3));
+        const auto [it, inserted] = positions.emplace(key, static_cast<Index>(v));
+        if (!inserted) {
+            locked[it->second] = true;
+            locked[v] = true;
+        }
+    }
+
+    auto edge_counts = std::unordered_map<uint64_t, uint32_t>();
+    edge_counts.reserve(indices.size());
+    for (size_t t = 0; t < indices.size(); t += 3) {
+        for (size_t k = 0; k < 3; k++) {
+            edge_counts[GetEdgeKey(indices[t + k], indices[t + (k + 1) % 3])]++;
+        }
+    }
+    for (const auto& [key, count] : edge_counts) {
+        if (count == 1) {
+            locked[key >> 32] = true;
+            locked[key & 0xffffffff] = true;
+        }
+    }
+    return locked;
+}
+
+struct Collapse {
+    double cost;
+    Index from;
+    Index to;
+};
+}  // namespace
+
+LodOptions ParseLodOptions(const nlohmann::json& config) {
+    const auto defaults = LodOptions{};
+    return {
+        .enable = config.value("enable", defaults.enable),
+        .max_levels = config.value("max_levels", defaults.max_levels),
+        .reduction = config.value("reduction", defaults.reduction),
+    };
+}
+
+MeshLod SimplifyMesh(const std::span<const Vertex> vertices, const std::span<const Index> indices,
+                     const size_t target_index_count) {
+    auto lod = MeshLod{.indices = std::vector<Index>(indices.begin(), indices.end())};
+    if (lod.indices.size() <= target_index_count) {
+        return lod;
+    }
+
+    const auto locked = FindLockedVertices(vertices, indices);
+    auto quadrics = std::vector<Quadric>(vertices.size());
+    for (size_t t = 0; t < indices.size(); t += 3) {
+        const auto quadric =
+            CreateTriangleQuadric(vertices[indices[t + 0]].pos, vertices[indices[t + 1]].pos,
+                                  vertices[indices[t + 2]].pos);
+        for (size_t k = 0; k < 3; k++) {
+            quadrics[indices[t + k]] += quadric;
+        }
+    }
+
+    // each pass sorts the collapses of every edge by cost and applies the cheapest ones whose
+    // neighbourhoods do not overlap
+    auto max_cost = 0.0;
+    auto remap = std::vector<Index>(vertices.size());
+    auto touched = std::vector<bool>(vertices.size());
+    auto adjacency_offsets = std::vector<size_t>(vertices.size() + 1);
+    auto adjacency = std::vector<size_t>();
+    auto edges = std::vector<uint64_t>();
+    auto collapses = std::vector<Collapse>();
+    while (lod.indices.size() > target_index_count) {
+        edges.clear();
+        for (size_t t = 0; t < lod.indices.size(); t += 3) {
+            for (size_t k = 0; k < 3; k++) {
+                edges.emplace_back(GetEdgeKey(lod.indices[t + k], lod.indices[t + (k + 1) % 3]));
+            }
+        }
+        std::ranges::sort(edges);
+        const auto [first, last] = std::ranges::unique(edges);
+        edges.erase(first, last);
+
+        collapses.clear();
+        for (const auto edge : edges) {
+            const auto a = static_cast<Index>(edge >> 32);
+            const auto b = static_cast<Index>(edge & 0xffffffff);
+            auto merged = quadrics[a];
+            merged += quadrics[b];
+            const auto cost_a_to_b = locked[a] ? -1.0 : GetCollapseCost(merged, vertices[b].pos);
+            const auto cost_b_to_a = locked[b] ? -1.0 : GetCollapseCost(merged, vertices[a].pos);
+            if (cost_a_to_b >= 0.0 && (cost_b_to_a < 0.0 || cost_a_to_b <= cost_b_to_a)) {
+                collapses.emplace_back(Collapse{.cost = cost_a_to_b, .from = a, .to = b});
+            } else if (cost_b_to_a >= 0.0) {
+                collapses.emplace_back(Collapse{.cost = cost_b_to_a, .from = b, .to = a});
+            }
+        }
+        if (collapses.empty()) {
+            break;
+        }
+        std::ranges::sort(collapses, {}, &Collapse::cost);
+
+        // triangles of each vertex
+        std::ranges::fill(adjacency_offsets, 0);
+        for (const auto index : lod.indices) {
+            adjacency_offsets[index + 1]++;
+        }
+        for (size_t v = 0; v < vertices.size(); v++) {
+            adjacency_offsets[v + 1] += adjacency_offsets[v];
+        }
+        adjacency.resize(lod.indices.size());
+        [&]() {
+            auto cursor =
+                std::vector<size_t>(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+            for (size_t i = 0; i < lod.indices.size(); i++) {
+                adjacency[cursor[lod.indices[i]]++] = i / 3;
+            }
+        }();
+
+        std::iota(remap.begin(), remap.end(), Index{0});
+        std::fill(touched.begin(), touched.end(), false);
+        const auto num_triangles_to_remove = (lod.indices.size() - target_index_count) / 3 + 1;
+        auto num_triangles_removed = size_t{0};
+        for (const auto& collapse : collapses) {
+            if (num_triangles_removed >= num_triangles_to_remove) {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to]) {
+                continue;
+            }
+            // reject collapses that flip a remaining triangle
+            const auto& from_pos = vertices[collapse.from].pos;
+            const auto& to_pos = vertices[collapse.to].pos;
+            auto num_degenerate = size_t{0};
+            auto flips = false;
+            for (auto i = adjacency_offsets[collapse.from];
+                 i < adjacency_offsets[collapse.from + 1]; i++) {
+                const auto* triangle = lod.indices.data() + adjacency[i] * 3;
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to ||
+                    triangle[2] == collapse.to) {
+                    num_degenerate++;
+                    continue;
+                }
+                auto p = std::array<glm::vec3, 3>();
+                for (size_t k = 0; k < 3; k++) {
+                    p[k] = vertices[triangle[k]].pos;
+                }
+                const auto normal_before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                for (auto& q : p) {
+                    if (q == from_pos) {
+                        q = to_pos;
+                    }
+                }
+                const auto normal_after = glm::cross(p[1] - p[0], p[2] - p[0]);
+                if (glm::dot(normal_before, normal_after) <= 0.0f) {
+                    flips = true;
+                    break;
+                }
+            }
+            if (flips) {
+                continue;
+            }
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            max_cost = std::max(max_cost, collapse.cost);
+            num_triangles_removed += num_degenerate;
+            for (auto i = adjacency_offsets[collapse.from];
+                 i < adjacency_offsets[collapse.from + 1]; i++) {
+                for (size_t k = 0; k < 3; k++) {
+                    touched[lod.indices[adjacency[i] * 3 + k]] = true;
+                }
+            }
+        }
+        if (num_triangles_removed == 0) {
+            break;
+        }
+
+        // apply the collapses and drop the triangles that became degenerate
+        auto num_indices = size_t{0};
+        for (size_t t = 0; t < lod.indices.size(); t += 3) {
+            const auto i0 = remap[lod.indices[t + 0]];
+            const auto i1 = remap[lod.indices[t + 1]];
+            const auto i2 = remap[lod.indices[t + 2]];
+            if (i0 == i1 || i1 == i2 || i2 == i0) {
+                continue;
+            }
+            lod.indices[num_indices++] = i0;
+            lod.indices[num_indices++] = i1;
+            lod.indices[num_indices++] = i2;
+        }
+        lod.indices.resize(num_indices);
+    }
+    lod.error = static_cast<float>(std::sqrt(max_cost));
+    return lod;
+}
+
+std::vector<MeshLod> GenerateLods(const std::span<const Vertex> vertices,
+                                  const std::span<const Index> indices, const LodOptions& options) {
+    auto lods = std::vector<MeshLod>();
+    if (indices.size() % 3 != 0) {
+        return lods;
+    }
+    auto previous = MeshLod{.indices = std::vector<Index>(indices.begin(), indices.end())};
+    for (uint32_t level = 0; level < options.max_levels; level++) {
+        const auto target_index_count =
+            static_cast<size_t>(static_cast<float>(previous.indices.size()) * options.reduction) /
+            3 * 3;
+        if (target_index_count < kMinLodIndexCount) {
+            break;
+        }
+        auto lod = SimplifyMesh(vertices, previous.indices, target_index_count);
+        if (static_cast<float>(lod.indices.size()) >
+            static_cast<float>(previous.indices.size()) * (1.0f - kMinLodReduction)) {
+            break;
+        }
+        lod.indices = OptimizeVertexCache(lod.indices, vertices.size());
+        lod.error += previous.error;
+        previous = lods.emplace_back(std::move(lod));
+    }
+    return lods;
+}
+}  // namespace vlux
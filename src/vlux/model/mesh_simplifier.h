@@ -0,0 +1,62 @@
+#ifndef MODEL_MESH_SIMPLIFIER_H
+#define MODEL_MESH_SIMPLIFIER_H
+#include "pch.h"
+//
+#include <span>
+
+#include "index.h"
+#include "vertex.h"
+
+namespace vlux {
+/**
+ * @brief Simplified triangle list over the vertices of the full-detail mesh
+ */
+struct MeshLod {
+    std::vector<Index> indices;
+    //! world-space distance the surface may deviate from the full-detail mesh
+    float error = 0.0f;
+};
+
+struct LodOptions {
+    bool enable = true;
+    //! levels in addition to the full-detail mesh
+    uint32_t max_levels = 4;
+    //! index count of a level relative to the previous one
+    float reduction = 0.5f;
+};
+
+/**
+ * @brief Read the `lod` section of the app config; missing keys keep the defaults
+ */
+LodOptions ParseLodOptions(const nlohmann::json& config);
+
+/**
+ * @brief Simplify a triangle list with quadric error metric edge collapses (Garland and Heckbert)
+ *
+ * Vertices are collapsed onto existing ones, so the result indexes `vertices` as is. Vertices on
+ * borders and attribute seams stay in place.
+ *
+ * @param vertices
+ * @param indices triangle list
+ * @param target_index_count collapses stop once the result has at most this many indices
+ * @return MeshLod with the largest collapse error
+ */
+MeshLod SimplifyMesh(const std::span<const Vertex> vertices, const std::span<const Index> indices,
+                     const size_t target_index_count);
+
+/**
+ * @brief Simplify a mesh repeatedly into a LOD chain
+ *
+ * Every level is simplified from the previous one and reordered for the vertex cache; its error
+ * includes the errors of the levels before it. The chain stops early once a level barely shrinks.
+ *
+ * @param vertices
+ * @param indices full-detail triangle list
+ * @param options
+ * @return levels from the most to the least detailed, without the full-detail mesh
+ */
+std::vector<MeshLod> GenerateLods(const std::span<const Vertex> vertices,
+                                  const std::span<const Index> indices, const LodOptions& options);
+}  // namespace vlux
+
+#endif
@@ -0,0 +1,133 @@
+#include "meshlet.h"
+
+namespace vlux {
+namespace {
+constexpr auto kUnusedVertex = uint8_t{0xff};
+//! normal cones wider than this (cos of the half-angle) never cull, so they are disabled
+constexpr auto kMinConeSpread = 0.1f;
+
+/**
+ * @brief Bounding sphere and normal cone of the last meshlet of `mesh`
+ */
+void ComputeMeshletBounds(const std::span<const Vertex> vertices, MeshletMesh& mesh) {
+    auto& meshlet = mesh.meshlets.back();
+    const auto get_pos = [&](const uint32_t local_index) -> const glm::vec3& {
+        return vertices[mesh.vertices[meshlet.vertex_offset + local_index]].pos;
+    };
+
+    auto bounds_min = get_pos(0);
+    auto bounds_max = get_pos(0);
+    for (uint32_t v = 1; v < meshlet.vertex_count; v++) {
+        bounds_min = glm::min(bounds_min, get_pos(v));
+        bounds_max = glm::max(bounds_max, get_pos(v));
+    }
+    const auto center = (bounds_min + bounds_max) * 0.5f;
+    auto radius = 0.0f;
+    for (uint32_t v = 0; v < meshlet.vertex_count; v++) {
+        radius = std::max(radius, glm::length(get_pos(v) - center));
+    }
+    meshlet.sphere = glm::vec4(center, radius);
+
+    // cone around the average face normal; degenerate triangles have no say
+    auto normals = std::vector<glm::vec3>();
+    normals.reserve(meshlet.triangle_count);
+    auto axis = glm::vec3(0.0f);
+    for (uint32_t t = 0; t < meshlet.triangle_count; t++) {
+        const auto triangle = mesh.triangles[meshlet.triangle_offset + t];
+        const auto& p0 = get_pos(triangle & 0xff);
+        const auto& p1 = get_pos((triangle >> 8) & 0xff);
+        const auto& p2 = get_pos((triangle >> 16) & 0xff);
+        const auto normal = glm::cross(p1 - p0, p2 - p0);
+        const auto length = glm::length(normal);
+        if (length > 0.0f) {
+            normals.emplace_back(normal / length);
+            axis += normals.back();
+        }
+    }
+    const auto axis_length = glm::length(axis);
+    if (normals.empty() || axis_length == 0.0f) {
+        meshlet.cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        return;
+    }
+    axis /= axis_length;
+    auto min_dot = 1.0f;
+    for (const auto& normal : normals) {
+        min_dot = std::min(min_dot, glm::dot(axis, normal));
+    }
+    // back-facing view directions form the cone with the complementary half-angle
+    const auto cutoff =
+        min_dot <= kMinConeSpread ? 1.0f : std::sqrt(std::max(1.0f - min_dot * min_dot, 0.0f));
+    meshlet.cone = glm::vec4(axis, cutoff);
+}
+}  // namespace
+
+MeshletMesh BuildMeshlets(const std::span<const Vertex> vertices,
+                          const std::span<const Index> indices) {
+    auto mesh = MeshletMesh();
+    // local index of every vertex in the open meshlet
+    auto local_indices = std::vector<uint8_t>(vertices.size(), kUnusedVertex);
+    auto meshlet = Meshlet{};
+
+    const auto close_meshlet = [&]() {
+        if (meshlet.triangle_count == 0) {
+            return;
+        }
+        for (uint32_t v = 0; v < meshlet.vertex_count; v++) {
+            local_indices[mesh.vertices[meshlet.vertex_offset + v]] = kUnusedVertex;
+        }
+        mesh.meshlets.emplace_back(meshlet);
+        ComputeMeshletBounds(vertices, mesh);
+        meshlet = Meshlet{
+            .vertex_offset = static_cast<uint32_t>(mesh.vertices.size()),
+            .triangle_offset = static_cast<uint32_t>(mesh.triangles.size()),
+        };
+    };
+
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        const auto a = indices[t + 0];
+        const auto b = indices[t + 1];
+        const auto c = indices[t + 2];
+        const auto num_new_vertices = static_cast<uint32_t>(local_indices[a] == kUnusedVertex) +
+                                      (local_indices[b] == kUnusedVertex && b != a) +
+                                      (local_indices[c] == kUnusedVertex && c != a && c != b);
+        if (meshlet.vertex_count + num_new_vertices > kMeshletMaxVertices ||
+            meshlet.triangle_count == kMeshletMaxTriangles) {
+            close_meshlet();
+        }
+
+        auto triangle = uint32_t{0};
+        const auto corners = std::to_array({a, b, c});
+        for (uint32_t k = 0; k < corners.size(); k++) {
+            const auto index = corners[k];
+            if (local_indices[index] == kUnusedVertex) {
+                local_indices[index] = static_cast<uint8_t>(meshlet.vertex_count++);
+                mesh.vertices.emplace_back(index);
+            }
+            triangle |= uint32_t{local_indices[index]} << (k * 8);
+        }
+        mesh.triangles.emplace_back(triangle);
+        meshlet.triangle_count++;
+    }
+    close_meshlet();
+    return mesh;
+}
+
+MeshletBuffer::MeshletBuffer(const VkDevice device, const VkPhysicalDevice physical_device,
+                             Uploader& uploader, const MeshletMesh& meshlet_mesh)
+    : meshlet_count_(static_cast<uint32_t>(meshlet_mesh.meshlets.size())) {
+    const auto create_buffer = [&](std::optional<Buffer>& buffer, const auto& data) {
+        // storage buffers cannot be empty
+        const auto size = std::max(static_cast<VkDeviceSize>(sizeof(data[0]) * data.size()),
+                                   VkDeviceSize{sizeof(data[0])});
+        buffer.emplace(device, physical_device,
+                       VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, size, nullptr);
+        if (!data.empty()) {
+            uploader.UploadBuffer(buffer->GetVkBuffer(), data.data(), sizeof(data[0]) * data.size());
+        }
+    };
+    create_buffer(meshlets_, meshlet_mesh.meshlets);
+    create_buffer(vertices_, meshlet_mesh.vertices);
+    create_buffer(triangles_, meshlet_mesh.triangles);
+}
+}  // namespace vlux
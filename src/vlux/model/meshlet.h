@@ -0,0 +1,87 @@
+#ifndef MODEL_MESHLET_H
+#define MODEL_MESHLET_H
+#include "pch.h"
+//
+#include <span>
+
+#include "common/buffer.h"
+#include "common/uploader.h"
+#include "index.h"
+#include "vertex.h"
+
+namespace vlux {
+//! limits of a meshlet; 64 vertices and 124 triangles keep the mesh shader outputs small
+constexpr auto kMeshletMaxVertices = uint32_t{64};
+constexpr auto kMeshletMaxTriangles = uint32_t{124};
+
+/**
+ * @brief Cluster of up to `kMeshletMaxTriangles` triangles over up to `kMeshletMaxVertices`
+ * vertices, with the bounds the task shader culls it by. std430 layout, see
+ * shader/rasterize/meshlet.glsl
+ */
+struct Meshlet {
+    //! first entry in `MeshletMesh::vertices`
+    uint32_t vertex_offset;
+    //! first entry in `MeshletMesh::triangles`
+    uint32_t triangle_offset;
+    uint32_t vertex_count;
+    uint32_t triangle_count;
+    //! xyz: center, w: radius
+    glm::vec4 sphere;
+    /**
+     * xyz: average normal, w: cutoff. The meshlet faces away from a camera at `camera_pos` if
+     * dot(center - camera_pos, axis) >= cutoff * length(center - camera_pos) + radius. A cutoff
+     * of 1 disables the test.
+     */
+    glm::vec4 cone;
+};
+static_assert(sizeof(Meshlet) == 48);
+
+struct MeshletMesh {
+    std::vector<Meshlet> meshlets;
+    //! vertex indices of all meshlets, `Meshlet::vertex_count` each
+    std::vector<uint32_t> vertices;
+    //! triangles of all meshlets as three 8-bit indices into the vertices of their meshlet
+    std::vector<uint32_t> triangles;
+};
+
+/**
+ * @brief Split a triangle list into meshlets in index order
+ *
+ * A meshlet is closed once the next triangle does not fit, so meshlets follow the triangle
+ * order; reorder the indices for the vertex cache first to get compact clusters.
+ *
+ * @param vertices
+ * @param indices triangle list
+ * @return MeshletMesh
+ */
+MeshletMesh BuildMeshlets(const std::span<const Vertex> vertices,
+                          const std::span<const Index> indices);
+
+/**
+ * @brief Meshlets of a mesh in storage buffers, read by the task and mesh shaders
+ */
+class MeshletBuffer {
+   public:
+    MeshletBuffer(const VkDevice device, const VkPhysicalDevice physical_device,
+                  Uploader& uploader, const MeshletMesh& meshlet_mesh);
+    ~MeshletBuffer() = default;
+    MeshletBuffer(const MeshletBuffer&) = delete;
+    MeshletBuffer& operator=(const MeshletBuffer&) = delete;
+    MeshletBuffer(MeshletBuffer&&) = default;
+    MeshletBuffer& operator=(MeshletBuffer&&) = default;
+
+    const Buffer& GetMeshlets() const { return meshlets_.value(); }
+    const Buffer& GetVertices() const { return vertices_.value(); }
+    const Buffer& GetTriangles() const { return triangles_.value(); }
+    uint32_t GetMeshletCount() const { return meshlet_count_; }
+
+   private:
+    uint32_t meshlet_count_;
+    std::optional<Buffer> meshlets_;
+    std::optional<Buffer> vertices_;
+    std::optional<Buffer> triangles_;
+};
+}  // namespace vlux
+
+#endif
@@ -8,7 +8,7 @@
 #include "pch.h"
 //
 #include "index.h"
-#include "uniform_buffer.h"
+#include "meshlet.h"
 #include "vertex.h"
 //
 #include "../texture/texture.h"
@@ -18,46 +18,61 @@ namespace vlux {
 struct MaterialParams {
     alignas(16) glm::vec4 base_color_factor;
     alignas(16) glm::vec4 metallic_roughnes_factor;
+    //! slots of `Scene::GetTextures`: base color, normal, emissive, occlusion roughness metallic;
+    //! `kNoTexture` where the material has none
+    alignas(16) glm::uvec4 texture_indices{0};
 };
 
+//! texture slot of a material without that texture; holds a null descriptor, sampled as zero
+constexpr auto kNoTexture = uint32_t{0};
+//! upper bound of the variable-count texture arrays, `kNoTexture` included
+constexpr auto kMaxTextures = uint32_t{4096};
+
 class Model {
    public:
     using ModelPixelType = uint8_t;
 
     Model() = delete;
-    Model(const VkDevice device, const VkPhysicalDevice physical_device,
-          std::vector<VertexBuffer>&& vertex_buffer, std::vector<IndexBuffer>&& index_buffer,
-          glm::vec4&& base_color_factor, const float metallic_factor, const float roughtness_factor,
+    Model(std::vector<VertexBuffer>&& vertex_buffer, std::vector<IndexBuffer>&& index_buffer,
+          std::optional<MeshletBuffer>&& meshlet_buffer, glm::vec4&& base_color_factor,
+          const float metallic_factor, const float roughtness_factor,
           std::shared_ptr<Texture<ModelPixelType>>&& base_color_texture,
           std::shared_ptr<Texture<ModelPixelType>>&& normal_texture,
           std::shared_ptr<Texture<ModelPixelType>>&& emissive_texture,
           std::shared_ptr<Texture<ModelPixelType>>&& metallic_roughness_texture)
         : vertex_buffers_(std::move(vertex_buffer)),
           index_buffers_(std::move(index_buffer)),
-          material_ubo_(std::make_unique<UniformBuffer<MaterialParams>>(device, physical_device)),
+          meshlet_buffer_(std::move(meshlet_buffer)),
+          material_params_{
+              .base_color_factor = base_color_factor,
+              .metallic_roughnes_factor = glm::vec4(metallic_factor, roughtness_factor, 0, 0),
+          },
           base_color_texture_(std::move(base_color_texture)),
           normal_texture_(std::move(normal_texture)),
           emissive_texture_(std::move(emissive_texture)),
-          metallic_roughness_texture_(std::move(metallic_roughness_texture)) {
-        // update ubo
-        for (auto frame_i = 0; frame_i < kMaxFramesInFlight; frame_i++) {
-            material_ubo_->UpdateUniformBuffer(
-                {
-                    .base_color_factor = base_color_factor,
-                    .metallic_roughnes_factor = glm::vec4(metallic_factor, roughtness_factor, 0, 0),
-                },
-                frame_i);
-        }
-    }
+          metallic_roughness_texture_(std::move(metallic_roughness_texture)) {}
     Model(const Model&) = delete;
     Model& operator=(const Model&) = delete;
     Model(Model&&) = default;
     Model& operator=(Model&&) = default;
 
     const std::vector<VertexBuffer>& GetVertexBuffers() const { return vertex_buffers_; }
+    //! full-detail indices first, then the LOD levels in order of increasing error
     const std::vector<IndexBuffer>& GetIndexBuffers() const { return index_buffers_; }
+    //! meshlets of the full-detail indices; only built if the device has mesh shaders
+    const std::optional<MeshletBuffer>& GetMeshletBuffer() const { return meshlet_buffer_; }
+
+    //! gathered into one storage buffer by the draw strategies, indexed by material id
+    const MaterialParams& GetMaterialParams() const { return material_params_; }
+    //! see `MaterialParams::texture_indices`; assigned by the `Scene`
+    void SetTextureIndices(const glm::uvec4& texture_indices) {
+        material_params_.texture_indices = texture_indices;
+    }
 
-    const UniformBuffer<MaterialParams>& GetMaterialUbo() const { return *material_ubo_; }
+    //! instance transform applied on top of the placement baked into the vertices at load time;
+    //! the ray tracer refits its top level acceleration structure when it changes
+    const glm::mat4& GetTransform() const { return transform_; }
+    void SetTransform(const glm::mat4& transform) { transform_ = transform; }
 
     std::shared_ptr<Texture<ModelPixelType>> GetBaseColorTexture() const {
         return base_color_texture_;
@@ -73,8 +88,10 @@ class Model {
    private:
     std::vector<VertexBuffer> vertex_buffers_;
     std::vector<IndexBuffer> index_buffers_;
+    std::optional<MeshletBuffer> meshlet_buffer_;
 
-    std::unique_ptr<UniformBuffer<MaterialParams>> material_ubo_;
+    MaterialParams material_params_;
+    glm::mat4 transform_{1.0f};
 
     std::shared_ptr<Texture<ModelPixelType>> base_color_texture_{nullptr};
     std::shared_ptr<Texture<ModelPixelType>> normal_texture_{nullptr};
@@ -1,25 +1,155 @@
 #include "vertex.h"
 
+#include <glm/gtc/packing.hpp>
+
 #include "common/buffer.h"
+#include "geometry_pool.h"
+#include "utils/hash.h"
 
 namespace vlux {
-VertexBuffer::VertexBuffer(const VkDevice device, const VkPhysicalDevice physical_device,
-                           const VkQueue queue, const VkCommandPool command_pool,
-                           std::vector<Vertex>&& vertices)
-    : device_(device), vertices_(std::move(vertices)) {
-    const auto buffer_size = static_cast<VkDeviceSize>(sizeof(Vertex) * vertices_.size());
-    assert(buffer_size > 0);
-    const auto staging_buffer =
-        Buffer(device_, physical_device, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-               buffer_size, vertices_.data());
-
-    buffer_.emplace(device_, physical_device,
-                    VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer_size, nullptr);
-
-    CopyBuffer(staging_buffer.GetVkBuffer(), buffer_->GetVkBuffer(), buffer_size, command_pool,
-               queue, device_);
-}
-
-}  // namespace vlux
\ No newline at end of file
+namespace {
+int16_t PackSnorm(const float v) { return static_cast<int16_t>(glm::packSnorm1x16(v)); }
+
+float UnpackSnorm(const int16_t v) { return glm::unpackSnorm1x16(static_cast<uint16_t>(v)); }
+
+// same as shader/common/octahedral.glsl
+glm::vec2 SignNotZero(const glm::vec2 v) {
+    return {v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f};
+}
+
+std::array<int16_t, 2> EncodeOctahedral(const glm::vec3& v) {
+    const auto l1_norm = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+    // degenerate (e.g. a zero tangent of an untextured mesh) or NaN: +Z instead of NaN snorms
+    if (!(l1_norm > 0.0f)) {
+        return {0, 0};
+    }
+    const auto n = v / l1_norm;
+    const auto e = n.z >= 0.0f ? glm::vec2(n)
+                               : (1.0f - glm::abs(glm::vec2(n.y, n.x))) * SignNotZero(glm::vec2(n));
+    return {PackSnorm(e.x), PackSnorm(e.y)};
+}
+
+glm::vec3 DecodeOctahedral(const std::array<int16_t, 2>& encoded) {
+    const auto e = glm::vec2(UnpackSnorm(encoded[0]), UnpackSnorm(encoded[1]));
+    auto n = glm::vec3(e, 1.0f - std::abs(e.x) - std::abs(e.y));
+    if (n.z < 0.0f) {
+        const auto xy = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * SignNotZero(glm::vec2(n));
+        n.x = xy.x;
+        n.y = xy.y;
+    }
+    return glm::normalize(n);
+}
+}  // namespace
+
+VertexFormat ParseVertexFormat(const std::string& name) {
+    if (name == "float") {
+        return VertexFormat::kFloat;
+    }
+    if (name == "compact") {
+        return VertexFormat::kCompact;
+    }
+    throw std::runtime_error(fmt::format("unknown vertex format: {}", name));
+}
+
+VertexQuantization ComputeVertexQuantization(const std::span<const Vertex> vertices) {
+    if (vertices.empty()) {
+        return {};
+    }
+    auto bounds_min = vertices.front().pos;
+    auto bounds_max = vertices.front().pos;
+    for (const auto& vertex : vertices) {
+        bounds_min = glm::min(bounds_min, vertex.pos);
+        bounds_max = glm::max(bounds_max, vertex.pos);
+    }
+    // keep flat meshes invertible
+    constexpr auto kMinScale = 1e-6f;
+    return {
+        .scale = glm::max((bounds_max - bounds_min) * 0.5f, glm::vec3(kMinScale)),
+        .offset = (bounds_max + bounds_min) * 0.5f,
+    };
+}
+
+BoundingBox ComputeBoundingBox(const std::span<const Vertex> vertices) {
+    if (vertices.empty()) {
+        return {};
+    }
+    auto bounds = BoundingBox{.min = vertices.front().pos, .max = vertices.front().pos};
+    for (const auto& vertex : vertices) {
+        bounds.min = glm::min(bounds.min, vertex.pos);
+        bounds.max = glm::max(bounds.max, vertex.pos);
+    }
+    return bounds;
+}
+
+BoundingSphere ComputeBoundingSphere(const std::span<const Vertex> vertices) {
+    if (vertices.empty()) {
+        return {};
+    }
+    const auto bounds = ComputeBoundingBox(vertices);
+    const auto center = (bounds.max + bounds.min) * 0.5f;
+    auto radius = 0.0f;
+    for (const auto& vertex : vertices) {
+        radius = std::max(radius, glm::length(vertex.pos - center));
+    }
+    return {.center = center, .radius = radius};
+}
+
+CompactVertex EncodeCompactVertex(const Vertex& vertex, const VertexQuantization& quantization) {
+    const auto pos = (vertex.pos - quantization.offset) / quantization.scale;
+    return {
+        .pos = {PackSnorm(pos.x), PackSnorm(pos.y), PackSnorm(pos.z),
+                PackSnorm(vertex.tangent.w < 0.0f ? -1.0f : 1.0f)},
+        .normal = EncodeOctahedral(vertex.normal),
+        .tangent = EncodeOctahedral(glm::vec3(vertex.tangent)),
+        .uv = {glm::packHalf1x16(vertex.uv.x), glm::packHalf1x16(vertex.uv.y)},
+    };
+}
+
+Vertex DecodeCompactVertex(const CompactVertex& vertex, const VertexQuantization& quantization) {
+    const auto pos = glm::vec3(UnpackSnorm(vertex.pos[0]), UnpackSnorm(vertex.pos[1]),
+                               UnpackSnorm(vertex.pos[2]));
+    return {
+        .pos = quantization.offset + quantization.scale * pos,
+        .normal = DecodeOctahedral(vertex.normal),
+        .uv = {glm::unpackHalf1x16(vertex.uv[0]), glm::unpackHalf1x16(vertex.uv[1])},
+        .tangent = glm::vec4(DecodeOctahedral(vertex.tangent), UnpackSnorm(vertex.pos[3])),
+    };
+}
+
+std::vector<std::byte> PackVertices(const std::span<const Vertex> vertices,
+                                    const VertexFormat format,
+                                    const VertexQuantization& quantization) {
+    auto packed = std::vector<std::byte>(GetVertexStride(format) * vertices.size());
+    if (format == VertexFormat::kFloat) {
+        memcpy(packed.data(), vertices.data(), packed.size());
+        return packed;
+    }
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const auto vertex = EncodeCompactVertex(vertices[i], quantization);
+        memcpy(packed.data() + sizeof(CompactVertex) * i, &vertex, sizeof(CompactVertex));
+    }
+    return packed;
+}
+
+VertexBuffer::VertexBuffer(GeometryPool& pool, Uploader& uploader,
+                           const std::span<const Vertex> vertices)
+    : vertex_count_(vertices.size()),
+      format_(pool.GetVertexFormat()),
+      quantization_(format_ == VertexFormat::kCompact ? ComputeVertexQuantization(vertices)
+                                                      : VertexQuantization{}),
+      bounding_box_(ComputeBoundingBox(vertices)),
+      bounding_sphere_(ComputeBoundingSphere(vertices)),
+      buffer_(pool.GetVertexBuffer().GetVkBuffer()) {
+    // `Vertex` is stored as is; the staging copy is made by the uploader
+    const auto packed = format_ == VertexFormat::kFloat
+                            ? std::vector<std::byte>()
+                            : PackVertices(vertices, format_, quantization_);
+    const auto bytes = format_ == VertexFormat::kFloat ? std::as_bytes(vertices)
+                                                       : std::span<const std::byte>(packed);
+    assert(!bytes.empty());
+    offset_ = pool.AllocateVertices(bytes.size());
+    content_hash_ = HashBytes(bytes);
+    uploader.UploadBuffer(buffer_, bytes.data(), bytes.size(), offset_);
+}
+
+}  // namespace vlux
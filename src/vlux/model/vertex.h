@@ -3,7 +3,10 @@
 #include "pch.h"
 
 //
+#include <span>
+
 #include "common/buffer.h"
+#include "common/uploader.h"
 
 namespace vlux {
 struct Vertex {
@@ -13,17 +16,121 @@ struct Vertex {
     glm::vec4 tangent;
 };
 
-constexpr VkVertexInputBindingDescription GetBindingDescription() {
-    constexpr auto kBindingDesc = VkVertexInputBindingDescription{
+/**
+ * @brief Quantized `Vertex`
+ *
+ * pos: xyz snorm16 within the mesh bounds (see `VertexQuantization`); w is the tangent sign
+ * normal, tangent: octahedral snorm16
+ * uv: half float
+ */
+struct CompactVertex {
+    std::array<int16_t, 4> pos;
+    std::array<int16_t, 2> normal;
+    std::array<int16_t, 2> tangent;
+    std::array<uint16_t, 2> uv;
+};
+static_assert(sizeof(CompactVertex) == 20);
+
+//! layout of the vertex buffers of a scene
+enum class VertexFormat : uint32_t {
+    //! `Vertex`
+    kFloat = 0,
+    //! `CompactVertex`
+    kCompact = 1,
+};
+
+/**
+ * @brief Per-mesh dequantization of `CompactVertex::pos`: pos = offset + scale * snorm(pos)
+ */
+struct VertexQuantization {
+    glm::vec3 scale{1.0f};
+    glm::vec3 offset{0.0f};
+};
+
+//! axis-aligned box around the positions of a mesh
+struct BoundingBox {
+    glm::vec3 min{0.0f};
+    glm::vec3 max{0.0f};
+};
+
+//! sphere around the positions of a mesh
+struct BoundingSphere {
+    glm::vec3 center{0.0f};
+    float radius = 0.0f;
+};
+
+/**
+ * @brief Parse the `vertex_format` of a scene config
+ *
+ * @param name "float" or "compact"
+ * @return VertexFormat
+ */
+VertexFormat ParseVertexFormat(const std::string& name);
+
+constexpr size_t GetVertexStride(const VertexFormat format) {
+    return format == VertexFormat::kCompact ? sizeof(CompactVertex) : sizeof(Vertex);
+}
+
+/**
+ * @brief Quantization mapping the bounds of `vertices` onto [-1, 1]
+ */
+VertexQuantization ComputeVertexQuantization(const std::span<const Vertex> vertices);
+
+CompactVertex EncodeCompactVertex(const Vertex& vertex, const VertexQuantization& quantization);
+Vertex DecodeCompactVertex(const CompactVertex& vertex, const VertexQuantization& quantization);
+
+/**
+ * @brief Store `vertices` in `format`
+ *
+ * @param vertices
+ * @param format
+ * @param quantization used by `VertexFormat::kCompact` only
+ * @return packed vertices, `GetVertexStride(format)` bytes each
+ */
+std::vector<std::byte> PackVertices(const std::span<const Vertex> vertices,
+                                    const VertexFormat format,
+                                    const VertexQuantization& quantization);
+
+constexpr VkVertexInputBindingDescription GetBindingDescription(const VertexFormat format) {
+    return VkVertexInputBindingDescription{
         .binding = 0,
-        .stride = sizeof(Vertex),
+        .stride = static_cast<uint32_t>(GetVertexStride(format)),
         .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
     };
-    return kBindingDesc;
 }
 
-constexpr std::array<VkVertexInputAttributeDescription, 4> GetAttributeDescriptions() {
-    constexpr auto kAttrDescs = std::to_array<VkVertexInputAttributeDescription>({
+constexpr std::array<VkVertexInputAttributeDescription, 4> GetAttributeDescriptions(
+    const VertexFormat format) {
+    if (format == VertexFormat::kCompact) {
+        // decoded by rasterize/shader_compact.vert
+        return std::to_array<VkVertexInputAttributeDescription>({
+            {
+                .location = 0,
+                .binding = 0,
+                .format = VK_FORMAT_R16G16B16A16_SNORM,
+                .offset = offsetof(CompactVertex, pos),
+            },
+            {
+                .location = 1,
+                .binding = 0,
+                .format = VK_FORMAT_R16G16_SNORM,
+                .offset = offsetof(CompactVertex, normal),
+            },
+            {
+                .location = 2,
+                .binding = 0,
+                .format = VK_FORMAT_R16G16_SFLOAT,
+                .offset = offsetof(CompactVertex, uv),
+            },
+            {
+                .location = 3,
+                .binding = 0,
+                .format = VK_FORMAT_R16G16_SNORM,
+                .offset = offsetof(CompactVertex, tangent),
+            },
+        });
+    }
+    return std::to_array<VkVertexInputAttributeDescription>({
         {
             .location = 0,
             .binding = 0,
@@ -49,25 +156,57 @@ constexpr std::array<VkVertexInputAttributeDescription, 4> GetAttributeDescripti
             .offset = offsetof(Vertex, tangent),
         },
     });
-    return kAttrDescs;
 }
 
+BoundingBox ComputeBoundingBox(const std::span<const Vertex> vertices);
+
+/**
+ * @brief Sphere centred on the bounding box of the positions; not the tightest one, but cheap
+ */
+BoundingSphere ComputeBoundingSphere(const std::span<const Vertex> vertices);
+
+class GeometryPool;
+
+/**
+ * @brief Vertices of a mesh in a range of the scene's `GeometryPool`
+ *
+ * Only the metadata stays on the CPU; the vertices are copied to the GPU on construction.
+ */
 class VertexBuffer {
    public:
-    VertexBuffer(const VkDevice device, const VkPhysicalDevice physical_device, const VkQueue queue,
-                 const VkCommandPool command_pool, std::vector<Vertex>&& vertices);
+    /**
+     * @param pool
+     * @param uploader
+     * @param vertices staged as is for `VertexFormat::kFloat`, e.g. straight from a
+     * memory-mapped file
+     */
+    VertexBuffer(GeometryPool& pool, Uploader& uploader, const std::span<const Vertex> vertices);
     ~VertexBuffer() = default;
     VertexBuffer(const VertexBuffer&) = delete;
     VertexBuffer& operator=(const VertexBuffer&) = delete;
     VertexBuffer(VertexBuffer&&) = default;
     VertexBuffer& operator=(VertexBuffer&&) = default;
-    VkBuffer GetVkBuffer() const { return buffer_->GetVkBuffer(); }
-    const std::vector<Vertex>& GetVertices() const { return vertices_; }
+    //! the pool's vertex buffer, shared with the other models
+    VkBuffer GetVkBuffer() const { return buffer_; }
+    //! byte offset of the first vertex in `GetVkBuffer()`
+    VkDeviceSize GetOffset() const { return offset_; }
+    VertexFormat GetVertexFormat() const { return format_; }
+    const VertexQuantization& GetQuantization() const { return quantization_; }
+    const BoundingBox& GetBoundingBox() const { return bounding_box_; }
+    const BoundingSphere& GetBoundingSphere() const { return bounding_sphere_; }
+    size_t GetSize() const { return vertex_count_; }
+    //! `HashBytes` of the vertices as stored in the buffer
+    uint64_t GetContentHash() const { return content_hash_; }
 
    private:
-    VkDevice device_;
-    std::optional<Buffer> buffer_;
-    std::vector<Vertex> vertices_;
+    size_t vertex_count_;
+    VertexFormat format_;
+    VertexQuantization quantization_;
+    BoundingBox bounding_box_;
+    BoundingSphere bounding_sphere_;
+    VkBuffer buffer_;
+    VkDeviceSize offset_;
+    uint64_t content_hash_;
 };
 
 }  // namespace vlux
@@ -0,0 +1,276 @@
+#include "vertex_decode.h"
+
+#include <limits>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace vlux {
+namespace {
+//! vertex fields are transformed in place, `kVertexStride` floats apart
+constexpr auto kVertexStride = sizeof(Vertex) / sizeof(float);
+static_assert(sizeof(Vertex) % sizeof(float) == 0);
+
+template <typename F>
+void VisitComponentType(const int component_type, F&& f) {
+    switch (component_type) {
+        case TINYGLTF_COMPONENT_TYPE_BYTE:
+            return f(int8_t{});
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+            return f(uint8_t{});
+        case TINYGLTF_COMPONENT_TYPE_SHORT:
+            return f(int16_t{});
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+            return f(uint16_t{});
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+            return f(uint32_t{});
+        case TINYGLTF_COMPONENT_TYPE_FLOAT:
+            return f(float{});
+        default:
+            throw std::runtime_error(
+                fmt::format("unsupported accessor component type: {}", component_type));
+    }
+}
+
+template <typename T>
+float ReadComponent(const unsigned char* src, const bool normalized) {
+    auto value = T{};
+    memcpy(&value, src, sizeof(T));
+    if constexpr (std::is_floating_point_v<T>) {
+        return value;
+    } else {
+        if (!normalized) {
+            return static_cast<float>(value);
+        }
+        // c / max for unsigned, max(c / max, -1) for signed types
+        const auto normalized_value =
+            static_cast<float>(value) / static_cast<float>(std::numeric_limits<T>::max());
+        if constexpr (std::is_signed_v<T>) {
+            return std::max(normalized_value, -1.0f);
+        }
+        return normalized_value;
+    }
+}
+
+template <typename T>
+void DecodeElements(const unsigned char* src, const size_t src_stride, const size_t count,
+                    const size_t num_components, const bool normalized, std::byte* dst,
+                    const size_t dst_stride) {
+    for (size_t i = 0; i < count; i++) {
+        const auto* element = src + src_stride * i;
+        auto* out = dst + dst_stride * i;
+        if constexpr (std::is_same_v<T, float>) {
+            memcpy(out, element, sizeof(float) * num_components);
+        } else {
+            for (size_t c = 0; c < num_components; c++) {
+                const auto value = ReadComponent<T>(element + sizeof(T) * c, normalized);
+                memcpy(out + sizeof(float) * c, &value, sizeof(float));
+            }
+        }
+    }
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define VLUX_VERTEX_DECODE_AVX2
+/**
+ * @brief `TransformVec3s` of the leading whole batches of 8 vec3s, with AVX2 and FMA
+ *
+ * Compiled for AVX2 regardless of the target flags; only called if the CPU supports it.
+ *
+ * @return number of vec3s transformed
+ */
+__attribute__((target("avx2,fma"))) size_t TransformVec3sAvx2(float* data, const size_t count,
+                                                              const glm::mat4& matrix,
+                                                              const float w) {
+    // 8 vertices per batch: gather each component into a register and transform them together
+    constexpr auto kBatchSize = 8uz;
+    const auto offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                            _mm256_set1_epi32(static_cast<int>(kVertexStride)));
+    // a plain array: std::array would drop the vector type's alignment attribute
+    __m256 columns[4][3];
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 3; row++) {
+            columns[col][row] = _mm256_set1_ps(matrix[col][row] * (col == 3 ? w : 1.0f));
+        }
+    }
+    auto i = size_t{0};
+    for (; i + kBatchSize <= count; i += kBatchSize) {
+        auto* batch = data + kVertexStride * i;
+        const auto x = _mm256_i32gather_ps(batch + 0, offsets, sizeof(float));
+        const auto y = _mm256_i32gather_ps(batch + 1, offsets, sizeof(float));
+        const auto z = _mm256_i32gather_ps(batch + 2, offsets, sizeof(float));
+        alignas(32) auto out = std::array<std::array<float, kBatchSize>, 3>();
+        for (int row = 0; row < 3; row++) {
+            const auto r = _mm256_fmadd_ps(
+                columns[0][row], x,
+                _mm256_fmadd_ps(columns[1][row], y,
+                                _mm256_fmadd_ps(columns[2][row], z, columns[3][row])));
+            _mm256_store_ps(out[row].data(), r);
+        }
+        for (size_t j = 0; j < kBatchSize; j++) {
+            batch[kVertexStride * j + 0] = out[0][j];
+            batch[kVertexStride * j + 1] = out[1][j];
+            batch[kVertexStride * j + 2] = out[2][j];
+        }
+    }
+    return i;
+}
+#endif
+
+/**
+ * @brief v' = matrix * vec4(v, w) for `count` vec3s, `kVertexStride` floats apart
+ */
+void TransformVec3s(float* data, const size_t count, const glm::mat4& matrix, const float w,
+                    const TransformIsa isa) {
+    auto i = size_t{0};
+#if defined(VLUX_VERTEX_DECODE_AVX2)
+    if (isa == TransformIsa::kAvx2Fma) {
+        i = TransformVec3sAvx2(data, count, matrix, w);
+    }
+#endif
+#if defined(__SSE2__)
+    const auto c0 = _mm_loadu_ps(&matrix[0][0]);
+    const auto c1 = _mm_loadu_ps(&matrix[1][0]);
+    const auto c2 = _mm_loadu_ps(&matrix[2][0]);
+    const auto c3 = _mm_mul_ps(_mm_loadu_ps(&matrix[3][0]), _mm_set1_ps(w));
+    for (; i < count; i++) {
+        auto* v = data + kVertexStride * i;
+        auto r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(v[0])), c3);
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(v[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(v[2])));
+        // xyz only; the fourth lane belongs to the next field
+        _mm_storel_pi(reinterpret_cast<__m64*>(v), r);
+        _mm_store_ss(v + 2, _mm_movehl_ps(r, r));
+    }
+#else
+    for (; i < count; i++) {
+        auto* v = data + kVertexStride * i;
+        const auto r = matrix * glm::vec4(v[0], v[1], v[2], w);
+        v[0] = r.x;
+        v[1] = r.y;
+        v[2] = r.z;
+    }
+#endif
+}
+}  // namespace
+
+const unsigned char* GetBufferViewData(const tinygltf::Model& model, const int buffer_view_idx,
+                                       const size_t byte_offset, const size_t size) {
+    const auto& buffer_view = model.bufferViews.at(buffer_view_idx);
+    const auto& buffer = model.buffers.at(buffer_view.buffer);
+    if (buffer_view.byteOffset + buffer_view.byteLength > buffer.data.size() ||
+        byte_offset > buffer_view.byteLength || size > buffer_view.byteLength - byte_offset) {
+        throw std::runtime_error(
+            fmt::format("accessor out of bounds: buffer view {}", buffer_view_idx));
+    }
+    return buffer.data.data() + buffer_view.byteOffset + byte_offset;
+}
+
+void DecodeAccessor(const tinygltf::Model& model, const tinygltf::Accessor& accessor,
+                    const size_t num_components, std::byte* dst, const size_t dst_stride) {
+    const auto accessor_components = tinygltf::GetNumComponentsInType(accessor.type);
+    const auto component_size = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+    if (accessor_components < static_cast<int>(num_components) || component_size <= 0) {
+        throw std::runtime_error(fmt::format("unsupported accessor: type {}, component type {}",
+                                             accessor.type, accessor.componentType));
+    }
+    const auto element_size = static_cast<size_t>(component_size * accessor_components);
+    if (accessor.count == 0) {
+        return;
+    }
+
+    if (accessor.bufferView < 0) {
+        // no data: every element is zero unless replaced by a sparse value
+        for (size_t i = 0; i < accessor.count; i++) {
+            memset(dst + dst_stride * i, 0, sizeof(float) * num_components);
+        }
+    } else {
+        const auto stride = accessor.ByteStride(model.bufferViews.at(accessor.bufferView));
+        if (stride <= 0) {
+            throw std::runtime_error(
+                fmt::format("invalid byte stride: buffer view {}", accessor.bufferView));
+        }
+        const auto* src =
+            GetBufferViewData(model, accessor.bufferView, accessor.byteOffset,
+                              static_cast<size_t>(stride) * (accessor.count - 1) + element_size);
+        VisitComponentType(accessor.componentType, [&]<typename T>(T) {
+            DecodeElements<T>(src, static_cast<size_t>(stride), accessor.count, num_components,
+                              accessor.normalized, dst, dst_stride);
+        });
+    }
+
+    if (!accessor.sparse.isSparse) {
+        return;
+    }
+    const auto& sparse = accessor.sparse;
+    const auto sparse_count = static_cast<size_t>(sparse.count);
+    const auto index_size = tinygltf::GetComponentSizeInBytes(sparse.indices.componentType);
+    if (index_size <= 0) {
+        throw std::runtime_error(fmt::format("unsupported sparse index component type: {}",
+                                             sparse.indices.componentType));
+    }
+    const auto* sparse_indices =
+        GetBufferViewData(model, sparse.indices.bufferView, sparse.indices.byteOffset,
+                          static_cast<size_t>(index_size) * sparse_count);
+    const auto* sparse_values = GetBufferViewData(model, sparse.values.bufferView,
+                                                  sparse.values.byteOffset,
+                                                  element_size * sparse_count);
+    VisitComponentType(sparse.indices.componentType, [&]<typename I>(I) {
+        if constexpr (!std::is_unsigned_v<I>) {
+            throw std::runtime_error(fmt::format("unsupported sparse index component type: {}",
+                                                 sparse.indices.componentType));
+        } else {
+            VisitComponentType(accessor.componentType, [&]<typename T>(T) {
+                for (size_t i = 0; i < sparse_count; i++) {
+                    auto index = I{};
+                    memcpy(&index, sparse_indices + sizeof(I) * i, sizeof(I));
+                    if (index >= accessor.count) {
+                        throw std::runtime_error(fmt::format("invalid sparse index: {}", index));
+                    }
+                    DecodeElements<T>(sparse_values + element_size * i, element_size, 1,
+                                      num_components, accessor.normalized,
+                                      dst + dst_stride * index, dst_stride);
+                }
+            });
+        }
+    });
+}
+
+TransformIsa GetTransformIsa() {
+#if defined(VLUX_VERTEX_DECODE_AVX2)
+    static const auto kIsa = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")
+                                 ? TransformIsa::kAvx2Fma
+                                 : TransformIsa::kBaseline;
+    return kIsa;
+#else
+    return TransformIsa::kBaseline;
+#endif
+}
+
+void TransformVertices(std::span<Vertex> vertices, const glm::mat4& rotation, const float scale,
+                       const glm::vec3& translation, const bool transform_tangents) {
+    TransformVertices(vertices, rotation, scale, translation, transform_tangents,
+                      GetTransformIsa());
+}
+
+void TransformVertices(std::span<Vertex> vertices, const glm::mat4& rotation, const float scale,
+                       const glm::vec3& translation, const bool transform_tangents,
+                       TransformIsa isa) {
+    if (vertices.empty()) {
+        return;
+    }
+    // never beyond what the CPU supports
+    if (isa == TransformIsa::kAvx2Fma) {
+        isa = GetTransformIsa();
+    }
+    // rotate, then scale and translate
+    const auto position_matrix = glm::translate(glm::mat4(1.0f), translation) *
+                                 glm::scale(glm::mat4(1.0f), glm::vec3(scale)) * rotation;
+    TransformVec3s(&vertices.front().pos.x, vertices.size(), position_matrix, 1.0f, isa);
+    TransformVec3s(&vertices.front().normal.x, vertices.size(), rotation, 0.0f, isa);
+    if (transform_tangents) {
+        TransformVec3s(&vertices.front().tangent.x, vertices.size(), rotation, 0.0f, isa);
+    }
+}
+}  // namespace vlux
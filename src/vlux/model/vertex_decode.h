@@ -0,0 +1,66 @@
+#ifndef MODEL_VERTEX_DECODE_H
+#define MODEL_VERTEX_DECODE_H
+#include "pch.h"
+//
+#include <span>
+
+#include "vertex.h"
+
+namespace vlux {
+/**
+ * @brief Decode a glTF attribute accessor into floats
+ *
+ * Interleaved/strided buffer views, (normalized) integer components and sparse accessors are
+ * supported. Element `i` is written as `num_components` floats to `dst + dst_stride * i`.
+ *
+ * @param model
+ * @param accessor must have at least `num_components` components
+ * @param num_components
+ * @param dst room for `accessor.count` elements
+ * @param dst_stride bytes between two elements of `dst`
+ */
+/**
+ * @brief Bounds-checked pointer to `size` bytes at `byte_offset` of a buffer view
+ *
+ * @throw std::runtime_error if the range is not inside the buffer view and its buffer
+ */
+const unsigned char* GetBufferViewData(const tinygltf::Model& model, const int buffer_view_idx,
+                                       const size_t byte_offset, const size_t size);
+
+void DecodeAccessor(const tinygltf::Model& model, const tinygltf::Accessor& accessor,
+                    const size_t num_components, std::byte* dst, const size_t dst_stride);
+
+//! instruction sets `TransformVertices` can run on
+enum class TransformIsa {
+    //! SSE2 on x86-64, plain glm elsewhere
+    kBaseline,
+    //! batches of 8 vertices; compiled in on x86-64 and picked at runtime
+    kAvx2Fma,
+};
+
+//! @return the fastest `TransformIsa` this CPU supports
+TransformIsa GetTransformIsa();
+
+/**
+ * @brief Apply a model transform to decoded vertices in place
+ *
+ * Positions are rotated, scaled and translated; normals (and tangents if
+ * `transform_tangents`) are rotated. Vertices are processed in SIMD batches of the fastest
+ * instruction set the CPU supports, see `GetTransformIsa`.
+ *
+ * @param vertices
+ * @param rotation
+ * @param scale uniform scale
+ * @param translation
+ * @param transform_tangents false if the tangents are computed after the transform
+ */
+void TransformVertices(std::span<Vertex> vertices, const glm::mat4& rotation, const float scale,
+                       const glm::vec3& translation, const bool transform_tangents);
+
+//! `TransformVertices` on `isa`, or on `GetTransformIsa` if the CPU does not support `isa`
+void TransformVertices(std::span<Vertex> vertices, const glm::mat4& rotation, const float scale,
+                       const glm::vec3& translation, const bool transform_tangents,
+                       TransformIsa isa);
+}  // namespace vlux
+
+#endif
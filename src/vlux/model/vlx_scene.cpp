@@ -0,0 +1,249 @@
+#include "vlx_scene.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/suballocator.h"
+
+namespace vlux {
+namespace {
+template <typename T>
+uint64_t AppendBlob(std::vector<std::byte>& blob, const T* data, const size_t count) {
+    const auto offset = AlignUp(blob.size(), kVlxSceneAlignment);
+    const auto size = sizeof(T) * count;
+    blob.resize(offset + size);
+    if (size > 0) {
+        memcpy(blob.data() + offset, data, size);
+    }
+    return offset;
+}
+}  // namespace
+
+void WriteVlxScene(const std::filesystem::path& path, const std::vector<GltfPrimitive>& primitives,
+                   const std::vector<Image<uint8_t>>& images) {
+    // the tables have a fixed size, so the blobs can be laid out right behind them
+    const auto primitives_offset = AlignUp(sizeof(VlxSceneHeader), kVlxSceneAlignment);
+    const auto textures_offset = AlignUp(
+        primitives_offset + sizeof(VlxScenePrimitive) * primitives.size(), kVlxSceneAlignment);
+    const auto blob_offset =
+        AlignUp(textures_offset + sizeof(VlxSceneTexture) * images.size(), kVlxSceneAlignment);
+
+    auto blob = std::vector<std::byte>(blob_offset);
+    const auto header = VlxSceneHeader{
+        .magic = kVlxSceneMagic,
+        .version = kVlxSceneVersion,
+        .vertex_size = sizeof(Vertex),
+        .num_primitives = static_cast<uint32_t>(primitives.size()),
+        .num_textures = static_cast<uint32_t>(images.size()),
+        .primitives_offset = primitives_offset,
+        .textures_offset = textures_offset,
+    };
+    memcpy(blob.data(), &header, sizeof(header));
+
+    auto primitive_records = std::vector<VlxScenePrimitive>();
+    primitive_records.reserve(primitives.size());
+    for (const auto& primitive : primitives) {
+        const auto& factor = primitive.base_color_factor;
+        const auto index_type = SelectIndexType(
+            primitive.indices.empty() ? 0 : std::ranges::max(primitive.indices));
+        const auto vertex_offset =
+            AppendBlob(blob, primitive.vertices.data(), primitive.vertices.size());
+        const auto packed_indices = PackIndices(primitive.indices, index_type);
+        const auto index_offset = AppendBlob(blob, packed_indices.data(), packed_indices.size());
+        auto lod_records = std::vector<VlxSceneLod>();
+        for (const auto& lod : primitive.lods) {
+            const auto packed_lod_indices = PackIndices(lod.indices, index_type);
+            lod_records.emplace_back(VlxSceneLod{
+                .index_offset =
+                    AppendBlob(blob, packed_lod_indices.data(), packed_lod_indices.size()),
+                .num_indices = static_cast<uint32_t>(lod.indices.size()),
+                .error = lod.error,
+            });
+        }
+        primitive_records.emplace_back(VlxScenePrimitive{
+            .vertex_offset = vertex_offset,
+            .index_offset = index_offset,
+            .num_vertices = static_cast<uint32_t>(primitive.vertices.size()),
+            .num_indices = static_cast<uint32_t>(primitive.indices.size()),
+            .index_type = static_cast<uint32_t>(index_type),
+            .num_lods = static_cast<uint32_t>(lod_records.size()),
+            .lods_offset = AppendBlob(blob, lod_records.data(), lod_records.size()),
+            .base_color_factor = {factor.r, factor.g, factor.b, factor.a},
+            .metallic_factor = primitive.metallic_factor,
+            .roughness_factor = primitive.roughness_factor,
+            .base_color_texture = primitive.base_color_image,
+            .normal_texture = primitive.normal_image,
+            .emissive_texture = primitive.emissive_image,
+            .occlusion_roughness_metallic_texture = primitive.occlusion_roughness_metallic_image,
+        });
+    }
+
+    auto texture_records = std::vector<VlxSceneTexture>();
+    texture_records.reserve(images.size());
+    for (const auto& image : images) {
+        texture_records.emplace_back(VlxSceneTexture{
+            .data_offset = AppendBlob(blob, image.GetPixels(), image.GetSize()),
+            .data_size = image.GetSize(),
+            .width = static_cast<uint32_t>(image.GetWidth()),
+            .height = static_cast<uint32_t>(image.GetHeight()),
+            .format = static_cast<uint32_t>(kGltfTextureFormat),
+            .num_mips = 1,
+        });
+    }
+
+    memcpy(blob.data() + primitives_offset, primitive_records.data(),
+           sizeof(VlxScenePrimitive) * primitive_records.size());
+    memcpy(blob.data() + textures_offset, texture_records.data(),
+           sizeof(VlxSceneTexture) * texture_records.size());
+
+    auto file = std::ofstream(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error(fmt::format("failed to open file: {}", path.string()));
+    }
+    file.write(reinterpret_cast<const char*>(blob.data()),
+               static_cast<std::streamsize>(blob.size()));
+    if (!file) {
+        throw std::runtime_error(fmt::format("failed to write file: {}", path.string()));
+    }
+}
+
+VlxSceneFile::VlxSceneFile(const std::filesystem::path& path) : path_(path) {
+    const auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(fmt::format("failed to open file: {}", path.string()));
+    }
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0 ||
+        static_cast<size_t>(file_stat.st_size) < sizeof(VlxSceneHeader)) {
+        close(fd);
+        throw std::runtime_error(fmt::format("invalid vlxscene file: {}", path.string()));
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    close(fd);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        throw std::runtime_error(fmt::format("failed to map file: {}", path.string()));
+    }
+    // every section is read right away; start paging in the whole file
+    madvise(data_, size_, MADV_WILLNEED);
+
+    try {
+        auto header = VlxSceneHeader{};
+        memcpy(&header, data_, sizeof(header));
+        if (header.magic != kVlxSceneMagic || header.version != kVlxSceneVersion ||
+            header.vertex_size != sizeof(Vertex)) {
+            throw std::runtime_error(
+                fmt::format("unsupported vlxscene file: {}; bake it again", path.string()));
+        }
+        primitives_ = {reinterpret_cast<const VlxScenePrimitive*>(
+                           GetSection(header.primitives_offset,
+                                      sizeof(VlxScenePrimitive) * header.num_primitives)),
+                       header.num_primitives};
+        textures_ = {reinterpret_cast<const VlxSceneTexture*>(GetSection(
+                         header.textures_offset, sizeof(VlxSceneTexture) * header.num_textures)),
+                     header.num_textures};
+    } catch (...) {
+        munmap(data_, size_);
+        data_ = nullptr;
+        throw;
+    }
+}
+
+VlxSceneFile::~VlxSceneFile() {
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+    }
+}
+
+std::span<const Vertex> VlxSceneFile::GetVertices(const VlxScenePrimitive& primitive) const {
+    const auto section =
+        GetSection(primitive.vertex_offset, sizeof(Vertex) * primitive.num_vertices);
+    return {reinterpret_cast<const Vertex*>(section), primitive.num_vertices};
+}
+
+std::span<const std::byte> VlxSceneFile::GetPackedIndices(
+    const VlxScenePrimitive& primitive) const {
+    const auto size = GetIndexSize(static_cast<VkIndexType>(primitive.index_type)) *
+                      uint64_t{primitive.num_indices};
+    return {GetSection(primitive.index_offset, size), size};
+}
+
+std::span<const VlxSceneLod> VlxSceneFile::GetLods(const VlxScenePrimitive& primitive) const {
+    const auto section =
+        GetSection(primitive.lods_offset, sizeof(VlxSceneLod) * uint64_t{primitive.num_lods});
+    return {reinterpret_cast<const VlxSceneLod*>(section), primitive.num_lods};
+}
+
+std::span<const std::byte> VlxSceneFile::GetPackedIndices(const VlxScenePrimitive& primitive,
+                                                          const VlxSceneLod& lod) const {
+    const auto size =
+        GetIndexSize(static_cast<VkIndexType>(primitive.index_type)) * uint64_t{lod.num_indices};
+    return {GetSection(lod.index_offset, size), size};
+}
+
+std::span<const uint8_t> VlxSceneFile::GetTexels(const VlxSceneTexture& texture) const {
+    const auto section = GetSection(texture.data_offset, texture.data_size);
+    return {reinterpret_cast<const uint8_t*>(section), texture.data_size};
+}
+
+const std::byte* VlxSceneFile::GetSection(const uint64_t offset, const uint64_t size) const {
+    if (offset % kVlxSceneAlignment != 0 || offset > size_ || size > size_ - offset) {
+        throw std::runtime_error(fmt::format("corrupted vlxscene file: {}", path_.string()));
+    }
+    return static_cast<const std::byte*>(data_) + offset;
+}
+
+GltfObject CreateVlxSceneObject(const VlxSceneFile& file, const VlxScenePrimitive& primitive,
+                                const std::filesystem::path& path, TextureCache& texture_cache,
+                                Uploader& uploader, const VkPhysicalDevice physical_device,
+                                const VkDevice device) {
+    const auto get_texture = [&](const int32_t texture_idx) -> std::shared_ptr<Texture<uint8_t>> {
+        if (texture_idx == -1) {
+            return nullptr;
+        }
+        if (static_cast<size_t>(texture_idx) >= file.GetTextures().size()) {
+            throw std::runtime_error(fmt::format("invalid texture index: {}", texture_idx));
+        }
+        const auto& texture = file.GetTextures()[texture_idx];
+        // the baker writes RGBA8 only, and the texel size below assumes it
+        if (texture.format != static_cast<uint32_t>(kGltfTextureFormat)) {
+            throw std::runtime_error(fmt::format("unsupported texture format {} in {}",
+                                                 texture.format, path.string()));
+        }
+        const auto format = kGltfTextureFormat;
+        const auto create_texture = [&]() {
+            // uploaded straight from the mapping; only the largest mip is used for now
+            const auto texels = file.GetTexels(texture);
+            const auto base_mip_size = VkDeviceSize{texture.width} * texture.height * 4;
+            if (texels.size() < base_mip_size) {
+                throw std::runtime_error(fmt::format("corrupted texture: {}", texture_idx));
+            }
+            return std::make_shared<Texture<uint8_t>>(texels.data(), base_mip_size, texture.width,
+                                                      texture.height, uploader, device,
+                                                      physical_device, format);
+        };
+        return texture_cache.GetOrCreate(
+            {.path = path, .image_index = texture_idx, .format = format}, create_texture);
+    };
+
+    const auto& factor = primitive.base_color_factor;
+    return {
+        .indices = {},
+        .lods = {},
+        .vertices = {},
+        .base_color_factor = glm::vec4(factor[0], factor[1], factor[2], factor[3]),
+        .metallic_factor = primitive.metallic_factor,
+        .roughness_factor = primitive.roughness_factor,
+        .base_color_texture = get_texture(primitive.base_color_texture),
+        .normal_texture = get_texture(primitive.normal_texture),
+        .emissive_texture = get_texture(primitive.emissive_texture),
+        .occlusion_roughness_metallic_texture =
+            get_texture(primitive.occlusion_roughness_metallic_texture),
+    };
+}
+
+}  // namespace vlux
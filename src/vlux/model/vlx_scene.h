@@ -0,0 +1,149 @@
+#ifndef MODEL_VLX_SCENE_H
+#define MODEL_VLX_SCENE_H
+#include "pch.h"
+//
+#include <span>
+
+#include "gltf.h"
+#include "index.h"
+#include "vertex.h"
+
+namespace vlux {
+/*
+ * .vlxscene layout (native byte order of the baker, every section 16-byte aligned):
+ *
+ *   VlxSceneHeader
+ *   VlxScenePrimitive[num_primitives]
+ *   VlxSceneTexture[num_textures]
+ *   blobs: vertices (`Vertex`), packed indices (`index_type` of the primitive), LOD tables
+ *   (VlxSceneLod[num_lods]) and RGBA8 texels, referenced by offset
+ *
+ * Vertices are stored pre-transformed with tangents, so loading is a copy into staging memory.
+ * Nothing is byte-swapped: a file is only readable on hosts of the baker's byte order.
+ */
+constexpr auto kVlxSceneMagic = std::to_array<char>({'V', 'L', 'X', 'S'});
+constexpr auto kVlxSceneVersion = uint32_t{3};
+constexpr auto kVlxSceneAlignment = uint64_t{16};
+
+struct VlxSceneHeader {
+    std::array<char, 4> magic;
+    uint32_t version;
+    //! sizeof(Vertex) of the baker, to reject files of another layout
+    uint32_t vertex_size;
+    uint32_t reserved = 0;
+    uint32_t num_primitives;
+    uint32_t num_textures;
+    uint64_t primitives_offset;
+    uint64_t textures_offset;
+};
+
+struct VlxScenePrimitive {
+    uint64_t vertex_offset;
+    uint64_t index_offset;
+    uint32_t num_vertices;
+    uint32_t num_indices;
+    //! VkIndexType of the index blob and of the LOD index blobs
+    uint32_t index_type;
+    uint32_t num_lods;
+    uint64_t lods_offset;
+    std::array<float, 4> base_color_factor;
+    float metallic_factor;
+    float roughness_factor;
+    //! indices into the texture table, -1 if unused
+    int32_t base_color_texture;
+    int32_t normal_texture;
+    int32_t emissive_texture;
+    int32_t occlusion_roughness_metallic_texture;
+};
+
+//! simplified level of a primitive; it indexes the vertices of the primitive
+struct VlxSceneLod {
+    uint64_t index_offset;
+    uint32_t num_indices;
+    float error;
+};
+
+struct VlxSceneTexture {
+    uint64_t data_offset;
+    uint64_t data_size;
+    uint32_t width;
+    uint32_t height;
+    //! VkFormat
+    uint32_t format;
+    //! mip levels stored back to back from the largest
+    uint32_t num_mips;
+};
+
+static_assert(std::is_trivially_copyable_v<VlxSceneHeader>);
+static_assert(std::is_trivially_copyable_v<VlxScenePrimitive>);
+static_assert(std::is_trivially_copyable_v<VlxSceneLod>);
+static_assert(std::is_trivially_copyable_v<VlxSceneTexture>);
+
+/**
+ * @brief Write a baked scene
+ *
+ * @param path
+ * @param primitives decoded primitives; their image indices refer to `images`
+ * @param images RGBA8 images
+ */
+void WriteVlxScene(const std::filesystem::path& path, const std::vector<GltfPrimitive>& primitives,
+                   const std::vector<Image<uint8_t>>& images);
+
+/**
+ * @brief Read-only memory mapping of a .vlxscene file
+ *
+ * The spans point into the mapping and stay valid while the object is alive.
+ */
+class VlxSceneFile {
+   public:
+    VlxSceneFile() = delete;
+    explicit VlxSceneFile(const std::filesystem::path& path);
+    ~VlxSceneFile();
+    VlxSceneFile(const VlxSceneFile&) = delete;
+    VlxSceneFile& operator=(const VlxSceneFile&) = delete;
+
+    std::span<const VlxScenePrimitive> GetPrimitives() const { return primitives_; }
+    std::span<const VlxSceneTexture> GetTextures() const { return textures_; }
+    std::span<const Vertex> GetVertices(const VlxScenePrimitive& primitive) const;
+    //! indices of `primitive.index_type`, see `UnpackIndices`
+    std::span<const std::byte> GetPackedIndices(const VlxScenePrimitive& primitive) const;
+    std::span<const VlxSceneLod> GetLods(const VlxScenePrimitive& primitive) const;
+    //! indices of `primitive.index_type`
+    std::span<const std::byte> GetPackedIndices(const VlxScenePrimitive& primitive,
+                                                const VlxSceneLod& lod) const;
+    std::span<const uint8_t> GetTexels(const VlxSceneTexture& texture) const;
+
+   private:
+    //! bounds-checked pointer to `size` bytes at `offset`
+    const std::byte* GetSection(const uint64_t offset, const uint64_t size) const;
+
+    std::filesystem::path path_;
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    std::span<const VlxScenePrimitive> primitives_;
+    std::span<const VlxSceneTexture> textures_;
+};
+
+/**
+ * @brief Create the material of a baked primitive
+ *
+ * The geometry is not copied out of the mapping: pass `GetVertices` and `GetPackedIndices` of
+ * `file` to `VertexBuffer` and `IndexBuffer` instead.
+ *
+ * @param file
+ * @param primitive a record of `file`
+ * @param path path of `file`, used as the texture cache key
+ * @param texture_cache
+ * @param uploader
+ * @param physical_device
+ * @param device
+ * @return GltfObject with empty vertices, indices and LODs
+ */
+GltfObject CreateVlxSceneObject(const VlxSceneFile& file, const VlxScenePrimitive& primitive,
+                                const std::filesystem::path& path, TextureCache& texture_cache,
+                                Uploader& uploader, const VkPhysicalDevice physical_device,
+                                const VkDevice device);
+
+}  // namespace vlux
+
+#endif
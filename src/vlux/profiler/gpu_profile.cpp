@@ -0,0 +1,59 @@
+#include "gpu_profile.h"
+
+namespace vlux {
+RollingAverage::RollingAverage(const size_t window) : samples_(window, 0.0f) {
+    if (window == 0) {
+        throw std::runtime_error("rolling average window must not be empty!");
+    }
+}
+
+void RollingAverage::Add(const float sample) {
+    samples_.at(next_) = sample;
+    next_ = (next_ + 1) % samples_.size();
+    count_ = std::min(count_ + 1, samples_.size());
+}
+
+float RollingAverage::Get() const {
+    if (count_ == 0) {
+        return 0.0f;
+    }
+    auto sum = 0.0;
+    for (auto sample_i = 0uz; sample_i < count_; sample_i++) {
+        sum += samples_.at(sample_i);
+    }
+    return static_cast<float>(sum / static_cast<double>(count_));
+}
+
+nlohmann::json ToChromeTrace(const std::deque<GpuFrameProfile>& frames) {
+    auto events = nlohmann::json::array();
+    for (const auto& frame : frames) {
+        for (const auto& scope : frame.scopes) {
+            events.emplace_back(nlohmann::json{
+                {"name", scope.name},
+                {"cat", "gpu"},
+                {"ph", "X"},
+                {"ts", scope.begin_us},
+                {"dur", static_cast<double>(scope.elapsed_ms) * 1e3},
+                {"pid", 0},
+                {"tid", 0},
+                {"args", {{"frame", frame.frame}, {"depth", scope.depth}}},
+            });
+        }
+    }
+    return {
+        {"traceEvents", std::move(events)},
+        {"displayTimeUnit", "ms"},
+    };
+}
+
+void WriteChromeTrace(const std::filesystem::path& path,
+                      const std::deque<GpuFrameProfile>& frames) {
+    auto file = std::ofstream(path);
+    if (!file.is_open()) {
+        throw std::runtime_error(fmt::format("failed to open file: {}", path.string()));
+    }
+    file << ToChromeTrace(frames).dump() << std::endl;
+    spdlog::info("wrote gpu trace of {} frames: {}", frames.size(), path.string());
+}
+
+}  // namespace vlux
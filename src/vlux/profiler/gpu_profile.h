@@ -0,0 +1,54 @@
+#ifndef PROFILER_GPU_PROFILE_H
+#define PROFILER_GPU_PROFILE_H
+#include "pch.h"
+//
+#include <deque>
+
+namespace vlux {
+
+//! GPU time of one named scope
+struct GpuScopeTime {
+    std::string name;
+    uint32_t depth;   // nesting level, 0 for the outermost scope
+    double begin_us;  // device timestamp converted to microseconds
+    float elapsed_ms;
+};
+
+//! GPU scopes of one frame, in the order they were opened
+struct GpuFrameProfile {
+    uint32_t frame;
+    std::vector<GpuScopeTime> scopes;
+};
+
+/**
+ * @brief Mean of the last `window` samples
+ */
+class RollingAverage {
+   public:
+    RollingAverage() = delete;
+    explicit RollingAverage(const size_t window);
+
+    void Add(const float sample);
+    float Get() const;
+    size_t GetCount() const { return count_; }
+
+   private:
+    //! (window,)
+    std::vector<float> samples_;
+    size_t next_ = 0;
+    size_t count_ = 0;
+};
+
+/**
+ * @brief Convert frame profiles to the Chrome trace event format (chrome://tracing, Perfetto)
+ *
+ * Every scope becomes a complete ("X") event; nesting is preserved by the timestamps.
+ */
+nlohmann::json ToChromeTrace(const std::deque<GpuFrameProfile>& frames);
+
+void WriteChromeTrace(const std::filesystem::path& path,
+                      const std::deque<GpuFrameProfile>& frames);
+
+}  // namespace vlux
+
+#endif
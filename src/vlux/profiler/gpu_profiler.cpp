@@ -0,0 +1,179 @@
+#include "gpu_profiler.h"
+
+namespace vlux {
+namespace {
+constexpr auto kMaxQueries = 64u;
+constexpr auto kAverageWindow = 64uz;
+constexpr auto kMaxTraceFrames = 256uz;
+}  // namespace
+
+GpuProfiler::GpuProfiler(const VkDevice device, const VkPhysicalDevice physical_device,
+                         const uint32_t queue_family)
+    : device_(device) {
+    auto properties = VkPhysicalDeviceProperties{};
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+
+    const auto queue_family_properties = [&]() {
+        uint32_t queue_family_count = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &queue_family_count, nullptr);
+        auto queue_families = std::vector<VkQueueFamilyProperties>(queue_family_count);
+        vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &queue_family_count,
+                                                 queue_families.data());
+        return queue_families.at(queue_family);
+    }();
+
+    const auto valid_bits = queue_family_properties.timestampValidBits;
+    supported_ = valid_bits > 0 && properties.limits.timestampPeriod > 0.0f;
+    if (!supported_) {
+        spdlog::warn("timestamp queries are not supported on this queue family");
+        return;
+    }
+    timestamp_period_ = properties.limits.timestampPeriod;
+    timestamp_mask_ = valid_bits >= 64 ? std::numeric_limits<uint64_t>::max()
+                                       : (uint64_t{1} << valid_bits) - 1;
+
+    const auto pool_info = VkQueryPoolCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = kMaxQueries,
+    };
+    for (auto& frame_slot : frame_slots_) {
+        if (vkCreateQueryPool(device, &pool_info, nullptr, &frame_slot.query_pool) !=
+            VK_SUCCESS) {
+            throw std::runtime_error("failed to create query pool!");
+        }
+    }
+}
+
+GpuProfiler::~GpuProfiler() {
+    for (const auto& frame_slot : frame_slots_) {
+        if (frame_slot.query_pool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(device_, frame_slot.query_pool, nullptr);
+        }
+    }
+}
+
+void GpuProfiler::BeginFrame(const uint32_t frame_idx, const VkCommandBuffer command_buffer) {
+    auto& frame_slot = frame_slots_.at(frame_idx);
+    frame_slot.frame = frame_count_++;
+    frame_slot.num_queries = 0;
+    frame_slot.scopes.clear();
+    frame_slot.open_scopes.clear();
+    if (!supported_) {
+        return;
+    }
+    vkCmdResetQueryPool(command_buffer, frame_slot.query_pool, 0, kMaxQueries);
+}
+
+void GpuProfiler::BeginScope(const uint32_t frame_idx, const VkCommandBuffer command_buffer,
+                             const std::string_view name) {
+    if (!supported_) {
+        return;
+    }
+    auto& frame_slot = frame_slots_.at(frame_idx);
+    // the end query of every open scope must still fit
+    if (frame_slot.num_queries + frame_slot.open_scopes.size() + 2 > kMaxQueries) {
+        throw std::runtime_error("too many gpu profiler scopes in a frame!");
+    }
+    const auto query = frame_slot.num_queries++;
+    vkCmdWriteTimestamp2(command_buffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                         frame_slot.query_pool, query);
+    frame_slot.open_scopes.emplace_back(frame_slot.scopes.size());
+    frame_slot.scopes.emplace_back(Scope{
+        .name = std::string(name),
+        .depth = static_cast<uint32_t>(frame_slot.open_scopes.size() - 1),
+        .begin_query = query,
+        .end_query = std::nullopt,
+    });
+}
+
+void GpuProfiler::EndScope(const uint32_t frame_idx, const VkCommandBuffer command_buffer) {
+    if (!supported_) {
+        return;
+    }
+    auto& frame_slot = frame_slots_.at(frame_idx);
+    if (frame_slot.open_scopes.empty()) {
+        throw std::runtime_error("`GpuProfiler::EndScope` without a matching `BeginScope`!");
+    }
+    const auto query = frame_slot.num_queries++;
+    // written once all previously submitted commands have completed
+    vkCmdWriteTimestamp2(command_buffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                         frame_slot.query_pool, query);
+    frame_slot.scopes.at(frame_slot.open_scopes.back()).end_query = query;
+    frame_slot.open_scopes.pop_back();
+}
+
+std::optional<GpuFrameProfile> GpuProfiler::Resolve(const uint32_t frame_idx) {
+    auto& frame_slot = frame_slots_.at(frame_idx);
+    const auto scopes = std::exchange(frame_slot.scopes, {});
+    const auto num_queries = std::exchange(frame_slot.num_queries, 0);
+    if (!supported_ || scopes.empty()) {
+        return std::nullopt;
+    }
+    if (!frame_slot.open_scopes.empty()) {
+        throw std::runtime_error("gpu profiler scope was not closed!");
+    }
+
+    // (timestamp, availability) pairs
+    auto results = std::vector<uint64_t>(num_queries * 2);
+    const auto result = vkGetQueryPoolResults(
+        device_, frame_slot.query_pool, 0, num_queries, results.size() * sizeof(uint64_t),
+        results.data(), sizeof(uint64_t) * 2,
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result != VK_SUCCESS && result != VK_NOT_READY) {
+        throw std::runtime_error("failed to get query pool results!");
+    }
+    for (auto query_i = 0uz; query_i < num_queries; query_i++) {
+        if (results.at(query_i * 2 + 1) == 0) {
+            return std::nullopt;
+        }
+    }
+
+    // differences are taken modulo the valid bits, so a counter wrap within the frame is fine
+    const auto ticks_to_us = static_cast<double>(timestamp_period_) * 1e-3;
+    const auto frame_begin = results.at(0) & timestamp_mask_;
+    const auto get_ticks_since_frame_begin = [&](const uint32_t query) {
+        return (results.at(query * 2) - frame_begin) & timestamp_mask_;
+    };
+
+    auto profile = GpuFrameProfile{
+        .frame = frame_slot.frame,
+        .scopes = {},
+    };
+    profile.scopes.reserve(scopes.size());
+    for (const auto& scope : scopes) {
+        const auto begin_ticks = get_ticks_since_frame_begin(scope.begin_query);
+        const auto end_ticks = get_ticks_since_frame_begin(scope.end_query.value());
+        profile.scopes.emplace_back(GpuScopeTime{
+            .name = scope.name,
+            .depth = scope.depth,
+            .begin_us = static_cast<double>(frame_begin + begin_ticks) * ticks_to_us,
+            .elapsed_ms = static_cast<float>(
+                static_cast<double>(end_ticks - begin_ticks) * ticks_to_us * 1e-3),
+        });
+    }
+
+    // rolling averages
+    for (const auto& scope_time : profile.scopes) {
+        auto average = std::ranges::find_if(averages_, [&](const ScopeAverage& scope_average) {
+            return scope_average.name == scope_time.name && scope_average.depth == scope_time.depth;
+        });
+        if (average == averages_.end()) {
+            averages_.emplace_back(ScopeAverage{
+                .name = scope_time.name,
+                .depth = scope_time.depth,
+                .elapsed_ms = RollingAverage(kAverageWindow),
+            });
+            average = std::prev(averages_.end());
+        }
+        average->elapsed_ms.Add(scope_time.elapsed_ms);
+    }
+
+    history_.emplace_back(profile);
+    if (history_.size() > kMaxTraceFrames) {
+        history_.pop_front();
+    }
+    return profile;
+}
+
+}  // namespace vlux
@@ -0,0 +1,92 @@
+#ifndef PROFILER_GPU_PROFILER_H
+#define PROFILER_GPU_PROFILER_H
+#include "pch.h"
+//
+#include "gpu_profile.h"
+
+namespace vlux {
+
+/**
+ * @brief Timestamp profiler for named, nestable GPU scopes
+ *
+ * Every frame slot owns a query pool, so the results of a slot can be read once its fence has
+ * been waited on without stalling the other slot in flight.
+ */
+class GpuProfiler {
+   public:
+    GpuProfiler() = delete;
+    /**
+     * @brief Construct a new GpuProfiler object
+     *
+     * @param device
+     * @param physical_device
+     * @param queue_family queue family the profiled command buffers are submitted to
+     */
+    GpuProfiler(const VkDevice device, const VkPhysicalDevice physical_device,
+                const uint32_t queue_family);
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+    ~GpuProfiler();
+
+    bool IsSupported() const { return supported_; }
+
+    /**
+     * @brief Reset the query pool of the frame slot. Must be recorded outside of a render pass
+     * before any scope of the frame.
+     */
+    void BeginFrame(const uint32_t frame_idx, const VkCommandBuffer command_buffer);
+    void BeginScope(const uint32_t frame_idx, const VkCommandBuffer command_buffer,
+                    const std::string_view name);
+    void EndScope(const uint32_t frame_idx, const VkCommandBuffer command_buffer);
+
+    /**
+     * @brief Read the scopes of the last submission of the frame slot and update the averages
+     *
+     * Must be called after the fence of the frame slot has been waited on; it never blocks.
+     *
+     * @return std::nullopt if nothing was recorded since the last call or timestamps are
+     * unavailable
+     */
+    std::optional<GpuFrameProfile> Resolve(const uint32_t frame_idx);
+
+    //! rolling average of a scope; kept in the order the scopes were first seen
+    struct ScopeAverage {
+        std::string name;
+        uint32_t depth;
+        RollingAverage elapsed_ms;
+    };
+    const std::vector<ScopeAverage>& GetAverages() const { return averages_; }
+
+    //! the most recently resolved frames (up to 256) for trace export
+    const std::deque<GpuFrameProfile>& GetHistory() const { return history_; }
+
+   private:
+    struct Scope {
+        std::string name;
+        uint32_t depth;
+        uint32_t begin_query;
+        std::optional<uint32_t> end_query;
+    };
+    struct FrameSlot {
+        VkQueryPool query_pool = VK_NULL_HANDLE;
+        uint32_t frame = 0;
+        uint32_t num_queries = 0;
+        std::vector<Scope> scopes;
+        // indices into `scopes` of the scopes still open
+        std::vector<size_t> open_scopes;
+    };
+
+    const VkDevice device_;
+    bool supported_ = false;
+    float timestamp_period_ = 0.0f;
+    uint64_t timestamp_mask_ = 0;
+    uint32_t frame_count_ = 0;
+    //! (kMaxFramesInFlight,)
+    std::array<FrameSlot, kMaxFramesInFlight> frame_slots_;
+    std::vector<ScopeAverage> averages_;
+    std::deque<GpuFrameProfile> history_;
+};
+
+}  // namespace vlux
+
+#endif
@@ -1,3 +1,37 @@
 #include "scene.h"
 
-namespace vlux {}
\ No newline at end of file
+#include <unordered_map>
+
+namespace vlux {
+Scene::Scene(GeometryPool&& geometry_pool, std::vector<Model>&& models,
+             std::optional<CubeMap>&& cubemap)
+    : geometry_pool_(std::move(geometry_pool)),
+      models_(std::move(models)),
+      cubemap_(std::move(cubemap)),
+      textures_{nullptr} {
+    // models of one asset share the textures handed out by the `TextureCache`
+    auto slots = std::unordered_map<const Texture<Model::ModelPixelType>*, uint32_t>();
+    const auto get_slot = [&](const std::shared_ptr<Texture<Model::ModelPixelType>>& texture) {
+        if (texture == nullptr) {
+            return kNoTexture;
+        }
+        const auto [it, inserted] =
+            slots.try_emplace(texture.get(), static_cast<uint32_t>(textures_.size()));
+        if (inserted) {
+            textures_.emplace_back(texture);
+        }
+        return it->second;
+    };
+    for (auto& model : models_) {
+        model.SetTextureIndices(glm::uvec4(
+            get_slot(model.GetBaseColorTexture()), get_slot(model.GetNormalTexture()),
+            get_slot(model.GetEmissiveTexture()), get_slot(model.GetMetallicRoughnessTexture())));
+    }
+    if (textures_.size() > kMaxTextures) {
+        throw std::runtime_error(
+            fmt::format("scene: {} textures, at most {}", textures_.size() - 1, kMaxTextures - 1));
+    }
+    spdlog::debug("scene: {} unique textures for {} models", textures_.size() - 1,
+                  models_.size());
+}
+}  // namespace vlux
@@ -3,25 +3,48 @@
 #include "pch.h"
 //
 #include "cubemap/cubemap.h"
+#include "model/geometry_pool.h"
 #include "model/model.h"
 
 namespace vlux {
 
 class Scene {
    public:
-    Scene(std::vector<Model>&& models, std::optional<CubeMap>&& cubemap = std::nullopt)
-        : models_(std::move(models)), cubemap_(std::move(cubemap)){};
+    /**
+     * @brief Gather the unique textures of `models` and point their materials at them
+     */
+    Scene(GeometryPool&& geometry_pool, std::vector<Model>&& models,
+          std::optional<CubeMap>&& cubemap = std::nullopt);
     Scene(const Scene&) = delete;
     Scene& operator=(const Scene&) = delete;
     Scene(Scene&&) = default;
     Scene& operator=(Scene&&) = delete;
 
     const std::vector<Model>& GetModels() const { return models_; }
+    //! see `Model::GetTransform`
+    void SetModelTransform(const size_t model_idx, const glm::mat4& transform) {
+        models_.at(model_idx).SetTransform(transform);
+        transform_version_++;
+    }
+    //! incremented by every `SetModelTransform`
+    uint64_t GetTransformVersion() const { return transform_version_; }
     const std::optional<CubeMap>& GetCubemap() const { return cubemap_; }
+    //! every texture of the scene once, indexed by `MaterialParams::texture_indices`; the
+    //! `kNoTexture` slot is nullptr
+    const std::vector<std::shared_ptr<Texture<Model::ModelPixelType>>>& GetTextures() const {
+        return textures_;
+    }
+    //! holds the vertices and indices of every model
+    const GeometryPool& GetGeometryPool() const { return geometry_pool_; }
+    //! layout of every vertex buffer of the scene
+    VertexFormat GetVertexFormat() const { return geometry_pool_.GetVertexFormat(); }
 
    private:
+    GeometryPool geometry_pool_;
     std::vector<Model> models_;
     std::optional<CubeMap> cubemap_{std::nullopt};
+    std::vector<std::shared_ptr<Texture<Model::ModelPixelType>>> textures_;
+    uint64_t transform_version_ = 0;
 };
 
 }  // namespace vlux
@@ -0,0 +1,15 @@
+#include "texture_cache.h"
+
+namespace vlux {
+std::shared_ptr<Texture<uint8_t>> TextureCache::GetOrCreate(
+    const TextureKey& key,
+    const std::function<std::shared_ptr<Texture<uint8_t>>()>& create_texture) {
+    if (const auto it = textures_.find(key); it != textures_.end()) {
+        num_hits_++;
+        return it->second;
+    }
+    auto texture = create_texture();
+    textures_.emplace(key, texture);
+    return texture;
+}
+}  // namespace vlux
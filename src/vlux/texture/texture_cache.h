@@ -0,0 +1,52 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+#include "pch.h"
+//
+#include <functional>
+#include <map>
+
+#include "texture.h"
+
+namespace vlux {
+struct TextureKey {
+    std::filesystem::path path;
+    //! index into the images of the asset
+    int image_index;
+    VkFormat format;
+
+    auto operator<=>(const TextureKey&) const = default;
+};
+
+/**
+ * @brief Hands out one shared texture per (asset path, image index, format)
+ *
+ * Materials of an asset usually reference a small set of images, so each image is converted and
+ * uploaded once. Not thread-safe; textures are created on the loading thread.
+ */
+class TextureCache {
+   public:
+    TextureCache() = default;
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    /**
+     * @brief Look up the texture of `key` or create it
+     *
+     * @param key
+     * @param create_texture called only on a miss
+     */
+    std::shared_ptr<Texture<uint8_t>> GetOrCreate(
+        const TextureKey& key,
+        const std::function<std::shared_ptr<Texture<uint8_t>>()>& create_texture);
+
+    size_t GetNumTextures() const { return textures_.size(); }
+    //! number of lookups served without creating a texture
+    uint32_t GetNumHits() const { return num_hits_; }
+
+   private:
+    std::map<TextureKey, std::shared_ptr<Texture<uint8_t>>> textures_;
+    uint32_t num_hits_ = 0;
+};
+}  // namespace vlux
+
+#endif
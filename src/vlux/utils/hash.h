@@ -0,0 +1,26 @@
+#ifndef UTILS_HASH_H
+#define UTILS_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace vlux {
+
+constexpr auto kFnv1aOffsetBasis = uint64_t{0xcbf29ce484222325};
+
+//! 64-bit FNV-1a; stable across runs, so it can name files
+inline uint64_t HashBytes(std::span<const std::byte> bytes,
+                          const uint64_t hash = kFnv1aOffsetBasis) {
+    constexpr auto kFnv1aPrime = uint64_t{0x100000001b3};
+    auto result = hash;
+    for (const auto byte : bytes) {
+        result ^= static_cast<uint64_t>(byte);
+        result *= kFnv1aPrime;
+    }
+    return result;
+}
+
+}  // namespace vlux
+
+#endif
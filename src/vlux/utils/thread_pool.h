@@ -0,0 +1,88 @@
+#ifndef UTILS_THREAD_POOL_H
+#define UTILS_THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace vlux {
+/**
+ * @brief Fixed number of worker threads consuming a FIFO of tasks
+ *
+ * Tasks may submit further tasks. Pending tasks are still run when the pool is destroyed.
+ */
+class ThreadPool {
+   public:
+    ThreadPool() = delete;
+    explicit ThreadPool(const uint32_t num_threads) {
+        for (auto i = 0u; i < std::max(num_threads, 1u); i++) {
+            workers_.emplace_back([this]() { WorkerLoop(); });
+        }
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool() {
+        {
+            const auto lock = std::lock_guard(mutex_);
+            stopping_ = true;
+        }
+        condition_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief Run `func` on a worker
+     *
+     * @return future of the result; exceptions thrown by `func` are rethrown by `get`
+     */
+    template <typename F>
+    std::future<std::invoke_result_t<F>> Submit(F&& func) {
+        using Result = std::invoke_result_t<F>;
+        // std::function requires a copyable callable
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(func));
+        auto future = task->get_future();
+        {
+            const auto lock = std::lock_guard(mutex_);
+            tasks_.emplace_back([task]() { (*task)(); });
+        }
+        condition_.notify_one();
+        return future;
+    }
+
+    uint32_t GetNumThreads() const { return static_cast<uint32_t>(workers_.size()); }
+
+   private:
+    void WorkerLoop() {
+        while (true) {
+            auto task = std::function<void()>();
+            {
+                auto lock = std::unique_lock(mutex_);
+                condition_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stopping_ = false;
+};
+}  // namespace vlux
+
+#endif
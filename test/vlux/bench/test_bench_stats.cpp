@@ -0,0 +1,22 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+//
+#include "vlux/bench/bench_stats.h"
+
+TEST_CASE("BenchStats::Percentile", "[bench, stats]") {
+    const auto values = std::vector<float>{5.0f, 1.0f, 4.0f, 2.0f, 3.0f};
+    REQUIRE_THAT(vlux::bench::Percentile(values, 0.0f), Catch::Matchers::WithinAbs(1.0f, 1e-6f));
+    REQUIRE_THAT(vlux::bench::Percentile(values, 50.0f), Catch::Matchers::WithinAbs(3.0f, 1e-6f));
+    REQUIRE_THAT(vlux::bench::Percentile(values, 100.0f), Catch::Matchers::WithinAbs(5.0f, 1e-6f));
+    REQUIRE_THAT(vlux::bench::Percentile(values, 95.0f), Catch::Matchers::WithinAbs(4.8f, 1e-5f));
+    REQUIRE_THAT(vlux::bench::Percentile({7.0f}, 99.0f), Catch::Matchers::WithinAbs(7.0f, 1e-6f));
+    REQUIRE_THROWS(vlux::bench::Percentile({}, 50.0f));
+}
+
+TEST_CASE("BenchStats::Summarize", "[bench, stats]") {
+    const auto summary = vlux::bench::Summarize({2.0f, 4.0f, 6.0f});
+    REQUIRE_THAT(summary.mean, Catch::Matchers::WithinAbs(4.0f, 1e-6f));
+    REQUIRE_THAT(summary.min, Catch::Matchers::WithinAbs(2.0f, 1e-6f));
+    REQUIRE_THAT(summary.max, Catch::Matchers::WithinAbs(6.0f, 1e-6f));
+    REQUIRE_THAT(summary.p50, Catch::Matchers::WithinAbs(4.0f, 1e-6f));
+}
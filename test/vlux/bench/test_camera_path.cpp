@@ -0,0 +1,33 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+//
+#include "vlux/bench/camera_path.h"
+
+TEST_CASE("CameraPath::Sample", "[bench, camera]") {
+    auto path = vlux::bench::CameraPath({
+        {.time = 0.0f, .pos = {0.0f, 0.0f, 0.0f}, .rot = {0.0f, 0.0f}},
+        {.time = 2.0f, .pos = {10.0f, 0.0f, 0.0f}, .rot = {1.0f, 0.0f}},
+        {.time = 4.0f, .pos = {10.0f, 10.0f, 0.0f}, .rot = {1.0f, 0.5f}},
+    });
+    REQUIRE_THAT(path.GetDuration(), Catch::Matchers::WithinAbs(4.0f, 1e-6f));
+
+    const auto mid = path.Sample(1.0f);
+    REQUIRE_THAT(mid.pos.x, Catch::Matchers::WithinAbs(5.0f, 1e-5f));
+    REQUIRE_THAT(mid.rot.x, Catch::Matchers::WithinAbs(0.5f, 1e-5f));
+
+    const auto second = path.Sample(3.0f);
+    REQUIRE_THAT(second.pos.y, Catch::Matchers::WithinAbs(5.0f, 1e-5f));
+    REQUIRE_THAT(second.rot.y, Catch::Matchers::WithinAbs(0.25f, 1e-5f));
+
+    // loops after the duration
+    const auto looped = path.Sample(5.0f);
+    REQUIRE_THAT(looped.pos.x, Catch::Matchers::WithinAbs(5.0f, 1e-5f));
+}
+
+TEST_CASE("CameraPath::Invalid", "[bench, camera]") {
+    REQUIRE_THROWS(vlux::bench::CameraPath({}));
+    REQUIRE_THROWS(vlux::bench::CameraPath({
+        {.time = 1.0f, .pos = {}, .rot = {}},
+        {.time = 1.0f, .pos = {}, .rot = {}},
+    }));
+}
@@ -0,0 +1,54 @@
+#include <catch2/catch_test_macros.hpp>
+//
+#include "vlux/common/staging_ring.h"
+
+TEST_CASE("StagingRing::Allocate", "[common, memory]") {
+    auto ring = vlux::StagingRing(1024);
+    REQUIRE(ring.Allocate(100, 4) == 0);
+    REQUIRE(ring.Allocate(100, 16) == 112);
+    REQUIRE(ring.GetHead() == 212);
+    REQUIRE(ring.GetUsed() == 212);
+    REQUIRE_FALSE(ring.Allocate(2048, 4).has_value());
+}
+
+TEST_CASE("StagingRing::Wrap", "[common, memory]") {
+    auto ring = vlux::StagingRing(1024);
+    REQUIRE(ring.Allocate(600, 4) == 0);
+    const auto first_end = ring.GetHead();
+    REQUIRE(ring.Allocate(300, 4) == 600);
+    const auto second_end = ring.GetHead();
+
+    // does not fit before the end of the ring and the front is still in use
+    REQUIRE_FALSE(ring.Allocate(200, 4).has_value());
+
+    ring.Release(first_end);
+    // never straddles the end of the ring
+    REQUIRE(ring.Allocate(200, 4) == 0);
+    REQUIRE(ring.GetUsed() == 1024 + 200 - first_end);
+
+    ring.Release(second_end);
+    ring.Release(ring.GetHead());
+    REQUIRE(ring.GetUsed() == 0);
+}
+
+TEST_CASE("StagingRing::EmptyStartsOver", "[common, memory]") {
+    auto ring = vlux::StagingRing(1024);
+    REQUIRE(ring.Allocate(640, 4) == 0);
+    const auto first_end = ring.GetHead();
+    REQUIRE(ring.Allocate(64, 4) == 640);
+    ring.Release(ring.GetHead());
+    REQUIRE(ring.GetUsed() == 0);
+
+    // larger than both the tail end and the head, but the ring is empty
+    REQUIRE(ring.Allocate(800, 4) == 0);
+    REQUIRE(ring.GetUsed() == 800);
+    // a stale position of an older submission is already released
+    ring.Release(first_end);
+    REQUIRE(ring.GetUsed() == 800);
+}
+
+TEST_CASE("StagingRing::Release", "[common, memory]") {
+    auto ring = vlux::StagingRing(256);
+    REQUIRE(ring.Allocate(64, 4) == 0);
+    REQUIRE_THROWS(ring.Release(ring.GetHead() + 1));
+}
@@ -0,0 +1,49 @@
+#include <catch2/catch_test_macros.hpp>
+//
+#include "vlux/common/suballocator.h"
+
+TEST_CASE("Suballocator::AlignUp", "[common, memory]") {
+    REQUIRE(vlux::AlignUp(0, 256) == 0);
+    REQUIRE(vlux::AlignUp(1, 256) == 256);
+    REQUIRE(vlux::AlignUp(256, 256) == 256);
+    REQUIRE(vlux::AlignUp(13, 1) == 13);
+}
+
+TEST_CASE("Suballocator::FreeList", "[common, memory]") {
+    auto suballocator = vlux::FreeListSuballocator(1024);
+    const auto a = suballocator.Allocate(100, 1);
+    const auto b = suballocator.Allocate(100, 256);
+    const auto c = suballocator.Allocate(500, 4);
+    REQUIRE(a == 0);
+    REQUIRE(b == 256);
+    REQUIRE(c.has_value());
+    REQUIRE(c.value() % 4 == 0);
+    REQUIRE(suballocator.GetUsed() == 700);
+    REQUIRE_FALSE(suballocator.Allocate(600, 1).has_value());
+
+    // the padding before `b` is reused
+    const auto d = suballocator.Allocate(100, 4);
+    REQUIRE(d.has_value());
+    REQUIRE(d.value() < 256);
+    suballocator.Free(d.value(), 100);
+
+    // freed ranges merge back into a single range
+    suballocator.Free(b.value(), 100);
+    suballocator.Free(a.value(), 100);
+    suballocator.Free(c.value(), 500);
+    REQUIRE(suballocator.IsEmpty());
+    REQUIRE(suballocator.Allocate(1024, 1) == 0);
+}
+
+TEST_CASE("Suballocator::Linear", "[common, memory]") {
+    auto suballocator = vlux::LinearSuballocator(256);
+    REQUIRE(suballocator.Allocate(100, 1) == 0);
+    REQUIRE(suballocator.Allocate(100, 64) == 128);
+    REQUIRE_FALSE(suballocator.Allocate(100, 1).has_value());
+    suballocator.Free(100);
+    REQUIRE_FALSE(suballocator.IsEmpty());
+    suballocator.Free(100);
+    // rewound once every allocation is freed
+    REQUIRE(suballocator.IsEmpty());
+    REQUIRE(suballocator.Allocate(256, 1) == 0);
+}
@@ -0,0 +1,35 @@
+#include <catch2/catch_test_macros.hpp>
+//
+#include "vlux/draw/raytracing/acceleration_structure.h"
+
+TEST_CASE("AccelerationStructure::ToVkTransformMatrix", "[draw, raytracing]") {
+    using vlux::draw::raytracing::ToVkTransformMatrix;
+
+    SECTION("identity") {
+        const auto matrix = ToVkTransformMatrix(glm::mat4(1.0f));
+        for (auto row = 0; row < 3; row++) {
+            for (auto col = 0; col < 4; col++) {
+                CHECK(matrix.matrix[row][col] == (row == col ? 1.0f : 0.0f));
+            }
+        }
+    }
+
+    SECTION("translation lands in the last column") {
+        const auto transform = glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 2.0f, 3.0f));
+        const auto matrix = ToVkTransformMatrix(transform);
+        CHECK(matrix.matrix[0][3] == 1.0f);
+        CHECK(matrix.matrix[1][3] == 2.0f);
+        CHECK(matrix.matrix[2][3] == 3.0f);
+        CHECK(matrix.matrix[0][0] == 1.0f);
+    }
+
+    SECTION("rows are transposed from glm columns") {
+        auto transform = glm::mat4(1.0f);
+        transform[1][0] = 5.0f;  // column 1, row 0
+        transform[0][2] = 7.0f;  // column 0, row 2
+        const auto matrix = ToVkTransformMatrix(transform);
+        CHECK(matrix.matrix[0][1] == 5.0f);
+        CHECK(matrix.matrix[2][0] == 7.0f);
+        CHECK(matrix.matrix[1][0] == 0.0f);
+    }
+}
@@ -0,0 +1,48 @@
+#include <catch2/catch_test_macros.hpp>
+//
+#include "vlux/draw/raytracing/as_cache.h"
+
+TEST_CASE("AccelerationStructureCache::GetASCachePath", "[draw, raytracing]") {
+    using vlux::draw::raytracing::GetASCachePath;
+
+    auto driver_uuid = std::array<uint8_t, VK_UUID_SIZE>();
+    driver_uuid.front() = 0xab;
+    driver_uuid.back() = 0x01;
+    const auto path = GetASCachePath("cache", 0x1234, driver_uuid);
+    CHECK(path.parent_path() == std::filesystem::path("cache"));
+    CHECK(path.filename() == "0000000000001234-ab000000000000000000000000000001.blas");
+}
+
+TEST_CASE("AccelerationStructureCache::ParseSerializedASHeader", "[draw, raytracing]") {
+    using vlux::draw::raytracing::ParseSerializedASHeader;
+    using vlux::draw::raytracing::SerializedASHeader;
+
+    auto header = SerializedASHeader{
+        .driver_uuid = {},
+        .compatibility_uuid = {},
+        .serialized_size = 64,
+        .deserialized_size = 4096,
+        .handle_count = 0,
+    };
+    auto blob = std::vector<std::byte>(64);
+    const auto write_header = [&]() { std::memcpy(blob.data(), &header, sizeof(header)); };
+
+    SECTION("valid") {
+        write_header();
+        const auto parsed = ParseSerializedASHeader(blob);
+        REQUIRE(parsed.has_value());
+        CHECK(parsed->deserialized_size == 4096);
+    }
+
+    SECTION("truncated") {
+        write_header();
+        CHECK_FALSE(ParseSerializedASHeader(std::span(blob).first(32)).has_value());
+        CHECK_FALSE(ParseSerializedASHeader(std::span(blob).first(60)).has_value());
+    }
+
+    SECTION("top level") {
+        header.handle_count = 1;
+        write_header();
+        CHECK_FALSE(ParseSerializedASHeader(blob).has_value());
+    }
+}
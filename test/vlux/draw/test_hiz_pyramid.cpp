@@ -0,0 +1,45 @@
+#include <catch2/catch_test_macros.hpp>
+//
+#include "vlux/draw/rasterize/hiz_pyramid.h"
+
+TEST_CASE("HiZPyramid::ComputeHiZLevels", "[draw, hiz]") {
+    using vlux::draw::rasterize::ComputeHiZLevels;
+
+    SECTION("halves down to one texel") {
+        const auto levels = ComputeHiZLevels(1920, 1080);
+        REQUIRE(levels.size() == 11);
+        CHECK(levels[0].width == 960);
+        CHECK(levels[0].height == 540);
+        CHECK(levels[1].width == 480);
+        CHECK(levels[1].height == 270);
+        CHECK(levels.back().width == 1);
+        CHECK(levels.back().height == 1);
+    }
+
+    SECTION("odd sizes round up") {
+        const auto levels = ComputeHiZLevels(5, 3);
+        REQUIRE(levels.size() == 3);
+        CHECK(levels[0].width == 3);
+        CHECK(levels[0].height == 2);
+        CHECK(levels[1].width == 2);
+        CHECK(levels[1].height == 1);
+        CHECK(levels[2].width == 1);
+        CHECK(levels[2].height == 1);
+    }
+
+    SECTION("levels are packed back to back") {
+        const auto levels = ComputeHiZLevels(64, 16);
+        CHECK(levels[0].offset == 0);
+        for (size_t i = 1; i < levels.size(); i++) {
+            CHECK(levels[i].offset ==
+                  levels[i - 1].offset + levels[i - 1].width * levels[i - 1].height);
+        }
+    }
+
+    SECTION("a single texel target") {
+        const auto levels = ComputeHiZLevels(1, 1);
+        REQUIRE(levels.size() == 1);
+        CHECK(levels[0].width == 1);
+        CHECK(levels[0].height == 1);
+    }
+}
@@ -0,0 +1,41 @@
+#include <catch2/catch_test_macros.hpp>
+//
+#include "vlux/draw/raytracing/scratch_buffer.h"
+
+TEST_CASE("RayTracingScratchBuffer::PlanScratchBatches", "[draw, raytracing]") {
+    using vlux::draw::raytracing::PlanScratchBatches;
+
+    SECTION("aligned offsets within a batch") {
+        const auto sizes = std::vector<VkDeviceSize>{100, 256, 1};
+        const auto plan = PlanScratchBatches(sizes, 128, 4096);
+        REQUIRE(plan.batches.size() == 1);
+        CHECK(plan.batches[0].first == 0);
+        CHECK(plan.batches[0].count == 3);
+        CHECK(plan.offsets == std::vector<VkDeviceSize>{0, 128, 384});
+        CHECK(plan.pool_size == 512);
+    }
+
+    SECTION("splits at the budget and reuses the pool") {
+        const auto sizes = std::vector<VkDeviceSize>{300, 300, 300, 300, 300};
+        const auto plan = PlanScratchBatches(sizes, 256, 1024);
+        REQUIRE(plan.batches.size() == 3);
+        CHECK(plan.batches[1].first == 2);
+        CHECK(plan.batches[1].count == 2);
+        CHECK(plan.batches[2].count == 1);
+        CHECK(plan.offsets == std::vector<VkDeviceSize>{0, 512, 0, 512, 0});
+        CHECK(plan.pool_size == 1024);
+    }
+
+    SECTION("oversized builds get their own batch") {
+        const auto sizes = std::vector<VkDeviceSize>{64, 5000, 64};
+        const auto plan = PlanScratchBatches(sizes, 64, 1024);
+        REQUIRE(plan.batches.size() == 3);
+        CHECK(plan.pool_size == 5056);
+    }
+
+    SECTION("no builds") {
+        const auto plan = PlanScratchBatches({}, 64, 1024);
+        CHECK(plan.batches.empty());
+        CHECK(plan.pool_size == 0);
+    }
+}
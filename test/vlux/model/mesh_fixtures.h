@@ -0,0 +1,65 @@
+#ifndef TEST_MODEL_MESH_FIXTURES_H
+#define TEST_MODEL_MESH_FIXTURES_H
+
+#include "vlux/model/index.h"
+#include "vlux/model/vertex.h"
+
+namespace vlux::test {
+/**
+ * @brief n x n quads on the unit square, facing +z and displaced along z by `height`
+ *
+ * The vertices are shared between quads, row by row.
+ */
+inline void CreateGrid(const int n, std::vector<Vertex>& vertices, std::vector<Index>& indices,
+                       const float height = 0.0f) {
+    for (int y = 0; y <= n; y++) {
+        for (int x = 0; x <= n; x++) {
+            const auto u = static_cast<float>(x) / n;
+            const auto v = static_cast<float>(y) / n;
+            vertices.emplace_back(Vertex{
+                .pos = {u, v, height * std::sin(u * 6.0f) * std::cos(v * 4.0f)},
+                .normal = {0.0f, 0.0f, 1.0f},
+            });
+        }
+    }
+    const auto get_index = [n](const int x, const int y) {
+        return static_cast<Index>(y * (n + 1) + x);
+    };
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            for (const auto index : {get_index(x, y), get_index(x + 1, y),
+                                     get_index(x + 1, y + 1), get_index(x, y),
+                                     get_index(x + 1, y + 1), get_index(x, y + 1)}) {
+                indices.emplace_back(index);
+            }
+        }
+    }
+}
+
+/**
+ * @brief n x n unit quads, every triangle with its own vertices and the rows in scrambled order
+ */
+inline void CreateUnweldedGrid(const int n, std::vector<Vertex>& vertices,
+                               std::vector<Index>& indices) {
+    const auto add_vertex = [&](const int x, const int y) {
+        vertices.emplace_back(Vertex{
+            .pos = {static_cast<float>(x), static_cast<float>(y), 0.0f},
+            .normal = {0.0f, 0.0f, 1.0f},
+        });
+        indices.emplace_back(static_cast<Index>(vertices.size() - 1));
+    };
+    for (int i = 0; i < n; i++) {
+        const auto y = (i * 7) % n;
+        for (int x = 0; x < n; x++) {
+            add_vertex(x, y);
+            add_vertex(x + 1, y);
+            add_vertex(x + 1, y + 1);
+            add_vertex(x, y);
+            add_vertex(x + 1, y + 1);
+            add_vertex(x, y + 1);
+        }
+    }
+}
+}  // namespace vlux::test
+
+#endif
@@ -0,0 +1,21 @@
+#include <catch2/catch_test_macros.hpp>
+//
+#include "vlux/model/index.h"
+
+TEST_CASE("Index::SelectIndexType", "[model, index]") {
+    REQUIRE(vlux::SelectIndexType(0) == VK_INDEX_TYPE_UINT16);
+    REQUIRE(vlux::SelectIndexType(255) == VK_INDEX_TYPE_UINT16);
+    REQUIRE(vlux::SelectIndexType(65535) == VK_INDEX_TYPE_UINT16);
+    REQUIRE(vlux::SelectIndexType(65536) == VK_INDEX_TYPE_UINT32);
+}
+
+TEST_CASE("Index::PackRoundTrip", "[model, index]") {
+    const auto indices = std::vector<vlux::Index>{0, 1, 2, 2, 1, 65535};
+    const auto packed16 = vlux::PackIndices(indices, VK_INDEX_TYPE_UINT16);
+    REQUIRE(packed16.size() == sizeof(uint16_t) * indices.size());
+    REQUIRE(vlux::UnpackIndices(packed16, VK_INDEX_TYPE_UINT16) == indices);
+
+    const auto packed32 = vlux::PackIndices(indices, VK_INDEX_TYPE_UINT32);
+    REQUIRE(packed32.size() == sizeof(uint32_t) * indices.size());
+    REQUIRE(vlux::UnpackIndices(packed32, VK_INDEX_TYPE_UINT32) == indices);
+}
@@ -0,0 +1,86 @@
+#include <catch2/catch_test_macros.hpp>
+//
+#include "mesh_fixtures.h"
+#include "vlux/model/mesh_optimizer.h"
+
+namespace {
+//! triangles as position triples, rotated to a canonical first vertex
+std::multiset<std::array<float, 9>> GetTriangles(const std::vector<vlux::Vertex>& vertices,
+                                                 const std::vector<vlux::Index>& indices) {
+    auto triangles = std::multiset<std::array<float, 9>>();
+    for (size_t t = 0; t < indices.size(); t += 3) {
+        auto corners = std::array<std::array<float, 3>, 3>();
+        for (size_t k = 0; k < 3; k++) {
+            const auto& pos = vertices[indices[t + k]].pos;
+            corners[k] = {pos.x, pos.y, pos.z};
+        }
+        std::ranges::rotate(corners, std::ranges::min_element(corners));
+        auto triangle = std::array<float, 9>();
+        for (size_t k = 0; k < 3; k++) {
+            std::ranges::copy(corners[k], triangle.begin() + k * 3);
+        }
+        triangles.emplace(triangle);
+    }
+    return triangles;
+}
+}  // namespace
+
+TEST_CASE("MeshOptimizer::AnalyzeVertexCache", "[model, mesh_optimizer]") {
+    const auto indices = std::vector<vlux::Index>{0, 1, 2, 2, 1, 3};
+    const auto stats = vlux::AnalyzeVertexCache(indices, 4);
+    REQUIRE(stats.num_transformed == 4);
+    REQUIRE(stats.num_triangles == 2);
+    REQUIRE(stats.GetAcmr() == 2.0f);
+    REQUIRE(stats.GetAtvr() == 1.0f);
+}
+
+TEST_CASE("MeshOptimizer::OptimizeOverdraw", "[model, mesh_optimizer]") {
+    // disconnected quads: each one starts a hard cluster
+    constexpr auto kNumQuads = 4096;
+    auto vertices = std::vector<vlux::Vertex>();
+    auto indices = std::vector<vlux::Index>();
+    for (int q = 0; q < kNumQuads; q++) {
+        // a spiral of quads, so that the clusters face in different directions
+        const auto angle = static_cast<float>(q) * 0.1f;
+        const auto origin = glm::vec3(std::cos(angle), std::sin(angle), static_cast<float>(q));
+        const auto tangent = glm::vec3(-std::sin(angle), std::cos(angle), 0.0f) * 0.05f;
+        const auto up = glm::vec3(0.0f, 0.0f, 0.5f);
+        const auto first = static_cast<vlux::Index>(vertices.size());
+        for (const auto& pos : {origin, origin + tangent, origin + tangent + up, origin + up}) {
+            vertices.emplace_back(vlux::Vertex{.pos = pos});
+        }
+        for (const auto corner : {0, 1, 2, 0, 2, 3}) {
+            indices.emplace_back(first + corner);
+        }
+    }
+
+    const auto result = vlux::OptimizeOverdraw(indices, vertices, 1.05f);
+    REQUIRE(result.size() == indices.size());
+    REQUIRE(GetTriangles(vertices, result) == GetTriangles(vertices, indices));
+    // clusters are moved whole: the two triangles of a quad stay together
+    for (size_t t = 0; t < result.size(); t += 6) {
+        REQUIRE(result[t] % 4 == 0);
+        REQUIRE(result[t + 3] == result[t]);
+    }
+}
+
+TEST_CASE("MeshOptimizer::OptimizeMesh", "[model, mesh_optimizer]") {
+    auto vertices = std::vector<vlux::Vertex>();
+    auto indices = std::vector<vlux::Index>();
+    vlux::test::CreateUnweldedGrid(16, vertices, indices);
+    const auto triangles = GetTriangles(vertices, indices);
+
+    const auto stats = vlux::OptimizeMesh(vertices, indices, {});
+    REQUIRE(vertices.size() == 17 * 17);
+    REQUIRE(indices.size() == 16 * 16 * 6);
+    REQUIRE(GetTriangles(vertices, indices) == triangles);
+    REQUIRE(stats.before.GetAcmr() == 3.0f);
+    REQUIRE(stats.after.GetAcmr() < 1.0f);
+
+    // vertices are in order of first use
+    auto next_vertex = vlux::Index{0};
+    for (const auto index : indices) {
+        REQUIRE(index <= next_vertex);
+        next_vertex = std::max(next_vertex, index + 1);
+    }
+}
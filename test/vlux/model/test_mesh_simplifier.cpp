@@ -0,0 +1,50 @@
+#include <catch2/catch_test_macros.hpp>
+//
+#include "mesh_fixtures.h"
+#include "vlux/model/mesh_simplifier.h"
+
+TEST_CASE("MeshSimplifier::SimplifyMesh", "[model, mesh_simplifier]") {
+    auto vertices = std::vector<vlux::Vertex>();
+    auto indices = std::vector<vlux::Index>();
+    vlux::test::CreateGrid(16, vertices, indices);
+
+    const auto lod = vlux::SimplifyMesh(vertices, indices, indices.size() / 4);
+    REQUIRE(lod.indices.size() <= indices.size() / 4);
+    REQUIRE(lod.indices.size() % 3 == 0);
+    // collapses within the plane keep it exactly
+    REQUIRE(lod.error < 1e-4f);
+    for (size_t t = 0; t < lod.indices.size(); t += 3) {
+        const auto& p0 = vertices[lod.indices[t + 0]].pos;
+        const auto& p1 = vertices[lod.indices[t + 1]].pos;
+        const auto& p2 = vertices[lod.indices[t + 2]].pos;
+        // no triangle is flipped
+        REQUIRE(glm::cross(p1 - p0, p2 - p0).z > 0.0f);
+    }
+
+    // border vertices stay
+    auto used = std::vector<bool>(vertices.size(), false);
+    for (const auto index : lod.indices) {
+        used[index] = true;
+    }
+    for (int i = 0; i <= 16; i++) {
+        REQUIRE(used[i]);
+    }
+}
+
+TEST_CASE("MeshSimplifier::GenerateLods", "[model, mesh_simplifier]") {
+    auto vertices = std::vector<vlux::Vertex>();
+    auto indices = std::vector<vlux::Index>();
+    vlux::test::CreateGrid(64, vertices, indices, 0.1f);
+
+    const auto lods = vlux::GenerateLods(vertices, indices, {.max_levels = 3});
+    REQUIRE(lods.size() == 3);
+    auto previous_size = indices.size();
+    auto previous_error = 0.0f;
+    for (const auto& lod : lods) {
+        REQUIRE(lod.indices.size() < previous_size);
+        REQUIRE(lod.error >= previous_error);
+        REQUIRE(lod.error < 0.1f);
+        previous_size = lod.indices.size();
+        previous_error = lod.error;
+    }
+}
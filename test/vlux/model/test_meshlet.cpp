@@ -0,0 +1,40 @@
+#include <catch2/catch_test_macros.hpp>
+//
+#include "mesh_fixtures.h"
+#include "vlux/model/meshlet.h"
+
+TEST_CASE("Meshlet::BuildMeshlets", "[model, meshlet]") {
+    auto vertices = std::vector<vlux::Vertex>();
+    auto indices = std::vector<vlux::Index>();
+    vlux::test::CreateGrid(32, vertices, indices);
+
+    const auto mesh = vlux::BuildMeshlets(vertices, indices);
+    REQUIRE(mesh.triangles.size() == indices.size() / 3);
+
+    // every triangle is kept, in order, and within the limits of its meshlet
+    auto t = size_t{0};
+    for (const auto& meshlet : mesh.meshlets) {
+        REQUIRE(meshlet.vertex_count <= vlux::kMeshletMaxVertices);
+        REQUIRE(meshlet.triangle_count <= vlux::kMeshletMaxTriangles);
+        REQUIRE(meshlet.triangle_offset == t);
+        for (uint32_t i = 0; i < meshlet.triangle_count; i++, t++) {
+            const auto triangle = mesh.triangles[meshlet.triangle_offset + i];
+            for (uint32_t k = 0; k < 3; k++) {
+                const auto local_index = (triangle >> (k * 8)) & 0xff;
+                REQUIRE(local_index < meshlet.vertex_count);
+                REQUIRE(mesh.vertices[meshlet.vertex_offset + local_index] == indices[t * 3 + k]);
+            }
+        }
+
+        // the sphere holds every vertex
+        const auto center = glm::vec3(meshlet.sphere);
+        for (uint32_t v = 0; v < meshlet.vertex_count; v++) {
+            const auto& pos = vertices[mesh.vertices[meshlet.vertex_offset + v]].pos;
+            REQUIRE(glm::length(pos - center) <= meshlet.sphere.w + 1e-5f);
+        }
+        // a flat meshlet has the tightest cone
+        REQUIRE(meshlet.cone.z > 0.999f);
+        REQUIRE(meshlet.cone.w < 1e-3f);
+    }
+    REQUIRE(t == indices.size() / 3);
+}
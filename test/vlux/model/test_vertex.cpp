@@ -0,0 +1,76 @@
+#include <catch2/catch_test_macros.hpp>
+//
+#include "vlux/model/vertex.h"
+
+TEST_CASE("Vertex::CompactRoundTrip", "[model, vertex]") {
+    const auto vertices = std::vector<vlux::Vertex>{
+        {
+            .pos = {-10.0f, 0.0f, 5.0f},
+            .normal = glm::normalize(glm::vec3(1.0f, -2.0f, -3.0f)),
+            .uv = {0.25f, 2.5f},
+            .tangent = {0.0f, 0.0f, -1.0f, -1.0f},
+        },
+        {
+            .pos = {10.0f, 4.0f, 5.0f},
+            .normal = {0.0f, 1.0f, 0.0f},
+            .uv = {1.0f, 0.0f},
+            .tangent = {1.0f, 0.0f, 0.0f, 1.0f},
+        },
+    };
+    const auto quantization = vlux::ComputeVertexQuantization(vertices);
+    REQUIRE(quantization.offset == glm::vec3(0.0f, 2.0f, 5.0f));
+
+    for (const auto& vertex : vertices) {
+        const auto compact = vlux::EncodeCompactVertex(vertex, quantization);
+        const auto decoded = vlux::DecodeCompactVertex(compact, quantization);
+        REQUIRE(glm::length(decoded.pos - vertex.pos) < 1e-3f);
+        REQUIRE(glm::dot(decoded.normal, vertex.normal) > 0.9999f);
+        REQUIRE(glm::length(decoded.uv - vertex.uv) < 1e-3f);
+        REQUIRE(glm::dot(glm::vec3(decoded.tangent), glm::vec3(vertex.tangent)) > 0.9999f);
+        REQUIRE(decoded.tangent.w == vertex.tangent.w);
+    }
+
+    const auto packed = vlux::PackVertices(vertices, vlux::VertexFormat::kCompact, quantization);
+    REQUIRE(packed.size() == sizeof(vlux::CompactVertex) * vertices.size());
+}
+
+TEST_CASE("Vertex::CompactZeroVector", "[model, vertex]") {
+    // e.g. the tangent of a mesh without UVs
+    const auto vertex = vlux::Vertex{
+        .pos = {0.0f, 0.0f, 0.0f},
+        .normal = {0.0f, 0.0f, 0.0f},
+        .uv = {0.0f, 0.0f},
+        .tangent = {0.0f, 0.0f, 0.0f, 1.0f},
+    };
+    const auto quantization = vlux::ComputeVertexQuantization(std::span(&vertex, 1));
+    const auto compact = vlux::EncodeCompactVertex(vertex, quantization);
+    REQUIRE(compact.normal == std::array<int16_t, 2>{0, 0});
+    REQUIRE(compact.tangent == std::array<int16_t, 2>{0, 0});
+
+    const auto decoded = vlux::DecodeCompactVertex(compact, quantization);
+    REQUIRE(decoded.normal == glm::vec3(0.0f, 0.0f, 1.0f));
+    REQUIRE(glm::vec3(decoded.tangent) == glm::vec3(0.0f, 0.0f, 1.0f));
+}
+
+TEST_CASE("Vertex::ParseVertexFormat", "[model, vertex]") {
+    REQUIRE(vlux::ParseVertexFormat("float") == vlux::VertexFormat::kFloat);
+    REQUIRE(vlux::ParseVertexFormat("compact") == vlux::VertexFormat::kCompact);
+    REQUIRE_THROWS(vlux::ParseVertexFormat("half"));
+}
+
+TEST_CASE("Vertex::ComputeBounds", "[model, vertex]") {
+    auto vertices = std::vector<vlux::Vertex>(3);
+    vertices[0].pos = {-1.0f, 0.0f, 2.0f};
+    vertices[1].pos = {3.0f, -2.0f, 2.0f};
+    vertices[2].pos = {1.0f, 4.0f, 0.0f};
+
+    const auto box = vlux::ComputeBoundingBox(vertices);
+    REQUIRE(box.min == glm::vec3(-1.0f, -2.0f, 0.0f));
+    REQUIRE(box.max == glm::vec3(3.0f, 4.0f, 2.0f));
+
+    const auto sphere = vlux::ComputeBoundingSphere(vertices);
+    REQUIRE(sphere.center == glm::vec3(1.0f, 1.0f, 1.0f));
+    for (const auto& vertex : vertices) {
+        REQUIRE(glm::length(vertex.pos - sphere.center) <= sphere.radius);
+    }
+}
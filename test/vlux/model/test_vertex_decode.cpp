@@ -0,0 +1,138 @@
+#include <catch2/catch_test_macros.hpp>
+//
+#include "vlux/model/vertex_decode.h"
+
+TEST_CASE("VertexDecode::StridedNormalized", "[model, vertex_decode]") {
+    // two interleaved elements: normalized u16 vec2 followed by 4 bytes of other data
+    const auto values = std::to_array<uint16_t>({0, 65535, 0xffff, 0xffff, 65535, 0, 0, 0});
+    auto model = tinygltf::Model();
+    model.buffers.emplace_back().data.resize(sizeof(values));
+    memcpy(model.buffers[0].data.data(), values.data(), sizeof(values));
+    auto& buffer_view = model.bufferViews.emplace_back();
+    buffer_view.buffer = 0;
+    buffer_view.byteLength = sizeof(values);
+    buffer_view.byteStride = 8;
+    auto accessor = tinygltf::Accessor();
+    accessor.bufferView = 0;
+    accessor.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT;
+    accessor.normalized = true;
+    accessor.count = 2;
+    accessor.type = TINYGLTF_TYPE_VEC2;
+
+    auto vertices = std::vector<vlux::Vertex>(2);
+    vlux::DecodeAccessor(model, accessor, 2, reinterpret_cast<std::byte*>(&vertices[0].uv),
+                         sizeof(vlux::Vertex));
+    REQUIRE(vertices[0].uv == glm::vec2(0.0f, 1.0f));
+    REQUIRE(vertices[1].uv == glm::vec2(1.0f, 0.0f));
+}
+
+TEST_CASE("VertexDecode::Sparse", "[model, vertex_decode]") {
+    // no buffer view: zeros, with element 1 replaced by a sparse value
+    const auto index = uint16_t{1};
+    const auto value = glm::vec3(1.0f, 2.0f, 3.0f);
+    auto model = tinygltf::Model();
+    model.buffers.emplace_back().data.resize(16 + sizeof(value));
+    memcpy(model.buffers[0].data.data(), &index, sizeof(index));
+    memcpy(model.buffers[0].data.data() + 16, &value, sizeof(value));
+    auto& index_view = model.bufferViews.emplace_back();
+    index_view.buffer = 0;
+    index_view.byteLength = sizeof(index);
+    auto& value_view = model.bufferViews.emplace_back();
+    value_view.buffer = 0;
+    value_view.byteOffset = 16;
+    value_view.byteLength = sizeof(value);
+    auto accessor = tinygltf::Accessor();
+    accessor.bufferView = -1;
+    accessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+    accessor.count = 3;
+    accessor.type = TINYGLTF_TYPE_VEC3;
+    accessor.sparse.isSparse = true;
+    accessor.sparse.count = 1;
+    accessor.sparse.indices.bufferView = 0;
+    accessor.sparse.indices.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT;
+    accessor.sparse.values.bufferView = 1;
+
+    auto vertices = std::vector<vlux::Vertex>(3);
+    vlux::DecodeAccessor(model, accessor, 3, reinterpret_cast<std::byte*>(&vertices[0].pos),
+                         sizeof(vlux::Vertex));
+    REQUIRE(vertices[0].pos == glm::vec3(0.0f));
+    REQUIRE(vertices[1].pos == value);
+    REQUIRE(vertices[2].pos == glm::vec3(0.0f));
+}
+
+TEST_CASE("VertexDecode::GetBufferViewData", "[model, vertex_decode]") {
+    // a 12 byte view at offset 4 of a 16 byte buffer
+    auto model = tinygltf::Model();
+    model.buffers.emplace_back().data.resize(16);
+    auto& buffer_view = model.bufferViews.emplace_back();
+    buffer_view.buffer = 0;
+    buffer_view.byteOffset = 4;
+    buffer_view.byteLength = 12;
+
+    REQUIRE(vlux::GetBufferViewData(model, 0, 0, 12) == model.buffers[0].data.data() + 4);
+    REQUIRE(vlux::GetBufferViewData(model, 0, 8, 4) == model.buffers[0].data.data() + 12);
+    REQUIRE_THROWS(vlux::GetBufferViewData(model, 0, 8, 5));
+    REQUIRE_THROWS(vlux::GetBufferViewData(model, 0, 13, 0));
+    REQUIRE_THROWS(vlux::GetBufferViewData(model, 1, 0, 0));
+
+    // the view itself past the end of the buffer
+    buffer_view.byteLength = 16;
+    REQUIRE_THROWS(vlux::GetBufferViewData(model, 0, 0, 1));
+}
+
+TEST_CASE("VertexDecode::Transform", "[model, vertex_decode]") {
+    // enough vertices for a full SIMD batch and a remainder
+    auto vertices = std::vector<vlux::Vertex>(11);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const auto f = static_cast<float>(i);
+        vertices[i].pos = {f, 1.0f, -f};
+        vertices[i].normal = {1.0f, 0.0f, 0.0f};
+        vertices[i].uv = {f, f};
+    }
+    const auto rotation =
+        glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const auto translation = glm::vec3(1.0f, 2.0f, 3.0f);
+    const auto original = vertices;
+    vlux::TransformVertices(vertices, rotation, 2.0f, translation, false);
+
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const auto expected_pos =
+            glm::vec3(rotation * glm::vec4(original[i].pos, 1.0f)) * 2.0f + translation;
+        const auto expected_normal = glm::vec3(rotation * glm::vec4(original[i].normal, 0.0f));
+        REQUIRE(glm::length(vertices[i].pos - expected_pos) < 1e-4f);
+        REQUIRE(glm::length(vertices[i].normal - expected_normal) < 1e-4f);
+        REQUIRE(vertices[i].uv == original[i].uv);
+        REQUIRE(vertices[i].tangent == original[i].tangent);
+    }
+}
+
+TEST_CASE("VertexDecode::TransformIsa", "[model, vertex_decode]") {
+    using vlux::TransformIsa;
+
+    // batches of 8 and a remainder, with tangents so every field goes through both paths
+    auto vertices = std::vector<vlux::Vertex>(37);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const auto f = static_cast<float>(i);
+        vertices[i].pos = {0.5f * f, 1.0f - f, 0.25f * f * f};
+        vertices[i].normal = glm::normalize(glm::vec3(1.0f, f, -2.0f));
+        vertices[i].tangent = glm::vec4(glm::normalize(glm::vec3(-f, 1.0f, 3.0f)), 1.0f);
+    }
+    const auto axis = glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f));
+    const auto rotation = glm::rotate(glm::mat4(1.0f), glm::radians(30.0f), axis);
+    const auto translation = glm::vec3(-4.0f, 5.0f, 6.0f);
+
+    auto baseline = vertices;
+    vlux::TransformVertices(baseline, rotation, 3.0f, translation, true, TransformIsa::kBaseline);
+    // the baseline again where the CPU lacks AVX2 or FMA
+    auto fastest = vertices;
+    vlux::TransformVertices(fastest, rotation, 3.0f, translation, true, TransformIsa::kAvx2Fma);
+
+    for (size_t i = 0; i < vertices.size(); i++) {
+        // FMA rounds once per multiply-add
+        const auto tolerance = 1e-5f * std::max(1.0f, glm::length(baseline[i].pos));
+        REQUIRE(glm::length(fastest[i].pos - baseline[i].pos) < tolerance);
+        REQUIRE(glm::length(fastest[i].normal - baseline[i].normal) < 1e-5f);
+        REQUIRE(glm::length(fastest[i].tangent - baseline[i].tangent) < 1e-5f);
+        REQUIRE(fastest[i].uv == baseline[i].uv);
+    }
+}
@@ -0,0 +1,59 @@
+#include <catch2/catch_test_macros.hpp>
+//
+#include "vlux/model/vlx_scene.h"
+
+TEST_CASE("VlxScene::RoundTrip", "[model, vlxscene]") {
+    auto primitive = vlux::GltfPrimitive{
+        .indices = {0, 1, 2, 2, 1, 0},
+        .lods = {{.indices = {0, 1, 2}, .error = 0.5f}},
+        .vertices = std::vector<vlux::Vertex>(3),
+        .base_color_factor = {1.0f, 0.5f, 0.25f, 1.0f},
+        .metallic_factor = 0.1f,
+        .roughness_factor = 0.9f,
+        .base_color_image = 0,
+    };
+    primitive.vertices[1].pos = {1.0f, 2.0f, 3.0f};
+    const auto pixels = std::vector<uint8_t>{255, 0, 0, 255, 0, 255, 0, 255};
+    const auto images = std::vector<vlux::Image<uint8_t>>{vlux::Image(pixels, 2, 1, 4)};
+
+    const auto path = std::filesystem::temp_directory_path() / "test_vlx_scene.vlxscene";
+    vlux::WriteVlxScene(path, {primitive}, images);
+    {
+        const auto file = vlux::VlxSceneFile(path);
+        REQUIRE(file.GetPrimitives().size() == 1);
+        REQUIRE(file.GetTextures().size() == 1);
+
+        const auto& record = file.GetPrimitives()[0];
+        REQUIRE(record.num_vertices == 3);
+        REQUIRE(record.base_color_factor[2] == 0.25f);
+        REQUIRE(record.base_color_texture == 0);
+        REQUIRE(record.normal_texture == -1);
+        REQUIRE(file.GetVertices(record)[1].pos == glm::vec3(1.0f, 2.0f, 3.0f));
+        REQUIRE(record.index_type == VK_INDEX_TYPE_UINT16);
+        const auto indices = vlux::UnpackIndices(file.GetPackedIndices(record),
+                                                 static_cast<VkIndexType>(record.index_type));
+        REQUIRE(indices[2] == 2);
+        const auto lods = file.GetLods(record);
+        REQUIRE(lods.size() == 1);
+        REQUIRE(lods[0].error == 0.5f);
+        const auto lod_indices = vlux::UnpackIndices(
+            file.GetPackedIndices(record, lods[0]), static_cast<VkIndexType>(record.index_type));
+        REQUIRE(lod_indices == std::vector<vlux::Index>{0, 1, 2});
+
+        const auto& texture = file.GetTextures()[0];
+        REQUIRE(texture.width == 2);
+        const auto texels = file.GetTexels(texture);
+        REQUIRE(std::equal(texels.begin(), texels.end(), pixels.begin(), pixels.end()));
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("VlxScene::Invalid", "[model, vlxscene]") {
+    const auto path = std::filesystem::temp_directory_path() / "test_vlx_scene_invalid.vlxscene";
+    {
+        auto file = std::ofstream(path, std::ios::binary);
+        file << std::string(128, 'x');
+    }
+    REQUIRE_THROWS(vlux::VlxSceneFile(path));
+    std::filesystem::remove(path);
+}
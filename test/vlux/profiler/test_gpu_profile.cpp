@@ -0,0 +1,38 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+//
+#include "vlux/profiler/gpu_profile.h"
+
+TEST_CASE("RollingAverage", "[profiler]") {
+    auto average = vlux::RollingAverage(3);
+    REQUIRE_THAT(average.Get(), Catch::Matchers::WithinAbs(0.0f, 1e-6f));
+    average.Add(1.0f);
+    average.Add(2.0f);
+    REQUIRE(average.GetCount() == 2);
+    REQUIRE_THAT(average.Get(), Catch::Matchers::WithinAbs(1.5f, 1e-6f));
+    average.Add(3.0f);
+    average.Add(10.0f);  // drops 1.0
+    REQUIRE(average.GetCount() == 3);
+    REQUIRE_THAT(average.Get(), Catch::Matchers::WithinAbs(5.0f, 1e-6f));
+    REQUIRE_THROWS(vlux::RollingAverage(0));
+}
+
+TEST_CASE("ToChromeTrace", "[profiler]") {
+    auto frames = std::deque<vlux::GpuFrameProfile>();
+    frames.emplace_back(vlux::GpuFrameProfile{
+        .frame = 7,
+        .scopes =
+            {
+                {.name = "frame", .depth = 0, .begin_us = 100.0, .elapsed_ms = 2.0f},
+                {.name = "gbuffer", .depth = 1, .begin_us = 150.0, .elapsed_ms = 0.5f},
+            },
+    });
+    const auto trace = vlux::ToChromeTrace(frames);
+    const auto& events = trace.at("traceEvents");
+    REQUIRE(events.size() == 2);
+    REQUIRE(events.at(0).at("name") == "frame");
+    REQUIRE(events.at(0).at("ph") == "X");
+    REQUIRE_THAT(events.at(0).at("dur").get<double>(), Catch::Matchers::WithinAbs(2000.0, 1e-3));
+    REQUIRE_THAT(events.at(1).at("ts").get<double>(), Catch::Matchers::WithinAbs(150.0, 1e-9));
+    REQUIRE(events.at(1).at("args").at("frame") == 7);
+}
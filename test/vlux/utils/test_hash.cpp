@@ -0,0 +1,19 @@
+#include <catch2/catch_test_macros.hpp>
+//
+#include <string_view>
+
+#include "vlux/utils/hash.h"
+
+TEST_CASE("Hash::HashBytes", "[utils, hash]") {
+    using vlux::HashBytes;
+    using vlux::kFnv1aOffsetBasis;
+
+    const auto bytes = [](const std::string_view text) {
+        return std::as_bytes(std::span(text.data(), text.size()));
+    };
+    CHECK(HashBytes({}) == kFnv1aOffsetBasis);
+    CHECK(HashBytes(bytes("a")) == 0xaf63dc4c8601ec8c);
+    CHECK(HashBytes(bytes("foobar")) == 0x85944171f73967e8);
+    // chaining equals hashing the concatenation
+    CHECK(HashBytes(bytes("bar"), HashBytes(bytes("foo"))) == HashBytes(bytes("foobar")));
+}
@@ -0,0 +1,28 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "vlux/utils/thread_pool.h"
+
+TEST_CASE("ThreadPool", "[utils,thread]") {
+    auto pool = vlux::ThreadPool(4);
+    REQUIRE(pool.GetNumThreads() == 4);
+
+    auto futures = std::vector<std::future<int>>();
+    for (auto i = 0; i < 100; i++) {
+        futures.emplace_back(pool.Submit([i]() { return i * i; }));
+    }
+    for (auto i = 0; i < 100; i++) {
+        REQUIRE(futures[i].get() == i * i);
+    }
+}
+
+TEST_CASE("ThreadPool::NestedSubmit", "[utils,thread]") {
+    auto pool = vlux::ThreadPool(2);
+    auto outer = pool.Submit([&pool]() { return pool.Submit([]() { return 42; }); });
+    REQUIRE(outer.get().get() == 42);
+}
+
+TEST_CASE("ThreadPool::Exception", "[utils,thread]") {
+    auto pool = vlux::ThreadPool(1);
+    auto future = pool.Submit([]() -> int { throw std::runtime_error("failed"); });
+    REQUIRE_THROWS_AS(future.get(), std::runtime_error);
+}